@@ -0,0 +1,256 @@
+// Measures how the frontend scales on synthetic designs: time, throughput and
+// peak RSS of slang parsing, elaboration, lowering and wire_connections, and
+// the parsing and lowering time at several thread counts.
+//
+//   abys_bench [--workload deep|wide|instances|unique|files] [--size N]
+//              [--threads 1,2,4,0] [--dir <tmpdir>]
+//
+// Without --workload every shape runs at its default size.
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/lowering_slang.h"
+#include "abys/ir/tig.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/util/parallel.h"
+#include "slang/driver/Driver.h"
+#include "sv_generator.h"
+
+namespace {
+
+using abys::bench::Workload;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using Clock = std::chrono::steady_clock;
+
+size_t default_size(Workload workload) {
+  switch (workload) {
+  case Workload::kDeep:
+    return 1000;
+  case Workload::kWide:
+    return 10000;
+  case Workload::kInstances:
+    return 100000;
+  case Workload::kUnique:
+    return 10000;
+  case Workload::kFiles:
+    return 2000;
+  }
+  return 0;
+}
+
+// Linux keeps the peak resident set in VmHWM, and writing 5 to clear_refs
+// resets it to the current RSS, which gives a peak per phase.
+void reset_peak_rss() {
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+}
+
+size_t peak_rss_bytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+  return 0;
+}
+
+struct Phase {
+  const char *name;
+  double seconds = 0;
+  size_t peak_rss = 0;
+};
+
+template <typename F> Phase measure(const char *name, F &&body) {
+  reset_peak_rss();
+  const auto start = Clock::now();
+  body();
+  return {name, std::chrono::duration<double>(Clock::now() - start).count(), peak_rss_bytes()};
+}
+
+void print_phase(Workload workload, const Phase &phase, double amount, const char *unit) {
+  std::printf("%-10s %-12s %10.3f s %12.3g %-9s %10.1f MiB\n",
+              std::string(abys::bench::workload_name(workload)).c_str(), phase.name,
+              phase.seconds, phase.seconds > 0 ? amount / phase.seconds : 0.0, unit,
+              static_cast<double>(phase.peak_rss) / (1024.0 * 1024.0));
+}
+
+size_t count_nodes(const Tig &design) {
+  size_t nodes = 0;
+  for (const auto &module : design.modules) {
+    nodes += module.num_nodes();
+  }
+  return nodes;
+}
+
+// Add `paths` to `driver` and process its options; `num_threads` of 0 keeps
+// slang's default thread count.
+bool configure(slang::driver::Driver &driver, const std::vector<std::string> &paths, size_t size,
+               unsigned num_threads) {
+  for (const auto &path : paths) {
+    driver.sourceLoader.addFiles(path);
+  }
+  driver.options.topModules.push_back("top");
+  driver.options.maxInstanceDepth = static_cast<uint32_t>(size + 16);
+  if (num_threads != 0) {
+    driver.options.numThreads = num_threads;
+  }
+  if (!driver.processOptions()) {
+    std::fprintf(stderr, "failed to process slang options\n");
+    return false;
+  }
+  return true;
+}
+
+bool run(Workload workload, size_t size, const std::vector<unsigned> &threads,
+         const std::filesystem::path &dir) {
+  const auto paths = abys::bench::write_workload_files(workload, size, dir.string());
+  if (paths.empty()) {
+    std::fprintf(stderr, "failed to write the %s workload to %s\n",
+                 std::string(abys::bench::workload_name(workload)).c_str(), dir.c_str());
+    return false;
+  }
+  double source_bytes = 0;
+  for (const auto &path : paths) {
+    source_bytes += static_cast<double>(std::filesystem::file_size(path));
+  }
+
+  slang::driver::Driver driver;
+  if (!configure(driver, paths, size, 0)) {
+    return false;
+  }
+
+  bool parsed = false;
+  const Phase parse = measure("parse", [&] { parsed = driver.parseAllSources(); });
+  if (!parsed) {
+    std::fprintf(stderr, "failed to parse the %s workload\n",
+                 std::string(abys::bench::workload_name(workload)).c_str());
+    return false;
+  }
+
+  std::unique_ptr<slang::ast::Compilation> compilation;
+  const Phase elaborate = measure("elaborate", [&] {
+    compilation = driver.createCompilation();
+    driver.reportCompilation(*compilation, true);
+  });
+  if (driver.diagEngine.getNumErrors() > 0) {
+    std::fprintf(stderr, "slang reported compilation errors\n");
+    return false;
+  }
+  const auto &root = compilation->getRoot();
+
+  // Serial lowering, split into its two halves: every body is visited before
+  // any is wired, so each half gets its own time and peak. A body's pending
+  // inputs stay with its visitor until it is wired.
+  Tig design;
+  TigBuilder builder(design);
+  abys::ir::SlangModuleCollector<TigBuilder> collector(builder);
+  using Visitor = abys::ir::SlangLoweringVisitor<TigBuilder>;
+  std::vector<std::unique_ptr<Visitor>> visitors;
+  const Phase lower = measure("lower", [&] {
+    root.visit(collector);
+    for (const auto &[body, module_id] : collector.bodies()) {
+      visitors.push_back(std::make_unique<Visitor>(builder, collector.module_ids()));
+      visitors.back()->visit_body(*body, module_id);
+    }
+  });
+  const Phase wire = measure("wire", [&] {
+    for (auto &visitor : visitors) {
+      visitor->wire_body();
+    }
+  });
+  visitors.clear();
+  const double nodes = static_cast<double>(count_nodes(design));
+
+  print_phase(workload, parse, source_bytes / (1024.0 * 1024.0), "MiB/s");
+  print_phase(workload, elaborate, nodes, "nodes/s");
+  print_phase(workload, lower, nodes, "nodes/s");
+  print_phase(workload, wire, nodes, "nodes/s");
+
+  // slang only spreads loading and parsing over threads when there are
+  // several files, so single-file workloads show no scaling here.
+  for (unsigned num_threads : threads) {
+    slang::driver::Driver parallel_driver;
+    if (!configure(parallel_driver, paths, size,
+                   abys::util::resolve_num_threads(num_threads))) {
+      return false;
+    }
+    const std::string name = "parse -j" + std::to_string(num_threads);
+    const Phase phase = measure(name.c_str(), [&] { parallel_driver.parseAllSources(); });
+    print_phase(workload, phase, source_bytes / (1024.0 * 1024.0), "MiB/s");
+  }
+
+  for (unsigned num_threads : threads) {
+    Tig parallel_design;
+    TigBuilder parallel_builder(parallel_design);
+    const std::string name = "lower -j" + std::to_string(num_threads);
+    const Phase phase = measure(name.c_str(), [&] {
+      abys::ir::lower_slang_ast_to_ir(root, parallel_builder, num_threads);
+    });
+    print_phase(workload, phase, nodes, "nodes/s");
+  }
+
+  for (const auto &path : paths) {
+    std::filesystem::remove(path);
+  }
+  return true;
+}
+
+std::vector<unsigned> parse_threads(const std::string &list) {
+  std::vector<unsigned> threads;
+  std::stringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    threads.push_back(static_cast<unsigned>(std::stoul(item)));
+  }
+  return threads;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::optional<Workload> only;
+  std::optional<size_t> size;
+  std::vector<unsigned> threads = {1, 2, 4, 0};
+  std::filesystem::path dir = std::filesystem::temp_directory_path();
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--workload" && i + 1 < argc) {
+      only = abys::bench::parse_workload(argv[++i]);
+      if (!only) {
+        std::fprintf(stderr, "unknown workload: %s\n", argv[i]);
+        return 1;
+      }
+    } else if (arg == "--size" && i + 1 < argc) {
+      size = std::stoull(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = parse_threads(argv[++i]);
+    } else if (arg == "--dir" && i + 1 < argc) {
+      dir = argv[++i];
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+      return 1;
+    }
+  }
+
+  std::printf("%-10s %-12s %12s %22s %14s\n", "workload", "phase", "time", "throughput",
+              "peak rss");
+  bool ok = true;
+  for (Workload workload : {Workload::kDeep, Workload::kWide, Workload::kInstances,
+                            Workload::kUnique, Workload::kFiles}) {
+    if (!only || *only == workload) {
+      ok &= run(workload, size.value_or(default_size(workload)), threads, dir);
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Binary AIGER throughput in MB/s: writing a synthetic design of many distinct
+// datapath modules for a range of thread counts, then reading every file back,
+// both decoding alone and decoding into a Tig through TigBuilder.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "abys/aig/aiger.h"
+#include "abys/ir/tig_builder.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using Clock = std::chrono::steady_clock;
+
+constexpr Tig::SignalWidth kWidth = 32;
+
+// Module i computes a chain of `depth` ops over its two inputs, with the op mix
+// varying per module.
+void build_module(TigBuilder &builder, int i, int depth) {
+  static constexpr const char *kOps[] = {"add", "and", "xor", "or", "sub"};
+  const auto m = builder.create_module("m" + std::to_string(i));
+  auto name = [&](const std::string &s) { return builder.intern(s); };
+  Tig::NodeId a = builder.create_module_input(m, name("a"), kWidth, false);
+  const Tig::NodeId b = builder.create_module_input(m, name("b"), kWidth, false);
+  for (int d = 0; d < depth; d++) {
+    const std::vector<TigBuilder::Signal> inputs{{a, 0}, {b, 0}};
+    a = builder.create_op_node(m, name("t" + std::to_string(d)), name(kOps[(i + d) % 5]),
+                               kWidth, false, inputs);
+  }
+  builder.create_module_output(m, name("y"), kWidth, false, a);
+}
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int modules = argc > 1 ? std::atoi(argv[1]) : 200;
+  const int depth = argc > 2 ? std::atoi(argv[2]) : 500;
+  Tig design;
+  {
+    TigBuilder builder(design);
+    for (int i = 0; i < modules; i++) {
+      build_module(builder, i, depth);
+    }
+  }
+  const auto dir = std::filesystem::temp_directory_path() / "abys_bench_aiger";
+  std::filesystem::remove_all(dir);
+
+  std::printf("modules: %d, depth: %d\n", modules, depth);
+  std::printf("%-12s %8s %12s %10s\n", "direction", "threads", "MB", "MB/s");
+  abys::aig::AigerWriteResult written;
+  for (const unsigned threads : {1u, 2u, 4u, 8u, 0u}) {
+    abys::aig::AigerWriteOptions options;
+    options.num_threads = threads;
+    const auto start = Clock::now();
+    written = abys::aig::write_aiger(design, dir.string(), options);
+    const double seconds = seconds_since(start);
+    if (!written.ok) {
+      std::fprintf(stderr, "write failed: %s\n", written.message.c_str());
+      return 1;
+    }
+    const double mb = static_cast<double>(written.bytes_written) / 1e6;
+    std::printf("%-12s %8u %12.1f %10.1f\n", "write", threads, mb, mb / seconds);
+  }
+
+  // Bit-blasting dominates writing; reading has no such step, so decoding and
+  // building the Tig are timed apart.
+  const double mb = static_cast<double>(written.bytes_written) / 1e6;
+  double decode_seconds = 0;
+  double build_seconds = 0;
+  Tig read_back;
+  TigBuilder builder(read_back);
+  for (const auto &path : written.paths) {
+    auto start = Clock::now();
+    const auto read = abys::aig::read_aiger(path);
+    decode_seconds += seconds_since(start);
+    if (!read.ok) {
+      std::fprintf(stderr, "read failed: %s\n", read.message.c_str());
+      return 1;
+    }
+    start = Clock::now();
+    abys::aig::build_aiger_module(builder, std::filesystem::path(path).stem().string(), read.aig,
+                                  read.symbols);
+    build_seconds += seconds_since(start);
+  }
+  std::printf("%-12s %8u %12.1f %10.1f\n", "read", 1u, mb, mb / decode_seconds);
+  std::printf("%-12s %8u %12.1f %10.1f\n", "read to tig", 1u, mb,
+              mb / (decode_seconds + build_seconds));
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,99 @@
+// Simulation throughput in patterns x nodes per second, for the scalar and the
+// AVX2 kernels and a range of batch sizes, on a synthetic hierarchy: a top
+// module chaining instances of a 32-bit datapath cell.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "abys/sim/simulator.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+
+constexpr Tig::SignalWidth kWidth = 32;
+
+// y = ((a + b) ^ (a & b)) - (a | ~b), repeated `depth` times with y fed back as a.
+Tig::ModuleId build_cell(TigBuilder &builder, int depth) {
+  const auto m = builder.create_module("cell");
+  auto name = [&](const std::string &s) { return builder.intern(s); };
+  Tig::NodeId a = builder.create_module_input(m, name("a"), kWidth, false);
+  const Tig::NodeId b = builder.create_module_input(m, name("b"), kWidth, false);
+  auto op = [&](const std::string &out, const char *o, std::vector<TigBuilder::Signal> in) {
+    return builder.create_op_node(m, name(out), name(o), kWidth, false, in);
+  };
+  for (int d = 0; d < depth; d++) {
+    const std::string s = std::to_string(d);
+    const auto sum = op("sum" + s, "add", {{a, 0}, {b, 0}});
+    const auto both = op("both" + s, "and", {{a, 0}, {b, 0}});
+    const auto mix = op("mix" + s, "xor", {{sum, 0}, {both, 0}});
+    const auto nb = op("nb" + s, "not", {{b, 0}});
+    const auto either = op("either" + s, "or", {{a, 0}, {nb, 0}});
+    a = op("y" + s, "sub", {{mix, 0}, {either, 0}});
+  }
+  builder.create_module_output(m, name("y"), kWidth, false, a);
+  return m;
+}
+
+Tig build_design(int instances, int depth) {
+  Tig design;
+  TigBuilder builder(design);
+  const auto cell = build_cell(builder, depth);
+  const auto top = builder.create_module("top");
+  Tig::NodeId a = builder.create_module_input(top, builder.intern("a"), kWidth, false);
+  const Tig::NodeId b = builder.create_module_input(top, builder.intern("b"), kWidth, false);
+  for (int i = 0; i < instances; i++) {
+    const std::vector<TigBuilder::Signal> inputs{{a, 0}, {b, 0}};
+    const TigBuilder::SignalSpec out{builder.intern("w" + std::to_string(i)), kWidth, false};
+    a = builder.create_instance(top, builder.intern("u" + std::to_string(i)), cell, inputs,
+                                {&out, 1});
+  }
+  builder.create_module_output(top, builder.intern("y"), kWidth, false, a);
+  return design;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int instances = argc > 1 ? std::atoi(argv[1]) : 256;
+  const int depth = argc > 2 ? std::atoi(argv[2]) : 16;
+  const Tig design = build_design(instances, depth);
+  const Tig::ModuleId top = 1;
+
+  std::printf("instances: %d, cell depth: %d, width: %llu\n", instances, depth,
+              static_cast<unsigned long long>(kWidth));
+  std::printf("%-8s %10s %14s %22s\n", "kernels", "words", "ms/run", "patterns*nodes/s");
+  for (const bool simd : {false, true}) {
+    if (simd && !abys::sim::avx2_kernels()) {
+      std::printf("%-8s (not available)\n", "avx2");
+      continue;
+    }
+    for (const size_t words : {1, 4, 16, 64, 256}) {
+      abys::sim::Simulator sim(design, top, {words, simd});
+      sim.randomize_inputs(1);
+      if (const auto warm = sim.run(); !warm.ok) {
+        std::fprintf(stderr, "simulation failed: %s\n", warm.message.c_str());
+        return 1;
+      }
+      // Aim for roughly the same total work at every batch size.
+      const int rounds = std::max<int>(1, static_cast<int>(256 / words));
+      const auto start = std::chrono::steady_clock::now();
+      for (int r = 0; r < rounds; r++) {
+        sim.run();
+      }
+      const double seconds =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      const double rate = static_cast<double>(sim.num_patterns()) *
+                          static_cast<double>(sim.nodes_evaluated()) * rounds / seconds;
+      std::printf("%-8s %10zu %14.3f %22.3e\n", sim.kernels().name, words,
+                  1e3 * seconds / rounds, rate);
+    }
+  }
+  return 0;
+}
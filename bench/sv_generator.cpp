@@ -0,0 +1,199 @@
+#include "sv_generator.h"
+
+#include <fstream>
+
+namespace abys::bench {
+
+namespace {
+
+constexpr size_t kWidePortWidth = 1024;
+
+// 8-bit cell shared by the hierarchical workloads.
+void write_cell(std::ostream &out) {
+  out << "module cell(\n"
+         "  input  logic [7:0] a,\n"
+         "  input  logic [7:0] b,\n"
+         "  output logic [7:0] y\n"
+         ");\n"
+         "  logic [7:0] t;\n"
+         "  assign t = a ^ b;\n"
+         "  assign y = t + a;\n"
+         "endmodule\n\n";
+}
+
+void write_deep(std::ostream &out, size_t size) {
+  write_cell(out);
+  for (size_t i = size; i-- > 0;) {
+    const std::string child = i + 1 == size ? "cell" : "level_" + std::to_string(i + 1);
+    out << "module " << (i == 0 ? std::string("top") : "level_" + std::to_string(i)) << "(\n"
+        << "  input  logic [7:0] a,\n"
+           "  input  logic [7:0] b,\n"
+           "  output logic [7:0] y\n"
+           ");\n"
+           "  logic [7:0] t;\n"
+        << "  " << child << " u(.a(a), .b(b), .y(t));\n"
+        << "  assign y = t & b;\n"
+           "endmodule\n\n";
+  }
+}
+
+void write_wide(std::ostream &out, size_t size) {
+  out << "module top(\n";
+  for (size_t i = 0; i < size; i++) {
+    out << "  input  logic [" << kWidePortWidth - 1 << ":0] a" << i << ",\n";
+  }
+  for (size_t i = 0; i < size; i++) {
+    out << "  output logic [" << kWidePortWidth - 1 << ":0] y" << i
+        << (i + 1 == size ? "\n" : ",\n");
+  }
+  out << ");\n";
+  for (size_t i = 0; i < size; i++) {
+    out << "  assign y" << i << " = a" << i << " ^ a" << (i + 1) % size << ";\n";
+  }
+  out << "endmodule\n";
+}
+
+void write_instances(std::ostream &out, size_t size) {
+  write_cell(out);
+  out << "module top(\n"
+         "  input  logic [7:0] a,\n"
+         "  input  logic [7:0] b,\n"
+         "  output logic [7:0] y\n"
+         ");\n";
+  for (size_t i = 1; i < size; i++) {
+    out << "  logic [7:0] w" << i << ";\n";
+  }
+  // Instance i drives w(i+1); the chain starts at `a` and ends at `y`.
+  for (size_t i = 0; i < size; i++) {
+    const std::string in = i == 0 ? "a" : "w" + std::to_string(i);
+    const std::string result = i + 1 == size ? "y" : "w" + std::to_string(i + 1);
+    out << "  cell u" << i << "(.a(" << in << "), .b(b), .y(" << result << "));\n";
+  }
+  out << "endmodule\n";
+}
+
+void write_unique_module(std::ostream &out, size_t i) {
+  static constexpr const char *kOps[] = {"&", "|", "^", "+", "-"};
+  // The operator mix and the extra signals vary per module so that no two
+  // definitions are alike.
+  out << "module m" << i << "(\n"
+      << "  input  logic [7:0] a,\n"
+         "  input  logic [7:0] b,\n"
+         "  output logic [7:0] y\n"
+         ");\n";
+  const size_t depth = 1 + i % 4;
+  for (size_t d = 0; d < depth; d++) {
+    out << "  logic [7:0] t" << d << ";\n";
+  }
+  out << "  assign t0 = a " << kOps[i % 5] << " b;\n";
+  for (size_t d = 1; d < depth; d++) {
+    out << "  assign t" << d << " = t" << d - 1 << " " << kOps[(i / 5 + d) % 5] << " a;\n";
+  }
+  out << "  assign y = ~t" << depth - 1 << ";\n"
+      << "endmodule\n\n";
+}
+
+void write_unique_top(std::ostream &out, size_t size) {
+  out << "module top(\n"
+         "  input  logic [7:0] a,\n"
+         "  input  logic [7:0] b,\n"
+         "  output logic [7:0] y\n"
+         ");\n";
+  for (size_t i = 1; i < size; i++) {
+    out << "  logic [7:0] w" << i << ";\n";
+  }
+  for (size_t i = 0; i < size; i++) {
+    const std::string in = i == 0 ? "a" : "w" + std::to_string(i);
+    const std::string result = i + 1 == size ? "y" : "w" + std::to_string(i + 1);
+    out << "  m" << i << " u" << i << "(.a(" << in << "), .b(b), .y(" << result << "));\n";
+  }
+  out << "endmodule\n";
+}
+
+void write_unique(std::ostream &out, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write_unique_module(out, i);
+  }
+  write_unique_top(out, size);
+}
+
+} // namespace
+
+std::string_view workload_name(Workload workload) {
+  switch (workload) {
+  case Workload::kDeep:
+    return "deep";
+  case Workload::kWide:
+    return "wide";
+  case Workload::kInstances:
+    return "instances";
+  case Workload::kUnique:
+    return "unique";
+  case Workload::kFiles:
+    return "files";
+  }
+  return "unknown";
+}
+
+std::optional<Workload> parse_workload(std::string_view name) {
+  for (Workload workload : {Workload::kDeep, Workload::kWide, Workload::kInstances,
+                            Workload::kUnique, Workload::kFiles}) {
+    if (workload_name(workload) == name) {
+      return workload;
+    }
+  }
+  return std::nullopt;
+}
+
+bool write_workload(Workload workload, size_t size, const std::string &path) {
+  std::ofstream out(path);
+  if (!out || size == 0) {
+    return false;
+  }
+  switch (workload) {
+  case Workload::kDeep:
+    write_deep(out, size);
+    break;
+  case Workload::kWide:
+    write_wide(out, size);
+    break;
+  case Workload::kInstances:
+    write_instances(out, size);
+    break;
+  case Workload::kUnique:
+  case Workload::kFiles:
+    write_unique(out, size);
+    break;
+  }
+  return static_cast<bool>(out);
+}
+
+std::vector<std::string> write_workload_files(Workload workload, size_t size,
+                                              const std::string &dir) {
+  const std::string base = dir + "/" + std::string(workload_name(workload));
+  if (workload != Workload::kFiles) {
+    if (!write_workload(workload, size, base + ".sv")) {
+      return {};
+    }
+    return {base + ".sv"};
+  }
+  if (size == 0) {
+    return {};
+  }
+  std::vector<std::string> paths;
+  for (size_t i = 0; i <= size; i++) {
+    paths.push_back(base + "_" + (i == size ? std::string("top") : std::to_string(i)) + ".sv");
+    std::ofstream out(paths.back());
+    if (i == size) {
+      write_unique_top(out, size);
+    } else {
+      write_unique_module(out, i);
+    }
+    if (!out) {
+      return {};
+    }
+  }
+  return paths;
+}
+
+} // namespace abys::bench
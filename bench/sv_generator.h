@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace abys::bench {
+
+// Shapes of synthetic designs. All of them only use constructs the slang
+// lowering supports: ports, continuous assignments of operators over named
+// values, and instances connected by name.
+enum class Workload {
+  // A chain of `size` distinct modules, each instantiating the next.
+  kDeep,
+  // One module with `size` input and output ports of 1024 bits each.
+  kWide,
+  // A top module with `size` instances of one small cell.
+  kInstances,
+  // `size` distinct module definitions, each instantiated once by the top.
+  kUnique,
+  // As kUnique, but every module, and the top, in a file of its own.
+  kFiles,
+};
+
+std::string_view workload_name(Workload workload);
+std::optional<Workload> parse_workload(std::string_view name);
+
+/// Write a design of the given shape to `path`; its top module is `top`.
+/// Returns false if the file could not be written.
+bool write_workload(Workload workload, size_t size, const std::string &path);
+
+/// Write a design of the given shape into `dir`, in one file per module for
+/// kFiles and in a single `<workload>.sv` otherwise. Returns the paths written,
+/// or nothing if a file could not be written.
+std::vector<std::string> write_workload_files(Workload workload, size_t size,
+                                              const std::string &dir);
+
+} // namespace abys::bench
@@ -0,0 +1,179 @@
+// Compares the packed Tig::Module node layout against the per-node layout it
+// replaced: heap bytes per node and fanin traversal time on a synthetic
+// netlist of conversion chains and instances.
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "abys/ir/tig.h"
+#include "abys/ir/tig_builder.h"
+
+namespace {
+
+// Live heap bytes, as seen by the allocator.
+size_t g_live_bytes = 0;
+
+void release(void *p) {
+  if (p) {
+    g_live_bytes -= malloc_usable_size(p);
+    std::free(p);
+  }
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (void *p = std::malloc(size)) {
+    g_live_bytes += malloc_usable_size(p);
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { release(p); }
+void operator delete(void *p, std::size_t) noexcept { release(p); }
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+
+// The node layout used before Tig::Module switched to column storage and
+// interned names.
+struct LegacyOutput {
+  std::string name;
+  Tig::SignalWidth width = 0;
+  bool sign = false;
+};
+
+struct LegacyNode {
+  Tig::Module::NodeKind kind = Tig::Module::NodeKind::kUnknown;
+  std::string name;
+  Tig::ModuleId module_id = Tig::kInvalidModuleId;
+  std::string op;
+  std::string const_value;
+  std::vector<Tig::Module::EdgeRef> inputs;
+  std::vector<LegacyOutput> outputs;
+  std::vector<Tig::SignalWidth> segment_widths;
+};
+
+constexpr Tig::NodeId kInstanceEvery = 16;
+
+std::string signal_name(Tig::NodeId i) { return "n" + std::to_string(i); }
+
+struct LegacyModule {
+  std::vector<LegacyNode> nodes;
+  std::unordered_map<std::string, Tig::Module::EdgeRef> signal_map;
+};
+
+LegacyModule build_legacy(Tig::NodeId num_nodes) {
+  LegacyModule module;
+  auto &nodes = module.nodes;
+  for (Tig::NodeId i = 0; i < num_nodes; i++) {
+    LegacyNode &node = nodes.emplace_back();
+    if (i == 0) {
+      node.kind = Tig::Module::NodeKind::kPi;
+    } else if (i % kInstanceEvery == 0) {
+      node.kind = Tig::Module::NodeKind::kInstance;
+      node.name = "u" + std::to_string(i);
+      node.module_id = 0;
+      node.inputs = {{i - 1, 0}, {i / 2, 0}};
+    } else {
+      node.kind = Tig::Module::NodeKind::kConvert;
+      node.inputs = {{i - 1, 0}};
+    }
+    node.outputs.push_back({signal_name(i), 8, false});
+    module.signal_map.emplace(signal_name(i), Tig::Module::EdgeRef{i, 0});
+  }
+  return module;
+}
+
+Tig build_packed(Tig::NodeId num_nodes) {
+  Tig design;
+  TigBuilder builder(design);
+  const Tig::ModuleId module_id = builder.create_module("bench");
+  for (Tig::NodeId i = 0; i < num_nodes; i++) {
+    if (i == 0) {
+      builder.create_module_input(module_id, builder.intern(signal_name(i)), 8, false);
+    } else if (i % kInstanceEvery == 0) {
+      std::vector<TigBuilder::Signal> inputs{{i - 1, 0}, {i / 2, 0}};
+      std::vector<TigBuilder::SignalSpec> outputs{{builder.intern(signal_name(i)), 8, false}};
+      builder.create_instance(module_id, builder.intern("u" + std::to_string(i)), 0, inputs,
+                              outputs);
+    } else {
+      builder.create_conversion_node(module_id, builder.intern(signal_name(i)), 8, false, i - 1);
+    }
+  }
+  return design;
+}
+
+template <typename F> double time_ns_per_node(Tig::NodeId num_nodes, int rounds, F &&walk) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    walk();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  return ns / (static_cast<double>(num_nodes) * rounds);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Tig::NodeId num_nodes =
+      argc > 1 ? static_cast<Tig::NodeId>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+  const int rounds = 20;
+
+  size_t before = g_live_bytes;
+  LegacyModule legacy = build_legacy(num_nodes);
+  const size_t legacy_bytes = g_live_bytes - before;
+
+  before = g_live_bytes;
+  Tig packed = build_packed(num_nodes);
+  const size_t packed_bytes = g_live_bytes - before;
+  const Tig::Module &module = packed.modules[0];
+
+  uint64_t legacy_sum = 0;
+  const double legacy_ns = time_ns_per_node(num_nodes, rounds, [&] {
+    for (const LegacyNode &node : legacy.nodes) {
+      for (const auto &edge : node.inputs) {
+        legacy_sum += edge.node_id;
+      }
+      for (const auto &output : node.outputs) {
+        legacy_sum += output.width;
+      }
+    }
+  });
+
+  uint64_t packed_sum = 0;
+  const double packed_ns = time_ns_per_node(num_nodes, rounds, [&] {
+    for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+      for (const auto &edge : module.node_fanins(n)) {
+        packed_sum += edge.node_id;
+      }
+      for (const auto &output : module.node_outputs(n)) {
+        packed_sum += output.width;
+      }
+    }
+  });
+
+  if (legacy_sum != packed_sum) {
+    std::fprintf(stderr, "traversal mismatch\n");
+    return 1;
+  }
+
+  std::printf("nodes: %u\n", num_nodes);
+  std::printf("%-8s %16s %16s\n", "layout", "bytes/node", "walk ns/node");
+  std::printf("%-8s %16.1f %16.2f\n", "legacy", static_cast<double>(legacy_bytes) / num_nodes,
+              legacy_ns);
+  std::printf("%-8s %16.1f %16.2f\n", "packed", static_cast<double>(packed_bytes) / num_nodes,
+              packed_ns);
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Verilog output throughput in MB/s for a range of thread counts and buffer
+// sizes, on a synthetic design of many distinct datapath modules. Peak RSS is
+// reported after each run: it should stay close to the size of the design
+// itself, whatever the size of the file written.
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/verilog_writer.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+
+constexpr Tig::SignalWidth kWidth = 32;
+
+// Module i computes a chain of `depth` ops over its two inputs, with the op mix
+// varying per module.
+void build_module(TigBuilder &builder, int i, int depth) {
+  static constexpr const char *kOps[] = {"add", "and", "xor", "or", "sub"};
+  const auto m = builder.create_module("m" + std::to_string(i));
+  auto name = [&](const std::string &s) { return builder.intern(s); };
+  Tig::NodeId a = builder.create_module_input(m, name("a"), kWidth, false);
+  const Tig::NodeId b = builder.create_module_input(m, name("b"), kWidth, false);
+  for (int d = 0; d < depth; d++) {
+    const std::vector<TigBuilder::Signal> inputs{{a, 0}, {b, 0}};
+    a = builder.create_op_node(m, name("t" + std::to_string(d)), name(kOps[(i + d) % 5]),
+                               kWidth, false, inputs);
+  }
+  builder.create_module_output(m, name("y"), kWidth, false, a);
+}
+
+Tig build_design(int modules, int depth) {
+  Tig design;
+  TigBuilder builder(design);
+  for (int i = 0; i < modules; i++) {
+    build_module(builder, i, depth);
+  }
+  return design;
+}
+
+double peak_rss_mib() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int modules = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const int depth = argc > 2 ? std::atoi(argv[2]) : 500;
+  const Tig design = build_design(modules, depth);
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "abys_bench_write_verilog.v").string();
+
+  std::printf("modules: %d, depth: %d, peak RSS after build: %.1f MiB\n", modules, depth,
+              peak_rss_mib());
+  std::printf("%8s %12s %12s %10s %14s\n", "threads", "buffer", "MB", "MB/s", "peak RSS MiB");
+  for (const size_t buffer : {size_t{64} << 10, size_t{1} << 20}) {
+    for (const unsigned threads : {1u, 2u, 4u, 8u, 0u}) {
+      abys::ir::VerilogWriteOptions options;
+      options.buffer_bytes = buffer;
+      options.num_threads = threads;
+      const auto start = std::chrono::steady_clock::now();
+      const auto result = abys::ir::write_verilog(design, path, options);
+      const double seconds =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (!result.ok) {
+        std::fprintf(stderr, "write failed: %s\n", result.message.c_str());
+        return 1;
+      }
+      const double mb = static_cast<double>(result.bytes_written) / 1e6;
+      std::printf("%8u %12zu %12.1f %10.1f %14.1f\n", threads, buffer, mb, mb / seconds,
+                  peak_rss_mib());
+    }
+  }
+  std::filesystem::remove(path);
+  return 0;
+}
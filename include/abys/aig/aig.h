@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace abys::aig {
+
+/// A 32-bit AIG literal: variable index shifted left once, low bit set when
+/// complemented. Variable 0 is constant false, so literal 0 is false and
+/// literal 1 is true.
+using Literal = uint32_t;
+using Var = uint32_t;
+
+static constexpr Literal kFalse = 0;
+static constexpr Literal kTrue = 1;
+
+inline constexpr Literal make_literal(Var var, bool complement = false) {
+  return (var << 1) | (complement ? 1u : 0u);
+}
+inline constexpr Var literal_var(Literal lit) { return lit >> 1; }
+inline constexpr bool is_complemented(Literal lit) { return (lit & 1u) != 0; }
+inline constexpr Literal negate(Literal lit) { return lit ^ 1u; }
+inline constexpr Literal negate_if(Literal lit, bool c) { return lit ^ (c ? 1u : 0u); }
+
+/// And-inverter graph with structural hashing.
+///
+/// Each variable is the constant, a primary input or a two-input AND; the two
+/// fanins of variable `v` sit side by side at `fanins_[2v]` and
+/// `fanins_[2v + 1]`, so a traversal touches one 8-byte record per node. Every
+/// AND is looked up in an open-addressing table before it is created, and
+/// trivial cases (constants, equal or opposite fanins) are folded, so no two
+/// variables compute the same AND of the same literals.
+class Aig {
+public:
+  Aig();
+
+  Var num_vars() const { return static_cast<Var>(fanins_.size() / 2); }
+  size_t num_inputs() const { return inputs_.size(); }
+  size_t num_ands() const { return num_vars() - 1 - inputs_.size(); }
+
+  bool is_constant(Var var) const { return var == 0; }
+  bool is_input(Var var) const { return var != 0 && fanins_[2 * var] == kNoFanin; }
+  bool is_and(Var var) const { return var != 0 && fanins_[2 * var] != kNoFanin; }
+
+  /// Fanins of an AND, with fanin0() < fanin1().
+  Literal fanin0(Var var) const { return fanins_[2 * var]; }
+  Literal fanin1(Var var) const { return fanins_[2 * var + 1]; }
+
+  std::span<const Var> inputs() const { return inputs_; }
+  std::span<const Literal> outputs() const { return outputs_; }
+
+  Literal create_input();
+  size_t add_output(Literal lit);
+
+  Literal create_and(Literal a, Literal b);
+  Literal create_or(Literal a, Literal b) { return negate(create_and(negate(a), negate(b))); }
+  Literal create_xor(Literal a, Literal b);
+  Literal create_xnor(Literal a, Literal b) { return negate(create_xor(a, b)); }
+  /// `s ? t : e`
+  Literal create_mux(Literal s, Literal t, Literal e);
+  /// Carry-out of a full adder.
+  Literal create_majority(Literal a, Literal b, Literal c);
+
+  /// Number of create_and calls answered by folding or by the hash table.
+  uint64_t strash_hits() const { return strash_hits_; }
+
+  void reserve(size_t num_vars);
+
+private:
+  static constexpr Literal kNoFanin = std::numeric_limits<Literal>::max();
+  static constexpr Var kEmptySlot = 0;
+
+  size_t slot_of(Literal a, Literal b) const;
+  void grow_table();
+
+  std::vector<Literal> fanins_;
+  std::vector<Var> inputs_;
+  std::vector<Literal> outputs_;
+  // Open-addressing table of AND variables, at most half full.
+  std::vector<Var> table_;
+  size_t num_table_entries_ = 0;
+  uint64_t strash_hits_ = 0;
+};
+
+} // namespace abys::aig
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abys/aig/aig.h"
+#include "abys/ir/tig.h"
+#include "abys/ir/tig_builder.h"
+
+namespace abys::aig {
+
+/// Names of the inputs and outputs of an AIG, as in an AIGER symbol table.
+/// Either list may be shorter than the AIG's, or empty.
+struct AigerSymbols {
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+};
+
+/// Encode `aig` as binary AIGER (the `aig` format, without latches) at the
+/// front of `buffer`, and return the number of bytes written.
+///
+/// Inputs are renumbered first and ANDs after them in variable order, which
+/// is topological. Each AND is written as two deltas in 7-bit groups straight
+/// into `buffer`, which grows only when the AIG cannot fit: reusing one buffer
+/// for many AIGs neither allocates nor clears it again.
+size_t encode_aiger(const Aig &aig, const AigerSymbols &symbols, std::vector<char> &buffer);
+
+struct AigerReadResult {
+  bool ok = false;
+  std::string message;
+  Aig aig;
+  AigerSymbols symbols;
+  uint64_t bytes_read = 0;
+};
+
+/// Decode a binary AIGER file. ANDs go through Aig::create_and, so the AIG
+/// comes back structurally hashed. Latches, and the ASCII `aag` format, are
+/// refused: the writer emits combinational modules only. So are files with
+/// more than 2^24 inputs, which cost memory but no bytes in the file.
+AigerReadResult decode_aiger(std::string_view data);
+AigerReadResult read_aiger(const std::string &path);
+
+/// Add `aig` to the builder's design as a module named `name`, and return its
+/// id.
+///
+/// Inputs and outputs whose symbols read `base[0]`, `base[1]`, ... in a row
+/// become one port `base` of that width, split into bits or merged from them;
+/// other symbols name 1-bit ports, and unnamed ones are called `i<n>` and
+/// `o<n>`. Every AND becomes a 1-bit `and` op and every complemented literal a
+/// `not` op, so a module written by write_aiger() reads back with its ports.
+ir::Tig::ModuleId build_aiger_module(ir::TigBuilder &builder, std::string_view name,
+                                     const Aig &aig, const AigerSymbols &symbols = {});
+
+struct AigerWriteOptions {
+  /// Threads writing modules; 0 means one per hardware thread.
+  unsigned num_threads = 1;
+  /// Write a symbol table naming every input and output bit.
+  bool symbols = true;
+};
+
+struct AigerWriteResult {
+  bool ok = false;
+  std::string message;
+  uint64_t bytes_written = 0;
+  /// The file of every module, indexed by module id.
+  std::vector<std::string> paths;
+};
+
+/// Bit-blast every module of `design` and write each to a file of its own in
+/// `dir`, named after the module, on up to `options.num_threads` threads.
+///
+/// Inputs and outputs follow bit_blast_module(): instances and registers are
+/// cut points, so every module is independent of the others. Symbols name the
+/// bits `port[i]` for ports, `signal[i]` for register and instance outputs,
+/// and `instance.port[i]` and `_n<node>[i]` for instance and register inputs;
+/// 1-bit signals drop the index.
+AigerWriteResult write_aiger(const ir::Tig &design, const std::string &dir,
+                             const AigerWriteOptions &options = {});
+
+} // namespace abys::aig
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "abys/aig/aig.h"
+#include "abys/ir/tig.h"
+
+namespace abys::aig {
+
+struct BitBlastResult {
+  bool ok = false;
+  std::string message;
+};
+
+/// One Tig module lowered to bits.
+///
+/// AIG inputs are, in order, the bits of every kPi node, then those of every
+/// kRo node and instance output in node order. AIG outputs are the bits of
+/// every kPo node, then those of every kRi node and instance input in node
+/// order. Instances and registers are thus cut points: the AIG is the
+/// combinational logic of this module alone.
+struct BlastedModule {
+  Aig aig;
+  // Bits of every node output, least significant first. The output with index
+  // `i` in Module::outputs owns `bits[bit_offsets[i] .. bit_offsets[i + 1])`.
+  std::vector<uint64_t> bit_offsets;
+  std::vector<Literal> bits;
+
+  std::span<const Literal> signal_bits(const ir::Tig::Module &module,
+                                       ir::Tig::Module::EdgeRef signal) const {
+    const size_t i = module.output_offsets[signal.node_id] + signal.port_idx;
+    return {bits.data() + bit_offsets[i], bits.data() + bit_offsets[i + 1]};
+  }
+};
+
+/// Lower the kOp, kConvert, kSplit, kMerge and kConst nodes of `module_id` into
+/// `out.aig`, which should be empty. Supported ops are those the slang lowering
+/// emits: and, or, xor, xnor, not, add, sub, neg, mul, eq, ne and lt. Unknown
+/// (x, z) constant bits become 0.
+BitBlastResult bit_blast_module(const ir::Tig &design, ir::Tig::ModuleId module_id,
+                                BlastedModule &out);
+
+} // namespace abys::aig
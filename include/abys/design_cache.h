@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "abys/frontend.h"
+
+namespace abys {
+
+/// Elaborated sessions and lowered designs kept resident between commands, as
+/// `abys serve` does.
+///
+/// Entries are keyed by the absolute source paths, the top module and the
+/// frontend options that change the result. Each remembers the size and
+/// modification time of every file slang read for it; a lookup whose files
+/// changed reloads the entry from scratch, and `refresh()` does so ahead of the
+/// next lookup. Past `max_designs` entries, the least recently used is dropped.
+/// A cache is not thread-safe.
+class DesignCache {
+public:
+  struct Lookup {
+    bool ok = false;
+    std::string message;
+    /// The lowered design; null after `load`, or if lowering failed.
+    std::shared_ptr<const ir::Tig> design;
+    FrontendSession::BuildStats build_stats;
+    /// True if nothing was parsed or lowered to answer.
+    bool warm = false;
+  };
+
+  explicit DesignCache(size_t max_designs = 4);
+  ~DesignCache();
+  DesignCache(const DesignCache &) = delete;
+  DesignCache &operator=(const DesignCache &) = delete;
+
+  /// Parse and elaborate `files`, or reuse a current session for them.
+  Lookup load(const std::vector<std::string> &files, const std::optional<std::string> &top,
+              const FrontendOptions &options);
+
+  /// As `load`, then lower the design into a Tig, or reuse the current one.
+  Lookup build(const std::vector<std::string> &files, const std::optional<std::string> &top,
+               const FrontendOptions &options);
+
+  /// Reload every entry whose sources changed, lowering it again if it had
+  /// been lowered. Returns the number of entries reloaded.
+  size_t refresh();
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry;
+
+  Entry &entry(const std::vector<std::string> &files, const std::optional<std::string> &top,
+               const FrontendOptions &options, bool &warm);
+
+  size_t max_designs_;
+  // Least recently used first.
+  std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+} // namespace abys
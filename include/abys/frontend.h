@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -8,17 +10,87 @@
 
 namespace abys {
 
+struct FrontendOptions {
+  /// Threads slang uses to load and parse source files; 0 means one per
+  /// hardware thread. Parsing is only spread over threads for multi-file
+  /// inputs, and diagnostics are identical for every count.
+  unsigned parse_threads = 0;
+  /// Threads used to lower module bodies into the Tig; 0 means one per
+  /// hardware thread. The resulting design is identical for every count.
+  unsigned lowering_threads = 1;
+  /// When set, lowered modules are cached in this directory and reused by
+  /// later builds whose sources, parameters and dependencies are unchanged.
+  std::string cache_dir;
+  /// Share identical conversions, operators and constants while lowering.
+  bool hash_consing = false;
+};
+
 struct ParseResult {
   bool ok = false;
   std::string message;
 };
 
+/// One slang driver and elaborated compilation, shared by every query on the
+/// same sources.
+///
+/// `load` runs slang's option processing, parsing, elaboration and diagnostic
+/// reporting once; diagnostics, Tig construction and later queries are then
+/// served from that compilation without re-running slang.
+class FrontendSession {
+public:
+  explicit FrontendSession(FrontendOptions options = {});
+  ~FrontendSession();
+  FrontendSession(FrontendSession &&other) noexcept;
+  FrontendSession &operator=(FrontendSession &&other) noexcept;
+  FrontendSession(const FrontendSession &) = delete;
+  FrontendSession &operator=(const FrontendSession &) = delete;
+
+  /// Parse and elaborate `files`. A session can only be loaded once.
+  ParseResult load(const std::vector<std::string> &files, const std::optional<std::string> &top);
+
+  /// True once `load` has produced a compilation without errors.
+  bool ok() const;
+
+  size_t num_errors() const;
+  size_t num_warnings() const;
+
+  /// Names of the top-level modules of the elaborated design.
+  std::vector<std::string> top_modules() const;
+
+  /// Paths of every file slang read for this session, included files among
+  /// them.
+  std::vector<std::string> source_files() const;
+
+  struct BuildStats {
+    size_t modules = 0;
+    size_t cached_modules = 0;
+  };
+
+  /// Lower the elaborated design into a fresh Tig.
+  ir::TigBuildResult build_tig();
+
+  const BuildStats &last_build_stats() const { return build_stats_; }
+
+  const FrontendOptions &options() const { return options_; }
+
+  /// Threads used by the next `build_tig`; the design does not depend on it.
+  void set_lowering_threads(unsigned threads) { options_.lowering_threads = threads; }
+
+private:
+  struct Impl;
+  FrontendOptions options_;
+  BuildStats build_stats_;
+  std::unique_ptr<Impl> impl_;
+};
+
 /// Parse one or more SystemVerilog sources using slang.
 ParseResult parse_systemverilog(const std::vector<std::string> &files,
-                                const std::optional<std::string> &top);
+                                const std::optional<std::string> &top,
+                                const FrontendOptions &options = {});
 
 /// Build a TIG design from one or more SystemVerilog sources using slang.
 ir::TigBuildResult build_tig_from_systemverilog(const std::vector<std::string> &files,
-                                                const std::optional<std::string> &top);
+                                                const std::optional<std::string> &top,
+                                                const FrontendOptions &options = {});
 
 } // namespace abys
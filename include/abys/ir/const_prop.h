@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+struct ConstPropReport {
+  /// Conversion, split, merge and op nodes whose outputs became constants.
+  size_t folded_nodes = 0;
+  /// Const nodes created for their outputs.
+  size_t created_consts = 0;
+  /// Fanins moved from a folded node to its constant.
+  size_t rewired_inputs = 0;
+};
+
+/// Fold every conversion, split, merge and op node whose fanins are all
+/// constants into one const node per output, in topological order so that
+/// folds cascade.
+///
+/// Each new constant takes over the name of the output it replaces, and every
+/// consumer and signal_map entry of that output moves to it. Folded nodes stay
+/// in the module, nameless and without consumers, for sweep_dead_logic to
+/// drop. Values follow the simulator's resize and op semantics, with x and z
+/// bits carried through as evaluate_const_op describes. Modules are folded
+/// independently, on up to `num_threads` threads (0 for one per core);
+/// constants are not propagated through instances.
+ConstPropReport propagate_constants(Tig &design, unsigned num_threads = 1);
+
+} // namespace abys::ir
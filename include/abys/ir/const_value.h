@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace abys::ir {
+
+/// One four-state bit, as its (unknown, value) plane bits: 0 is (0, 0), 1 is
+/// (0, 1), x is (1, 0) and z is (1, 1).
+enum class Logic : uint8_t { k0 = 0, k1 = 1, kX = 2, kZ = 3 };
+
+/// Read-only four-state bit vector over packed 64-bit words, least significant
+/// bit first.
+///
+/// Bit `i` lives in bit `i % 64` of word `i / 64` of the value plane and, when
+/// there is one, of the unknown plane. A two-state value has no unknown plane.
+/// Bits past the width are zero in both planes, so views compare and hash by
+/// their words.
+class ConstView {
+public:
+  ConstView() = default;
+  ConstView(uint64_t width, const uint64_t *value, const uint64_t *unknown)
+      : width_(width), value_(value), unknown_(unknown) {}
+
+  static constexpr size_t words_for(uint64_t width) { return (width + 63) / 64; }
+
+  uint64_t width() const { return width_; }
+  size_t num_words() const { return words_for(width_); }
+
+  Logic bit(uint64_t i) const {
+    const uint64_t mask = uint64_t{1} << (i % 64);
+    const bool v = (value_[i / 64] & mask) != 0;
+    const bool u = unknown_ && (unknown_[i / 64] & mask) != 0;
+    return static_cast<Logic>((u ? 2 : 0) | (v ? 1 : 0));
+  }
+
+  std::span<const uint64_t> value_words() const { return {value_, num_words()}; }
+  /// Empty for a two-state value.
+  std::span<const uint64_t> unknown_words() const {
+    return unknown_ ? std::span<const uint64_t>(unknown_, num_words())
+                    : std::span<const uint64_t>();
+  }
+
+  /// True if any bit is x or z.
+  bool has_unknown() const;
+
+  /// The low 64 bits of the value plane.
+  uint64_t low_word() const { return width_ == 0 ? 0 : value_[0]; }
+
+  /// Digits 0, 1, x and z, most significant first.
+  std::string to_string() const;
+
+  uint64_t hash() const;
+
+  friend bool operator==(const ConstView &a, const ConstView &b);
+
+private:
+  uint64_t width_ = 0;
+  const uint64_t *value_ = nullptr;
+  const uint64_t *unknown_ = nullptr;
+};
+
+/// An owned four-state bit vector.
+///
+/// Values of up to 64 bits keep both planes inline; wider ones allocate one
+/// buffer holding the value words followed by the unknown words. Constants
+/// stored in a Tig live in their module's `const_words` arena instead, and are
+/// read back as ConstViews.
+class ConstValue {
+public:
+  ConstValue() = default;
+  explicit ConstValue(uint64_t width, Logic fill = Logic::k0);
+  explicit ConstValue(ConstView view);
+  ConstValue(const ConstValue &other);
+  ConstValue &operator=(const ConstValue &other);
+  ConstValue(ConstValue &&other) noexcept;
+  ConstValue &operator=(ConstValue &&other) noexcept;
+
+  /// The low `width` bits of `value`, zero-extended past 64 bits.
+  static ConstValue from_uint64(uint64_t width, uint64_t value);
+  /// Parse digits 0, 1, x and z (either case), most significant first; nothing
+  /// if any other character appears.
+  static std::optional<ConstValue> parse(std::string_view digits);
+
+  uint64_t width() const { return width_; }
+  size_t num_words() const { return ConstView::words_for(width_); }
+
+  ConstView view() const;
+  operator ConstView() const { return view(); }
+
+  Logic bit(uint64_t i) const { return view().bit(i); }
+  void set_bit(uint64_t i, Logic bit);
+
+  std::span<uint64_t> value_words() { return {words(), num_words()}; }
+  std::span<uint64_t> unknown_words() { return {words() + plane_stride(), num_words()}; }
+
+  /// Clear the bits past the width, after writing whole words.
+  void mask_top();
+
+private:
+  uint64_t *words() { return heap_ ? heap_.get() : inline_; }
+  const uint64_t *words() const { return heap_ ? heap_.get() : inline_; }
+  size_t plane_stride() const { return heap_ ? num_words() : 1; }
+
+  uint64_t width_ = 0;
+  // Value and unknown planes of values up to 64 bits.
+  uint64_t inline_[2] = {0, 0};
+  std::unique_ptr<uint64_t[]> heap_;
+};
+
+/// Bits `[lo, lo + width)` of `a`; bits past its width repeat its top bit when
+/// `sign` is set and are zero otherwise. With `lo` zero this is the resize the
+/// Tig applies to every operand.
+ConstValue const_bits(ConstView a, uint64_t lo, uint64_t width, bool sign);
+
+/// Evaluate a Tig op on constant operands, each resized to `width` by its own
+/// sign, as the simulator and the bit-blaster do. Comparisons work at the
+/// operands' common width, signed only if both are, and yield one bit. Bitwise
+/// ops follow Verilog's four-state tables; an unknown bit in any operand of an
+/// arithmetic op or comparison makes the whole result x. Nothing is returned
+/// for an unknown op or a unary op given two operands, or the reverse.
+std::optional<ConstValue> evaluate_const_op(std::string_view op, uint64_t width, ConstView a,
+                                            bool a_sign, const ConstView *b, bool b_sign);
+
+} // namespace abys::ir
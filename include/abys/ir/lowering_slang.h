@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <string>
@@ -12,14 +13,20 @@
 #include "slang/ast/ASTVisitor.h"
 #include "slang/ast/expressions/AssignmentExpressions.h"
 #include "slang/ast/expressions/ConversionExpression.h"
+#include "slang/ast/expressions/LiteralExpressions.h"
 #include "slang/ast/expressions/MiscExpressions.h"
+#include "slang/ast/expressions/OperatorExpressions.h"
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
 #include "slang/ast/symbols/InstanceSymbols.h"
+#include "slang/ast/symbols/MemberSymbols.h"
 #include "slang/ast/symbols/PortSymbols.h"
+#include "slang/ast/symbols/VariableSymbols.h"
 #include "slang/ast/types/Type.h"
 #include "slang/driver/Driver.h"
 
 #include "abys/ir/tig_builder.h"
+#include "abys/util/parallel.h"
+#include "abys/util/profile.h"
 
 namespace abys::ir {
 
@@ -35,8 +42,109 @@ namespace abys::ir {
       return "Unknown";
     }
   }
-  
-  
+
+  // Op names carried by kOp nodes. Returns nullptr for unsupported operators.
+  inline const char* binaryOperatorToOp(slang::ast::BinaryOperator op) {
+    switch (op) {
+    case slang::ast::BinaryOperator::Add:
+      return "add";
+    case slang::ast::BinaryOperator::Subtract:
+      return "sub";
+    case slang::ast::BinaryOperator::Multiply:
+      return "mul";
+    case slang::ast::BinaryOperator::BinaryAnd:
+      return "and";
+    case slang::ast::BinaryOperator::BinaryOr:
+      return "or";
+    case slang::ast::BinaryOperator::BinaryXor:
+      return "xor";
+    case slang::ast::BinaryOperator::BinaryXnor:
+      return "xnor";
+    case slang::ast::BinaryOperator::Equality:
+      return "eq";
+    case slang::ast::BinaryOperator::Inequality:
+      return "ne";
+    case slang::ast::BinaryOperator::LessThan:
+      return "lt";
+    default:
+      return nullptr;
+    }
+  }
+
+  inline const char* unaryOperatorToOp(slang::ast::UnaryOperator op) {
+    switch (op) {
+    case slang::ast::UnaryOperator::BitwiseNot:
+      return "not";
+    case slang::ast::UnaryOperator::Minus:
+      return "neg";
+    default:
+      return nullptr;
+    }
+  }
+
+  using SlangModuleIds =
+    std::unordered_map<const slang::ast::InstanceBodySymbol *, Tig::ModuleId>;
+
+  // Walks the elaborated hierarchy once and reserves a module for every
+  // distinct instance body, in the order the bodies are first reached. Also
+  // records, per body, the modules of its instances in member order.
+  template <typename Builder>
+    class SlangModuleCollector final
+    : public slang::ast::ASTVisitor<SlangModuleCollector<Builder>, false, false, false, true> {
+  private:
+
+    using ModuleId = typename Builder::ModuleId;
+
+    Builder &builder_;
+    SlangModuleIds module_ids_;
+    std::vector<std::pair<const slang::ast::InstanceBodySymbol *, ModuleId>> bodies_;
+    std::vector<std::vector<ModuleId>> children_;
+    std::vector<size_t> stack_;
+
+  public:
+    explicit SlangModuleCollector(Builder &builder) : builder_(builder) {}
+
+    const SlangModuleIds &module_ids() const { return module_ids_; }
+    const auto &bodies() const { return bodies_; }
+    // Indexed like bodies().
+    const std::vector<std::vector<ModuleId>> &children() const { return children_; }
+
+    void handle(const slang::ast::InstanceSymbol &symbol) {
+      this->visitDefault(symbol);
+      if (stack_.empty()) {
+	return;
+      }
+      const auto &body = symbol.getCanonicalBody() ? *symbol.getCanonicalBody() : symbol.body;
+      auto it = module_ids_.find(&body);
+      assert(it != module_ids_.end());
+      children_[stack_.back()].push_back(it->second);
+    }
+
+    void handle(const slang::ast::InstanceBodySymbol &symbol) {
+      const auto &definition = symbol.getDefinition();
+      if (definition.definitionKind != slang::ast::DefinitionKind::Module) {
+	throw std::logic_error(
+			       std::string("Unhandled definition kind: ")
+			       + definitionKindToString(definition.definitionKind)
+			       );
+      }
+
+      if(module_ids_.contains(&symbol)) {
+	return;
+      }
+
+      ModuleId module_id = builder_.create_module(definition.name);
+      module_ids_[&symbol] = module_id;
+      stack_.push_back(bodies_.size());
+      bodies_.emplace_back(&symbol, module_id);
+      children_.emplace_back();
+      this->visitDefault(symbol);
+      stack_.pop_back();
+    }
+  };
+
+  // Lowers the contents of one instance body. Instances refer to the module
+  // ids reserved by SlangModuleCollector and are not descended into.
   template <typename Builder>
     class SlangLoweringVisitor final
     : public slang::ast::ASTVisitor<SlangLoweringVisitor<Builder>, false, false, false, true> {
@@ -45,46 +153,91 @@ namespace abys::ir {
     using ModuleId = typename Builder::ModuleId;
     using NodeId = typename Builder::NodeId;
     using SignalWidth = typename Builder::SignalWidth;
+    using NameId = typename Builder::NameId;
     static constexpr ModuleId kInvalidModuleId = Builder::kInvalidModuleId;
     static constexpr NodeId kInvalidNodeId = Builder::kInvalidNodeId;
     using Signal = typename Builder::Signal;
     using SignalSpec = typename Builder::SignalSpec;
 
+    using PortIndex = typename Builder::PortIndex;
+
+    // An input left open until every signal of the module exists.
+    struct PendingInput {
+      NodeId node_id = kInvalidNodeId;
+      PortIndex port_idx = 0;
+      SignalSpec spec;
+    };
+
     struct ModuleContext {
-      ModuleId module_id;
-      std::unordered_map<NodeId, std::vector<SignalSpec>> node_inputs;
+      ModuleId module_id = kInvalidModuleId;
+      std::string_view name;
+      std::vector<PendingInput> pending;
+      // Indexed by NodeId: the port the next recorded input of the node fills.
+      std::vector<PortIndex> next_port;
     };
 
     Builder &builder_;
+    const SlangModuleIds &module_ids_;
 
-    std::vector<ModuleContext> module_stack_;
-    std::unordered_map<const slang::ast::InstanceBodySymbol *, ModuleId> module_ids_;
+    ModuleContext module_;
 
     ModuleId current_module_id() const {
-      if (module_stack_.empty()) {
-	return kInvalidModuleId;
-      }
-      return module_stack_.back().module_id;
+      return module_.module_id;
     }
 
-    void record_input(NodeId node_id, std::string name, SignalWidth width, bool sign) {
-      if (module_stack_.empty()) {
-	throw std::logic_error("module stack is empty");
+    // Inputs are recorded in port order once their node exists; anonymous ones
+    // are already connected and only advance the port.
+    void record_input(NodeId node_id, NameId name, SignalWidth width, bool sign) {
+      if (module_.module_id == kInvalidModuleId) {
+	throw std::logic_error("no module is being lowered");
+      }
+      if (node_id >= module_.next_port.size()) {
+	module_.next_port.resize(std::max<size_t>(node_id + 1, 2 * module_.next_port.size()));
+      }
+      const PortIndex port_idx = module_.next_port[node_id]++;
+      if (name != kEmptyName) {
+	module_.pending.push_back({node_id, port_idx, SignalSpec{name, width, sign}});
       }
-      module_stack_.back().node_inputs[node_id].emplace_back(name, width, sign);
     }
 
   public:
-    explicit SlangLoweringVisitor(Builder &builder) : builder_(builder) {}
+    SlangLoweringVisitor(Builder &builder, const SlangModuleIds &module_ids)
+      : builder_(builder), module_ids_(module_ids) {}
+
+    void lower_body(const slang::ast::InstanceBodySymbol &symbol, ModuleId module_id) {
+      visit_body(symbol, module_id);
+      wire_body();
+    }
+
+    // The two halves of lower_body, for callers that profile them separately:
+    // visiting creates the nodes of the body, wiring resolves named inputs.
+    void visit_body(const slang::ast::InstanceBodySymbol &symbol, ModuleId module_id) {
+      util::ScopedTimer timer("visit", symbol.getDefinition().name);
+      module_ = {module_id, symbol.getDefinition().name, {}, {}};
+      this->visitDefault(symbol);
+    }
+
+    void wire_body() {
+      util::ScopedTimer timer("wire", module_.name);
+      wire_connections();
+      if (builder_.hash_consing()) {
+	builder_.merge_equivalent_nodes(module_.module_id);
+      }
+      module_ = {};
+    }
 
   private:
-    std::string extract_named_value(const slang::ast::Expression &expr) {
-      assert(expr.kind == slang::ast::ExpressionKind::NamedValue);
+    // Assignment targets and output connections must be whole signals; parts
+    // and concatenations of signals are valid SystemVerilog but not lowered.
+    NameId extract_named_value(const slang::ast::Expression &expr) {
+      if (expr.kind != slang::ast::ExpressionKind::NamedValue) {
+	throw std::logic_error("Only whole signals can be assigned or connected to outputs");
+      }
       const auto &named = expr.as<slang::ast::NamedValueExpression>();
-      return std::string(named.symbol.name);
+      return builder_.intern(named.symbol.name);
     }
 
-    std::string extract_output_named_value(const slang::ast::Expression &expr) {
+    NameId extract_output_named_value(const slang::ast::Expression &expr) {
       assert(expr.kind == slang::ast::ExpressionKind::Assignment);
       const auto &assign = expr.as<slang::ast::AssignmentExpression>();
       assert(assign.right().kind == slang::ast::ExpressionKind::EmptyArgument);
@@ -107,43 +260,145 @@ namespace abys::ir {
       return expr.type->isSigned();
     }
 
+    // Named values are resolved in wire_connections once every signal of the
+    // module exists; any other expression is lowered to an anonymous node.
+    // When hash-consing, names already driven are connected at once, so that
+    // the node reading them can be shared as it is created.
     void prepare_input(const slang::ast::Expression &expr, std::vector<Signal> &node_inputs,
                        std::vector<SignalSpec> &node_input_specs) {
-      if (expr.kind == slang::ast::ExpressionKind::Conversion) {
-	NodeId node_id = builder_.create_conversion_node(
-            current_module_id(), "", expr_width(expr), expr_sign(expr), kInvalidNodeId);
-	const auto &conv = expr.as<slang::ast::ConversionExpression>();
-	const std::string name = extract_named_value(conv.operand());
-	const uint64_t width = conv.operand().type->getBitstreamWidth();
-	const bool sign = conv.operand().type->isSigned();
-	record_input(node_id, name, width, sign);
-	node_inputs.emplace_back(node_id, 0);
-	node_input_specs.emplace_back("", 0, false);
-      } else {
+      if (expr.kind == slang::ast::ExpressionKind::NamedValue) {
+	const NameId name = extract_named_value(expr);
+	if (builder_.hash_consing()) {
+	  const Signal input = builder_.find_signal(current_module_id(), name);
+	  if (input.node_id != kInvalidNodeId) {
+	    const auto spec = builder_.get_signal_spec(current_module_id(), input);
+	    if (spec.width == expr_width(expr) && spec.sign == expr_sign(expr)) {
+	      node_inputs.push_back(input);
+	      node_input_specs.emplace_back(kEmptyName, 0, false);
+	      return;
+	    }
+	  }
+	}
 	node_inputs.emplace_back(kInvalidNodeId, 0);
-	node_input_specs.emplace_back(extract_named_value(expr), expr_width(expr), expr_sign(expr));
+	node_input_specs.emplace_back(name, expr_width(expr), expr_sign(expr));
+      } else {
+	node_inputs.emplace_back(lower_expression(expr, kEmptyName), 0);
+	node_input_specs.emplace_back(kEmptyName, 0, false);
+      }
+    }
+
+    static Logic to_logic(slang::logic_t bit) {
+      if (bit.value == slang::logic_t::Z_VALUE) {
+	return Logic::kZ;
+      }
+      if (bit.isUnknown()) {
+	return Logic::kX;
+      }
+      return bit.value ? Logic::k1 : Logic::k0;
+    }
+
+    // Literals become const nodes as wide as their type; an unbased unsized
+    // literal ('0, '1, 'x, 'z) fills every bit.
+    NodeId lower_literal(const slang::ast::Expression &expr, NameId name) {
+      const SignalWidth width = expr_width(expr);
+      ConstValue value(width);
+      if (expr.kind == slang::ast::ExpressionKind::IntegerLiteral) {
+	const slang::SVInt &literal = expr.as<slang::ast::IntegerLiteral>().getValue();
+	const SignalWidth bits = std::min<SignalWidth>(width, literal.getBitWidth());
+	for (SignalWidth i = 0; i < bits; i++) {
+	  value.set_bit(i, to_logic(literal[static_cast<int32_t>(i)]));
+	}
+      } else {
+	const Logic fill =
+	    to_logic(expr.as<slang::ast::UnbasedUnsizedIntegerLiteral>().getLiteralValue());
+	value = ConstValue(width, fill);
+      }
+      return builder_.create_const_node(current_module_id(), name, width, expr_sign(expr),
+                                        value.view());
+    }
+
+    NodeId lower_expression(const slang::ast::Expression &expr, NameId name) {
+      std::vector<Signal> node_inputs;
+      std::vector<SignalSpec> node_input_specs;
+      NodeId node_id = kInvalidNodeId;
+      if (expr.kind == slang::ast::ExpressionKind::Conversion ||
+          expr.kind == slang::ast::ExpressionKind::NamedValue) {
+	// A named value on its own becomes a same-width conversion, i.e. a buffer.
+	const auto &operand = expr.kind == slang::ast::ExpressionKind::Conversion
+                                  ? expr.as<slang::ast::ConversionExpression>().operand()
+                                  : expr;
+	prepare_input(operand, node_inputs, node_input_specs);
+	node_id = builder_.create_conversion_node(current_module_id(), name, expr_width(expr),
+                                                  expr_sign(expr), node_inputs[0].node_id,
+                                                  node_inputs[0].port_idx);
+      } else if (expr.kind == slang::ast::ExpressionKind::BinaryOp) {
+	const auto &binary = expr.as<slang::ast::BinaryExpression>();
+	const char *op = binaryOperatorToOp(binary.op);
+	if (!op) {
+	  throw std::logic_error("Unhandled binary operator");
+	}
+	prepare_input(binary.left(), node_inputs, node_input_specs);
+	prepare_input(binary.right(), node_inputs, node_input_specs);
+	node_id = builder_.create_op_node(current_module_id(), name, builder_.intern(op),
+                                          expr_width(expr), expr_sign(expr), node_inputs);
+      } else if (expr.kind == slang::ast::ExpressionKind::UnaryOp) {
+	const auto &unary = expr.as<slang::ast::UnaryExpression>();
+	const char *op = unaryOperatorToOp(unary.op);
+	if (!op) {
+	  throw std::logic_error("Unhandled unary operator");
+	}
+	prepare_input(unary.operand(), node_inputs, node_input_specs);
+	node_id = builder_.create_op_node(current_module_id(), name, builder_.intern(op),
+                                          expr_width(expr), expr_sign(expr), node_inputs);
+      } else if (expr.kind == slang::ast::ExpressionKind::IntegerLiteral ||
+                 expr.kind == slang::ast::ExpressionKind::UnbasedUnsizedIntegerLiteral) {
+	node_id = lower_literal(expr, name);
+      } else {
+	throw std::logic_error("Unhandled expression kind");
+      }
+      for (const auto &spec : node_input_specs) {
+	record_input(node_id, spec.name, spec.width, spec.sign);
       }
+      return node_id;
     }
 
+    // Resolves every pending input against one index of the module's signals.
+    // All unresolved or mismatched names are reported together.
     void wire_connections() {
-      ModuleId module_id = current_module_id();
-      for (const auto &entry : module_stack_.back().node_inputs) {
-	const NodeId node_id = entry.first;
-	for (size_t i = 0; i < entry.second.size(); i++) {
-	  const std::string &name = entry.second[i].name;
-	  if (!name.empty()) {
-	    Signal input = builder_.find_signal(module_id, name);
-            assert(input.node_id != kInvalidNodeId);
-            const auto spec = builder_.get_signal_spec(module_id, input);
-            assert(entry.second[i].width == spec.width);
-            assert(entry.second[i].sign == spec.sign);
-	    builder_.set_node_input(module_id, node_id, i, input);
-	  } else {
-	    Signal input = builder_.get_node_input(module_id, node_id, i);
-	    assert(input.node_id != kInvalidNodeId);
-	  }
+      const ModuleId module_id = current_module_id();
+      const SignalIndex index = builder_.index_signals(module_id);
+      std::vector<std::string> errors;
+      for (const auto &pending : module_.pending) {
+	const NameId name = pending.spec.name;
+	const Signal input = index.find(name);
+	if (input.node_id == kInvalidNodeId) {
+	  errors.push_back("'" + std::string(builder_.name(name)) + "' is not driven");
+	  continue;
+	}
+	const auto spec = builder_.get_signal_spec(module_id, input);
+	if (spec.width != pending.spec.width || spec.sign != pending.spec.sign) {
+	  errors.push_back("'" + std::string(builder_.name(name)) + "' has a mismatched type");
+	  continue;
 	}
+	builder_.set_node_input(module_id, pending.node_id, pending.port_idx, input);
+      }
+      util::count("names resolved", static_cast<int64_t>(module_.pending.size() - errors.size()));
+      if (!errors.empty()) {
+	report_unresolved(errors);
+      }
+    }
+
+    [[noreturn]] void report_unresolved(const std::vector<std::string> &errors) {
+      static constexpr size_t kMaxReported = 10;
+      std::string message = std::to_string(errors.size()) + " unresolved input(s) in module " +
+                            std::string(module_.name) + ":";
+      for (size_t i = 0; i < std::min(errors.size(), kMaxReported); i++) {
+	message += " " + errors[i] + (i + 1 < errors.size() ? ";" : "");
       }
+      if (errors.size() > kMaxReported) {
+	message += " ...";
+      }
+      throw std::logic_error(message);
     }
 
   public:
@@ -155,30 +410,26 @@ namespace abys::ir {
 			     );
     }
     
-    void handle(const slang::ast::RootSymbol &symbol) {
-      this->visitDefault(symbol);
-    }
-    
-    void handle(const slang::ast::InstanceBodySymbol &symbol) {
-      const auto &definition = symbol.getDefinition();
-      if (definition.definitionKind != slang::ast::DefinitionKind::Module) {
-	throw std::logic_error(
-			       std::string("Unhandled definition kind: ")
-			       + definitionKindToString(definition.definitionKind)
-			       );
+    // Declarations carry no logic; their drivers are ports, instance outputs
+    // and continuous assignments. A variable initializer only sets the value
+    // at time zero, so it drives nothing either and is refused like a net's.
+    void handle(const slang::ast::VariableSymbol &symbol) {
+      if (symbol.getInitializer()) {
+	throw std::logic_error("Variable initializers are not supported");
       }
-      
-      if(module_ids_.contains(&symbol)) {
-	return;
+    }
+
+    void handle(const slang::ast::NetSymbol &symbol) {
+      if (symbol.getInitializer()) {
+	throw std::logic_error("Net initializers are not supported");
       }
-      
-      ModuleId module_id = builder_.create_module(std::string(definition.name));
-      module_ids_[&symbol] = module_id;
+    }
 
-      module_stack_.push_back({module_id, {}});
-      this->visitDefault(symbol);
-      wire_connections();
-      module_stack_.pop_back();
+    void handle(const slang::ast::ContinuousAssignSymbol &symbol) {
+      const auto &expr = symbol.getAssignment();
+      assert(expr.kind == slang::ast::ExpressionKind::Assignment);
+      const auto &assign = expr.as<slang::ast::AssignmentExpression>();
+      lower_expression(assign.right(), extract_named_value(assign.left()));
     }
 
     void handle(const slang::ast::PortSymbol &symbol) {
@@ -190,22 +441,22 @@ namespace abys::ir {
         throw std::logic_error("Ref ports are not supported");
       }
       if(symbol.direction == slang::ast::ArgumentDirection::In) {
-	NodeId node_id = builder_.create_module_input(current_module_id(), std::string(symbol.name),
+	const NameId name = builder_.intern(symbol.name);
+	NodeId node_id = builder_.create_module_input(current_module_id(), name,
                                                      port_width(symbol), port_sign(symbol));
         (void)node_id;
       } else if(symbol.direction == slang::ast::ArgumentDirection::Out) {
-	NodeId node_id = builder_.create_module_output(current_module_id(), std::string(symbol.name),
+	const NameId name = builder_.intern(symbol.name);
+	NodeId node_id = builder_.create_module_output(current_module_id(), name,
                                                       port_width(symbol), port_sign(symbol),
                                                       kInvalidNodeId);
-	record_input(node_id, std::string(symbol.name), port_width(symbol), port_sign(symbol));
+	record_input(node_id, name, port_width(symbol), port_sign(symbol));
       } else {
 	throw std::logic_error("Unknown port direction");
       }
     }
 
     void handle(const slang::ast::InstanceSymbol &symbol) {
-      this->visitDefault(symbol);
-
       const auto &body = symbol.getCanonicalBody() ? *symbol.getCanonicalBody() : symbol.body;
       auto it = module_ids_.find(&body);
       assert(it != module_ids_.end());
@@ -233,21 +484,63 @@ namespace abys::ir {
 	}
       }
 
-      if(current_module_id() != kInvalidModuleId) {
-	NodeId instance_id = builder_.create_instance(current_module_id(), std::string(symbol.name),
-                                                      instance_module_id, node_inputs,
-                                                      node_outputs);
-	for(auto &spec: node_input_specs) {
-	  record_input(instance_id, spec.name, spec.width, spec.sign);
-	}
+      const NameId name = builder_.intern(symbol.name);
+      NodeId instance_id = builder_.create_instance(current_module_id(), name,
+                                                    instance_module_id, node_inputs,
+                                                    node_outputs);
+      for(auto &spec: node_input_specs) {
+	record_input(instance_id, spec.name, spec.width, spec.sign);
       }
     }
   };
   
   
+  // Lower one instance body into module 0 of the empty design `local`.
   template <typename Builder>
-    void lower_slang_ast_to_ir(const slang::ast::RootSymbol &root, Builder &builder) {
-    SlangLoweringVisitor<Builder> visitor(builder);
-    root.visit(visitor);
+    void lower_slang_body(const slang::ast::InstanceBodySymbol &body,
+                          const SlangModuleIds &module_ids,
+                          typename Builder::Design &local, bool hash_consing = false) {
+    Builder builder(local);
+    builder.set_hash_consing(hash_consing);
+    const auto local_id = builder.create_module(body.getDefinition().name);
+    SlangLoweringVisitor<Builder> visitor(builder, module_ids);
+    visitor.lower_body(body, local_id);
+    if (hash_consing) {
+      util::count("hash-cons lookups", static_cast<int64_t>(builder.hash_cons_stats().lookups));
+      util::count("hash-cons hits", static_cast<int64_t>(builder.hash_cons_stats().hits));
+    }
+  }
+
+  // Module ids are reserved in one serial walk of the hierarchy. Each body is
+  // then lowered into a design of its own, on `num_threads` threads (0 picks
+  // the hardware concurrency), and the results are adopted in module id order.
+  // The output therefore does not depend on the thread count. Bodies are
+  // hash-consed if `builder` is.
+  //
+  // Lowering only reads the AST; it relies on the compilation having been
+  // fully elaborated (e.g. by reporting its diagnostics) beforehand.
+  template <typename Builder>
+    void lower_slang_ast_to_ir(const slang::ast::RootSymbol &root, Builder &builder,
+                               unsigned num_threads = 1) {
+    SlangModuleCollector<Builder> collector(builder);
+    {
+      util::ScopedTimer timer("phase", "collect modules");
+      root.visit(collector);
+    }
+
+    const auto &bodies = collector.bodies();
+    std::vector<typename Builder::Design> locals(bodies.size());
+    {
+      util::ScopedTimer timer("phase", "lower modules");
+      util::parallel_for(bodies.size(), num_threads, [&](size_t i) {
+	lower_slang_body<Builder>(*bodies[i].first, collector.module_ids(), locals[i],
+                                  builder.hash_consing());
+      });
+    }
+
+    util::ScopedTimer timer("phase", "adopt modules");
+    for (size_t i = 0; i < bodies.size(); i++) {
+      builder.adopt_module(bodies[i].second, std::move(locals[i]));
+    }
   }
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+/// On-disk store of lowered modules, keyed by a hash of everything their
+/// lowering depends on.
+///
+/// An entry is a Tig snapshot whose module 0 is the lowered module. Modules
+/// 1..n are empty stubs named after the keys of the modules it instantiates,
+/// and instances point at those stubs, so an entry can be spliced into a
+/// design whose module ids differ from the one it was produced in.
+class ModuleCache {
+public:
+  using ModuleId = Tig::ModuleId;
+
+  explicit ModuleCache(std::string dir);
+
+  /// Load the entry for `key` into `local`, resolving the stubs through
+  /// `module_ids`. Returns false if there is no usable entry.
+  bool load(uint64_t key, const std::unordered_map<uint64_t, ModuleId> &module_ids,
+            Tig &local) const;
+
+  /// Store module 0 of `local`, whose instances refer to modules by their id
+  /// in the full design; `keys` gives the key of each of those modules.
+  void store(uint64_t key, const Tig &local,
+             const std::unordered_map<ModuleId, uint64_t> &keys) const;
+
+private:
+  std::string path_of(uint64_t key) const;
+
+  std::string dir_;
+};
+
+} // namespace abys::ir
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+struct ModuleDedupReport {
+  size_t modules_before = 0;
+  size_t modules_after = 0;
+  /// Heap bytes held by the modules that were dropped.
+  size_t bytes_saved = 0;
+  /// New id of every module, indexed by its id before deduplication.
+  std::vector<Tig::ModuleId> remap;
+};
+
+/// Merge modules that are structurally identical and retarget instances.
+///
+/// Two modules are identical when they have the same name, ports, node
+/// kinds, widths, signs, edges, ops, constants, segments and blocks, and their
+/// instances refer to identical modules. Internal signal and instance names
+/// are not compared; the first module of each class keeps its own. Modules are
+/// compared bottom-up, so parents of merged children can merge in turn. The
+/// surviving modules keep their relative order.
+ModuleDedupReport dedup_modules(Tig &design);
+
+/// Heap bytes held by `module`'s arrays and maps, counting capacity; the total
+/// of module_memory().
+size_t module_heap_bytes(const Tig::Module &module);
+
+} // namespace abys::ir
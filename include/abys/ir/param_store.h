@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abys/ir/const_value.h"
+#include "abys/ir/symbol_table.h"
+
+namespace abys::ir {
+
+using ParamSetId = uint32_t;
+static constexpr ParamSetId kEmptyParamSet = 0;
+static constexpr ParamSetId kInvalidParamSet = std::numeric_limits<ParamSetId>::max();
+
+/// What a parameter or attribute value holds.
+enum class ParamKind : uint8_t {
+  kInt,    // a signed 64-bit integer
+  kReal,   // a double
+  kString, // a string literal's contents, as a NameId
+  kBits,   // a sized four-state vector, interned in the store
+  kText,   // any other expression, verbatim, as a NameId
+};
+
+/// One entry of a parameter set: a key and a typed value in 16 bytes.
+struct Param {
+  NameId key = kEmptyName;
+  ParamKind kind = ParamKind::kInt;
+  uint8_t reserved[3] = {};
+  // The integer, the bits of the double, a NameId, or for kBits the id the
+  // store gave the vector.
+  uint64_t payload = 0;
+
+  static Param integer(NameId key, int64_t value);
+  static Param real(NameId key, double value);
+  static Param string(NameId key, NameId value);
+  static Param text(NameId key, NameId value);
+
+  int64_t as_int() const { return static_cast<int64_t>(payload); }
+  double as_real() const;
+  NameId as_name() const { return static_cast<NameId>(payload); }
+
+  friend bool operator==(const Param &, const Param &) = default;
+};
+
+/// Interns parameter and attribute sets into dense 32-bit handles.
+///
+/// A set is an immutable array of Params sorted by key, stored once however
+/// many blocks refer to it, so equal sets have equal handles. Bit vectors are
+/// interned too, which makes a Param's bytes its value. Handle 0 is always the
+/// empty set. Views returned by `view()` are invalidated by the next `intern()`
+/// of a new set.
+class ParamStore {
+public:
+  ParamStore();
+
+  /// Intern the set holding `params`, in any order. For a key given more than
+  /// once, the last value wins.
+  ParamSetId intern(std::span<const Param> params);
+
+  std::span<const Param> view(ParamSetId id) const {
+    return {params_.data() + offsets_[id], params_.data() + offsets_[id + 1]};
+  }
+
+  /// Return the entry for `key` in set `id`, or nullptr.
+  const Param *find(ParamSetId id, NameId key) const;
+
+  ParamSetId size() const { return static_cast<ParamSetId>(offsets_.size() - 1); }
+
+  /// A kBits param holding `value`.
+  Param bits(NameId key, ConstView value);
+  /// The vector held by a kBits param.
+  ConstView bits_value(const Param &param) const;
+
+  /// A param from Verilog source text: integers, reals, string literals
+  /// without escapes and sized binary or hex literals are typed; anything else
+  /// is kept as kText.
+  Param parse(SymbolTable &names, NameId key, std::string_view text);
+
+  /// The value of `param` as Verilog source text.
+  std::string to_verilog(const SymbolTable &names, const Param &param) const;
+
+  /// Intern set `id` of `other` here, translating its names through `names`,
+  /// indexed by `other`'s handles.
+  ParamSetId import(const ParamStore &other, ParamSetId id, std::span<const NameId> names);
+  /// As above, translating each name with `translate`.
+  ParamSetId import(const ParamStore &other, ParamSetId id,
+                    const std::function<NameId(NameId)> &translate);
+
+  /// Heap bytes held by the store, counting capacity.
+  uint64_t heap_bytes() const;
+
+  // Raw storage, for serialization. `assign` takes back what these return and
+  // rebuilds the lookup tables; the caller checks the arrays are consistent.
+  // Each interned vector is a header word, its width times two plus one if it
+  // has an unknown plane, then its planes.
+  std::span<const Param> params() const { return params_; }
+  std::span<const uint32_t> offsets() const { return offsets_; }
+  std::span<const uint64_t> words() const { return words_; }
+  std::span<const uint64_t> bits_offsets() const { return bits_offsets_; }
+  void assign(std::span<const Param> params, std::span<const uint32_t> offsets,
+              std::span<const uint64_t> words, std::span<const uint64_t> bits_offsets);
+
+private:
+  uint64_t intern_bits(ConstView value);
+  ConstView bits_view(uint64_t bits_id) const;
+  void grow_sets();
+  void grow_bits();
+
+  std::vector<Param> params_;
+  std::vector<uint32_t> offsets_;
+  std::vector<ParamSetId> set_slots_;
+  std::vector<uint64_t> words_;
+  std::vector<uint64_t> bits_offsets_;
+  std::vector<uint32_t> bits_slots_;
+};
+
+} // namespace abys::ir
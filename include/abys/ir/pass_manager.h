@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+/// The module hierarchy as a DAG, derived from the module ids of instance
+/// nodes.
+///
+/// Instance edges that would close a cycle are left out, found by a
+/// depth-first walk from every module in id order, so the graph is acyclic
+/// even for a design that instantiates itself.
+struct ModuleDag {
+  /// Distinct modules each module instantiates, by id, with the number of
+  /// instances of each.
+  std::vector<std::vector<std::pair<Tig::ModuleId, uint64_t>>> children;
+  /// Distinct modules instantiating each module, by id.
+  std::vector<std::vector<Tig::ModuleId>> parents;
+  /// Modules no instance refers to, cyclic edges included.
+  std::vector<Tig::ModuleId> tops;
+  /// Every module after all of its children.
+  std::vector<Tig::ModuleId> bottom_up;
+  /// Instance edges dropped to break cycles.
+  size_t cyclic_edges = 0;
+
+  static ModuleDag build(const Tig &design);
+};
+
+/// When a module pass may run on a module relative to the modules around it.
+enum class PassOrder : uint8_t {
+  kAny,      // modules are independent
+  kBottomUp, // after every module it instantiates
+  kTopDown,  // after every module instantiating it
+};
+
+/// A step that runs once per module.
+///
+/// `run` captures whatever it works on. It may read anything its order
+/// guarantees is finished and must only write to the module it is given, or
+/// to per-module state it owns; it must not add, remove or retarget instances
+/// or rename modules. A pass that throws stops the run.
+struct ModulePass {
+  std::string name;
+  PassOrder order = PassOrder::kAny;
+  std::function<void(Tig::ModuleId module_id)> run;
+};
+
+struct PassTiming {
+  std::string name;
+  std::chrono::nanoseconds wall{0};
+  /// Time spent in `run`, indexed by module id.
+  std::vector<std::chrono::nanoseconds> modules;
+};
+
+struct PassRunResult {
+  bool ok = false;
+  std::string message;
+  /// One entry per pass that ran, in order.
+  std::vector<PassTiming> timings;
+};
+
+struct PassManagerOptions {
+  /// Threads to run modules on; 0 means one per core.
+  unsigned num_threads = 1;
+};
+
+/// Runs module passes over a whole design, one pass after another.
+///
+/// Within a pass, modules become ready once the modules their order waits for
+/// are done, and ready modules run concurrently on a work-stealing pool: each
+/// worker keeps its own queue, runs what it made ready itself first, and
+/// steals the oldest ready module of another worker when its queue runs dry.
+/// Each module's run is also recorded as a profiler scope named after the
+/// module, under the pass name.
+class PassManager {
+public:
+  explicit PassManager(PassManagerOptions options = {}) : options_(options) {}
+
+  PassManager &add(ModulePass pass) {
+    passes_.push_back(std::move(pass));
+    return *this;
+  }
+
+  /// Run every pass over the modules of `design`. The hierarchy is derived
+  /// once, up front.
+  PassRunResult run(const Tig &design) const;
+
+private:
+  PassManagerOptions options_;
+  std::vector<ModulePass> passes_;
+};
+
+} // namespace abys::ir
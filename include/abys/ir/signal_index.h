@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+/// Read-only map from a module's signal names to the edges driving them.
+///
+/// Built once from a module's signal_map and then queried in bulk: keys and
+/// values sit in two flat open-addressing arrays at most half full, so a lookup
+/// is a multiply and, typically, one or two probes within a cache line.
+class SignalIndex {
+public:
+  using NameId = Tig::NameId;
+  using EdgeRef = Tig::Module::EdgeRef;
+
+  SignalIndex() = default;
+
+  explicit SignalIndex(const Tig::Module &module) {
+    const size_t capacity = std::bit_ceil(std::max<size_t>(2 * module.signal_map.size(), 16));
+    keys_.assign(capacity, kInvalidName);
+    edges_.resize(capacity);
+    mask_ = capacity - 1;
+    for (const auto &[name, edge] : module.signal_map) {
+      size_t slot = slot_of(name);
+      while (keys_[slot] != kInvalidName) {
+        slot = (slot + 1) & mask_;
+      }
+      keys_[slot] = name;
+      edges_[slot] = edge;
+    }
+  }
+
+  /// Return the edge driven under `name`, or an invalid edge if there is none.
+  EdgeRef find(NameId name) const {
+    if (keys_.empty()) {
+      return {};
+    }
+    for (size_t slot = slot_of(name);; slot = (slot + 1) & mask_) {
+      if (keys_[slot] == name) {
+        return edges_[slot];
+      }
+      if (keys_[slot] == kInvalidName) {
+        return {};
+      }
+    }
+  }
+
+private:
+  size_t slot_of(NameId name) const {
+    // Fibonacci hashing; names are small consecutive integers.
+    return static_cast<size_t>((uint64_t{name} * 0x9e3779b97f4a7c15ULL) >> 32) & mask_;
+  }
+
+  std::vector<NameId> keys_;
+  std::vector<EdgeRef> edges_;
+  size_t mask_ = 0;
+};
+
+} // namespace abys::ir
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+struct SweepOptions {
+  /// Modules whose outputs are all kept. Empty means the roots of the
+  /// ModuleDag: the modules no instance refers to, and in a cyclic hierarchy
+  /// the modules the depth-first walk entered it by.
+  std::vector<Tig::ModuleId> roots;
+  /// Threads to compact modules on; 0 means one per core.
+  unsigned num_threads = 1;
+};
+
+struct SweepReport {
+  size_t nodes_before = 0;
+  size_t nodes_after = 0;
+  size_t modules_before = 0;
+  size_t modules_after = 0;
+  /// Fanins of kept nodes whose drivers were dropped, now tied to x.
+  size_t tied_inputs = 0;
+  /// New id of every module, indexed by its id before the sweep, or
+  /// kInvalidModuleId if it was dropped.
+  std::vector<Tig::ModuleId> remap;
+};
+
+/// Drop every node outside the cone of influence of the root modules' outputs
+/// and of the design's blocks, and every module no kept instance refers to.
+///
+/// Liveness is followed through the hierarchy port by port: an instance output
+/// keeps only the child logic behind that output port, and a child input port
+/// keeps the instance's driver only if the child reads it. Every block and kRi
+/// node is kept, and so is any instance whose module holds blocks. Marking runs
+/// on one thread over dense per-module bitsets with a worklist; kept nodes are
+/// then compacted, in order, module by module on up to `num_threads` threads.
+/// Modules keep their ports and kPi and kPo nodes; outputs no parent reads, and
+/// instance inputs the child does not read, are tied to an all-x constant, one
+/// per width and module, so the result still simulates. Surviving modules keep
+/// their relative order.
+SweepReport sweep_dead_logic(Tig &design, const SweepOptions &options = {});
+
+struct ConeResult {
+  bool ok = false;
+  std::string message;
+  /// The cone, with `top` holding only the chosen output and the inputs it
+  /// depends on, and every module below it only the ports the cone uses.
+  Tig design;
+  Tig::ModuleId top = Tig::kInvalidModuleId;
+};
+
+/// Copy the cone of influence of output port `output_port` of `module_id`,
+/// through instances and blocks, into a design of its own.
+///
+/// Marks are kept only for nodes the cone reaches, so past one scan of the node
+/// kinds of each module the cone enters, the cost grows with the cone and not
+/// with the design. Names and parameter sets are carried over as far as the
+/// cone uses them.
+ConeResult extract_cone(const Tig &design, Tig::ModuleId module_id, Tig::PortIndex output_port);
+
+} // namespace abys::ir
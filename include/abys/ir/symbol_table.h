@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace abys::ir {
+
+using NameId = uint32_t;
+static constexpr NameId kEmptyName = 0;
+static constexpr NameId kInvalidName = std::numeric_limits<NameId>::max();
+
+/// Interns strings into dense 32-bit handles.
+///
+/// Characters are kept in one contiguous buffer and looked up through an
+/// open-addressing table, so interning an existing name and resolving a handle
+/// never allocate. Handle 0 is always the empty string. Views returned by
+/// `view()` are invalidated by the next `intern()` of a new name.
+class SymbolTable {
+public:
+  SymbolTable();
+
+  NameId intern(std::string_view name);
+
+  /// Return the handle of `name`, or kInvalidName if it was never interned.
+  NameId find(std::string_view name) const;
+
+  std::string_view view(NameId id) const {
+    return {chars_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]};
+  }
+
+  NameId size() const { return static_cast<NameId>(offsets_.size() - 1); }
+
+  static uint64_t hash(std::string_view name);
+
+  /// Heap bytes held by the table, counting capacity.
+  uint64_t heap_bytes() const {
+    return chars_.capacity() + 1 + offsets_.capacity() * sizeof(uint32_t) +
+           slots_.capacity() * sizeof(NameId);
+  }
+
+  // Raw storage, for serialization. `assign` takes back exactly what these
+  // return and trusts it to be consistent.
+  std::string_view chars() const { return chars_; }
+  std::span<const uint32_t> offsets() const { return offsets_; }
+  std::span<const NameId> slots() const { return slots_; }
+  void assign(std::string_view chars, std::span<const uint32_t> offsets,
+              std::span<const NameId> slots);
+
+  /// `find` over raw storage, e.g. a memory-mapped copy of the arrays above.
+  static NameId find(std::string_view chars, std::span<const uint32_t> offsets,
+                     std::span<const NameId> slots, std::string_view name);
+
+private:
+  void grow();
+
+  std::string chars_;
+  std::vector<uint32_t> offsets_;
+  std::vector<NameId> slots_;
+};
+
+} // namespace abys::ir
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "abys/ir/const_value.h"
+#include "abys/ir/param_store.h"
+#include "abys/ir/symbol_table.h"
+
 namespace abys::ir {
 
   struct Tig {
@@ -14,13 +22,14 @@ namespace abys::ir {
     using PortIndex = uint32_t;
     using ModuleId = uint32_t;
     using SignalWidth = uint64_t;
+    using NameId = ir::NameId;
     static constexpr NodeId kInvalidNodeId = std::numeric_limits<NodeId>::max();
     static constexpr ModuleId kInvalidModuleId = std::numeric_limits<ModuleId>::max();
     
     struct Module {
       
       struct Port {
-	std::string name;
+	NameId name = kEmptyName;
 	SignalWidth width = 0;
 	bool sign = false;
       };
@@ -30,7 +39,7 @@ namespace abys::ir {
 	PortIndex port_idx = 0;
       };
       
-      enum class NodeKind {
+      enum class NodeKind : uint8_t {
 	kInstance,
 	kPi,
 	kPo,
@@ -43,22 +52,28 @@ namespace abys::ir {
 	kOp,
 	kUnknown,
       };
-      
-      struct Node {
-	NodeKind kind = NodeKind::kUnknown;
-	std::string name; // instance name
+
+      struct Output {
+	NameId name = kEmptyName;
+	SignalWidth width = 0;
+	bool sign = false;
+      };
+
+      // Fields that only instance, op, const and split/merge nodes carry. They
+      // live out of line so that the common node costs no more than its kind,
+      // its offsets and its edges.
+      struct NodeAttrs {
+	NameId name = kEmptyName; // instance name
 	ModuleId module_id = kInvalidModuleId;
-	std::string op;
-	std::string const_value;
-	std::vector<EdgeRef> inputs;
-	struct Output {
-	  std::string name;
-	  SignalWidth width = 0;
-	  bool sign = false;
-	};
-	std::vector<Output> outputs;
-	std::vector<SignalWidth> segment_widths;
+	NameId op = kEmptyName;
+	// Offset of the value in `const_words`, or'd with kConstUnknownPlane
+	// when an unknown plane follows the value plane.
+	uint32_t const_value = 0;
+	uint32_t segments_begin = 0;
+	uint32_t segments_end = 0;
       };
+      static constexpr uint32_t kNoAttrs = std::numeric_limits<uint32_t>::max();
+      static constexpr uint32_t kConstUnknownPlane = uint32_t{1} << 31;
       
       enum class BlockKind {
 	kMemory,
@@ -70,25 +85,248 @@ namespace abys::ir {
       
       struct Block {
 	BlockKind kind = BlockKind::kUnknown;
-	std::string name;
-	std::string impl_name;
+	NameId name = kEmptyName;
+	NameId impl_name = kEmptyName;
 	std::vector<Port> input_ports;
 	std::vector<Port> output_ports;
 	std::vector<NodeId> inputs;
 	std::vector<NodeId> outputs;
-	std::unordered_map<std::string, std::string> params;
-	std::unordered_map<std::string, std::string> attributes;
+	// Sets in the design's `params` store.
+	ParamSetId params = kEmptyParamSet;
+	ParamSetId attributes = kEmptyParamSet;
       };
 
-      std::string name;
+      NameId name = kEmptyName;
       std::vector<Port> input_ports;
       std::vector<Port> output_ports;
-      std::vector<Node> nodes;
+
+      // Nodes are stored column-wise. Node `n` has kind `node_kinds[n]`, fanins
+      // `fanins[fanin_offsets[n] .. fanin_offsets[n + 1])`, outputs
+      // `outputs[output_offsets[n] .. output_offsets[n + 1])` and, when
+      // `node_attrs[n] != kNoAttrs`, the rare fields in `attrs[node_attrs[n]]`.
+      std::vector<NodeKind> node_kinds;
+      std::vector<uint32_t> node_attrs;
+      std::vector<uint32_t> fanin_offsets{0};
+      std::vector<EdgeRef> fanins;
+      std::vector<uint32_t> output_offsets{0};
+      std::vector<Output> outputs;
+      std::vector<NodeAttrs> attrs;
+      std::vector<SignalWidth> segment_widths;
+      // Packed values of const nodes: the value words, then the unknown words
+      // for values with x or z bits.
+      std::vector<uint64_t> const_words;
+
       std::vector<Block> blocks;
-      std::unordered_map<std::string, EdgeRef> signal_map;
+      std::unordered_map<NameId, EdgeRef> signal_map;
+
+      static constexpr uint32_t kNoLevel = std::numeric_limits<uint32_t>::max();
+
+      // Fanout, topological order and level indices, built on first query.
+      // TigBuilder keeps them in step with node creation and set_node_input,
+      // patching them where that is cheap; code that edits the arrays above
+      // directly must call invalidate_graph_index().
+      struct GraphIndex {
+	// Nodes and edges the index reflects; a mismatch forces a rebuild.
+	NodeId num_nodes = 0;
+	size_t num_edges = 0;
+	bool fanouts_valid = false;
+	bool order_valid = false;
+	bool levels_valid = false;
+	// Consumers of node `n` as {consumer, input index}, in
+	// `fanouts[fanout_offsets[n] .. fanout_offsets[n + 1])`.
+	std::vector<uint32_t> fanout_offsets;
+	std::vector<EdgeRef> fanouts;
+	// Every node reachable without going around a cycle, drivers first.
+	std::vector<NodeId> order;
+	// Position in `order`, or kNoLevel for nodes left out of it.
+	std::vector<uint32_t> order_pos;
+	std::vector<uint32_t> levels;
+      };
+      mutable GraphIndex graph_index;
+
+      NodeId num_nodes() const { return static_cast<NodeId>(node_kinds.size()); }
+
+      NodeKind kind(NodeId node_id) const { return node_kinds[node_id]; }
+
+      std::span<const EdgeRef> node_fanins(NodeId node_id) const {
+	return {fanins.data() + fanin_offsets[node_id],
+		fanins.data() + fanin_offsets[node_id + 1]};
+      }
+      std::span<EdgeRef> node_fanins(NodeId node_id) {
+	return {fanins.data() + fanin_offsets[node_id],
+		fanins.data() + fanin_offsets[node_id + 1]};
+      }
+
+      std::span<const Output> node_outputs(NodeId node_id) const {
+	return {outputs.data() + output_offsets[node_id],
+		outputs.data() + output_offsets[node_id + 1]};
+      }
+
+      const NodeAttrs *find_attrs(NodeId node_id) const {
+	const uint32_t idx = node_attrs[node_id];
+	return idx == kNoAttrs ? nullptr : &attrs[idx];
+      }
+
+      ModuleId instance_module_id(NodeId node_id) const {
+	const NodeAttrs *a = find_attrs(node_id);
+	return a ? a->module_id : kInvalidModuleId;
+      }
+
+      /// Consumers of `node_id`'s outputs, as {consumer node, input index}.
+      std::span<const EdgeRef> node_fanouts(NodeId node_id) const;
+
+      /// Nodes with every driver before its consumers. Nodes on a cycle, or fed
+      /// by one, are left out; the order is complete iff the module is acyclic.
+      std::span<const NodeId> topological_order() const;
+
+      /// Longest path from a node without connected fanins, counting every
+      /// node as one level; kNoLevel for nodes left out of the order.
+      uint32_t node_level(NodeId node_id) const;
+
+      void invalidate_graph_index() { graph_index = {}; }
+
+      // Called by TigBuilder after appending a node or rewiring an input.
+      void patch_graph_index_node_added(NodeId node_id);
+      void patch_graph_index_input_changed(NodeId node_id, PortIndex port_idx, EdgeRef old_input);
+
+      std::span<const SignalWidth> node_segment_widths(NodeId node_id) const {
+	const NodeAttrs *a = find_attrs(node_id);
+	if (!a) {
+	  return {};
+	}
+	return {segment_widths.data() + a->segments_begin,
+		segment_widths.data() + a->segments_end};
+      }
+
+      /// The value of a const node, as wide as its output.
+      ConstView node_const(NodeId node_id) const {
+	const NodeAttrs *a = find_attrs(node_id);
+	const SignalWidth width = outputs[output_offsets[node_id]].width;
+	if (!a || width == 0) {
+	  return {};
+	}
+	const uint64_t *value = const_words.data() + (a->const_value & ~kConstUnknownPlane);
+	const uint64_t *unknown =
+	    (a->const_value & kConstUnknownPlane) ? value + ConstView::words_for(width) : nullptr;
+	return {width, value, unknown};
+      }
+    };
+
+    // The design's modules, each held through a reference count so that copies
+    // of a design share every module neither copy has changed since. Const
+    // access only reads. Non-const access first copies a module that another
+    // design still shares, so it counts as a write: a pass must take it for
+    // its own module only, and a reference taken before the design was copied
+    // must not be written through after. Iteration is read-only.
+    //
+    // Shared modules build their graph index lazily on const queries, so two
+    // designs sharing a module must not query it from different threads.
+    class ModuleList {
+    public:
+      using value_type = Module;
+      using size_type = size_t;
+
+      class const_iterator {
+      public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = Module;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const Module *;
+	using reference = const Module &;
+
+	const_iterator() = default;
+	reference operator*() const { return **it_; }
+	pointer operator->() const { return it_->get(); }
+	reference operator[](difference_type i) const { return *it_[i]; }
+	const_iterator &operator++() { ++it_; return *this; }
+	const_iterator operator++(int) { return const_iterator(it_++); }
+	const_iterator &operator--() { --it_; return *this; }
+	const_iterator operator--(int) { return const_iterator(it_--); }
+	const_iterator &operator+=(difference_type i) { it_ += i; return *this; }
+	const_iterator &operator-=(difference_type i) { it_ -= i; return *this; }
+	const_iterator operator+(difference_type i) const { return const_iterator(it_ + i); }
+	const_iterator operator-(difference_type i) const { return const_iterator(it_ - i); }
+	difference_type operator-(const const_iterator &other) const { return it_ - other.it_; }
+	auto operator<=>(const const_iterator &other) const = default;
+
+      private:
+	friend class ModuleList;
+	using Base = std::vector<std::shared_ptr<Module>>::const_iterator;
+	explicit const_iterator(Base it) : it_(it) {}
+	Base it_;
+      };
+      using iterator = const_iterator;
+
+      size_t size() const { return items_.size(); }
+      size_t capacity() const { return items_.capacity(); }
+      bool empty() const { return items_.empty(); }
+
+      const Module &operator[](size_t m) const { return *items_[m]; }
+      Module &operator[](size_t m) {
+	std::shared_ptr<Module> &item = items_[m];
+	if (item.use_count() > 1) {
+	  item = std::make_shared<Module>(*item);
+	}
+	return *item;
+      }
+      const Module &back() const { return *items_.back(); }
+      Module &back() { return (*this)[items_.size() - 1]; }
+
+      const_iterator begin() const { return const_iterator(items_.begin()); }
+      const_iterator end() const { return const_iterator(items_.end()); }
+
+      Module &emplace_back() { return *items_.emplace_back(std::make_shared<Module>()); }
+      void push_back(Module module) {
+	items_.push_back(std::make_shared<Module>(std::move(module)));
+      }
+      void reserve(size_t n) { items_.reserve(n); }
+      void resize(size_t n) {
+	const size_t old = items_.size();
+	items_.resize(n);
+	for (size_t m = old; m < n; m++) {
+	  items_[m] = std::make_shared<Module>();
+	}
+      }
+      void clear() { items_.clear(); }
+
+      /// Put `module` in place of module `m`, without copying the one it replaces.
+      void replace(size_t m, Module module) {
+	items_[m] = std::make_shared<Module>(std::move(module));
+      }
+
+      /// Keep only the modules `keep(m)` holds for, in their order, without
+      /// copying any of them.
+      template <typename F> void retain(F &&keep) {
+	size_t kept = 0;
+	for (size_t m = 0; m < items_.size(); m++) {
+	  if (keep(m)) {
+	    if (kept != m) {
+	      items_[kept] = std::move(items_[m]);
+	    }
+	    kept++;
+	  }
+	}
+	items_.resize(kept);
+      }
+
+      /// Whether module `m` is shared with another design, so that writing it
+      /// would copy it first.
+      bool shared(size_t m) const { return items_[m].use_count() > 1; }
+
+      /// Whether module `m` here and module `other_m` of `other` are one object.
+      bool same(size_t m, const ModuleList &other, size_t other_m) const {
+	return items_[m] == other.items_[other_m];
+      }
+
+    private:
+      std::vector<std::shared_ptr<Module>> items_;
     };
 
-    std::vector<Module> modules;
+    ModuleList modules;
+    // Every NameId in `modules` and `params` refers to this table.
+    SymbolTable names;
+    // Every ParamSetId in `modules` refers to this store.
+    ParamStore params;
   };
 
 } // namespace abys::ir
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "abys/ir/signal_index.h"
 #include "abys/ir/tig.h"
 
 namespace abys::ir {
@@ -16,49 +21,144 @@ struct TigBuildResult {
 };
 
 class TigBuilder {
+public:
+  struct HashConsStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+  };
+
 private:
   Tig &design_;
+  bool hash_consing_ = false;
+  HashConsStats hash_cons_stats_;
+  // Open-addressing table of hash-consed node ids; `used` counts tombstones.
+  struct HashConsTable {
+    std::vector<Tig::NodeId> slots;
+    size_t used = 0;
+  };
+  std::vector<HashConsTable> hash_cons_tables_;
 
 public:
+  using Design = Tig;
   using NodeId = Tig::NodeId;
   using PortIndex = Tig::PortIndex;
   using ModuleId = Tig::ModuleId;
   using SignalWidth = Tig::SignalWidth;
+  using NameId = Tig::NameId;
   static constexpr NodeId kInvalidNodeId = Tig::kInvalidNodeId;
   static constexpr ModuleId kInvalidModuleId = Tig::kInvalidModuleId;
   using Module = Tig::Module;
   using NodeKind = Tig::Module::NodeKind;
   using EdgeRef = Tig::Module::EdgeRef;
   using Signal = EdgeRef;
-  using SignalSpec = Tig::Module::Node::Output;
+  using SignalSpec = Tig::Module::Output;
 
 private:
-  NodeId create_node(Module &module, NodeKind kind);
-  void add_signal(Module &module, std::string_view name, EdgeRef edge);
+  NodeId create_node(Module &module, NodeKind kind, std::span<const EdgeRef> inputs,
+                     std::span<const SignalSpec> outputs);
+  Module::NodeAttrs &create_attrs(Module &module, NodeId node_id);
+  void add_signal(Module &module, NameId name, EdgeRef edge);
+
+  bool hash_consable(const Module &module, NodeId node_id) const;
+  // `value` is the constant a kConst lookup must match.
+  NodeId hash_cons_find(ModuleId module_id, NodeKind kind, uint64_t key,
+                        const SignalSpec &output, std::span<const EdgeRef> inputs,
+                        ConstView value = {}) const;
+  NodeId hash_cons_reuse(ModuleId module_id, NodeKind kind, uint64_t key,
+                         const SignalSpec &output, std::span<const EdgeRef> inputs,
+                         ConstView value = {});
+  void hash_cons_insert(ModuleId module_id, NodeId node_id);
+  void hash_cons_place(ModuleId module_id, NodeId node_id);
+  void hash_cons_erase(ModuleId module_id, NodeId node_id);
 
 public:
   explicit TigBuilder(Tig &design) : design_(design) {}
 
-  ModuleId create_module(std::string name);
-
-  NodeId create_module_input(ModuleId module_id, std::string name, SignalWidth width, bool sign);
-  NodeId create_module_output(ModuleId module_id, std::string name, SignalWidth width, bool sign,
+  const Tig &design() const { return design_; }
+
+  /// In hash-consing mode, creating a conversion, op or constant node that
+  /// matches an existing one (same kind, op or value, width, sign and fanins)
+  /// returns the existing node and only registers the new name for it. Nodes
+  /// with unconnected fanins are never shared; they join the table once
+  /// set_node_input has connected them all, and merge_equivalent_nodes shares
+  /// them after the fact.
+  void set_hash_consing(bool enabled) { hash_consing_ = enabled; }
+  bool hash_consing() const { return hash_consing_; }
+  const HashConsStats &hash_cons_stats() const { return hash_cons_stats_; }
+
+  NameId intern(std::string_view name) { return design_.names.intern(name); }
+  std::string_view name(NameId name) const { return design_.names.view(name); }
+
+  /// Intern a block parameter or attribute set from keys and Verilog value
+  /// text, typing the values ParamStore::parse recognizes.
+  ParamSetId
+  intern_params(std::span<const std::pair<std::string_view, std::string_view>> params);
+
+  ModuleId create_module(std::string_view name);
+
+  /// Replace the contents of `module_id` with module `local_id` of `local`,
+  /// translating names and block parameter sets into this design's tables. The names the module
+  /// uses are interned in `local`'s handle order, so adopting the same modules
+  /// in the same order always yields the same design. The module keeps its
+  /// reserved name.
+  void adopt_module(ModuleId module_id, Tig &&local, ModuleId local_id = 0);
+
+  NodeId create_module_input(ModuleId module_id, NameId name, SignalWidth width, bool sign);
+  NodeId create_module_output(ModuleId module_id, NameId name, SignalWidth width, bool sign,
                               NodeId input_id, PortIndex port_idx = 0);
 
-  NodeId create_conversion_node(ModuleId module_id, std::string name, SignalWidth width, bool sign,
+  NodeId create_conversion_node(ModuleId module_id, NameId name, SignalWidth width, bool sign,
                                 NodeId input_id, PortIndex port_idx = 0);
 
-  NodeId create_instance(ModuleId module_id, std::string name, ModuleId instance_module_id,
-                         std::vector<Signal> &node_inputs,
-                         std::vector<SignalSpec> &node_outputs);
+  NodeId create_op_node(ModuleId module_id, NameId name, NameId op, SignalWidth width, bool sign,
+                        std::span<const Signal> node_inputs);
+
+  /// `value` holds `width` binary digits (0, 1, x or z), most significant first.
+  NodeId create_const_node(ModuleId module_id, NameId name, SignalWidth width, bool sign,
+                           std::string_view value);
+  /// `value` must be `width` bits wide; its words are copied into the module's
+  /// const_words arena.
+  NodeId create_const_node(ModuleId module_id, NameId name, SignalWidth width, bool sign,
+                           ConstView value);
+
+  /// Cut one signal into consecutive bit ranges, least significant first; the
+  /// widths of `node_outputs` must add up to the input width.
+  NodeId create_split_node(ModuleId module_id, NodeId input_id, PortIndex port_idx,
+                           std::span<const SignalSpec> node_outputs);
+
+  /// Concatenate `node_inputs`, the first one least significant. `input_widths`
+  /// gives the width of each and must add up to `width`.
+  NodeId create_merge_node(ModuleId module_id, NameId name, SignalWidth width, bool sign,
+                           std::span<const Signal> node_inputs,
+                           std::span<const SignalWidth> input_widths);
+
+  NodeId create_instance(ModuleId module_id, NameId name, ModuleId instance_module_id,
+                         std::span<const Signal> node_inputs,
+                         std::span<const SignalSpec> node_outputs);
 
   void set_node_input(ModuleId module_id, NodeId node_id, PortIndex port_idx, Signal input);
 
+  /// Rebuild the hash-consing table of `module_id` in topological order,
+  /// merging every conversion, op and constant node equal to one before it:
+  /// its consumers and names move to the node kept, and it is left unread for
+  /// sweep_dead_logic(). This shares nodes whose inputs were connected only
+  /// after they were created. Returns the number of nodes merged, which are
+  /// also counted as hits.
+  size_t merge_equivalent_nodes(ModuleId module_id);
+
   Signal get_node_input(ModuleId module_id, NodeId node_id, PortIndex port_idx);
 
   SignalSpec get_signal_spec(ModuleId module_id, Signal signal);
 
-  Signal find_signal(ModuleId module_id, std::string name);
+  /// Return the signal driven under `name`, or an invalid edge if there is none.
+  Signal find_signal(ModuleId module_id, NameId name);
+  Signal find_signal(ModuleId module_id, std::string_view name);
+
+  /// Snapshot of every signal of `module_id`, for resolving many names at once.
+  /// Signals added afterwards are not in the index.
+  SignalIndex index_signals(ModuleId module_id) const {
+    return SignalIndex(std::as_const(design_).modules[module_id]);
+  }
 };
 
 } // namespace abys::ir
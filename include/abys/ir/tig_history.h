@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+/// Checkpoints of a design that passes edit in place, for undo.
+///
+/// A checkpoint is a copy of the design's module list, which shares every
+/// module with the design until something writes it. Taking one costs a
+/// pointer per module, and what it holds on to grows only with the modules
+/// written since. The symbol table and parameter store only ever grow, so
+/// checkpoints leave them out: undo keeps the names and sets interned since,
+/// which nothing refers to any more.
+class TigHistory {
+public:
+  explicit TigHistory(Tig &design) : design_(design) {}
+
+  /// Remember the design's modules as they are now.
+  void checkpoint();
+
+  /// Put back the modules of the last checkpoint and forget it. Returns false
+  /// if there is none.
+  bool undo();
+
+  size_t num_checkpoints() const { return checkpoints_.size(); }
+
+  /// Modules added or written since the last checkpoint, or every module if
+  /// there is none.
+  size_t changed_modules() const;
+
+  /// A design of its own to try something else on. It shares every module
+  /// with this one until either writes it; the names and parameter sets are
+  /// copied.
+  Tig fork() const { return design_; }
+
+private:
+  Tig &design_;
+  std::vector<Tig::ModuleList> checkpoints_;
+};
+
+} // namespace abys::ir
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+/// What a byte of Tig storage holds.
+enum class MemoryCategory : uint8_t {
+  kNodes,       // node kinds and the attr, fanin and output offsets
+  kEdges,       // fanins
+  kOutputs,     // node outputs: names, widths and signs
+  kAttrs,       // out-of-line node attributes and split/merge segment widths
+  kConsts,      // packed constant words
+  kPorts,       // module port lists
+  kSignalMap,   // signal_map nodes and buckets
+  kBlocks,      // blocks and their port and node lists
+  kBlockParams, // the design's store of block parameter and attribute sets
+  kGraphIndex,  // fanout, topological order and level indices
+  kNames,       // the design's symbol table
+  kModules,     // the design's module records and the array holding them
+};
+
+inline constexpr size_t kNumMemoryCategories = 12;
+
+std::string_view memory_category_name(MemoryCategory category);
+
+/// Heap bytes by category.
+///
+/// Containers are counted at their capacity, and hash maps by the nodes and
+/// bucket arrays libstdc++ allocates for them, so the figures are what the
+/// allocator was asked for, not the size of the live data.
+struct MemoryUsage {
+  std::array<uint64_t, kNumMemoryCategories> bytes{};
+
+  uint64_t &operator[](MemoryCategory c) { return bytes[static_cast<size_t>(c)]; }
+  uint64_t operator[](MemoryCategory c) const { return bytes[static_cast<size_t>(c)]; }
+
+  uint64_t total() const;
+
+  MemoryUsage &operator+=(const MemoryUsage &other);
+  /// Add `other` `times` times, saturating rather than wrapping.
+  void add_scaled(const MemoryUsage &other, uint64_t times);
+};
+
+struct ModuleMemory {
+  /// Storage owned by the module itself.
+  MemoryUsage self;
+  /// The module and, for every instance below it, the child's storage once per
+  /// instance: what the subtree would cost if it were flattened.
+  MemoryUsage hierarchy;
+  /// Times the module occurs in the hierarchy below the top modules; 1 for a
+  /// top module and 0 for none, which can only happen in cyclic designs.
+  uint64_t instances = 0;
+};
+
+struct DesignMemory {
+  /// Indexed by module id.
+  std::vector<ModuleMemory> modules;
+  /// Modules no other module instantiates.
+  std::vector<Tig::ModuleId> tops;
+  /// Storage shared by the whole design: names and module records.
+  MemoryUsage design;
+  /// Everything the design holds: `design` plus every module's `self`.
+  MemoryUsage total;
+  /// `design` plus every module's `self` times its instance count.
+  MemoryUsage flattened;
+};
+
+/// Heap bytes held by `module`, by category.
+MemoryUsage module_memory(const Tig::Module &module);
+
+/// Account every module of `design` and aggregate over its hierarchy, on up
+/// to `num_threads` threads (0 for one per core).
+DesignMemory design_memory(const Tig &design, unsigned num_threads = 1);
+
+/// A category table for the design followed by the `limit` modules that hold
+/// the most bytes, or all of them when `limit` is 0.
+void write_memory_report(std::ostream &out, const Tig &design, const DesignMemory &memory,
+                         size_t limit = 0);
+/// The same figures, with every module, as one JSON object.
+void write_memory_report_json(std::ostream &out, const Tig &design,
+                              const DesignMemory &memory);
+
+} // namespace abys::ir
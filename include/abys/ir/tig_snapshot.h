@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+struct TigSnapshotResult {
+  bool ok = false;
+  std::string message;
+};
+
+/// Bumped whenever the on-disk layout of any Tig array changes.
+static constexpr uint32_t kTigSnapshotVersion = 3;
+
+/// Write `design` to `path` as a versioned, checksummed binary snapshot.
+TigSnapshotResult write_tig_snapshot(const Tig &design, const std::string &path);
+
+/// Read-only view of a Tig snapshot mapped into memory.
+///
+/// Node, edge and name arrays are used in place: opening a snapshot costs one
+/// checksum pass over the file and one pass of bounds checks over its arrays,
+/// with no allocation beyond decoding the few blocks. A file that opens, with
+/// or without the checksum, only refers to names, nodes and sets it holds.
+/// `materialize()` turns the view back into a mutable Tig with one bulk copy
+/// per array.
+class TigSnapshot {
+public:
+  using NodeId = Tig::NodeId;
+  using ModuleId = Tig::ModuleId;
+  using NameId = Tig::NameId;
+  using SignalWidth = Tig::SignalWidth;
+  using Module = Tig::Module;
+  using NodeKind = Module::NodeKind;
+  using EdgeRef = Module::EdgeRef;
+
+  struct SignalEntry {
+    NameId name = kEmptyName;
+    EdgeRef edge;
+  };
+
+  struct ModuleView {
+    NameId name = kEmptyName;
+    std::span<const Module::Port> input_ports;
+    std::span<const Module::Port> output_ports;
+    std::span<const NodeKind> node_kinds;
+    std::span<const uint32_t> node_attrs;
+    std::span<const uint32_t> fanin_offsets;
+    std::span<const EdgeRef> fanins;
+    std::span<const uint32_t> output_offsets;
+    std::span<const Module::Output> outputs;
+    std::span<const Module::NodeAttrs> attrs;
+    std::span<const SignalWidth> segment_widths;
+    std::span<const uint64_t> const_words;
+    // Sorted by name.
+    std::span<const SignalEntry> signals;
+
+    NodeId num_nodes() const { return static_cast<NodeId>(node_kinds.size()); }
+
+    std::span<const EdgeRef> node_fanins(NodeId node_id) const {
+      return fanins.subspan(fanin_offsets[node_id],
+                            fanin_offsets[node_id + 1] - fanin_offsets[node_id]);
+    }
+
+    std::span<const Module::Output> node_outputs(NodeId node_id) const {
+      return outputs.subspan(output_offsets[node_id],
+                             output_offsets[node_id + 1] - output_offsets[node_id]);
+    }
+
+    /// Return the signal driven under `name`, or an invalid edge if there is none.
+    EdgeRef find_signal(NameId name) const;
+  };
+
+  TigSnapshot() = default;
+  TigSnapshot(const TigSnapshot &) = delete;
+  TigSnapshot &operator=(const TigSnapshot &) = delete;
+  TigSnapshot(TigSnapshot &&other) noexcept;
+  TigSnapshot &operator=(TigSnapshot &&other) noexcept;
+  ~TigSnapshot();
+
+  TigSnapshotResult open(const std::string &path, bool verify_checksum = true);
+  void close();
+
+  ModuleId num_modules() const { return num_modules_; }
+  ModuleView module(ModuleId module_id) const;
+
+  std::string_view name(NameId name) const;
+  /// Return the handle of `name`, or kInvalidName if the design never uses it.
+  NameId find_name(std::string_view name) const;
+
+  Tig materialize() const;
+
+private:
+  template <typename T> std::span<const T> section(size_t index) const;
+  TigSnapshotResult validate(bool verify_checksum) const;
+
+  const std::byte *data_ = nullptr;
+  size_t size_ = 0;
+  ModuleId num_modules_ = 0;
+};
+
+} // namespace abys::ir
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "abys/ir/tig.h"
+
+namespace abys::ir {
+
+struct VerilogWriteOptions {
+  /// Size of each output buffer. A module is rendered into a buffer that is
+  /// handed to the file whenever it fills, so peak memory is a small multiple
+  /// of this per thread, whatever the size of the output.
+  size_t buffer_bytes = size_t{1} << 20;
+  /// Threads rendering modules; 0 means one per hardware thread. Modules are
+  /// still written in module id order, so the file is the same for every count.
+  unsigned num_threads = 1;
+};
+
+struct VerilogWriteResult {
+  bool ok = false;
+  std::string message;
+  uint64_t bytes_written = 0;
+};
+
+/// Write `design` to `path` as structural Verilog-2005, one module per Tig
+/// module. Modules are named as in the Tig, or `_m<id>` when unnamed; since
+/// every specialization of a source module shares its name, a name already
+/// taken gets `_<id>` added until it is unique, at definitions and instances
+/// alike.
+///
+/// Every node output becomes a wire named after the signal, or `_n<node>` (with
+/// `_<port>` for ports past the first) when it has no name; names that are not
+/// plain identifiers are escaped. Conversions, splits, merges, constants and
+/// ops become continuous assignments whose operands are sign- or zero-extended
+/// explicitly, so the Verilog computes what the bit-blaster and the simulator
+/// do. Instances become module instances connected by port name, and blocks
+/// become instances of their implementation, with their parameters and
+/// attributes, connected through the block's register nodes.
+VerilogWriteResult write_verilog(const Tig &design, const std::string &path,
+                                 const VerilogWriteOptions &options = {});
+
+} // namespace abys::ir
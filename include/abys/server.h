@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace abys {
+
+struct ServeResult {
+  bool ok = false;
+  std::string message;
+};
+
+struct ServerOptions {
+  std::string socket_path;
+  /// How long the server waits for a command before calling `idle`; at least
+  /// a millisecond.
+  std::chrono::milliseconds poll_interval{500};
+  /// How long a connected client may take to send its command, or to accept
+  /// the reply. A slower one is dropped, so it cannot hold up the others;
+  /// zero waits forever.
+  std::chrono::milliseconds client_timeout{5000};
+};
+
+/// Runs one forwarded CLI invocation, without the program name, and returns
+/// its exit status. Standard output and error point at the client's for the
+/// duration, and the working directory is the client's.
+using ServerHandler = std::function<int(const std::vector<std::string> &args)>;
+
+/// Serve commands on the Unix domain socket `options.socket_path` until a
+/// client asks the server to stop.
+///
+/// Clients hand over their standard output and error descriptors along with
+/// the command, so everything the command prints, diagnostics included, goes
+/// straight to the client. Commands run one at a time on the calling thread;
+/// between them `idle` runs at least every `poll_interval`. The socket is only
+/// reachable by the current user and is removed on return.
+ServeResult serve(const ServerOptions &options, const ServerHandler &run,
+                  const std::function<void()> &idle);
+
+/// Run `args` on the server at `socket_path`, with this process's working
+/// directory, standard output and error, and store the exit status in `status`.
+ServeResult forward_to_server(const std::string &socket_path,
+                              const std::vector<std::string> &args, int &status);
+
+/// Ask the server at `socket_path` to stop once it has finished its current
+/// command.
+ServeResult stop_server(const std::string &socket_path);
+
+/// `$ABYS_SOCKET` if set, else abys.sock in `$XDG_RUNTIME_DIR`, else a
+/// per-user path in /tmp.
+std::string default_socket_path();
+
+} // namespace abys
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace abys::sim {
+
+/// One machine word of simulation patterns: bit `p` holds pattern `p`.
+using Word = uint64_t;
+
+/// Word-parallel kernels over bit planes of `n` words.
+///
+/// Destinations may alias a source of the same position but never overlap one
+/// partially. `full_add` and friends update `carry` in place, so a ripple-carry
+/// chain is one call per bit.
+struct Kernels {
+  const char *name;
+  void (*fill)(Word *dst, Word value, size_t n);
+  void (*copy)(Word *dst, const Word *a, size_t n);
+  void (*bit_not)(Word *dst, const Word *a, size_t n);
+  void (*bit_and)(Word *dst, const Word *a, const Word *b, size_t n);
+  void (*bit_or)(Word *dst, const Word *a, const Word *b, size_t n);
+  void (*bit_xor)(Word *dst, const Word *a, const Word *b, size_t n);
+  void (*bit_xnor)(Word *dst, const Word *a, const Word *b, size_t n);
+  /// sum = a ^ b ^ carry, carry = maj(a, b, carry).
+  void (*full_add)(Word *sum, Word *carry, const Word *a, const Word *b, size_t n);
+  /// As full_add with `b` inverted.
+  void (*full_sub)(Word *sum, Word *carry, const Word *a, const Word *b, size_t n);
+  /// As full_add with `acc` as both sum and first addend and `a & b` as the
+  /// second, for shift-and-add multiplication.
+  void (*accumulate_and)(Word *acc, Word *carry, const Word *a, const Word *b, size_t n);
+  /// acc &= ~(a ^ b).
+  void (*and_xnor)(Word *acc, const Word *a, const Word *b, size_t n);
+};
+
+/// Portable kernels, always available.
+const Kernels &scalar_kernels();
+
+/// AVX2 kernels, or null if abys was built without them or the CPU lacks AVX2.
+const Kernels *avx2_kernels();
+
+/// The fastest kernels the running CPU supports.
+const Kernels &best_kernels();
+
+} // namespace abys::sim
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig.h"
+#include "abys/sim/sim_kernels.h"
+
+namespace abys::sim {
+
+struct SimResult {
+  bool ok = false;
+  std::string message;
+};
+
+struct SimOptions {
+  // Patterns per run, in 64-pattern words.
+  size_t num_words = 1;
+  // Use AVX2 kernels when the CPU has them.
+  bool allow_simd = true;
+};
+
+/// Word-parallel simulation of one Tig module and everything it instantiates.
+///
+/// Every signal of width `w` is `w` bit planes of `num_words` words each: bit
+/// `b` of pattern `p` is bit `p % 64` of word `b * num_words + p / 64` of the
+/// signal's values. Inputs are the outputs of every kPi node of the top module,
+/// then those of every kRo node, in node order; outputs are the fanins of every
+/// kPo node, then those of every kRi node. Instances are simulated through
+/// their module, so the top module's values are exact across the hierarchy,
+/// while registers are cut points: they read as zero below the top module.
+/// Supported ops are those of the bit-blaster, and x or z constant bits read
+/// as 0.
+class Simulator {
+public:
+  using EdgeRef = ir::Tig::Module::EdgeRef;
+
+  Simulator(const ir::Tig &design, ir::Tig::ModuleId top, SimOptions options = {});
+  ~Simulator();
+  Simulator(Simulator &&) noexcept;
+
+  size_t num_words() const { return num_words_; }
+  size_t num_patterns() const { return 64 * num_words_; }
+  const Kernels &kernels() const { return *kernels_; }
+
+  std::span<const EdgeRef> inputs() const { return inputs_; }
+  std::span<const EdgeRef> outputs() const { return outputs_; }
+
+  /// Planes of input `i`, to be filled before run().
+  std::span<Word> input_values(size_t i);
+  /// Fill every input with pseudo-random patterns derived from `seed`; input
+  /// `i` gets the same patterns for the same seed whatever the module.
+  void randomize_inputs(uint64_t seed);
+
+  /// Evaluate the top module, and every instance below it, on the current
+  /// inputs.
+  SimResult run();
+
+  /// Planes of a top-module signal after run().
+  std::span<const Word> values(EdgeRef signal) const;
+  std::span<const Word> output_values(size_t i) const { return values(outputs_[i]); }
+
+  /// Hash of a signal's values, equal for signals that agreed on every
+  /// pattern. Signals that differ in width never collide by construction.
+  uint64_t signature(EdgeRef signal) const;
+  /// signature() of every top-module node output, indexed like Module::outputs.
+  std::vector<uint64_t> signatures() const;
+
+  /// Nodes evaluated by the last run(), instances expanded.
+  uint64_t nodes_evaluated() const { return nodes_evaluated_; }
+
+private:
+  struct Frame;
+
+  Frame &frame(ir::Tig::ModuleId module_id);
+  void evaluate(ir::Tig::ModuleId module_id, size_t depth);
+  void evaluate_node(Frame &frame, ir::Tig::NodeId n, size_t depth);
+  void evaluate_op(Frame &frame, ir::Tig::NodeId n);
+  void evaluate_instance(Frame &frame, ir::Tig::NodeId n, size_t depth);
+
+  const ir::Tig &design_;
+  ir::Tig::ModuleId top_;
+  size_t num_words_;
+  const Kernels *kernels_;
+  std::vector<EdgeRef> inputs_;
+  std::vector<EdgeRef> outputs_;
+  // One frame per module, made on first use. A module cannot instantiate
+  // itself, so a frame is never live twice at once.
+  std::vector<std::unique_ptr<Frame>> frames_;
+  // Constant planes and per-op temporaries.
+  std::vector<Word> zeros_;
+  std::vector<Word> scratch_;
+  uint64_t nodes_evaluated_ = 0;
+};
+
+struct ScreenResult {
+  bool ok = false;
+  std::string message;
+  // Set when some pattern tells the modules apart.
+  bool distinguished = false;
+  size_t output = 0;
+  size_t pattern = 0;
+};
+
+/// Simulate modules `a` and `b` of `design` on the same `rounds` batches of
+/// random patterns and report the first output and pattern where they differ.
+/// The modules must have inputs and outputs of matching widths. Agreement on
+/// every pattern does not prove equivalence, but a difference disproves it.
+ScreenResult screen_equivalence(const ir::Tig &design, ir::Tig::ModuleId a, ir::Tig::ModuleId b,
+                                size_t rounds = 4, SimOptions options = {}, uint64_t seed = 1);
+
+} // namespace abys::sim
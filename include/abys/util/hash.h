@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace abys::util {
+
+/// Mix one 64-bit word into a running hash.
+inline uint64_t hash_combine(uint64_t h, uint64_t word) {
+  h ^= word + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  h *= 0xff51afd7ed558ccdULL;
+  return h ^ (h >> 32);
+}
+
+/// Streaming byte hash, consumed eight bytes at a time. The result only depends
+/// on the concatenated input, not on how it was split across `update` calls,
+/// and is stable across runs, so it is safe to persist.
+class Hasher {
+public:
+  explicit Hasher(uint64_t seed = 0) : h_(seed) {}
+
+  void update(const void *data, size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    length_ += size;
+    while (size > 0 && tail_len_ != 0) {
+      push_tail(*bytes++);
+      size--;
+    }
+    for (; size >= 8; bytes += 8, size -= 8) {
+      uint64_t word;
+      std::memcpy(&word, bytes, 8);
+      h_ = hash_combine(h_, word);
+    }
+    while (size > 0) {
+      push_tail(*bytes++);
+      size--;
+    }
+  }
+
+  uint64_t digest() const {
+    uint64_t h = tail_len_ ? hash_combine(h_, tail_) : h_;
+    return hash_combine(h, length_);
+  }
+
+private:
+  void push_tail(unsigned char byte) {
+    tail_ |= uint64_t{byte} << (8 * tail_len_);
+    if (++tail_len_ == 8) {
+      h_ = hash_combine(h_, tail_);
+      tail_ = 0;
+      tail_len_ = 0;
+    }
+  }
+
+  uint64_t h_;
+  uint64_t tail_ = 0;
+  size_t tail_len_ = 0;
+  uint64_t length_ = 0;
+};
+
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0) {
+  Hasher hasher(seed);
+  hasher.update(data, size);
+  return hasher.digest();
+}
+
+} // namespace abys::util
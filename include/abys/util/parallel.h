@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace abys::util {
+
+/// Resolve a requested thread count; 0 means one per hardware thread.
+inline unsigned resolve_num_threads(unsigned num_threads) {
+  if (num_threads != 0) {
+    return num_threads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// Call `body(i)` for every i in [0, n) on up to `num_threads` threads.
+///
+/// Indices are handed out dynamically, so uneven work balances itself. If any
+/// call throws, the exception of the lowest failing index is rethrown once all
+/// threads have stopped, which makes failures independent of scheduling.
+template <typename F> void parallel_for(size_t n, unsigned num_threads, F &&body) {
+  const size_t workers = std::min<size_t>(resolve_num_threads(num_threads), n);
+  if (workers <= 1) {
+    for (size_t i = 0; i < n; i++) {
+      body(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> first_error{n};
+  std::vector<std::exception_ptr> errors(n);
+  auto work = [&] {
+    for (size_t i = next++; i < n && i < first_error.load(); i = next++) {
+      try {
+        body(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+        size_t prev = first_error.load();
+        while (i < prev && !first_error.compare_exchange_weak(prev, i)) {
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; t++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (first_error < n) {
+    std::rethrow_exception(errors[first_error]);
+  }
+}
+
+} // namespace abys::util
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace abys::util {
+
+/// Allocations made by the calling thread since it started. They stay zero
+/// unless the executable links an allocation hook that bumps them (the `abys`
+/// CLI does).
+struct AllocationCounters {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+AllocationCounters &thread_allocations();
+
+/// Process-wide recorder of timed scopes and counters.
+///
+/// Recording is off by default; while it is off a ScopedTimer or count() costs
+/// one relaxed atomic load. Scopes are grouped by category: "phase" for the
+/// steps of a run, anything else (e.g. "visit", "wire") for per-module work,
+/// named after the module.
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    std::string category;
+    std::string name;
+    uint32_t thread = 0;
+    Clock::duration start{};
+    Clock::duration duration{};
+    // Made by this thread inside the scope.
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    // Resident set at the end of the scope; only sampled for phases.
+    size_t rss_bytes = 0;
+  };
+
+  static Profiler &instance();
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  static void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+  Clock::time_point origin() const { return origin_; }
+
+  void record(Event event);
+  void count(std::string_view name, int64_t delta);
+  void clear();
+
+  std::vector<Event> events() const;
+  std::map<std::string, int64_t, std::less<>> counters() const;
+
+  /// Per-phase table, per-category totals of the per-module scopes, the
+  /// slowest modules and the counters.
+  void write_summary(std::ostream &out) const;
+  /// Chrome trace-event JSON, viewable in chrome://tracing or Perfetto.
+  bool write_trace(const std::string &path) const;
+
+private:
+  Profiler() = default;
+
+  static inline std::atomic<bool> enabled_{false};
+
+  Clock::time_point origin_ = Clock::now();
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::map<std::string, int64_t, std::less<>> counters_;
+};
+
+/// Small dense id of the calling thread, for trace output.
+uint32_t thread_ordinal();
+
+/// Current resident set size, or 0 where it cannot be read.
+size_t current_rss_bytes();
+
+/// Records the wall time and allocations between construction and destruction
+/// when the profiler is enabled.
+class ScopedTimer {
+public:
+  ScopedTimer(std::string_view category, std::string_view name) {
+    if (Profiler::enabled()) {
+      begin(category, name);
+    }
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() {
+    if (active_) {
+      end();
+    }
+  }
+
+private:
+  void begin(std::string_view category, std::string_view name);
+  void end();
+
+  bool active_ = false;
+  Profiler::Event event_;
+  Profiler::Clock::time_point start_;
+  AllocationCounters allocations_;
+};
+
+/// Add `delta` to the named counter when the profiler is enabled.
+inline void count(std::string_view name, int64_t delta = 1) {
+  if (Profiler::enabled()) {
+    Profiler::instance().count(name, delta);
+  }
+}
+
+} // namespace abys::util
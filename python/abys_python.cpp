@@ -0,0 +1,453 @@
+// pybind11 bindings for the frontend, the Tig and TigBuilder.
+//
+// Node data is exposed as read-only buffer-protocol columns that point into the
+// Tig's own arrays, so `numpy.asarray(module.node_kinds)` costs nothing however
+// large the module is. Parsing and lowering run with the GIL released.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "abys/frontend.h"
+#include "abys/ir/const_value.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_snapshot.h"
+#include "abys/version.h"
+
+namespace py = pybind11;
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+
+// A read-only strided view of Tig memory. `owner` is the Python object whose
+// lifetime covers the memory, so a column keeps its design alive.
+struct Column {
+  py::object owner;
+  const void *data = nullptr;
+  py::ssize_t itemsize = 0;
+  std::string format;
+  std::vector<py::ssize_t> shape;
+  std::vector<py::ssize_t> strides;
+};
+
+template <typename T>
+Column column(py::object owner, const std::vector<T> &values) {
+  return {std::move(owner), values.data(), sizeof(T), py::format_descriptor<T>::format(),
+          {static_cast<py::ssize_t>(values.size())}, {sizeof(T)}};
+}
+
+// One field of every element of `values`, e.g. the widths of all outputs.
+template <typename Record, typename Field>
+Column field_column(py::object owner, const std::vector<Record> &values, Field Record::*field) {
+  static const Record probe{};
+  const auto offset = reinterpret_cast<const std::byte *>(&(probe.*field)) -
+                      reinterpret_cast<const std::byte *>(&probe);
+  const auto *base = reinterpret_cast<const std::byte *>(values.data());
+  return {std::move(owner), base ? base + offset : nullptr, sizeof(Field),
+          py::format_descriptor<Field>::format(), {static_cast<py::ssize_t>(values.size())},
+          {sizeof(Record)}};
+}
+
+py::buffer_info column_buffer(const Column &c) {
+  // An empty vector may have no storage; the buffer protocol wants a pointer.
+  static const std::byte kEmpty{};
+  const void *data = c.data ? c.data : &kEmpty;
+  return py::buffer_info(const_cast<void *>(data), c.itemsize, c.format,
+                         static_cast<py::ssize_t>(c.shape.size()), c.shape, c.strides,
+                         /*readonly=*/true);
+}
+
+using SpecTuple = std::tuple<std::string, Tig::SignalWidth, bool>;
+
+std::vector<TigBuilder::SignalSpec> to_specs(TigBuilder &builder,
+                                             const std::vector<SpecTuple> &in) {
+  std::vector<TigBuilder::SignalSpec> specs;
+  specs.reserve(in.size());
+  for (const auto &[name, width, sign] : in) {
+    specs.push_back({builder.intern(name), width, sign});
+  }
+  return specs;
+}
+
+const Module &module_at(const Tig &design, Tig::ModuleId module_id) {
+  if (module_id >= design.modules.size()) {
+    throw py::index_error("module id " + std::to_string(module_id) + " out of range");
+  }
+  return design.modules[module_id];
+}
+
+void check_node(const Module &module, Tig::NodeId node_id) {
+  if (node_id >= module.num_nodes()) {
+    throw py::index_error("node id " + std::to_string(node_id) + " out of range");
+  }
+}
+
+// TigBuilder only asserts its arguments, so the builder bindings check every
+// id Python passes before handing it on. An input may be left open with
+// INVALID_NODE and connected later with set_node_input.
+void check_input(const Module &module, Tig::NodeId node_id, Tig::PortIndex port_idx) {
+  if (node_id == Tig::kInvalidNodeId) {
+    return;
+  }
+  check_node(module, node_id);
+  if (port_idx >= module.node_outputs(node_id).size()) {
+    throw py::index_error("port " + std::to_string(port_idx) + " of node " +
+                          std::to_string(node_id) + " out of range");
+  }
+}
+
+std::vector<EdgeRef> to_edges(const Module &module,
+                              const std::vector<std::pair<Tig::NodeId, Tig::PortIndex>> &in) {
+  std::vector<EdgeRef> edges;
+  edges.reserve(in.size());
+  for (const auto &[node, port] : in) {
+    check_input(module, node, port);
+    edges.push_back({node, port});
+  }
+  return edges;
+}
+
+py::tuple edge_tuple(EdgeRef edge) { return py::make_tuple(edge.node_id, edge.port_idx); }
+
+} // namespace
+
+PYBIND11_MODULE(abys, m) {
+  m.doc() = "Python bindings for the abys Tig IR and SystemVerilog frontend";
+  m.attr("__version__") = abys::version();
+  m.attr("INVALID_NODE") = Tig::kInvalidNodeId;
+  m.attr("INVALID_MODULE") = Tig::kInvalidModuleId;
+  m.attr("NO_ATTRS") = Module::kNoAttrs;
+
+  py::class_<Column>(m, "Column", py::buffer_protocol(),
+                     "Read-only view of one Tig array; pass it to numpy.asarray or "
+                     "memoryview. It is invalidated by later edits of its module.")
+      .def_buffer(&column_buffer)
+      .def("__len__", [](const Column &c) { return c.shape[0]; });
+
+  py::enum_<NodeKind>(m, "NodeKind")
+      .value("INSTANCE", NodeKind::kInstance)
+      .value("PI", NodeKind::kPi)
+      .value("PO", NodeKind::kPo)
+      .value("RI", NodeKind::kRi)
+      .value("RO", NodeKind::kRo)
+      .value("CONST", NodeKind::kConst)
+      .value("SPLIT", NodeKind::kSplit)
+      .value("MERGE", NodeKind::kMerge)
+      .value("CONVERT", NodeKind::kConvert)
+      .value("OP", NodeKind::kOp)
+      .value("UNKNOWN", NodeKind::kUnknown);
+
+  // Modules are only ever handed out by reference into a Design, which they
+  // keep alive; the columns in turn keep the module object alive.
+  py::class_<Module>(m, "Module")
+      .def_property_readonly("name_id", [](const Module &mod) { return mod.name; })
+      .def_property_readonly("num_nodes", &Module::num_nodes)
+      .def_property_readonly("node_kinds",
+                             [](py::object self) {
+                               // NodeKind is a uint8_t enum; expose the raw values.
+                               const auto &kinds = self.cast<const Module &>().node_kinds;
+                               static_assert(sizeof(NodeKind) == sizeof(uint8_t));
+                               return Column{self, kinds.data(), sizeof(NodeKind),
+                                             py::format_descriptor<uint8_t>::format(),
+                                             {static_cast<py::ssize_t>(kinds.size())},
+                                             {sizeof(NodeKind)}};
+                             })
+      .def_property_readonly(
+          "fanin_offsets",
+          [](py::object self) { return column(self, self.cast<const Module &>().fanin_offsets); })
+      .def_property_readonly("fanins",
+                             [](py::object self) {
+                               // An (edges, 2) array of {node, port} pairs.
+                               const auto &mod = self.cast<const Module &>();
+                               Column c = field_column(self, mod.fanins, &EdgeRef::node_id);
+                               c.shape.push_back(2);
+                               c.strides.push_back(sizeof(Tig::NodeId));
+                               return c;
+                             })
+      .def_property_readonly("output_offsets",
+                             [](py::object self) {
+                               return column(self, self.cast<const Module &>().output_offsets);
+                             })
+      .def_property_readonly("output_widths",
+                             [](py::object self) {
+                               return field_column(self, self.cast<const Module &>().outputs,
+                                                   &Module::Output::width);
+                             })
+      .def_property_readonly("output_signs",
+                             [](py::object self) {
+                               return field_column(self, self.cast<const Module &>().outputs,
+                                                   &Module::Output::sign);
+                             })
+      .def_property_readonly("output_names",
+                             [](py::object self) {
+                               return field_column(self, self.cast<const Module &>().outputs,
+                                                   &Module::Output::name);
+                             })
+      .def_property_readonly(
+          "node_attrs",
+          [](py::object self) { return column(self, self.cast<const Module &>().node_attrs); },
+          "Index of each node's attributes, or NO_ATTRS.")
+      .def_property_readonly(
+          "attr_module_ids",
+          [](py::object self) {
+            return field_column(self, self.cast<const Module &>().attrs,
+                                &Module::NodeAttrs::module_id);
+          },
+          "Instantiated module of each attribute record, indexed through node_attrs.")
+      .def_property_readonly("attr_ops",
+                             [](py::object self) {
+                               return field_column(self, self.cast<const Module &>().attrs,
+                                                   &Module::NodeAttrs::op);
+                             })
+      .def("kind",
+           [](const Module &mod, Tig::NodeId node_id) {
+             check_node(mod, node_id);
+             return mod.kind(node_id);
+           })
+      .def("node_fanins",
+           [](const Module &mod, Tig::NodeId node_id) {
+             check_node(mod, node_id);
+             py::list out;
+             for (const EdgeRef edge : mod.node_fanins(node_id)) {
+               out.append(edge_tuple(edge));
+             }
+             return out;
+           })
+      .def("node_fanouts",
+           [](const Module &mod, Tig::NodeId node_id) {
+             check_node(mod, node_id);
+             py::list out;
+             for (const EdgeRef edge : mod.node_fanouts(node_id)) {
+               out.append(edge_tuple(edge));
+             }
+             return out;
+           })
+      .def(
+          "const_value",
+          [](const Module &mod, Tig::NodeId node_id) {
+            check_node(mod, node_id);
+            if (mod.kind(node_id) != Module::NodeKind::kConst) {
+              throw py::value_error("node " + std::to_string(node_id) + " is not a constant");
+            }
+            return mod.node_const(node_id).to_string();
+          },
+          "Digits 0, 1, x and z of a const node, most significant first.")
+      .def("instance_module_id",
+           [](const Module &mod, Tig::NodeId node_id) {
+             check_node(mod, node_id);
+             return mod.instance_module_id(node_id);
+           })
+      .def("topological_order", [](const Module &mod) {
+        const auto order = mod.topological_order();
+        return std::vector<Tig::NodeId>(order.begin(), order.end());
+      });
+
+  py::class_<Tig>(m, "Design")
+      .def(py::init<>())
+      .def_property_readonly("num_modules",
+                             [](const Tig &design) { return design.modules.size(); })
+      .def("__len__", [](const Tig &design) { return design.modules.size(); })
+      .def("module", &module_at, py::return_value_policy::reference_internal)
+      .def("find_module",
+           [](const Tig &design, std::string_view name) -> std::optional<Tig::ModuleId> {
+             const auto id = design.names.find(name);
+             for (Tig::ModuleId i = 0; i < design.modules.size(); i++) {
+               if (id != abys::ir::kInvalidName && design.modules[i].name == id) {
+                 return i;
+               }
+             }
+             return std::nullopt;
+           })
+      .def("name",
+           [](const Tig &design, Tig::NameId id) {
+             if (id >= design.names.size()) {
+               throw py::index_error("name id " + std::to_string(id) + " out of range");
+             }
+             return std::string(design.names.view(id));
+           })
+      .def("find_name", [](const Tig &design, std::string_view name) -> std::optional<Tig::NameId> {
+        const auto id = design.names.find(name);
+        if (id == abys::ir::kInvalidName) {
+          return std::nullopt;
+        }
+        return id;
+      });
+
+  // Names and ops are passed as strings and interned; signals are (node, port)
+  // tuples and output specs are (name, width, signed) tuples.
+  py::class_<TigBuilder>(m, "TigBuilder")
+      .def(py::init<Tig &>(), py::keep_alive<1, 2>())
+      .def_property("hash_consing", &TigBuilder::hash_consing, &TigBuilder::set_hash_consing)
+      .def("intern", [](TigBuilder &b, std::string_view name) { return b.intern(name); })
+      .def("create_module",
+           [](TigBuilder &b, std::string_view name) { return b.create_module(name); })
+      .def("create_module_input",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::SignalWidth width,
+              bool sign) {
+             module_at(b.design(), mod);
+             return b.create_module_input(mod, b.intern(name), width, sign);
+           },
+           py::arg("module"), py::arg("name"), py::arg("width"), py::arg("signed") = false)
+      .def("create_module_output",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::SignalWidth width,
+              bool sign, Tig::NodeId input, Tig::PortIndex port) {
+             check_input(module_at(b.design(), mod), input, port);
+             return b.create_module_output(mod, b.intern(name), width, sign, input, port);
+           },
+           py::arg("module"), py::arg("name"), py::arg("width"), py::arg("signed"),
+           py::arg("input"), py::arg("port") = 0)
+      .def("create_conversion_node",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::SignalWidth width,
+              bool sign, Tig::NodeId input, Tig::PortIndex port) {
+             check_input(module_at(b.design(), mod), input, port);
+             return b.create_conversion_node(mod, b.intern(name), width, sign, input, port);
+           },
+           py::arg("module"), py::arg("name"), py::arg("width"), py::arg("signed"),
+           py::arg("input"), py::arg("port") = 0)
+      .def("create_op_node",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, std::string_view op,
+              Tig::SignalWidth width, bool sign,
+              const std::vector<std::pair<Tig::NodeId, Tig::PortIndex>> &inputs) {
+             const auto edges = to_edges(module_at(b.design(), mod), inputs);
+             return b.create_op_node(mod, b.intern(name), b.intern(op), width, sign, edges);
+           },
+           py::arg("module"), py::arg("name"), py::arg("op"), py::arg("width"),
+           py::arg("signed"), py::arg("inputs"))
+      .def("create_const_node",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::SignalWidth width,
+              bool sign, std::string_view value) {
+             module_at(b.design(), mod);
+             if (value.size() != width) {
+               throw py::value_error("constant needs one digit per bit");
+             }
+             const auto parsed = abys::ir::ConstValue::parse(value);
+             if (!parsed) {
+               throw py::value_error("constant digits must be 0, 1, x or z");
+             }
+             return b.create_const_node(mod, b.intern(name), width, sign, parsed->view());
+           },
+           py::arg("module"), py::arg("name"), py::arg("width"), py::arg("signed"),
+           py::arg("value"))
+      .def("create_split_node",
+           [](TigBuilder &b, Tig::ModuleId mod, Tig::NodeId input, Tig::PortIndex port,
+              const std::vector<SpecTuple> &outputs) {
+             check_input(module_at(b.design(), mod), input, port);
+             return b.create_split_node(mod, input, port, to_specs(b, outputs));
+           },
+           py::arg("module"), py::arg("input"), py::arg("port"), py::arg("outputs"))
+      .def("create_merge_node",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::SignalWidth width,
+              bool sign, const std::vector<std::pair<Tig::NodeId, Tig::PortIndex>> &inputs,
+              const std::vector<Tig::SignalWidth> &input_widths) {
+             const auto edges = to_edges(module_at(b.design(), mod), inputs);
+             if (edges.size() != input_widths.size()) {
+               throw py::index_error("merge needs one input width per input");
+             }
+             return b.create_merge_node(mod, b.intern(name), width, sign, edges, input_widths);
+           },
+           py::arg("module"), py::arg("name"), py::arg("width"), py::arg("signed"),
+           py::arg("inputs"), py::arg("input_widths"))
+      .def("create_instance",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name, Tig::ModuleId child,
+              const std::vector<std::pair<Tig::NodeId, Tig::PortIndex>> &inputs,
+              const std::vector<SpecTuple> &outputs) {
+             const auto edges = to_edges(module_at(b.design(), mod), inputs);
+             module_at(b.design(), child);
+             return b.create_instance(mod, b.intern(name), child, edges, to_specs(b, outputs));
+           },
+           py::arg("module"), py::arg("name"), py::arg("child"), py::arg("inputs"),
+           py::arg("outputs"))
+      .def("set_node_input",
+           [](TigBuilder &b, Tig::ModuleId mod, Tig::NodeId node, Tig::PortIndex idx,
+              std::pair<Tig::NodeId, Tig::PortIndex> input) {
+             const Module &module = module_at(b.design(), mod);
+             check_node(module, node);
+             if (idx >= module.node_fanins(node).size()) {
+               throw py::index_error("input " + std::to_string(idx) + " of node " +
+                                     std::to_string(node) + " out of range");
+             }
+             check_input(module, input.first, input.second);
+             b.set_node_input(mod, node, idx, {input.first, input.second});
+           })
+      .def("find_signal",
+           [](TigBuilder &b, Tig::ModuleId mod, std::string_view name) -> py::object {
+             module_at(b.design(), mod);
+             const EdgeRef edge = b.find_signal(mod, name);
+             if (edge.node_id == Tig::kInvalidNodeId) {
+               return py::none();
+             }
+             return edge_tuple(edge);
+           });
+
+  py::class_<abys::FrontendOptions>(m, "FrontendOptions")
+      .def(py::init<>())
+      .def_readwrite("parse_threads", &abys::FrontendOptions::parse_threads)
+      .def_readwrite("lowering_threads", &abys::FrontendOptions::lowering_threads)
+      .def_readwrite("cache_dir", &abys::FrontendOptions::cache_dir)
+      .def_readwrite("hash_consing", &abys::FrontendOptions::hash_consing);
+
+  py::class_<abys::ParseResult>(m, "ParseResult")
+      .def_readonly("ok", &abys::ParseResult::ok)
+      .def_readonly("message", &abys::ParseResult::message);
+
+  py::class_<abys::ir::TigBuildResult>(m, "TigBuildResult")
+      .def_readonly("ok", &abys::ir::TigBuildResult::ok)
+      .def_readonly("message", &abys::ir::TigBuildResult::message)
+      .def_property_readonly(
+          "design", [](abys::ir::TigBuildResult &r) -> Tig & { return r.design; },
+          py::return_value_policy::reference_internal);
+
+  py::class_<abys::ir::TigSnapshotResult>(m, "TigSnapshotResult")
+      .def_readonly("ok", &abys::ir::TigSnapshotResult::ok)
+      .def_readonly("message", &abys::ir::TigSnapshotResult::message);
+
+  py::class_<abys::FrontendSession>(m, "FrontendSession")
+      .def(py::init<abys::FrontendOptions>(), py::arg("options") = abys::FrontendOptions{})
+      .def("load", &abys::FrontendSession::load, py::arg("files"), py::arg("top") = std::nullopt,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("ok", &abys::FrontendSession::ok)
+      .def_property_readonly("num_errors", &abys::FrontendSession::num_errors)
+      .def_property_readonly("num_warnings", &abys::FrontendSession::num_warnings)
+      .def("top_modules", &abys::FrontendSession::top_modules)
+      .def("build_tig", &abys::FrontendSession::build_tig,
+           py::call_guard<py::gil_scoped_release>());
+
+  m.def("parse_systemverilog", &abys::parse_systemverilog, py::arg("files"),
+        py::arg("top") = std::nullopt, py::arg("options") = abys::FrontendOptions{},
+        py::call_guard<py::gil_scoped_release>());
+  m.def("build_tig_from_systemverilog", &abys::build_tig_from_systemverilog, py::arg("files"),
+        py::arg("top") = std::nullopt, py::arg("options") = abys::FrontendOptions{},
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def("write_tig_snapshot", &abys::ir::write_tig_snapshot, py::arg("design"), py::arg("path"),
+        py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "read_tig_snapshot",
+      [](const std::string &path) {
+        abys::ir::TigSnapshot snapshot;
+        abys::ir::TigBuildResult result;
+        {
+          py::gil_scoped_release release;
+          const auto opened = snapshot.open(path);
+          result.ok = opened.ok;
+          result.message = opened.message;
+          if (opened.ok) {
+            result.design = snapshot.materialize();
+          }
+        }
+        return result;
+      },
+      py::arg("path"), "Load a snapshot written by write_tig_snapshot into a new Design.");
+}
@@ -0,0 +1,158 @@
+"""Checks for the abys Python module; run by ctest with the module on PYTHONPATH."""
+
+import os
+import sys
+import tempfile
+import threading
+
+import abys
+
+failures = 0
+
+
+def check(cond, what):
+    global failures
+    if not cond:
+        print(f"FAIL: {what}", file=sys.stderr)
+        failures += 1
+
+
+def raises(error, call, *args):
+    try:
+        call(*args)
+    except error:
+        return True
+    return False
+
+
+def build_adder():
+    design = abys.Design()
+    builder = abys.TigBuilder(design)
+    cell = builder.create_module("cell")
+    a = builder.create_module_input(cell, "a", 8)
+    b = builder.create_module_input(cell, "b", 8, signed=True)
+    s = builder.create_op_node(cell, "s", "add", 9, False, [(a, 0), (b, 0)])
+    builder.create_module_output(cell, "s", 9, False, s)
+
+    top = builder.create_module("top")
+    x = builder.create_module_input(top, "x", 8)
+    one = builder.create_const_node(top, "one", 8, False, "00000001")
+    u = builder.create_instance(top, "u", cell, [(x, 0), (one, 0)], [("sum", 9, False)])
+    halves = builder.create_split_node(top, u, 0, [("lo", 4, False), ("hi", 5, False)])
+    builder.create_module_output(top, "y", 5, False, halves, 1)
+    return design, cell, top
+
+
+def check_columns():
+    design, cell, top = build_adder()
+    m = design.module(cell)
+    check(m.num_nodes == 4, "cell has four nodes")
+    kinds = memoryview(m.node_kinds)
+    check(kinds.readonly, "columns are read-only")
+    check(kinds.format == "B" and kinds.tolist() == [
+        int(abys.NodeKind.PI), int(abys.NodeKind.PI), int(abys.NodeKind.OP),
+        int(abys.NodeKind.PO)], "node kinds")
+    check(memoryview(m.fanin_offsets).tolist() == [0, 0, 0, 2, 3], "fanin offsets")
+    check(memoryview(m.fanins).shape == (3, 2), "fanins are (edges, 2)")
+    check(memoryview(m.fanins).tolist() == [[0, 0], [1, 0], [2, 0]], "fanin edges")
+    check(memoryview(m.output_widths).tolist() == [8, 8, 9, 9], "output widths")
+    check(memoryview(m.output_signs).tolist() == [False, True, False, False], "output signs")
+    check(design.name(memoryview(m.output_names)[2]) == "s", "output names")
+
+    t = design.module(top)
+    attrs = memoryview(t.node_attrs).tolist()
+    module_ids = memoryview(t.attr_module_ids).tolist()
+    instance = [n for n in range(t.num_nodes) if t.kind(n) == abys.NodeKind.INSTANCE]
+    check(len(instance) == 1 and module_ids[attrs[instance[0]]] == cell,
+          "instance module ids through node_attrs")
+    check(t.instance_module_id(instance[0]) == cell, "instance_module_id")
+    consts = [n for n in range(t.num_nodes) if t.kind(n) == abys.NodeKind.CONST]
+    check(len(consts) == 1 and t.const_value(consts[0]) == "00000001", "const_value")
+    check(design.find_module("top") == top and design.find_module("nope") is None, "find_module")
+    check(t.node_fanouts(instance[0]) == [(instance[0] + 1, 0)], "fanouts")
+
+    # A column keeps the design alive after every other reference is gone.
+    widths = t.output_widths
+    del design, t
+    check(memoryview(widths).tolist()[-1] == 5, "column outlives the design handle")
+
+    try:
+        import numpy
+    except ImportError:
+        return
+    design, cell, _ = build_adder()
+    m = design.module(cell)
+    kinds = numpy.asarray(m.node_kinds)
+    check(kinds.dtype == numpy.uint8 and not kinds.flags.writeable, "numpy view")
+    check(numpy.asarray(m.fanins)[:, 0].tolist() == [0, 1, 2], "numpy fanin nodes")
+
+
+def check_builder_errors():
+    design, cell, top = build_adder()
+    builder = abys.TigBuilder(design)
+    check(raises(IndexError, builder.create_module_input, 99, "a", 1), "module id out of range")
+    check(raises(IndexError, builder.create_op_node, cell, "t", "and", 8, False, [(99, 0)]),
+          "input node out of range")
+    check(raises(IndexError, builder.create_module_output, cell, "t", 8, False, 0, 5),
+          "input port out of range")
+    check(raises(IndexError, builder.set_node_input, cell, 2, 2, (0, 0)),
+          "fanin index out of range")
+    check(raises(IndexError, builder.set_node_input, cell, 99, 0, (0, 0)),
+          "set_node_input node out of range")
+    check(raises(IndexError, builder.create_merge_node, top, "m", 2, False, [(0, 0)], [1, 1]),
+          "merge inputs and widths differ in length")
+    check(raises(IndexError, builder.create_instance, top, "v", 99, [], []),
+          "instantiated module out of range")
+    check(raises(ValueError, builder.create_const_node, top, "c", 2, False, "12"),
+          "constant digits are checked")
+    check(raises(ValueError, builder.create_const_node, top, "c", 2, False, "1"),
+          "constant width is checked")
+    check(design.module(cell).num_nodes == 4 and design.module(top).num_nodes == 5,
+          "refused calls leave the design alone")
+
+
+def check_frontend():
+    fixtures = os.environ.get("ABYS_FIXTURES_DIR")
+    if not fixtures:
+        return
+    options = abys.FrontendOptions()
+    options.lowering_threads = 2
+    result = abys.build_tig_from_systemverilog([os.path.join(fixtures, "hier.sv")], "top",
+                                               options)
+    check(result.ok, f"build: {result.message}")
+    design = result.design
+    check(design.find_module("full_adder") is not None, "lowered full_adder")
+
+    # Parsing and lowering release the GIL; a Python thread running alongside
+    # must neither stall them nor be stalled.
+    ticks = []
+    stop = threading.Event()
+
+    def tick():
+        while not stop.is_set():
+            ticks.append(1)
+            stop.wait(0.001)
+
+    ticker = threading.Thread(target=tick)
+    ticker.start()
+    session = abys.FrontendSession()
+    parsed = session.load([os.path.join(fixtures, "hier.sv")], "top")
+    built = session.build_tig()
+    stop.set()
+    ticker.join()
+    check(parsed.ok and session.ok and built.ok, "session load and build")
+    check(session.top_modules() == ["top"], "top modules")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "hier.tig")
+        check(abys.write_tig_snapshot(design, path).ok, "write snapshot")
+        loaded = abys.read_tig_snapshot(path)
+        check(loaded.ok and len(loaded.design) == len(design), "read snapshot")
+
+
+check_columns()
+check_builder_errors()
+check_frontend()
+if failures == 0:
+    print("python bindings ok")
+sys.exit(1 if failures else 0)
@@ -0,0 +1,108 @@
+#include "abys/aig/aig.h"
+
+#include <utility>
+
+namespace abys::aig {
+
+Aig::Aig() {
+  // Variable 0 is the constant; its fanins are never read.
+  fanins_ = {kFalse, kFalse};
+  table_.assign(16, kEmptySlot);
+}
+
+void Aig::reserve(size_t num_vars) {
+  fanins_.reserve(2 * num_vars);
+  while (table_.size() < 2 * num_vars) {
+    grow_table();
+  }
+}
+
+Literal Aig::create_input() {
+  const Var var = num_vars();
+  fanins_.push_back(kNoFanin);
+  fanins_.push_back(kNoFanin);
+  inputs_.push_back(var);
+  return make_literal(var);
+}
+
+size_t Aig::add_output(Literal lit) {
+  outputs_.push_back(lit);
+  return outputs_.size() - 1;
+}
+
+size_t Aig::slot_of(Literal a, Literal b) const {
+  const uint64_t key = (uint64_t{a} << 32) | b;
+  return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32) & (table_.size() - 1);
+}
+
+void Aig::grow_table() {
+  std::vector<Var> old = std::move(table_);
+  table_.assign(old.size() * 2, kEmptySlot);
+  const size_t mask = table_.size() - 1;
+  for (const Var var : old) {
+    if (var != kEmptySlot) {
+      size_t slot = slot_of(fanin0(var), fanin1(var));
+      while (table_[slot] != kEmptySlot) {
+        slot = (slot + 1) & mask;
+      }
+      table_[slot] = var;
+    }
+  }
+}
+
+Literal Aig::create_and(Literal a, Literal b) {
+  if (a > b) {
+    std::swap(a, b);
+  }
+  if (a == kFalse || a == negate(b)) {
+    strash_hits_++;
+    return kFalse;
+  }
+  if (a == kTrue || a == b) {
+    strash_hits_++;
+    return b;
+  }
+
+  const size_t mask = table_.size() - 1;
+  size_t slot = slot_of(a, b);
+  for (; table_[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+    const Var var = table_[slot];
+    if (fanin0(var) == a && fanin1(var) == b) {
+      strash_hits_++;
+      return make_literal(var);
+    }
+  }
+
+  const Var var = num_vars();
+  fanins_.push_back(a);
+  fanins_.push_back(b);
+  table_[slot] = var;
+  if (++num_table_entries_ * 2 > table_.size()) {
+    grow_table();
+  }
+  return make_literal(var);
+}
+
+Literal Aig::create_xor(Literal a, Literal b) {
+  // Complements are pulled out so that a ^ b, !a ^ !b and their negations
+  // share one pair of ANDs.
+  const bool complement = is_complemented(a) != is_complemented(b);
+  a &= ~1u;
+  b &= ~1u;
+  const Literal both = create_and(a, b);
+  const Literal neither = create_and(negate(a), negate(b));
+  return negate_if(create_and(negate(both), negate(neither)), complement);
+}
+
+Literal Aig::create_mux(Literal s, Literal t, Literal e) {
+  if (t == e) {
+    return t;
+  }
+  return create_or(create_and(s, t), create_and(negate(s), e));
+}
+
+Literal Aig::create_majority(Literal a, Literal b, Literal c) {
+  return create_or(create_and(a, b), create_and(c, create_or(a, b)));
+}
+
+} // namespace abys::aig
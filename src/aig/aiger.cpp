@@ -0,0 +1,653 @@
+#include "abys/aig/aiger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "abys/aig/bit_blast.h"
+#include "abys/util/parallel.h"
+#include "abys/util/profile.h"
+#include "abys/version.h"
+
+namespace abys::aig {
+
+namespace {
+
+using ir::kEmptyName;
+using ir::NameId;
+using ir::Tig;
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+
+// Longest decimal of a 64-bit number.
+constexpr size_t kMaxDigits = 20;
+// A 32-bit delta takes at most five 7-bit groups.
+constexpr size_t kMaxDeltaBytes = 5;
+// Inputs take no bytes in a binary AIGER file, so unlike ANDs and outputs
+// their number cannot be checked against its size; this bounds what a short
+// header can make the reader allocate.
+constexpr uint64_t kMaxInputs = uint64_t{1} << 24;
+
+char *put_number(char *p, uint64_t x) { return std::to_chars(p, p + kMaxDigits, x).ptr; }
+
+char *put_delta(char *p, uint32_t x) {
+  while (x >= 0x80) {
+    *p++ = static_cast<char>((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  *p++ = static_cast<char>(x);
+  return p;
+}
+
+char *put_text(char *p, std::string_view s) {
+  s.copy(p, s.size());
+  return p + s.size();
+}
+
+struct FileCloser {
+  void operator()(std::FILE *f) const { std::fclose(f); }
+};
+
+// Reads the sections of a binary AIGER file in order.
+class Reader {
+public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool at_end() const { return pos_ >= data_.size(); }
+
+  // The rest of the current line, without its newline, or nothing at the end.
+  std::optional<std::string_view> line() {
+    if (at_end()) {
+      return std::nullopt;
+    }
+    const size_t end = data_.find('\n', pos_);
+    const size_t stop = end == std::string_view::npos ? data_.size() : end;
+    const std::string_view text = data_.substr(pos_, stop - pos_);
+    pos_ = stop + 1;
+    return text;
+  }
+
+  // One delta, or nothing if the data ends inside it or it overflows.
+  std::optional<uint32_t> delta() {
+    uint32_t x = 0;
+    for (unsigned shift = 0; shift < 7 * kMaxDeltaBytes; shift += 7) {
+      if (at_end()) {
+        return std::nullopt;
+      }
+      const auto byte = static_cast<uint8_t>(data_[pos_++]);
+      if (shift == 28 && byte > 0x0f) {
+        return std::nullopt;
+      }
+      x |= uint32_t{byte & 0x7fu} << shift;
+      if (!(byte & 0x80)) {
+        return x;
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+// Whitespace-separated unsigned numbers of `text`, or nothing if any is not.
+std::optional<std::vector<uint64_t>> parse_numbers(std::string_view text) {
+  std::vector<uint64_t> numbers;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    if (text[pos] == ' ') {
+      pos++;
+      continue;
+    }
+    uint64_t x = 0;
+    const auto [end, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), x);
+    if (ec != std::errc() || (end != text.data() + text.size() && *end != ' ')) {
+      return std::nullopt;
+    }
+    numbers.push_back(x);
+    pos = static_cast<size_t>(end - text.data());
+  }
+  return numbers;
+}
+
+// `base[bit]` split into base and bit; other names come back whole, with no bit.
+std::pair<std::string_view, std::optional<uint64_t>> split_bit(std::string_view symbol) {
+  const size_t open = symbol.rfind('[');
+  if (open == std::string_view::npos || open == 0 || symbol.size() < open + 3 ||
+      symbol.back() != ']') {
+    return {symbol, std::nullopt};
+  }
+  uint64_t bit = 0;
+  const char *first = symbol.data() + open + 1;
+  const char *last = symbol.data() + symbol.size() - 1;
+  const auto [end, ec] = std::from_chars(first, last, bit);
+  if (ec != std::errc() || end != last) {
+    return {symbol, std::nullopt};
+  }
+  return {symbol.substr(0, open), bit};
+}
+
+// Runs of symbols `base[0]`, `base[1]`, ... as {first index, width, name}.
+struct PortGroup {
+  size_t first = 0;
+  uint64_t width = 0;
+  std::string name;
+};
+
+std::vector<PortGroup> group_ports(size_t count, const std::vector<std::string> &symbols,
+                                   char prefix) {
+  std::vector<PortGroup> groups;
+  std::unordered_set<std::string> used;
+  auto unique = [&](std::string name, size_t first) {
+    if (name.empty() || used.count(name)) {
+      name = prefix + std::to_string(first);
+      while (used.count(name)) {
+        name += '_';
+      }
+    }
+    used.insert(name);
+    return name;
+  };
+  size_t i = 0;
+  while (i < count) {
+    const std::string_view symbol = i < symbols.size() ? std::string_view(symbols[i]) : "";
+    const auto [base, bit] = split_bit(symbol);
+    size_t end = i + 1;
+    if (bit == 0) {
+      while (end < count && end < symbols.size()) {
+        const auto [next_base, next_bit] = split_bit(symbols[end]);
+        if (next_base != base || next_bit != end - i) {
+          break;
+        }
+        end++;
+      }
+    }
+    const std::string_view name = bit == 0 ? base : symbol;
+    groups.push_back({i, end - i, unique(std::string(name), i)});
+    i = end;
+  }
+  return groups;
+}
+
+// Appends the symbols of every bit of a signal `width` wide named `base`.
+void add_bits(std::vector<std::string> &symbols, const std::string &base, uint64_t width) {
+  if (width == 1) {
+    symbols.push_back(base);
+    return;
+  }
+  for (uint64_t b = 0; b < width; b++) {
+    symbols.push_back(base + '[' + std::to_string(b) + ']');
+  }
+}
+
+// Symbols for the inputs and outputs bit_blast_module() gives `module_id`, in
+// its order.
+AigerSymbols module_symbols(const Tig &design, Tig::ModuleId module_id) {
+  const Module &module = design.modules[module_id];
+  AigerSymbols symbols;
+  auto node_name = [&](Tig::NodeId n, size_t port) {
+    const NameId name = module.node_outputs(n)[port].name;
+    if (name != kEmptyName) {
+      return std::string(design.names.view(name));
+    }
+    return "_n" + std::to_string(n) + (port == 0 ? "" : "_" + std::to_string(port));
+  };
+  auto add_outputs_of = [&](Tig::NodeId n) {
+    const auto outputs = module.node_outputs(n);
+    for (size_t port = 0; port < outputs.size(); port++) {
+      add_bits(symbols.inputs, node_name(n, port), outputs[port].width);
+    }
+  };
+  auto fanin_width = [&](const EdgeRef &fanin) {
+    return module.node_outputs(fanin.node_id)[fanin.port_idx].width;
+  };
+
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.kind(n) == NodeKind::kPi) {
+      add_outputs_of(n);
+    }
+  }
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.kind(n) == NodeKind::kRo || module.kind(n) == NodeKind::kInstance) {
+      add_outputs_of(n);
+    }
+  }
+  size_t po = 0;
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.kind(n) != NodeKind::kPo) {
+      continue;
+    }
+    const std::string port = po < module.output_ports.size()
+                                 ? std::string(design.names.view(module.output_ports[po].name))
+                                 : "_n" + std::to_string(n);
+    po++;
+    for (const EdgeRef &fanin : module.node_fanins(n)) {
+      add_bits(symbols.outputs, port, fanin_width(fanin));
+    }
+  }
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    const NodeKind kind = module.kind(n);
+    if (kind != NodeKind::kRi && kind != NodeKind::kInstance) {
+      continue;
+    }
+    const Module *child = nullptr;
+    std::string prefix = "_n" + std::to_string(n);
+    if (kind == NodeKind::kInstance) {
+      const Module::NodeAttrs *attrs = module.find_attrs(n);
+      if (attrs && attrs->module_id < design.modules.size()) {
+        child = &design.modules[attrs->module_id];
+      }
+      if (attrs && attrs->name != kEmptyName) {
+        prefix = std::string(design.names.view(attrs->name));
+      }
+    }
+    const auto fanins = module.node_fanins(n);
+    for (size_t i = 0; i < fanins.size(); i++) {
+      std::string base = prefix;
+      if (child && i < child->input_ports.size()) {
+        base += '.' + std::string(design.names.view(child->input_ports[i].name));
+      } else if (kind == NodeKind::kInstance || fanins.size() > 1) {
+        base += '.' + std::to_string(i);
+      }
+      add_bits(symbols.outputs, base, fanin_width(fanins[i]));
+    }
+  }
+  return symbols;
+}
+
+// A file name for every module: its name with anything but letters, digits,
+// `_`, `-` and `.` replaced, and the module id added, as often as needed,
+// where two would clash.
+std::vector<std::string> module_paths(const Tig &design, const std::filesystem::path &dir) {
+  std::vector<std::string> paths;
+  paths.reserve(design.modules.size());
+  std::unordered_set<std::string> used;
+  for (Tig::ModuleId m = 0; m < design.modules.size(); m++) {
+    std::string stem(design.names.view(design.modules[m].name));
+    for (char &c : stem) {
+      const bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                         (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+      c = plain ? c : '_';
+    }
+    if (stem.empty() || stem.front() == '.') {
+      stem += '_' + std::to_string(m);
+    }
+    // Stems are compared without case, for case-insensitive file systems, and
+    // until one is free: `a_2` may itself be taken.
+    auto key = [](std::string text) {
+      std::transform(text.begin(), text.end(), text.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      return text;
+    };
+    while (!used.insert(key(stem)).second) {
+      stem += '_' + std::to_string(m);
+    }
+    paths.push_back((dir / (stem + ".aig")).string());
+  }
+  return paths;
+}
+
+// Encoding buffers, at most one per thread, handed from module to module.
+class BufferPool {
+public:
+  std::vector<char> acquire() {
+    std::lock_guard lock(mutex_);
+    if (free_.empty()) {
+      return {};
+    }
+    std::vector<char> buffer = std::move(free_.back());
+    free_.pop_back();
+    return buffer;
+  }
+
+  void release(std::vector<char> buffer) {
+    std::lock_guard lock(mutex_);
+    free_.push_back(std::move(buffer));
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::vector<char>> free_;
+};
+
+} // namespace
+
+size_t encode_aiger(const Aig &aig, const AigerSymbols &symbols, std::vector<char> &buffer) {
+  const Var num_vars = aig.num_vars();
+  const auto inputs = aig.inputs();
+  const auto outputs = aig.outputs();
+  const size_t num_ands = aig.num_ands();
+
+  // AIGER numbers inputs before ANDs. AIGs built input first, as the
+  // bit-blaster's are, already do, and need no renumbering.
+  bool renumber = false;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    renumber = renumber || inputs[i] != i + 1;
+  }
+  std::vector<Var> vars;
+  if (renumber) {
+    vars.assign(num_vars, 0);
+    Var next = 1;
+    for (const Var var : inputs) {
+      vars[var] = next++;
+    }
+    for (Var var = 1; var < num_vars; var++) {
+      if (aig.is_and(var)) {
+        vars[var] = next++;
+      }
+    }
+  }
+  auto literal = [&](Literal lit) {
+    return renumber ? make_literal(vars[literal_var(lit)], is_complemented(lit)) : lit;
+  };
+
+  const std::string comment = "c\nabys " + version() + "\n";
+  const size_t num_input_symbols = std::min(symbols.inputs.size(), inputs.size());
+  const size_t num_output_symbols = std::min(symbols.outputs.size(), outputs.size());
+  size_t bound = 4 + 5 * (kMaxDigits + 1) + outputs.size() * (kMaxDigits + 1) +
+                 num_ands * 2 * kMaxDeltaBytes + comment.size();
+  for (size_t i = 0; i < num_input_symbols; i++) {
+    bound += kMaxDigits + 3 + symbols.inputs[i].size();
+  }
+  for (size_t i = 0; i < num_output_symbols; i++) {
+    bound += kMaxDigits + 3 + symbols.outputs[i].size();
+  }
+  if (buffer.size() < bound) {
+    buffer.resize(bound);
+  }
+
+  char *const start = buffer.data();
+  char *p = put_text(start, "aig ");
+  for (const uint64_t x : {uint64_t{num_vars - 1}, uint64_t{inputs.size()}, uint64_t{0},
+                           uint64_t{outputs.size()}, uint64_t{num_ands}}) {
+    p = put_number(p, x);
+    *p++ = ' ';
+  }
+  p[-1] = '\n';
+  for (const Literal lit : outputs) {
+    p = put_number(p, literal(lit));
+    *p++ = '\n';
+  }
+  Var lhs_var = static_cast<Var>(inputs.size());
+  for (Var var = 1; var < num_vars; var++) {
+    if (!aig.is_and(var)) {
+      continue;
+    }
+    const Literal lhs = make_literal(++lhs_var);
+    Literal rhs0 = literal(aig.fanin0(var));
+    Literal rhs1 = literal(aig.fanin1(var));
+    if (rhs0 < rhs1) {
+      std::swap(rhs0, rhs1);
+    }
+    p = put_delta(p, lhs - rhs0);
+    p = put_delta(p, rhs0 - rhs1);
+  }
+  auto put_symbols = [&](char kind, const std::vector<std::string> &names, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      if (names[i].empty()) {
+        continue;
+      }
+      *p++ = kind;
+      p = put_number(p, i);
+      *p++ = ' ';
+      p = put_text(p, names[i]);
+      *p++ = '\n';
+    }
+  };
+  put_symbols('i', symbols.inputs, num_input_symbols);
+  put_symbols('o', symbols.outputs, num_output_symbols);
+  p = put_text(p, comment);
+  return static_cast<size_t>(p - start);
+}
+
+AigerReadResult decode_aiger(std::string_view data) {
+  AigerReadResult result;
+  result.bytes_read = data.size();
+  auto fail = [&](std::string message) {
+    result.message = std::move(message);
+    return std::move(result);
+  };
+
+  Reader reader(data);
+  const auto header = reader.line();
+  if (!header || header->substr(0, 4) != "aig ") {
+    return fail(header && header->substr(0, 4) == "aag "
+                    ? "ASCII AIGER is not supported; write binary AIGER"
+                    : "not a binary AIGER file");
+  }
+  const auto numbers = parse_numbers(header->substr(4));
+  if (!numbers || numbers->size() < 5) {
+    return fail("malformed AIGER header");
+  }
+  const uint64_t max_var = (*numbers)[0];
+  const uint64_t num_inputs = (*numbers)[1];
+  const uint64_t num_latches = (*numbers)[2];
+  const uint64_t num_outputs = (*numbers)[3];
+  const uint64_t num_ands = (*numbers)[4];
+  if (num_latches != 0) {
+    return fail("latches are not supported");
+  }
+  for (size_t i = 5; i < numbers->size(); i++) {
+    if ((*numbers)[i] != 0) {
+      return fail("bad states, constraints and properties are not supported");
+    }
+  }
+  if (max_var >= (uint64_t{1} << 31) - 1 || max_var != num_inputs + num_ands) {
+    return fail("AIGER header does not add up: M must be I + A");
+  }
+  if (num_inputs > kMaxInputs) {
+    return fail("AIGER file has " + std::to_string(num_inputs) + " inputs, more than the " +
+                std::to_string(kMaxInputs) + " supported");
+  }
+
+  // Every output line and every AND's two deltas take at least two bytes.
+  if (num_outputs > data.size() || num_ands > data.size()) {
+    return fail("AIGER file is truncated");
+  }
+  std::vector<uint64_t> output_literals;
+  output_literals.reserve(num_outputs);
+  for (uint64_t o = 0; o < num_outputs; o++) {
+    const auto line = reader.line();
+    const auto lit = line ? parse_numbers(*line) : std::nullopt;
+    if (!lit || lit->size() != 1 || (*lit)[0] > 2 * max_var + 1) {
+      return fail("malformed output " + std::to_string(o));
+    }
+    output_literals.push_back((*lit)[0]);
+  }
+
+  Aig &aig = result.aig;
+  aig.reserve(max_var + 1);
+  // Our literal for each of the file's variables.
+  std::vector<Literal> lits(max_var + 1, kFalse);
+  for (uint64_t i = 1; i <= num_inputs; i++) {
+    lits[i] = aig.create_input();
+  }
+  auto ours = [&](uint64_t lit) { return negate_if(lits[lit >> 1], (lit & 1) != 0); };
+  for (uint64_t a = 0; a < num_ands; a++) {
+    const uint64_t lhs = 2 * (num_inputs + a + 1);
+    const auto delta0 = reader.delta();
+    const auto delta1 = reader.delta();
+    if (!delta0 || !delta1 || *delta0 == 0 || *delta0 > lhs || *delta1 > lhs - *delta0) {
+      return fail("malformed AND " + std::to_string(a));
+    }
+    const uint64_t rhs0 = lhs - *delta0;
+    lits[lhs >> 1] = aig.create_and(ours(rhs0), ours(rhs0 - *delta1));
+  }
+  for (const uint64_t lit : output_literals) {
+    aig.add_output(ours(lit));
+  }
+
+  while (const auto line = reader.line()) {
+    if (line->empty() || line->front() == 'c') {
+      break;
+    }
+    const char kind = line->front();
+    const size_t space = line->find(' ');
+    uint64_t index = 0;
+    const char *first = line->data() + 1;
+    const char *last = line->data() + (space == std::string_view::npos ? line->size() : space);
+    if ((kind != 'i' && kind != 'o') || space == std::string_view::npos ||
+        std::from_chars(first, last, index).ptr != last ||
+        index >= (kind == 'i' ? num_inputs : num_outputs)) {
+      return fail("malformed symbol: " + std::string(*line));
+    }
+    auto &names = kind == 'i' ? result.symbols.inputs : result.symbols.outputs;
+    if (names.empty()) {
+      names.resize(kind == 'i' ? num_inputs : num_outputs);
+    }
+    names[index] = std::string(line->substr(space + 1));
+  }
+  result.ok = true;
+  result.message = "ok";
+  return result;
+}
+
+AigerReadResult read_aiger(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    AigerReadResult result;
+    result.message = "failed to open " + path;
+    return result;
+  }
+  const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  AigerReadResult result = decode_aiger(data);
+  if (!result.ok) {
+    result.message = path + ": " + result.message;
+  }
+  return result;
+}
+
+Tig::ModuleId build_aiger_module(ir::TigBuilder &builder, std::string_view name, const Aig &aig,
+                                 const AigerSymbols &symbols) {
+  using Signal = ir::TigBuilder::Signal;
+  using SignalSpec = ir::TigBuilder::SignalSpec;
+  const Tig::ModuleId m = builder.create_module(name);
+  const NameId and_op = builder.intern("and");
+  const NameId not_op = builder.intern("not");
+
+  // The signal of every variable, and of its complement once one is needed.
+  std::vector<Signal> vars(aig.num_vars());
+  std::vector<Signal> complements(aig.num_vars());
+  Signal constants[2];
+  auto signal = [&](Literal lit) -> Signal {
+    const Var var = literal_var(lit);
+    if (aig.is_constant(var)) {
+      Signal &constant = constants[lit];
+      if (constant.node_id == Tig::kInvalidNodeId) {
+        const std::string_view value = lit == kTrue ? "1" : "0";
+        constant = {builder.create_const_node(m, kEmptyName, 1, false, value), 0};
+      }
+      return constant;
+    }
+    if (!is_complemented(lit)) {
+      return vars[var];
+    }
+    Signal &complement = complements[var];
+    if (complement.node_id == Tig::kInvalidNodeId) {
+      const Signal input[] = {vars[var]};
+      complement = {builder.create_op_node(m, kEmptyName, not_op, 1, false, input), 0};
+    }
+    return complement;
+  };
+
+  const auto inputs = aig.inputs();
+  for (const PortGroup &group : group_ports(inputs.size(), symbols.inputs, 'i')) {
+    const Tig::NodeId pi =
+        builder.create_module_input(m, builder.intern(group.name), group.width, false);
+    if (group.width == 1) {
+      vars[inputs[group.first]] = {pi, 0};
+      continue;
+    }
+    const std::vector<SignalSpec> bits(group.width, SignalSpec{kEmptyName, 1, false});
+    const Tig::NodeId split = builder.create_split_node(m, pi, 0, bits);
+    for (uint64_t b = 0; b < group.width; b++) {
+      vars[inputs[group.first + b]] = {split, static_cast<Tig::PortIndex>(b)};
+    }
+  }
+  for (Var var = 1; var < aig.num_vars(); var++) {
+    if (aig.is_and(var)) {
+      const Signal fanins[] = {signal(aig.fanin0(var)), signal(aig.fanin1(var))};
+      vars[var] = {builder.create_op_node(m, kEmptyName, and_op, 1, false, fanins), 0};
+    }
+  }
+
+  const auto outputs = aig.outputs();
+  for (const PortGroup &group : group_ports(outputs.size(), symbols.outputs, 'o')) {
+    Signal driver = signal(outputs[group.first]);
+    if (group.width > 1) {
+      std::vector<Signal> bits;
+      bits.reserve(group.width);
+      for (uint64_t b = 0; b < group.width; b++) {
+        bits.push_back(signal(outputs[group.first + b]));
+      }
+      const std::vector<Tig::SignalWidth> widths(group.width, 1);
+      driver = {builder.create_merge_node(m, kEmptyName, group.width, false, bits, widths), 0};
+    }
+    builder.create_module_output(m, builder.intern(group.name), group.width, false,
+                                 driver.node_id, driver.port_idx);
+  }
+  return m;
+}
+
+AigerWriteResult write_aiger(const Tig &design, const std::string &dir,
+                             const AigerWriteOptions &options) {
+  AigerWriteResult result;
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    result.message = "failed to create " + dir + ": " + ec.message();
+    return result;
+  }
+  result.paths = module_paths(design, dir);
+
+  const size_t n = design.modules.size();
+  std::vector<std::string> errors(n);
+  std::vector<uint64_t> bytes(n, 0);
+  BufferPool buffers;
+  util::parallel_for(n, options.num_threads, [&](size_t m) {
+    const auto id = static_cast<Tig::ModuleId>(m);
+    const std::string_view name = design.names.view(design.modules[m].name);
+    util::ScopedTimer timer("write aiger", name);
+    BlastedModule blasted;
+    if (const auto blast = bit_blast_module(design, id, blasted); !blast.ok) {
+      errors[m] = "module " + std::string(name) + ": " + blast.message;
+      return;
+    }
+    const AigerSymbols symbols = options.symbols ? module_symbols(design, id) : AigerSymbols{};
+    std::vector<char> buffer = buffers.acquire();
+    const size_t size = encode_aiger(blasted.aig, symbols, buffer);
+    std::unique_ptr<std::FILE, FileCloser> file(std::fopen(result.paths[m].c_str(), "wb"));
+    if (!file || std::fwrite(buffer.data(), 1, size, file.get()) != size ||
+        std::fclose(file.release()) != 0) {
+      errors[m] = "failed to write " + result.paths[m];
+    }
+    bytes[m] = size;
+    buffers.release(std::move(buffer));
+  });
+
+  for (size_t m = 0; m < n; m++) {
+    result.bytes_written += errors[m].empty() ? bytes[m] : 0;
+    if (!errors[m].empty() && result.message.empty()) {
+      result.message = std::move(errors[m]);
+    }
+  }
+  result.ok = result.message.empty();
+  if (result.ok) {
+    result.message = "ok";
+  }
+  return result;
+}
+
+} // namespace abys::aig
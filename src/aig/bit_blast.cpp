@@ -0,0 +1,353 @@
+#include "abys/aig/bit_blast.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace abys::aig {
+
+namespace {
+
+using ir::Tig;
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+using Bits = std::vector<Literal>;
+
+// Thrown for designs the blaster cannot handle; turned into a BitBlastResult.
+struct BlastError : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+Bits resize(Bits bits, uint64_t width, bool sign) {
+  const Literal fill = sign && !bits.empty() ? bits.back() : kFalse;
+  bits.resize(width, fill);
+  return bits;
+}
+
+class Blaster {
+public:
+  Blaster(const Tig &design, const Module &module, BlastedModule &out)
+      : design_(design), module_(module), out_(out), aig_(out.aig) {}
+
+  void run() {
+    size_t total = 0;
+    out_.bit_offsets.assign(module_.outputs.size() + 1, 0);
+    for (size_t i = 0; i < module_.outputs.size(); i++) {
+      total += module_.outputs[i].width;
+      out_.bit_offsets[i + 1] = total;
+    }
+    out_.bits.assign(total, kFalse);
+    state_.assign(module_.num_nodes(), kUnvisited);
+
+    // Sources first, so that input numbering follows the documented order.
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) == NodeKind::kPi) {
+        make_inputs(n);
+      }
+    }
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) == NodeKind::kRo || module_.kind(n) == NodeKind::kInstance) {
+        make_inputs(n);
+      }
+    }
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      evaluate(n);
+    }
+
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) == NodeKind::kPo) {
+        add_outputs(n);
+      }
+    }
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) == NodeKind::kRi || module_.kind(n) == NodeKind::kInstance) {
+        add_outputs(n);
+      }
+    }
+  }
+
+private:
+  enum State : uint8_t { kUnvisited, kActive, kDone };
+
+  std::string_view name(ir::NameId id) const { return design_.names.view(id); }
+
+  std::span<Literal> node_bits(Tig::NodeId n, size_t port) {
+    const size_t i = module_.output_offsets[n] + port;
+    return {out_.bits.data() + out_.bit_offsets[i], out_.bits.data() + out_.bit_offsets[i + 1]};
+  }
+
+  void make_inputs(Tig::NodeId n) {
+    for (size_t port = 0; port < module_.node_outputs(n).size(); port++) {
+      for (Literal &bit : node_bits(n, port)) {
+        bit = aig_.create_input();
+      }
+    }
+    state_[n] = kDone;
+  }
+
+  void add_outputs(Tig::NodeId n) {
+    for (const EdgeRef &fanin : module_.node_fanins(n)) {
+      for (const Literal bit : out_.signal_bits(module_, fanin)) {
+        aig_.add_output(bit);
+      }
+    }
+  }
+
+  const Module::Output &spec(const EdgeRef &edge) const {
+    return module_.node_outputs(edge.node_id)[edge.port_idx];
+  }
+
+  Bits operand(Tig::NodeId n, size_t i, uint64_t width, bool sign) const {
+    const EdgeRef edge = module_.node_fanins(n)[i];
+    const auto bits = out_.signal_bits(module_, edge);
+    return resize(Bits(bits.begin(), bits.end()), width, sign);
+  }
+
+  // Every node is blasted after its fanins. Sources are already done; nodes
+  // that only consume (outputs, register inputs, instances) need no bits.
+  void evaluate(Tig::NodeId root) {
+    std::vector<Tig::NodeId> stack{root};
+    while (!stack.empty()) {
+      const Tig::NodeId n = stack.back();
+      if (state_[n] == kDone) {
+        stack.pop_back();
+        continue;
+      }
+      if (state_[n] == kUnvisited) {
+        state_[n] = kActive;
+        for (const EdgeRef &fanin : module_.node_fanins(n)) {
+          if (fanin.node_id == Tig::kInvalidNodeId) {
+            throw BlastError("node " + std::to_string(n) + " has an unconnected input");
+          }
+          if (state_[fanin.node_id] == kActive) {
+            throw BlastError("combinational cycle through node " + std::to_string(n));
+          }
+          if (state_[fanin.node_id] == kUnvisited) {
+            stack.push_back(fanin.node_id);
+          }
+        }
+        continue;
+      }
+      blast(n);
+      state_[n] = kDone;
+      stack.pop_back();
+    }
+  }
+
+  void blast(Tig::NodeId n) {
+    switch (module_.kind(n)) {
+    case NodeKind::kPo:
+    case NodeKind::kRi:
+      return;
+    case NodeKind::kConst:
+      return blast_const(n);
+    case NodeKind::kConvert: {
+      const auto &out = module_.node_outputs(n)[0];
+      const EdgeRef input = module_.node_fanins(n)[0];
+      store(n, 0, operand(n, 0, out.width, spec(input).sign));
+      return;
+    }
+    case NodeKind::kSplit:
+      return blast_split(n);
+    case NodeKind::kMerge:
+      return blast_merge(n);
+    case NodeKind::kOp:
+      return blast_op(n);
+    default:
+      throw BlastError("node " + std::to_string(n) + " has a kind the bit-blaster does not handle");
+    }
+  }
+
+  void store(Tig::NodeId n, size_t port, const Bits &bits) {
+    auto dst = node_bits(n, port);
+    std::copy_n(bits.begin(), dst.size(), dst.begin());
+  }
+
+  void blast_const(Tig::NodeId n) {
+    const ir::ConstView value = module_.node_const(n);
+    auto dst = node_bits(n, 0);
+    for (size_t i = 0; i < dst.size(); i++) {
+      dst[i] = i < value.width() && value.bit(i) == ir::Logic::k1 ? kTrue : kFalse;
+    }
+  }
+
+  void blast_split(Tig::NodeId n) {
+    const auto outputs = module_.node_outputs(n);
+    uint64_t total = 0;
+    for (const auto &out : outputs) {
+      total += out.width;
+    }
+    const EdgeRef input = module_.node_fanins(n)[0];
+    const Bits bits = operand(n, 0, total, spec(input).sign);
+    uint64_t offset = 0;
+    for (size_t port = 0; port < outputs.size(); port++) {
+      auto dst = node_bits(n, port);
+      std::copy_n(bits.begin() + static_cast<ptrdiff_t>(offset), dst.size(), dst.begin());
+      offset += dst.size();
+    }
+  }
+
+  void blast_merge(Tig::NodeId n) {
+    const auto widths = module_.node_segment_widths(n);
+    const auto fanins = module_.node_fanins(n);
+    Bits bits;
+    for (size_t i = 0; i < fanins.size(); i++) {
+      const Bits segment = operand(n, i, widths[i], spec(fanins[i]).sign);
+      bits.insert(bits.end(), segment.begin(), segment.end());
+    }
+    const auto &out = module_.node_outputs(n)[0];
+    store(n, 0, resize(std::move(bits), out.width, false));
+  }
+
+  Bits add(const Bits &a, const Bits &b, Literal carry) {
+    Bits sum(a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+      sum[i] = aig_.create_xor(aig_.create_xor(a[i], b[i]), carry);
+      carry = aig_.create_majority(a[i], b[i], carry);
+    }
+    return sum;
+  }
+
+  // Carry out of a + ~b + 1, i.e. a >= b unsigned.
+  Literal greater_equal(const Bits &a, const Bits &b) {
+    Literal carry = kTrue;
+    for (size_t i = 0; i < a.size(); i++) {
+      carry = aig_.create_majority(a[i], negate(b[i]), carry);
+    }
+    return carry;
+  }
+
+  Literal and_reduce(Bits bits) {
+    // Pairwise, for logarithmic depth.
+    if (bits.empty()) {
+      return kTrue;
+    }
+    while (bits.size() > 1) {
+      Bits next;
+      for (size_t i = 0; i + 1 < bits.size(); i += 2) {
+        next.push_back(aig_.create_and(bits[i], bits[i + 1]));
+      }
+      if (bits.size() % 2 != 0) {
+        next.push_back(bits.back());
+      }
+      bits = std::move(next);
+    }
+    return bits[0];
+  }
+
+  void blast_op(Tig::NodeId n) {
+    const auto *attrs = module_.find_attrs(n);
+    const std::string_view op = attrs ? name(attrs->op) : std::string_view();
+    const auto &out = module_.node_outputs(n)[0];
+    const auto fanins = module_.node_fanins(n);
+    const uint64_t w = out.width;
+    auto unary = [&] { return operand(n, 0, w, spec(fanins[0]).sign); };
+    auto binary = [&] {
+      return std::pair(operand(n, 0, w, spec(fanins[0]).sign),
+                       operand(n, 1, w, spec(fanins[1]).sign));
+    };
+    auto bitwise = [&](auto &&f) {
+      auto [a, b] = binary();
+      for (size_t i = 0; i < w; i++) {
+        a[i] = f(a[i], b[i]);
+      }
+      return a;
+    };
+
+    const size_t arity = fanins.size();
+    const bool is_unary = op == "not" || op == "neg";
+    if (arity != (is_unary ? 1u : 2u)) {
+      throw BlastError("op '" + std::string(op) + "' of node " + std::to_string(n) + " has " +
+                       std::to_string(arity) + " inputs");
+    }
+
+    Bits result;
+    if (op == "and") {
+      result = bitwise([&](Literal a, Literal b) { return aig_.create_and(a, b); });
+    } else if (op == "or") {
+      result = bitwise([&](Literal a, Literal b) { return aig_.create_or(a, b); });
+    } else if (op == "xor") {
+      result = bitwise([&](Literal a, Literal b) { return aig_.create_xor(a, b); });
+    } else if (op == "xnor") {
+      result = bitwise([&](Literal a, Literal b) { return aig_.create_xnor(a, b); });
+    } else if (op == "not") {
+      result = unary();
+      for (Literal &bit : result) {
+        bit = negate(bit);
+      }
+    } else if (op == "add") {
+      auto [a, b] = binary();
+      result = add(a, b, kFalse);
+    } else if (op == "sub" || op == "neg") {
+      auto [a, b] = op == "neg" ? std::pair(Bits(w, kFalse), unary()) : binary();
+      for (Literal &bit : b) {
+        bit = negate(bit);
+      }
+      result = add(a, b, kTrue);
+    } else if (op == "mul") {
+      // Shift-and-add, truncated to the result width.
+      auto [a, b] = binary();
+      result.assign(w, kFalse);
+      for (size_t i = 0; i < w; i++) {
+        Bits partial(w, kFalse);
+        for (size_t j = 0; i + j < w; j++) {
+          partial[i + j] = aig_.create_and(a[j], b[i]);
+        }
+        result = add(result, partial, kFalse);
+      }
+    } else if (op == "eq" || op == "ne" || op == "lt") {
+      // Operands are compared at their common width, signed only if both are.
+      const auto &sa = spec(fanins[0]);
+      const auto &sb = spec(fanins[1]);
+      const bool sign = sa.sign && sb.sign;
+      const uint64_t cw = std::max(sa.width, sb.width);
+      Bits a = operand(n, 0, cw, sign);
+      Bits b = operand(n, 1, cw, sign);
+      Literal bit;
+      if (op == "lt") {
+        if (sign && cw > 0) {
+          a.back() = negate(a.back());
+          b.back() = negate(b.back());
+        }
+        bit = negate(greater_equal(a, b));
+      } else {
+        for (size_t i = 0; i < cw; i++) {
+          a[i] = aig_.create_xnor(a[i], b[i]);
+        }
+        bit = negate_if(and_reduce(std::move(a)), op == "ne");
+      }
+      result.assign(w, kFalse);
+      if (w > 0) {
+        result[0] = bit;
+      }
+    } else {
+      throw BlastError("unsupported op '" + std::string(op) + "' on node " + std::to_string(n));
+    }
+    store(n, 0, result);
+  }
+
+  const Tig &design_;
+  const Module &module_;
+  BlastedModule &out_;
+  Aig &aig_;
+  std::vector<State> state_;
+};
+
+} // namespace
+
+BitBlastResult bit_blast_module(const ir::Tig &design, ir::Tig::ModuleId module_id,
+                                BlastedModule &out) {
+  if (module_id >= design.modules.size()) {
+    return {false, "no module " + std::to_string(module_id)};
+  }
+  try {
+    Blaster(design, design.modules[module_id], out).run();
+  } catch (const BlastError &e) {
+    return {false, e.what()};
+  }
+  return {true, "ok"};
+}
+
+} // namespace abys::aig
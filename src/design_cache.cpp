@@ -0,0 +1,207 @@
+#include "abys/design_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "abys/util/profile.h"
+
+namespace abys {
+
+namespace {
+
+// What a file looked like when an entry was loaded.
+struct FileStamp {
+  std::string path;
+  bool exists = false;
+  uintmax_t size = 0;
+  std::filesystem::file_time_type mtime;
+
+  bool operator==(const FileStamp &) const = default;
+};
+
+FileStamp stamp(const std::string &path) {
+  FileStamp s;
+  s.path = path;
+  std::error_code ec;
+  s.size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return s;
+  }
+  s.mtime = std::filesystem::last_write_time(path, ec);
+  s.exists = !ec;
+  return s;
+}
+
+std::vector<std::string> absolute_paths(const std::vector<std::string> &files) {
+  std::vector<std::string> out;
+  out.reserve(files.size());
+  for (const auto &file : files) {
+    std::error_code ec;
+    const auto path = std::filesystem::absolute(file, ec);
+    out.push_back(ec ? file : path.lexically_normal().string());
+  }
+  return out;
+}
+
+// Thread counts do not change the result and are left out.
+std::string key_of(const std::vector<std::string> &files, const std::optional<std::string> &top,
+                   const FrontendOptions &options) {
+  std::string key;
+  for (const auto &file : files) {
+    key += file;
+    key += '\0';
+  }
+  key += top ? "top:" + *top : "no top";
+  key += '\0';
+  key += options.hash_consing ? "hash-cons" : "";
+  key += '\0';
+  key += options.cache_dir;
+  return key;
+}
+
+} // namespace
+
+struct DesignCache::Entry {
+  std::string key;
+  std::vector<std::string> files;
+  std::optional<std::string> top;
+  FrontendOptions options;
+
+  std::unique_ptr<FrontendSession> session;
+  ParseResult loaded;
+  std::vector<FileStamp> stamps;
+
+  bool built = false;
+  ir::TigBuildResult build_result;
+  std::shared_ptr<const ir::Tig> design;
+  FrontendSession::BuildStats build_stats;
+
+  bool stale() const {
+    return std::any_of(stamps.begin(), stamps.end(),
+                       [](const FileStamp &s) { return stamp(s.path) != s; });
+  }
+
+  void reload() {
+    util::ScopedTimer timer("phase", "load resident design");
+    session = std::make_unique<FrontendSession>(options);
+    built = false;
+    build_result = {};
+    design.reset();
+    build_stats = {};
+    // The named files are stamped before parsing, so an edit made while slang
+    // reads them is seen by the next lookup; included files are only known
+    // afterwards.
+    std::vector<std::string> paths = files;
+    stamps.clear();
+    for (const auto &path : paths) {
+      stamps.push_back(stamp(path));
+    }
+    loaded = session->load(files, top);
+    for (const auto &path : session->source_files()) {
+      if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+        paths.push_back(path);
+        stamps.push_back(stamp(path));
+      }
+    }
+  }
+
+  void build() {
+    util::ScopedTimer timer("phase", "build resident tig");
+    build_result = session->build_tig();
+    build_stats = session->last_build_stats();
+    if (build_result.ok) {
+      design = std::make_shared<const ir::Tig>(std::move(build_result.design));
+      build_result.design = {};
+    }
+    built = true;
+  }
+};
+
+DesignCache::DesignCache(size_t max_designs) : max_designs_(std::max<size_t>(1, max_designs)) {}
+
+DesignCache::~DesignCache() = default;
+
+DesignCache::Entry &DesignCache::entry(const std::vector<std::string> &files,
+                                       const std::optional<std::string> &top,
+                                       const FrontendOptions &options, bool &warm) {
+  const auto paths = absolute_paths(files);
+  const std::string key = key_of(paths, top, options);
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [&](const auto &e) { return e->key == key; });
+  if (it != entries_.end()) {
+    // Most recently used goes last.
+    std::rotate(it, it + 1, entries_.end());
+    Entry &e = *entries_.back();
+    // Thread counts are taken from the latest request: lowering threads by the
+    // next build of this session, parse threads by the next reload.
+    e.options = options;
+    e.session->set_lowering_threads(options.lowering_threads);
+    warm = !e.stale();
+    if (!warm) {
+      e.reload();
+    }
+    return e;
+  }
+  if (entries_.size() >= max_designs_) {
+    entries_.erase(entries_.begin());
+  }
+  auto e = std::make_unique<Entry>();
+  e->key = key;
+  e->files = paths;
+  e->top = top;
+  e->options = options;
+  e->reload();
+  warm = false;
+  entries_.push_back(std::move(e));
+  return *entries_.back();
+}
+
+DesignCache::Lookup DesignCache::load(const std::vector<std::string> &files,
+                                      const std::optional<std::string> &top,
+                                      const FrontendOptions &options) {
+  Lookup lookup;
+  const Entry &e = entry(files, top, options, lookup.warm);
+  lookup.ok = e.loaded.ok;
+  lookup.message = e.loaded.message;
+  return lookup;
+}
+
+DesignCache::Lookup DesignCache::build(const std::vector<std::string> &files,
+                                       const std::optional<std::string> &top,
+                                       const FrontendOptions &options) {
+  Lookup lookup;
+  Entry &e = entry(files, top, options, lookup.warm);
+  if (!e.loaded.ok) {
+    lookup.message = e.loaded.message;
+    return lookup;
+  }
+  if (!e.built) {
+    e.build();
+    lookup.warm = false;
+  }
+  lookup.ok = e.build_result.ok;
+  lookup.message = e.build_result.message;
+  lookup.design = e.design;
+  lookup.build_stats = e.build_stats;
+  return lookup;
+}
+
+size_t DesignCache::refresh() {
+  size_t reloaded = 0;
+  for (auto &e : entries_) {
+    if (!e->stale()) {
+      continue;
+    }
+    const bool was_built = e->built;
+    e->reload();
+    if (was_built && e->loaded.ok) {
+      e->build();
+    }
+    reloaded++;
+  }
+  return reloaded;
+}
+
+} // namespace abys
@@ -1,58 +1,168 @@
 #include "abys/frontend.h"
 #include "abys/ir/lowering_slang.h"
+#include "abys/ir/module_cache.h"
 #include "abys/ir/tig.h"
 #include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_snapshot.h"
+#include "abys/util/hash.h"
+#include "abys/util/parallel.h"
+#include "abys/util/profile.h"
+#include "abys/version.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "slang/ast/symbols/ParameterSymbols.h"
 #include "slang/driver/Driver.h"
+#include "slang/text/SourceManager.h"
 
 namespace abys {
 
-ParseResult parse_systemverilog(const std::vector<std::string> &files,
-                                const std::optional<std::string> &top) {
-  if (files.empty()) {
-    return {false, "no input files provided"};
-  }
+namespace {
 
-  slang::driver::Driver driver;
+using Collector = ir::SlangModuleCollector<ir::TigBuilder>;
 
-  for (const auto &file : files) {
-    driver.sourceLoader.addFiles(file);
-  }
+uint64_t hash_text(std::string_view text, uint64_t seed = 0) {
+  return util::hash_bytes(text.data(), text.size(), seed);
+}
 
-  if (top && !top->empty()) {
-    driver.options.topModules.push_back(*top);
+// Key of every collected body, indexed like Collector::bodies(). It covers the
+// text of the file defining the module, its name and parameter values, the
+// keys of the modules it instantiates, and the text of every source that
+// defines no module (packages, includes), which any module may depend on, and
+// the lowering options that change the result.
+std::vector<uint64_t> module_keys(const Collector &collector,
+                                  const slang::SourceManager &source_manager,
+                                  const FrontendOptions &options) {
+  const auto &bodies = collector.bodies();
+
+  std::unordered_map<uint32_t, uint64_t> file_hashes;
+  for (const auto &[body, module_id] : bodies) {
+    const auto buffer = body->getDefinition().location.buffer();
+    if (!file_hashes.contains(buffer.getId())) {
+      file_hashes[buffer.getId()] = hash_text(source_manager.getSourceText(buffer));
+    }
+  }
+  uint64_t shared = hash_text(version(), ir::kTigSnapshotVersion);
+  shared = util::hash_combine(shared, options.hash_consing ? 1 : 0);
+  for (const auto buffer : source_manager.getAllBuffers()) {
+    if (!file_hashes.contains(buffer.getId())) {
+      shared = util::hash_combine(shared, hash_text(source_manager.getSourceText(buffer)));
+    }
   }
 
-  if (!driver.processOptions()) {
-    return {false, "failed to process slang options"};
+  const ir::Tig::ModuleId first_id = bodies.empty() ? 0 : bodies.front().second;
+  std::vector<uint64_t> keys(bodies.size());
+  std::vector<bool> done(bodies.size());
+  auto key_of = [&](auto &self, size_t i) -> uint64_t {
+    if (done[i]) {
+      return keys[i];
+    }
+    const auto &body = *bodies[i].first;
+    const auto &definition = body.getDefinition();
+    uint64_t key = util::hash_combine(shared, file_hashes[definition.location.buffer().getId()]);
+    key = hash_text(definition.name, key);
+    for (const auto *param : body.getParameters()) {
+      if (param->symbol.kind == slang::ast::SymbolKind::Parameter) {
+        const auto &value = param->symbol.as<slang::ast::ParameterSymbol>().getValue();
+        key = hash_text(value.toString(), key);
+      } else if (param->symbol.kind == slang::ast::SymbolKind::TypeParameter) {
+        const auto &type = param->symbol.as<slang::ast::TypeParameterSymbol>().targetType;
+        key = hash_text(type.getType().toString(), key);
+      }
+    }
+    for (const auto child : collector.children()[i]) {
+      key = util::hash_combine(key, self(self, child - first_id));
+    }
+    done[i] = true;
+    return keys[i] = key;
+  };
+  for (size_t i = 0; i < bodies.size(); i++) {
+    key_of(key_of, i);
   }
+  return keys;
+}
 
-  if (!driver.parseAllSources()) {
-    return {false, "failed to parse SystemVerilog sources"};
+// Like ir::lower_slang_ast_to_ir, but bodies whose key is in the cache are
+// loaded from it instead of being lowered, and fresh ones are stored.
+size_t lower_with_cache(const slang::ast::RootSymbol &root,
+                        const slang::SourceManager &source_manager, ir::TigBuilder &builder,
+                        const FrontendOptions &options) {
+  Collector collector(builder);
+  std::vector<uint64_t> keys;
+  {
+    util::ScopedTimer timer("phase", "collect modules");
+    root.visit(collector);
+    keys = module_keys(collector, source_manager, options);
   }
+  const auto &bodies = collector.bodies();
 
-  auto compilation = driver.createCompilation();
-  if (!compilation) {
-    return {false, "failed to create slang compilation"};
+  std::unordered_map<uint64_t, ir::Tig::ModuleId> module_ids;
+  std::unordered_map<ir::Tig::ModuleId, uint64_t> keys_by_id;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    module_ids.emplace(keys[i], bodies[i].second);
+    keys_by_id.emplace(bodies[i].second, keys[i]);
   }
 
-  driver.reportCompilation(*compilation, true);
-  if (driver.diagEngine.getNumErrors() > 0) {
-    return {false, "slang reported compilation errors"};
+  const ir::ModuleCache cache(options.cache_dir);
+  std::vector<ir::Tig> locals(bodies.size());
+  std::vector<char> hits(bodies.size());
+  {
+    util::ScopedTimer timer("phase", "lower modules");
+    util::parallel_for(bodies.size(), options.lowering_threads, [&](size_t i) {
+      const auto name = bodies[i].first->getDefinition().name;
+      {
+        util::ScopedTimer load_timer("cache load", name);
+        hits[i] = cache.load(keys[i], module_ids, locals[i]);
+      }
+      if (!hits[i]) {
+        ir::lower_slang_body<ir::TigBuilder>(*bodies[i].first, collector.module_ids(), locals[i],
+                                             options.hash_consing);
+        util::ScopedTimer store_timer("cache store", name);
+        cache.store(keys[i], locals[i], keys_by_id);
+      }
+    });
   }
 
-  return {true, "ok"};
+  util::ScopedTimer timer("phase", "adopt modules");
+  size_t cached = 0;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    cached += hits[i] ? 1 : 0;
+    builder.adopt_module(bodies[i].second, std::move(locals[i]));
+  }
+  return cached;
 }
 
-ir::TigBuildResult build_tig_from_systemverilog(const std::vector<std::string> &files,
-                                                const std::optional<std::string> &top) {
-  ir::Tig design;
+} // namespace
+
+struct FrontendSession::Impl {
+  slang::driver::Driver driver;
+  std::unique_ptr<slang::ast::Compilation> compilation;
+  bool loaded = false;
+  bool ok = false;
+};
+
+FrontendSession::FrontendSession(FrontendOptions options)
+    : options_(options), impl_(std::make_unique<Impl>()) {}
+
+FrontendSession::~FrontendSession() = default;
+FrontendSession::FrontendSession(FrontendSession &&other) noexcept = default;
+FrontendSession &FrontendSession::operator=(FrontendSession &&other) noexcept = default;
+
+ParseResult FrontendSession::load(const std::vector<std::string> &files,
+                                  const std::optional<std::string> &top) {
+  if (impl_->loaded) {
+    return {false, "frontend session is already loaded"};
+  }
+  impl_->loaded = true;
 
   if (files.empty()) {
-    return {false, "no input files provided", {}};
+    return {false, "no input files provided"};
   }
 
-  slang::driver::Driver driver;
+  auto &driver = impl_->driver;
 
   for (const auto &file : files) {
     driver.sourceLoader.addFiles(file);
@@ -62,28 +172,120 @@ ir::TigBuildResult build_tig_from_systemverilog(const std::vector<std::string> &
     driver.options.topModules.push_back(*top);
   }
 
+  // slang loads and parses the files on a thread pool of this size; it falls
+  // back to one thread when there are too few files to be worth it.
+  const unsigned parse_threads = util::resolve_num_threads(options_.parse_threads);
+  driver.options.numThreads = parse_threads;
+  util::count("parse threads", parse_threads);
+
   if (!driver.processOptions()) {
-    return {false, "failed to process slang options", {}};
+    return {false, "failed to process slang options"};
   }
 
-  if (!driver.parseAllSources()) {
-    return {false, "failed to parse SystemVerilog sources", {}};
+  {
+    util::ScopedTimer timer("phase", "parseAllSources");
+    if (!driver.parseAllSources()) {
+      return {false, "failed to parse SystemVerilog sources"};
+    }
   }
 
-  auto compilation = driver.createCompilation();
-  if (!compilation) {
-    return {false, "failed to create slang compilation", {}};
+  {
+    util::ScopedTimer timer("phase", "createCompilation");
+    impl_->compilation = driver.createCompilation();
+    if (!impl_->compilation) {
+      return {false, "failed to create slang compilation"};
+    }
   }
 
-  driver.reportCompilation(*compilation, true);
+  // Reporting also forces full elaboration, which lowering relies on.
+  {
+    util::ScopedTimer timer("phase", "reportCompilation");
+    driver.reportCompilation(*impl_->compilation, true);
+  }
   if (driver.diagEngine.getNumErrors() > 0) {
-    return {false, "slang reported compilation errors", {}};
+    return {false, "slang reported compilation errors"};
   }
 
+  impl_->ok = true;
+  return {true, "ok"};
+}
+
+bool FrontendSession::ok() const { return impl_->ok; }
+
+size_t FrontendSession::num_errors() const { return impl_->driver.diagEngine.getNumErrors(); }
+
+size_t FrontendSession::num_warnings() const {
+  return impl_->driver.diagEngine.getNumWarnings();
+}
+
+std::vector<std::string> FrontendSession::top_modules() const {
+  std::vector<std::string> names;
+  if (impl_->compilation) {
+    for (const auto *instance : impl_->compilation->getRoot().topInstances) {
+      names.emplace_back(instance->name);
+    }
+  }
+  return names;
+}
+
+std::vector<std::string> FrontendSession::source_files() const {
+  std::vector<std::string> files;
+  const auto &source_manager = impl_->driver.sourceManager;
+  for (const auto buffer : source_manager.getAllBuffers()) {
+    // Buffers slang made up itself, e.g. for macro expansions, have no path.
+    const auto &path = source_manager.getFullPath(buffer);
+    if (!path.empty()) {
+      files.push_back(path.string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+ir::TigBuildResult FrontendSession::build_tig() {
+  build_stats_ = {};
+  if (!impl_->ok) {
+    return {false, "frontend session has no elaborated design", {}};
+  }
+
+  ir::Tig design;
   ir::TigBuilder builder(design);
-  ir::lower_slang_ast_to_ir(compilation->getRoot(), builder);
+  builder.set_hash_consing(options_.hash_consing);
+  const auto &root = impl_->compilation->getRoot();
+  try {
+    if (options_.cache_dir.empty()) {
+      ir::lower_slang_ast_to_ir(root, builder, options_.lowering_threads);
+    } else {
+      build_stats_.cached_modules =
+          lower_with_cache(root, impl_->driver.sourceManager, builder, options_);
+    }
+  } catch (const std::logic_error &e) {
+    return {false, std::string("failed to lower design: ") + e.what(), {}};
+  }
+  build_stats_.modules = design.modules.size();
+  util::count("modules", static_cast<int64_t>(build_stats_.modules));
+  util::count("modules from cache", static_cast<int64_t>(build_stats_.cached_modules));
 
   return {true, "ok", std::move(design)};
 }
 
+ParseResult parse_systemverilog(const std::vector<std::string> &files,
+                                const std::optional<std::string> &top,
+                                const FrontendOptions &options) {
+  FrontendSession session(options);
+  return session.load(files, top);
+}
+
+ir::TigBuildResult build_tig_from_systemverilog(const std::vector<std::string> &files,
+                                                const std::optional<std::string> &top,
+                                                const FrontendOptions &options) {
+  FrontendSession session(options);
+  auto loaded = session.load(files, top);
+  if (!loaded.ok) {
+    return {false, std::move(loaded.message), {}};
+  }
+  return session.build_tig();
+}
+
 } // namespace abys
@@ -0,0 +1,231 @@
+#include "abys/ir/const_prop.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "abys/ir/pass_manager.h"
+#include "abys/ir/tig_builder.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+
+// OR `src` into `dst` starting at bit `at`; bits past `dst`'s width are lost.
+void place_bits(ConstValue &dst, uint64_t at, ConstValue &src) {
+  auto dv = dst.value_words();
+  auto du = dst.unknown_words();
+  const auto sv = src.value_words();
+  const auto su = src.unknown_words();
+  const unsigned shift = at % 64;
+  for (size_t i = 0; i < sv.size(); i++) {
+    const size_t w = at / 64 + i;
+    if (w >= dv.size()) {
+      break;
+    }
+    dv[w] |= sv[i] << shift;
+    du[w] |= su[i] << shift;
+    if (shift != 0 && w + 1 < dv.size()) {
+      dv[w + 1] |= sv[i] >> (64 - shift);
+      du[w + 1] |= su[i] >> (64 - shift);
+    }
+  }
+  dst.mask_top();
+}
+
+class ModuleFolder {
+public:
+  ModuleFolder(Tig &design, Tig::ModuleId module_id)
+      : design_(design), builder_(design), module_id_(module_id),
+        module_(&std::as_const(design).modules[module_id]) {}
+
+  ConstPropReport run() {
+    // Folding appends nodes and rewires edges, which patches the order in
+    // place; walk a copy.
+    const auto order = module_->topological_order();
+    const std::vector<Tig::NodeId> nodes(order.begin(), order.end());
+    std::vector<Tig::NodeId> folded_outputs(module_->outputs.size(), Tig::kInvalidNodeId);
+    for (const Tig::NodeId n : nodes) {
+      const NodeKind kind = module_->kind(n);
+      if (kind != NodeKind::kConvert && kind != NodeKind::kSplit && kind != NodeKind::kMerge &&
+          kind != NodeKind::kOp) {
+        continue;
+      }
+      // Nodes nothing reads or names, such as those an earlier run folded,
+      // gain nothing from a constant.
+      const auto outputs = module_->node_outputs(n);
+      if (module_->node_fanouts(n).empty() &&
+          std::all_of(outputs.begin(), outputs.end(),
+                      [](const Module::Output &out) { return out.name == kEmptyName; })) {
+        continue;
+      }
+      const auto fanins = module_->node_fanins(n);
+      if (std::any_of(fanins.begin(), fanins.end(), [&](const EdgeRef &fanin) {
+            return fanin.node_id == Tig::kInvalidNodeId ||
+                   module_->kind(fanin.node_id) != NodeKind::kConst;
+          })) {
+        continue;
+      }
+      std::vector<ConstValue> values = evaluate(n);
+      if (values.empty()) {
+        continue;
+      }
+      report_.folded_nodes++;
+      for (size_t port = 0; port < values.size(); port++) {
+        folded_outputs[module_->output_offsets[n] + port] = replace_output(n, port, values[port]);
+      }
+    }
+
+    if (report_.folded_nodes == 0) {
+      return report_;
+    }
+    // Names hash-consing gave the folded outputs besides their own.
+    for (auto &[name, edge] : edit().signal_map) {
+      if (edge.node_id == Tig::kInvalidNodeId) {
+        continue;
+      }
+      const size_t i = module_->output_offsets[edge.node_id] + edge.port_idx;
+      if (i >= folded_outputs.size()) {
+        continue;
+      }
+      if (const Tig::NodeId c = folded_outputs[i]; c != Tig::kInvalidNodeId) {
+        edge = {c, 0};
+      }
+    }
+    return report_;
+  }
+
+private:
+  // The module for writing. Until the first fold the module is only read, so
+  // one that nothing folds stays shared with copies of the design.
+  Module &edit() {
+    Module &module = design_.modules[module_id_];
+    module_ = &module;
+    return module;
+  }
+
+  ConstValue input(Tig::NodeId n, size_t i, uint64_t width) const {
+    const EdgeRef fanin = module_->node_fanins(n)[i];
+    return const_bits(module_->node_const(fanin.node_id), 0, width, spec(fanin).sign);
+  }
+
+  const Module::Output &spec(const EdgeRef &edge) const {
+    return module_->node_outputs(edge.node_id)[edge.port_idx];
+  }
+
+  // The value of every output of `n`, or nothing if it cannot be folded.
+  std::vector<ConstValue> evaluate(Tig::NodeId n) const {
+    const auto outputs = module_->node_outputs(n);
+    const auto fanins = module_->node_fanins(n);
+    std::vector<ConstValue> values;
+    switch (module_->kind(n)) {
+    case NodeKind::kConvert:
+      values.push_back(input(n, 0, outputs[0].width));
+      break;
+    case NodeKind::kSplit: {
+      uint64_t total = 0;
+      for (const auto &out : outputs) {
+        total += out.width;
+      }
+      const ConstValue whole = input(n, 0, total);
+      uint64_t offset = 0;
+      for (const auto &out : outputs) {
+        values.push_back(const_bits(whole, offset, out.width, false));
+        offset += out.width;
+      }
+      break;
+    }
+    case NodeKind::kMerge: {
+      const auto widths = module_->node_segment_widths(n);
+      ConstValue merged(outputs[0].width);
+      uint64_t offset = 0;
+      for (size_t i = 0; i < fanins.size() && offset < merged.width(); i++) {
+        ConstValue segment = input(n, i, widths[i]);
+        place_bits(merged, offset, segment);
+        offset += widths[i];
+      }
+      values.push_back(std::move(merged));
+      break;
+    }
+    case NodeKind::kOp: {
+      const auto *attrs = module_->find_attrs(n);
+      if (!attrs || fanins.empty() || fanins.size() > 2) {
+        break;
+      }
+      const bool binary = fanins.size() == 2;
+      const ConstView a = module_->node_const(fanins[0].node_id);
+      const ConstView b = binary ? module_->node_const(fanins[1].node_id) : ConstView();
+      auto value = evaluate_const_op(design_.names.view(attrs->op), outputs[0].width, a,
+                                     spec(fanins[0]).sign, binary ? &b : nullptr,
+                                     binary && spec(fanins[1]).sign);
+      if (value) {
+        values.push_back(std::move(*value));
+      }
+      break;
+    }
+    default:
+      break;
+    }
+    return values;
+  }
+
+  // Create the constant for output `port` of `n`, hand it the output's name
+  // and move the output's consumers over to it.
+  Tig::NodeId replace_output(Tig::NodeId n, size_t port, const ConstValue &value) {
+    Module &module = edit();
+    Module::Output &out = module.outputs[module.output_offsets[n] + port];
+    const NameId name = out.name;
+    const bool sign = out.sign;
+    if (name != kEmptyName) {
+      module.signal_map.erase(name);
+      out.name = kEmptyName;
+    }
+    const Tig::NodeId c =
+        builder_.create_const_node(module_id_, name, value.width(), sign, value.view());
+    report_.created_consts++;
+
+    const auto fanouts = module_->node_fanouts(n);
+    const std::vector<EdgeRef> consumers(fanouts.begin(), fanouts.end());
+    for (const EdgeRef &consumer : consumers) {
+      if (module_->node_fanins(consumer.node_id)[consumer.port_idx].port_idx == port) {
+        builder_.set_node_input(module_id_, consumer.node_id, consumer.port_idx, {c, 0});
+        report_.rewired_inputs++;
+      }
+    }
+    return c;
+  }
+
+  Tig &design_;
+  TigBuilder builder_;
+  Tig::ModuleId module_id_;
+  const Module *module_;
+  ConstPropReport report_;
+};
+
+} // namespace
+
+ConstPropReport propagate_constants(Tig &design, unsigned num_threads) {
+  std::vector<ConstPropReport> reports(design.modules.size());
+  PassManager passes({num_threads});
+  passes.add({"const prop", PassOrder::kAny,
+              [&](Tig::ModuleId m) { reports[m] = ModuleFolder(design, m).run(); }});
+  // Folding fails only when it runs out of memory.
+  if (const auto run = passes.run(design); !run.ok) {
+    throw std::runtime_error(run.message);
+  }
+  ConstPropReport total;
+  for (const auto &report : reports) {
+    total.folded_nodes += report.folded_nodes;
+    total.created_consts += report.created_consts;
+    total.rewired_inputs += report.rewired_inputs;
+  }
+  return total;
+}
+
+} // namespace abys::ir
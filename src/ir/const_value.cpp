@@ -0,0 +1,341 @@
+#include "abys/ir/const_value.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "abys/util/hash.h"
+
+namespace abys::ir {
+
+namespace {
+
+constexpr uint64_t kOnes = ~uint64_t{0};
+
+// Mask of the bits of the last word that lie within `width`.
+uint64_t top_mask(uint64_t width) {
+  return width % 64 == 0 ? kOnes : (uint64_t{1} << (width % 64)) - 1;
+}
+
+// Bits [pos, pos + 64) of a plane of `width` bits, filled with `fill` past the
+// width. A missing plane reads as zero.
+uint64_t read_word(const uint64_t *plane, uint64_t width, uint64_t pos, bool fill) {
+  if (!plane || pos >= width) {
+    return fill ? kOnes : 0;
+  }
+  const size_t w = pos / 64;
+  const unsigned s = pos % 64;
+  uint64_t out = plane[w] >> s;
+  if (s != 0 && w + 1 < ConstView::words_for(width)) {
+    out |= plane[w + 1] << (64 - s);
+  }
+  const uint64_t avail = width - pos;
+  if (avail < 64) {
+    out &= (uint64_t{1} << avail) - 1;
+    if (fill) {
+      out |= kOnes << avail;
+    }
+  }
+  return out;
+}
+
+// a + b + carry; `carry` becomes the carry out.
+uint64_t add_carry(uint64_t a, uint64_t b, uint64_t &carry) {
+  const uint64_t sum = a + b;
+  const uint64_t out = sum + carry;
+  carry = (sum < a) + (out < sum);
+  return out;
+}
+
+// The low word of a * b, with the high word in `hi`.
+uint64_t mul_wide(uint64_t a, uint64_t b, uint64_t &hi) {
+  const uint64_t a0 = a & 0xffffffff, a1 = a >> 32;
+  const uint64_t b0 = b & 0xffffffff, b1 = b >> 32;
+  const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  const uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+  hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return (mid << 32) | (p00 & 0xffffffff);
+}
+
+bool any_unknown(const ConstValue &v) {
+  const auto unknown = const_cast<ConstValue &>(v).unknown_words();
+  return std::any_of(unknown.begin(), unknown.end(), [](uint64_t w) { return w != 0; });
+}
+
+ConstValue all_x(uint64_t width) { return ConstValue(width, Logic::kX); }
+
+// Unsigned a < b over equal-width two-state values.
+bool less_unsigned(ConstValue &a, ConstValue &b) {
+  const auto va = a.value_words();
+  const auto vb = b.value_words();
+  for (size_t i = va.size(); i-- > 0;) {
+    if (va[i] != vb[i]) {
+      return va[i] < vb[i];
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+bool ConstView::has_unknown() const {
+  const auto unknown = unknown_words();
+  return std::any_of(unknown.begin(), unknown.end(), [](uint64_t w) { return w != 0; });
+}
+
+std::string ConstView::to_string() const {
+  static constexpr char kDigits[] = {'0', '1', 'x', 'z'};
+  std::string out(width_, '0');
+  for (uint64_t i = 0; i < width_; i++) {
+    out[width_ - 1 - i] = kDigits[static_cast<size_t>(bit(i))];
+  }
+  return out;
+}
+
+uint64_t ConstView::hash() const {
+  uint64_t h = util::hash_combine(0, width_);
+  for (const uint64_t w : value_words()) {
+    h = util::hash_combine(h, w);
+  }
+  // Two-state values hash alike with or without an all-zero unknown plane.
+  if (has_unknown()) {
+    for (const uint64_t w : unknown_words()) {
+      h = util::hash_combine(h, w);
+    }
+  }
+  return h;
+}
+
+bool operator==(const ConstView &a, const ConstView &b) {
+  if (a.width_ != b.width_) {
+    return false;
+  }
+  const auto va = a.value_words();
+  const auto vb = b.value_words();
+  if (!std::equal(va.begin(), va.end(), vb.begin())) {
+    return false;
+  }
+  for (size_t i = 0; i < a.num_words(); i++) {
+    const uint64_t ua = a.unknown_ ? a.unknown_[i] : 0;
+    const uint64_t ub = b.unknown_ ? b.unknown_[i] : 0;
+    if (ua != ub) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ConstValue::ConstValue(uint64_t width, Logic fill) : width_(width) {
+  if (width > 64) {
+    heap_ = std::make_unique<uint64_t[]>(2 * num_words());
+  }
+  const uint64_t v = (static_cast<uint8_t>(fill) & 1) ? kOnes : 0;
+  const uint64_t u = (static_cast<uint8_t>(fill) & 2) ? kOnes : 0;
+  std::fill(value_words().begin(), value_words().end(), v);
+  std::fill(unknown_words().begin(), unknown_words().end(), u);
+  mask_top();
+}
+
+ConstValue::ConstValue(ConstView view) : ConstValue(view.width()) {
+  const auto value = view.value_words();
+  std::copy(value.begin(), value.end(), value_words().begin());
+  const auto unknown = view.unknown_words();
+  std::copy(unknown.begin(), unknown.end(), unknown_words().begin());
+}
+
+ConstValue::ConstValue(const ConstValue &other) : ConstValue(other.view()) {}
+
+ConstValue &ConstValue::operator=(const ConstValue &other) {
+  if (this != &other) {
+    *this = ConstValue(other);
+  }
+  return *this;
+}
+
+ConstValue::ConstValue(ConstValue &&other) noexcept
+    : width_(other.width_), heap_(std::move(other.heap_)) {
+  std::memcpy(inline_, other.inline_, sizeof(inline_));
+  other.width_ = 0;
+}
+
+ConstValue &ConstValue::operator=(ConstValue &&other) noexcept {
+  width_ = other.width_;
+  heap_ = std::move(other.heap_);
+  std::memcpy(inline_, other.inline_, sizeof(inline_));
+  other.width_ = 0;
+  return *this;
+}
+
+ConstValue ConstValue::from_uint64(uint64_t width, uint64_t value) {
+  ConstValue out(width);
+  if (width > 0) {
+    out.value_words()[0] = value;
+    out.mask_top();
+  }
+  return out;
+}
+
+std::optional<ConstValue> ConstValue::parse(std::string_view digits) {
+  ConstValue out(digits.size());
+  for (size_t i = 0; i < digits.size(); i++) {
+    Logic bit;
+    switch (digits[digits.size() - 1 - i]) {
+    case '0':
+      bit = Logic::k0;
+      break;
+    case '1':
+      bit = Logic::k1;
+      break;
+    case 'x':
+    case 'X':
+      bit = Logic::kX;
+      break;
+    case 'z':
+    case 'Z':
+      bit = Logic::kZ;
+      break;
+    default:
+      return std::nullopt;
+    }
+    out.set_bit(i, bit);
+  }
+  return out;
+}
+
+ConstView ConstValue::view() const {
+  return {width_, words(), words() + plane_stride()};
+}
+
+void ConstValue::set_bit(uint64_t i, Logic bit) {
+  const uint64_t mask = uint64_t{1} << (i % 64);
+  uint64_t &v = value_words()[i / 64];
+  uint64_t &u = unknown_words()[i / 64];
+  v = (static_cast<uint8_t>(bit) & 1) ? v | mask : v & ~mask;
+  u = (static_cast<uint8_t>(bit) & 2) ? u | mask : u & ~mask;
+}
+
+void ConstValue::mask_top() {
+  if (width_ == 0) {
+    return;
+  }
+  value_words().back() &= top_mask(width_);
+  unknown_words().back() &= top_mask(width_);
+}
+
+ConstValue const_bits(ConstView a, uint64_t lo, uint64_t width, bool sign) {
+  ConstValue out(width);
+  const bool extend = sign && a.width() > 0;
+  const Logic msb = extend ? a.bit(a.width() - 1) : Logic::k0;
+  const bool fill_v = (static_cast<uint8_t>(msb) & 1) != 0;
+  const bool fill_u = (static_cast<uint8_t>(msb) & 2) != 0;
+  const uint64_t *value = a.value_words().data();
+  const uint64_t *unknown = a.unknown_words().empty() ? nullptr : a.unknown_words().data();
+  auto v = out.value_words();
+  auto u = out.unknown_words();
+  for (size_t i = 0; i < out.num_words(); i++) {
+    v[i] = read_word(value, a.width(), lo + 64 * i, fill_v);
+    u[i] = read_word(unknown, a.width(), lo + 64 * i, fill_u);
+  }
+  out.mask_top();
+  return out;
+}
+
+std::optional<ConstValue> evaluate_const_op(std::string_view op, uint64_t width, ConstView a,
+                                            bool a_sign, const ConstView *b, bool b_sign) {
+  const bool is_unary = op == "not" || op == "neg";
+  if (is_unary != (b == nullptr)) {
+    return std::nullopt;
+  }
+
+  if (op == "eq" || op == "ne" || op == "lt") {
+    const uint64_t cw = std::max(a.width(), b->width());
+    const bool sign = a_sign && b_sign;
+    ConstValue ca = const_bits(a, 0, cw, sign);
+    ConstValue cb = const_bits(*b, 0, cw, sign);
+    ConstValue out(width);
+    if (width == 0) {
+      return out;
+    }
+    if (any_unknown(ca) || any_unknown(cb)) {
+      out.set_bit(0, Logic::kX);
+      return out;
+    }
+    bool result;
+    if (op == "lt") {
+      // Signed operands compare as unsigned with their sign bits flipped.
+      if (sign && cw > 0) {
+        ca.set_bit(cw - 1, ca.bit(cw - 1) == Logic::k1 ? Logic::k0 : Logic::k1);
+        cb.set_bit(cw - 1, cb.bit(cw - 1) == Logic::k1 ? Logic::k0 : Logic::k1);
+      }
+      result = less_unsigned(ca, cb);
+    } else {
+      result = (ca.view() == cb.view()) == (op == "eq");
+    }
+    out.set_bit(0, result ? Logic::k1 : Logic::k0);
+    return out;
+  }
+
+  ConstValue x = const_bits(a, 0, width, a_sign);
+  ConstValue y = b ? const_bits(*b, 0, width, b_sign) : ConstValue(width);
+  ConstValue out(width);
+  auto xv = x.value_words(), xu = x.unknown_words();
+  auto yv = y.value_words(), yu = y.unknown_words();
+  auto ov = out.value_words(), ou = out.unknown_words();
+  const size_t n = out.num_words();
+
+  if (op == "and" || op == "or" || op == "xor" || op == "xnor" || op == "not") {
+    for (size_t i = 0; i < n; i++) {
+      if (op == "and") {
+        // A known 0 on either side decides the bit.
+        const uint64_t zero = (~xu[i] & ~xv[i]) | (~yu[i] & ~yv[i]);
+        ou[i] = (xu[i] | yu[i]) & ~zero;
+        ov[i] = xv[i] & yv[i] & ~xu[i] & ~yu[i];
+      } else if (op == "or") {
+        const uint64_t one = (~xu[i] & xv[i]) | (~yu[i] & yv[i]);
+        ou[i] = (xu[i] | yu[i]) & ~one;
+        ov[i] = one;
+      } else if (op == "not") {
+        ou[i] = xu[i];
+        ov[i] = ~xv[i] & ~xu[i];
+      } else {
+        ou[i] = xu[i] | yu[i];
+        ov[i] = (op == "xor" ? xv[i] ^ yv[i] : ~(xv[i] ^ yv[i])) & ~ou[i];
+      }
+    }
+    out.mask_top();
+    return out;
+  }
+
+  if (op != "add" && op != "sub" && op != "neg" && op != "mul") {
+    return std::nullopt;
+  }
+  if (any_unknown(x) || any_unknown(y)) {
+    return all_x(width);
+  }
+  if (op == "add" || op == "sub" || op == "neg") {
+    // a + ~b + 1 for subtraction; negation subtracts from zero.
+    const bool subtract = op != "add";
+    uint64_t carry = subtract ? 1 : 0;
+    for (size_t i = 0; i < n; i++) {
+      const uint64_t lhs = op == "neg" ? 0 : xv[i];
+      const uint64_t rhs = op == "neg" ? ~xv[i] : subtract ? ~yv[i] : yv[i];
+      ov[i] = add_carry(lhs, rhs, carry);
+    }
+  } else {
+    // Schoolbook, truncated to the result width.
+    for (size_t i = 0; i < n; i++) {
+      uint64_t carry = 0;
+      for (size_t j = 0; i + j < n; j++) {
+        uint64_t hi;
+        const uint64_t lo = mul_wide(xv[j], yv[i], hi);
+        uint64_t c0 = 0;
+        uint64_t c1 = 0;
+        ov[i + j] = add_carry(add_carry(ov[i + j], lo, c0), carry, c1);
+        carry = hi + c0 + c1;
+      }
+    }
+  }
+  out.mask_top();
+  return out;
+}
+
+} // namespace abys::ir
@@ -0,0 +1,119 @@
+#include "abys/ir/module_cache.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_snapshot.h"
+
+namespace abys::ir {
+
+namespace {
+
+std::string key_name(uint64_t key) {
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016" PRIx64, key);
+  return buf;
+}
+
+bool parse_key(std::string_view name, uint64_t &key) {
+  if (name.size() != 16) {
+    return false;
+  }
+  key = 0;
+  for (const char c : name) {
+    const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    if (digit < 0) {
+      return false;
+    }
+    key = key << 4 | static_cast<uint64_t>(digit);
+  }
+  return true;
+}
+
+} // namespace
+
+ModuleCache::ModuleCache(std::string dir) : dir_(std::move(dir)) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir_, ec);
+}
+
+std::string ModuleCache::path_of(uint64_t key) const {
+  return (std::filesystem::path(dir_) / (key_name(key) + ".tig")).string();
+}
+
+bool ModuleCache::load(uint64_t key, const std::unordered_map<uint64_t, ModuleId> &module_ids,
+                       Tig &local) const {
+  TigSnapshot snapshot;
+  if (!snapshot.open(path_of(key)).ok || snapshot.num_modules() == 0) {
+    return false;
+  }
+  Tig entry = snapshot.materialize();
+
+  std::vector<ModuleId> stubs(entry.modules.size(), Tig::kInvalidModuleId);
+  for (ModuleId m = 1; m < entry.modules.size(); m++) {
+    uint64_t dep = 0;
+    if (!parse_key(entry.names.view(entry.modules[m].name), dep)) {
+      return false;
+    }
+    auto it = module_ids.find(dep);
+    if (it == module_ids.end()) {
+      return false;
+    }
+    stubs[m] = it->second;
+  }
+  for (auto &attrs : entry.modules[0].attrs) {
+    if (attrs.module_id != Tig::kInvalidModuleId) {
+      attrs.module_id = stubs[attrs.module_id];
+    }
+  }
+  entry.modules.resize(1);
+  local = std::move(entry);
+  return true;
+}
+
+void ModuleCache::store(uint64_t key, const Tig &local,
+                        const std::unordered_map<ModuleId, uint64_t> &keys) const {
+  Tig entry;
+  entry.names = local.names;
+  entry.params = local.params;
+  entry.modules.push_back(local.modules[0]);
+  TigBuilder builder(entry);
+
+  std::unordered_map<ModuleId, ModuleId> stubs;
+  for (auto &attrs : entry.modules[0].attrs) {
+    if (attrs.module_id == Tig::kInvalidModuleId) {
+      continue;
+    }
+    auto [it, inserted] = stubs.emplace(attrs.module_id, 0);
+    if (inserted) {
+      it->second = builder.create_module(key_name(keys.at(attrs.module_id)));
+    }
+    attrs.module_id = it->second;
+  }
+
+  // Written under a private name and renamed into place, so concurrent builds
+  // never observe a partial entry.
+  static std::atomic<uint64_t> next_tmp{0};
+  const std::string path = path_of(key);
+  const std::string tmp = path + ".tmp" + std::to_string(::getpid()) + "." +
+                          std::to_string(next_tmp.fetch_add(1, std::memory_order_relaxed));
+  if (write_tig_snapshot(entry, tmp).ok) {
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (!ec) {
+      return;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::remove(tmp, ec);
+}
+
+} // namespace abys::ir
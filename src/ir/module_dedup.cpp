@@ -0,0 +1,221 @@
+#include "abys/ir/module_dedup.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "abys/ir/tig_memory.h"
+#include "abys/util/hash.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using ModuleId = Tig::ModuleId;
+
+// Instances refer to modules through `canonical`, so that modules whose
+// children were merged compare equal.
+class ModuleComparer {
+public:
+  explicit ModuleComparer(const std::vector<ModuleId> &canonical) : canonical_(canonical) {}
+
+  uint64_t hash(const Module &m) const {
+    util::Hasher h(m.name);
+    auto add = [&](uint64_t word) { h.update(&word, sizeof(word)); };
+    auto add_ports = [&](const std::vector<Module::Port> &ports) {
+      add(ports.size());
+      for (const auto &port : ports) {
+        add(port.name);
+        add(port.width * 2 + (port.sign ? 1 : 0));
+      }
+    };
+    add_ports(m.input_ports);
+    add_ports(m.output_ports);
+    add(m.num_nodes());
+    for (Tig::NodeId n = 0; n < m.num_nodes(); n++) {
+      add(static_cast<uint64_t>(m.kind(n)));
+      for (const auto &fanin : m.node_fanins(n)) {
+        add((uint64_t{fanin.node_id} << 32) | fanin.port_idx);
+      }
+      for (const auto &output : m.node_outputs(n)) {
+        add(output.width * 2 + (output.sign ? 1 : 0));
+      }
+      if (const auto *attrs = m.find_attrs(n)) {
+        add(child(attrs->module_id));
+        add(attrs->op);
+        for (const auto width : m.node_segment_widths(n)) {
+          add(width);
+        }
+      }
+      if (m.kind(n) == Module::NodeKind::kConst) {
+        add(m.node_const(n).hash());
+      }
+    }
+    add(m.blocks.size());
+    return h.digest();
+  }
+
+  bool equal(const Module &a, const Module &b) const {
+    if (a.name != b.name || !same_ports(a.input_ports, b.input_ports) ||
+        !same_ports(a.output_ports, b.output_ports) || a.node_kinds != b.node_kinds ||
+        a.fanin_offsets != b.fanin_offsets || a.output_offsets != b.output_offsets ||
+        a.blocks.size() != b.blocks.size()) {
+      return false;
+    }
+    if (!std::equal(a.fanins.begin(), a.fanins.end(), b.fanins.begin(),
+                    [](const Module::EdgeRef &x, const Module::EdgeRef &y) {
+                      return x.node_id == y.node_id && x.port_idx == y.port_idx;
+                    })) {
+      return false;
+    }
+    if (!std::equal(a.outputs.begin(), a.outputs.end(), b.outputs.begin(),
+                    [](const Module::Output &x, const Module::Output &y) {
+                      return x.width == y.width && x.sign == y.sign;
+                    })) {
+      return false;
+    }
+    for (Tig::NodeId n = 0; n < a.num_nodes(); n++) {
+      const auto *x = a.find_attrs(n);
+      const auto *y = b.find_attrs(n);
+      if ((x == nullptr) != (y == nullptr)) {
+        return false;
+      }
+      if (x && (child(x->module_id) != child(y->module_id) || x->op != y->op)) {
+        return false;
+      }
+      if (a.kind(n) == Module::NodeKind::kConst && !(a.node_const(n) == b.node_const(n))) {
+        return false;
+      }
+      const auto wa = a.node_segment_widths(n);
+      const auto wb = b.node_segment_widths(n);
+      if (!std::equal(wa.begin(), wa.end(), wb.begin(), wb.end())) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < a.blocks.size(); i++) {
+      if (!same_block(a.blocks[i], b.blocks[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  ModuleId child(ModuleId id) const {
+    return id == Tig::kInvalidModuleId ? id : canonical_[id];
+  }
+
+  static bool same_ports(const std::vector<Module::Port> &a, const std::vector<Module::Port> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const Module::Port &x, const Module::Port &y) {
+                        return x.name == y.name && x.width == y.width && x.sign == y.sign;
+                      });
+  }
+
+  static bool same_block(const Module::Block &a, const Module::Block &b) {
+    return a.kind == b.kind && a.impl_name == b.impl_name &&
+           same_ports(a.input_ports, b.input_ports) &&
+           same_ports(a.output_ports, b.output_ports) && a.inputs == b.inputs &&
+           a.outputs == b.outputs && a.params == b.params && a.attributes == b.attributes;
+  }
+
+  const std::vector<ModuleId> &canonical_;
+};
+
+// Modules in an order where every instantiated module precedes its parents.
+std::vector<ModuleId> bottom_up_order(const Tig &design) {
+  const size_t n = design.modules.size();
+  std::vector<ModuleId> order;
+  order.reserve(n);
+  std::vector<uint8_t> state(n, 0); // 0 unvisited, 1 on the stack, 2 done
+  for (ModuleId root = 0; root < n; root++) {
+    if (state[root] != 0) {
+      continue;
+    }
+    std::vector<std::pair<ModuleId, size_t>> stack{{root, 0}};
+    state[root] = 1;
+    while (!stack.empty()) {
+      auto &[m, next] = stack.back();
+      const auto &attrs = design.modules[m].attrs;
+      if (next < attrs.size()) {
+        const ModuleId child = attrs[next++].module_id;
+        if (child != Tig::kInvalidModuleId && child < n && state[child] == 0) {
+          state[child] = 1;
+          stack.emplace_back(child, 0);
+        }
+        continue;
+      }
+      state[m] = 2;
+      order.push_back(m);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+} // namespace
+
+size_t module_heap_bytes(const Tig::Module &module) {
+  return module_memory(module).total();
+}
+
+ModuleDedupReport dedup_modules(Tig &design) {
+  // Modules are read through `source`, so that reading one does not copy it
+  // away from copies of the design that share it.
+  const Tig &source = design;
+  ModuleDedupReport report;
+  const size_t n = design.modules.size();
+  report.modules_before = n;
+
+  std::vector<ModuleId> canonical(n);
+  for (ModuleId m = 0; m < n; m++) {
+    canonical[m] = m;
+  }
+  const ModuleComparer comparer(canonical);
+  std::unordered_map<uint64_t, std::vector<ModuleId>> classes;
+  for (const ModuleId m : bottom_up_order(design)) {
+    auto &candidates = classes[comparer.hash(source.modules[m])];
+    const auto it = std::find_if(candidates.begin(), candidates.end(), [&](ModuleId other) {
+      return comparer.equal(source.modules[other], source.modules[m]);
+    });
+    if (it != candidates.end()) {
+      canonical[m] = *it;
+    } else {
+      candidates.push_back(m);
+    }
+  }
+
+  // Survivors keep their relative order.
+  report.remap.assign(n, Tig::kInvalidModuleId);
+  for (ModuleId m = 0; m < n; m++) {
+    if (canonical[m] == m) {
+      report.remap[m] = static_cast<ModuleId>(report.modules_after++);
+    } else {
+      report.bytes_saved += module_heap_bytes(source.modules[m]);
+    }
+  }
+  for (ModuleId m = 0; m < n; m++) {
+    report.remap[m] = report.remap[canonical[m]];
+  }
+  design.modules.retain([&](size_t m) { return canonical[m] == m; });
+  // Only modules with an instance whose id changes are written.
+  auto moves = [&](const Module::NodeAttrs &attrs) {
+    return attrs.module_id != Tig::kInvalidModuleId &&
+           report.remap[attrs.module_id] != attrs.module_id;
+  };
+  for (ModuleId m = 0; m < report.modules_after; m++) {
+    const auto &attrs = source.modules[m].attrs;
+    if (std::none_of(attrs.begin(), attrs.end(), moves)) {
+      continue;
+    }
+    for (auto &instance : design.modules[m].attrs) {
+      if (instance.module_id != Tig::kInvalidModuleId) {
+        instance.module_id = report.remap[instance.module_id];
+      }
+    }
+  }
+  return report;
+}
+
+} // namespace abys::ir
@@ -0,0 +1,401 @@
+#include "abys/ir/param_store.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <charconv>
+#include <cctype>
+#include <cstdio>
+#include <optional>
+
+#include "abys/util/hash.h"
+
+namespace abys::ir {
+
+namespace {
+
+constexpr uint32_t kNoBits = std::numeric_limits<uint32_t>::max();
+
+// Params as they are stored: only the key, kind and payload take part.
+Param canonical(const Param &param) {
+  Param out;
+  out.key = param.key;
+  out.kind = param.kind;
+  out.payload = param.payload;
+  return out;
+}
+
+uint64_t hash_set(std::span<const Param> params) {
+  util::Hasher h;
+  h.update(params.data(), params.size_bytes());
+  return h.digest();
+}
+
+size_t table_size(size_t entries) {
+  return std::max<size_t>(16, std::bit_ceil(2 * entries + 1));
+}
+
+// Value of one digit of a based literal; false for anything not a digit of
+// `base`.
+bool based_digit(char c, unsigned base, uint64_t &value) {
+  c = static_cast<char>(c | 0x20);
+  if (c >= '0' && c <= '9') {
+    value = static_cast<uint64_t>(c - '0');
+  } else if (c >= 'a' && c <= 'f') {
+    value = static_cast<uint64_t>(c - 'a' + 10);
+  } else {
+    return false;
+  }
+  return value < base;
+}
+
+// A sized binary, octal or hex literal such as 8'hff or 4'b10xz.
+std::optional<ConstValue> parse_sized(std::string_view text) {
+  const size_t tick = text.find('\'');
+  if (tick == 0 || tick == std::string_view::npos || tick + 2 > text.size()) {
+    return std::nullopt;
+  }
+  uint64_t width = 0;
+  const auto [end, ec] = std::from_chars(text.data(), text.data() + tick, width);
+  // Wider literals are kept as text rather than allocated blindly.
+  if (ec != std::errc() || end != text.data() + tick || width == 0 || width > (1u << 20)) {
+    return std::nullopt;
+  }
+  unsigned shift;
+  switch (text[tick + 1] | 0x20) {
+  case 'b':
+    shift = 1;
+    break;
+  case 'o':
+    shift = 3;
+    break;
+  case 'h':
+    shift = 4;
+    break;
+  default:
+    return std::nullopt;
+  }
+  std::string_view digits = text.substr(tick + 2);
+  if (digits.empty() || digits.front() == '_') {
+    return std::nullopt;
+  }
+  // An x or z leading digit extends to the full width; anything else zeros.
+  const char lead = static_cast<char>(digits.front() | 0x20);
+  const Logic fill = lead == 'x' ? Logic::kX : (lead == 'z' || lead == '?') ? Logic::kZ : Logic::k0;
+  ConstValue out(width, fill);
+  uint64_t pos = 0;
+  for (size_t i = digits.size(); i-- > 0;) {
+    const char c = static_cast<char>(digits[i] | 0x20);
+    if (c == '_') {
+      continue;
+    }
+    uint64_t value = 0;
+    Logic unknown = Logic::k0;
+    if (c == 'x') {
+      unknown = Logic::kX;
+    } else if (c == 'z' || c == '?') {
+      unknown = Logic::kZ;
+    } else if (!based_digit(c, 1u << shift, value)) {
+      return std::nullopt;
+    }
+    for (unsigned b = 0; b < shift; b++, pos++) {
+      if (pos < width) {
+        out.set_bit(pos, unknown != Logic::k0 ? unknown
+                                              : ((value >> b) & 1 ? Logic::k1 : Logic::k0));
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+Param Param::integer(NameId key, int64_t value) {
+  Param p;
+  p.key = key;
+  p.kind = ParamKind::kInt;
+  p.payload = static_cast<uint64_t>(value);
+  return p;
+}
+
+Param Param::real(NameId key, double value) {
+  Param p;
+  p.key = key;
+  p.kind = ParamKind::kReal;
+  p.payload = std::bit_cast<uint64_t>(value);
+  return p;
+}
+
+Param Param::string(NameId key, NameId value) {
+  Param p;
+  p.key = key;
+  p.kind = ParamKind::kString;
+  p.payload = value;
+  return p;
+}
+
+Param Param::text(NameId key, NameId value) {
+  Param p;
+  p.key = key;
+  p.kind = ParamKind::kText;
+  p.payload = value;
+  return p;
+}
+
+double Param::as_real() const { return std::bit_cast<double>(payload); }
+
+ParamStore::ParamStore() : offsets_{0, 0}, set_slots_(16, kInvalidParamSet) {
+  set_slots_[hash_set({}) & (set_slots_.size() - 1)] = kEmptyParamSet;
+}
+
+ParamSetId ParamStore::intern(std::span<const Param> params) {
+  std::vector<Param> set;
+  set.reserve(params.size());
+  for (const Param &param : params) {
+    set.push_back(canonical(param));
+  }
+  std::stable_sort(set.begin(), set.end(),
+                   [](const Param &a, const Param &b) { return a.key < b.key; });
+  // Keep the last of each run of equal keys.
+  size_t kept = 0;
+  for (size_t i = 0; i < set.size(); i++) {
+    if (i + 1 < set.size() && set[i + 1].key == set[i].key) {
+      continue;
+    }
+    set[kept++] = set[i];
+  }
+  set.resize(kept);
+
+  const size_t mask = set_slots_.size() - 1;
+  size_t i = hash_set(set) & mask;
+  for (; set_slots_[i] != kInvalidParamSet; i = (i + 1) & mask) {
+    const auto existing = view(set_slots_[i]);
+    if (std::equal(existing.begin(), existing.end(), set.begin(), set.end())) {
+      return set_slots_[i];
+    }
+  }
+  const ParamSetId id = size();
+  assert(id != kInvalidParamSet);
+  params_.insert(params_.end(), set.begin(), set.end());
+  offsets_.push_back(static_cast<uint32_t>(params_.size()));
+  set_slots_[i] = id;
+  if (2 * static_cast<size_t>(size()) > set_slots_.size()) {
+    grow_sets();
+  }
+  return id;
+}
+
+const Param *ParamStore::find(ParamSetId id, NameId key) const {
+  const auto set = view(id);
+  const auto it = std::lower_bound(set.begin(), set.end(), key,
+                                   [](const Param &p, NameId k) { return p.key < k; });
+  return it != set.end() && it->key == key ? &*it : nullptr;
+}
+
+Param ParamStore::bits(NameId key, ConstView value) {
+  Param p;
+  p.key = key;
+  p.kind = ParamKind::kBits;
+  p.payload = intern_bits(value);
+  return p;
+}
+
+ConstView ParamStore::bits_value(const Param &param) const {
+  assert(param.kind == ParamKind::kBits);
+  return bits_view(param.payload);
+}
+
+ConstView ParamStore::bits_view(uint64_t bits_id) const {
+  const uint64_t offset = bits_offsets_[bits_id];
+  const uint64_t header = words_[offset];
+  const uint64_t width = header >> 1;
+  const uint64_t *value = words_.data() + offset + 1;
+  return {width, value, (header & 1) ? value + ConstView::words_for(width) : nullptr};
+}
+
+uint64_t ParamStore::intern_bits(ConstView value) {
+  if (bits_slots_.empty()) {
+    grow_bits();
+  }
+  const size_t mask = bits_slots_.size() - 1;
+  size_t i = value.hash() & mask;
+  for (; bits_slots_[i] != kNoBits; i = (i + 1) & mask) {
+    if (bits_view(bits_slots_[i]) == value) {
+      return bits_slots_[i];
+    }
+  }
+  const auto id = static_cast<uint32_t>(bits_offsets_.size());
+  const bool unknown = value.has_unknown();
+  bits_offsets_.push_back(words_.size());
+  words_.push_back(value.width() * 2 + (unknown ? 1 : 0));
+  const auto value_words = value.value_words();
+  words_.insert(words_.end(), value_words.begin(), value_words.end());
+  if (unknown) {
+    const auto unknown_words = value.unknown_words();
+    words_.insert(words_.end(), unknown_words.begin(), unknown_words.end());
+  }
+  bits_slots_[i] = id;
+  if (2 * bits_offsets_.size() > bits_slots_.size()) {
+    grow_bits();
+  }
+  return id;
+}
+
+Param ParamStore::parse(SymbolTable &names, NameId key, std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+    text.remove_suffix(1);
+  }
+  const char *first = text.data();
+  const char *last = text.data() + text.size();
+  const bool numeric =
+      !text.empty() && (std::isdigit(static_cast<unsigned char>(text[0])) ||
+                        (text[0] == '-' && text.size() > 1 &&
+                         std::isdigit(static_cast<unsigned char>(text[1]))));
+  if (numeric) {
+    int64_t integer = 0;
+    if (const auto [end, ec] = std::from_chars(first, last, integer);
+        ec == std::errc() && end == last) {
+      return Param::integer(key, integer);
+    }
+    double real = 0;
+    if (text.find_first_of(".eE") != std::string_view::npos) {
+      if (const auto [end, ec] = std::from_chars(first, last, real);
+          ec == std::errc() && end == last) {
+        return Param::real(key, real);
+      }
+    }
+    if (auto value = parse_sized(text)) {
+      return bits(key, *value);
+    }
+  }
+  if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+    const std::string_view contents = text.substr(1, text.size() - 2);
+    if (contents.find_first_of("\"\\") == std::string_view::npos) {
+      return Param::string(key, names.intern(contents));
+    }
+  }
+  return Param::text(key, names.intern(text));
+}
+
+std::string ParamStore::to_verilog(const SymbolTable &names, const Param &param) const {
+  switch (param.kind) {
+  case ParamKind::kInt:
+    return std::to_string(param.as_int());
+  case ParamKind::kReal: {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", param.as_real());
+    std::string out(buf);
+    if (out.find_first_of(".eEn") == std::string::npos) {
+      out += ".0";
+    }
+    return out;
+  }
+  case ParamKind::kString: {
+    std::string out = "\"";
+    for (const char c : names.view(param.as_name())) {
+      switch (c) {
+      case '"':
+      case '\\':
+        out += '\\';
+        out += c;
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += c;
+      }
+    }
+    out += '"';
+    return out;
+  }
+  case ParamKind::kBits: {
+    const ConstView value = bits_value(param);
+    return std::to_string(value.width()) + "'b" + value.to_string();
+  }
+  case ParamKind::kText:
+    break;
+  }
+  return std::string(names.view(param.as_name()));
+}
+
+ParamSetId ParamStore::import(const ParamStore &other, ParamSetId id,
+                              std::span<const NameId> names) {
+  return import(other, id, [names](NameId name) { return names[name]; });
+}
+
+ParamSetId ParamStore::import(const ParamStore &other, ParamSetId id,
+                              const std::function<NameId(NameId)> &translate) {
+  std::vector<Param> set;
+  set.reserve(other.view(id).size());
+  for (const Param &param : other.view(id)) {
+    const NameId key = translate(param.key);
+    switch (param.kind) {
+    case ParamKind::kString:
+      set.push_back(Param::string(key, translate(param.as_name())));
+      break;
+    case ParamKind::kText:
+      set.push_back(Param::text(key, translate(param.as_name())));
+      break;
+    case ParamKind::kBits:
+      set.push_back(bits(key, other.bits_value(param)));
+      break;
+    default:
+      set.push_back(param);
+      set.back().key = key;
+    }
+  }
+  return intern(set);
+}
+
+uint64_t ParamStore::heap_bytes() const {
+  return params_.capacity() * sizeof(Param) + offsets_.capacity() * sizeof(uint32_t) +
+         set_slots_.capacity() * sizeof(ParamSetId) + words_.capacity() * sizeof(uint64_t) +
+         bits_offsets_.capacity() * sizeof(uint64_t) + bits_slots_.capacity() * sizeof(uint32_t);
+}
+
+void ParamStore::assign(std::span<const Param> params, std::span<const uint32_t> offsets,
+                        std::span<const uint64_t> words, std::span<const uint64_t> bits_offsets) {
+  params_.assign(params.begin(), params.end());
+  offsets_.assign(offsets.begin(), offsets.end());
+  words_.assign(words.begin(), words.end());
+  bits_offsets_.assign(bits_offsets.begin(), bits_offsets.end());
+  set_slots_.clear();
+  grow_sets();
+  bits_slots_.clear();
+  if (!bits_offsets_.empty()) {
+    grow_bits();
+  }
+}
+
+void ParamStore::grow_sets() {
+  set_slots_.assign(table_size(size()), kInvalidParamSet);
+  const size_t mask = set_slots_.size() - 1;
+  for (ParamSetId id = 0; id < size(); id++) {
+    size_t i = hash_set(view(id)) & mask;
+    while (set_slots_[i] != kInvalidParamSet) {
+      i = (i + 1) & mask;
+    }
+    set_slots_[i] = id;
+  }
+}
+
+void ParamStore::grow_bits() {
+  bits_slots_.assign(table_size(bits_offsets_.size()), kNoBits);
+  const size_t mask = bits_slots_.size() - 1;
+  for (uint32_t id = 0; id < bits_offsets_.size(); id++) {
+    size_t i = bits_view(id).hash() & mask;
+    while (bits_slots_[i] != kNoBits) {
+      i = (i + 1) & mask;
+    }
+    bits_slots_[i] = id;
+  }
+}
+
+} // namespace abys::ir
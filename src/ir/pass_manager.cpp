@@ -0,0 +1,316 @@
+#include "abys/ir/pass_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "abys/util/parallel.h"
+#include "abys/util/profile.h"
+
+namespace abys::ir {
+
+namespace {
+
+using ModuleId = Tig::ModuleId;
+using Clock = std::chrono::steady_clock;
+
+// A pass over one design: modules, the modules each one releases when it
+// finishes, and how many modules each one waits for.
+struct PassGraph {
+  std::vector<std::vector<ModuleId>> successors;
+  std::vector<uint32_t> waits;
+};
+
+PassGraph pass_graph(const ModuleDag &dag, PassOrder order) {
+  const size_t n = dag.children.size();
+  PassGraph graph;
+  graph.successors.resize(n);
+  graph.waits.assign(n, 0);
+  if (order == PassOrder::kAny) {
+    return graph;
+  }
+  for (ModuleId m = 0; m < n; m++) {
+    for (const auto &[child, count] : dag.children[m]) {
+      if (order == PassOrder::kBottomUp) {
+        graph.successors[child].push_back(m);
+        graph.waits[m]++;
+      } else {
+        graph.successors[m].push_back(child);
+        graph.waits[child]++;
+      }
+    }
+  }
+  return graph;
+}
+
+class Scheduler {
+public:
+  Scheduler(const Tig &design, const ModulePass &pass, const PassGraph &graph, PassTiming &timing)
+      : design_(design), pass_(pass), graph_(graph), timing_(timing),
+        waits_(std::make_unique<std::atomic<uint32_t>[]>(graph.waits.size())) {
+    for (size_t m = 0; m < graph.waits.size(); m++) {
+      waits_[m].store(graph.waits[m], std::memory_order_relaxed);
+    }
+  }
+
+  // Returns an empty string on success, else what went wrong.
+  std::string run(unsigned num_threads) {
+    const size_t n = graph_.waits.size();
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(num_threads, n));
+    queues_ = std::vector<Queue>(workers);
+    // Modules that are ready up front are dealt out in id order.
+    size_t next = 0;
+    for (ModuleId m = 0; m < n; m++) {
+      if (graph_.waits[m] == 0) {
+        queues_[next++ % workers].tasks.push_back(m);
+      }
+    }
+    queued_.store(next, std::memory_order_relaxed);
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) {
+      threads.emplace_back([this, w] { work(w); });
+    }
+    work(0);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return error_;
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<ModuleId> tasks;
+  };
+
+  bool pop(size_t w, ModuleId &m) {
+    // The newest module of our own queue is the one whose inputs are most
+    // likely still in cache.
+    {
+      Queue &own = queues_[w];
+      std::lock_guard lock(own.mutex);
+      if (!own.tasks.empty()) {
+        m = own.tasks.back();
+        own.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); i++) {
+      Queue &victim = queues_[(w + i) % queues_.size()];
+      std::lock_guard lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        m = victim.tasks.front();
+        victim.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool finished() const {
+    return failed_.load(std::memory_order_acquire) ||
+           done_.load(std::memory_order_acquire) == graph_.waits.size();
+  }
+
+  // Wake idle workers after publishing work or finishing. Taking the mutex
+  // orders the change before any waiter's next predicate check.
+  void wake(bool all) {
+    { std::lock_guard lock(idle_mutex_); }
+    if (all) {
+      idle_.notify_all();
+    } else {
+      idle_.notify_one();
+    }
+  }
+
+  void work(size_t w) {
+    while (!finished()) {
+      ModuleId m;
+      if (!pop(w, m)) {
+        std::unique_lock lock(idle_mutex_);
+        idle_.wait(lock,
+                   [&] { return queued_.load(std::memory_order_relaxed) > 0 || finished(); });
+        continue;
+      }
+      if (!run_module(m)) {
+        wake(true);
+        return;
+      }
+      for (const ModuleId next : graph_.successors[m]) {
+        if (waits_[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          {
+            Queue &own = queues_[w];
+            std::lock_guard lock(own.mutex);
+            own.tasks.push_back(next);
+          }
+          queued_.fetch_add(1, std::memory_order_relaxed);
+          wake(false);
+        }
+      }
+      if (done_.fetch_add(1, std::memory_order_acq_rel) + 1 == graph_.waits.size()) {
+        wake(true);
+      }
+    }
+  }
+
+  bool run_module(ModuleId m) {
+    const auto start = Clock::now();
+    try {
+      util::ScopedTimer timer(pass_.name, design_.names.view(design_.modules[m].name));
+      pass_.run(m);
+    } catch (const std::exception &e) {
+      fail(m, e.what());
+      return false;
+    } catch (...) {
+      fail(m, "unknown exception");
+      return false;
+    }
+    timing_.modules[m] = Clock::now() - start;
+    return true;
+  }
+
+  void fail(ModuleId m, const std::string &what) {
+    std::lock_guard lock(error_mutex_);
+    if (error_.empty()) {
+      error_ = "pass " + pass_.name + " failed on module " +
+               std::string(design_.names.view(design_.modules[m].name)) + ": " + what;
+    }
+    failed_.store(true, std::memory_order_release);
+  }
+
+  const Tig &design_;
+  const ModulePass &pass_;
+  const PassGraph &graph_;
+  PassTiming &timing_;
+  std::unique_ptr<std::atomic<uint32_t>[]> waits_;
+  std::vector<Queue> queues_;
+  // Modules sitting in some queue, for idle workers to wait on.
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> done_{0};
+  std::atomic<bool> failed_{false};
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+  std::mutex error_mutex_;
+  std::string error_;
+};
+
+} // namespace
+
+ModuleDag ModuleDag::build(const Tig &design) {
+  const size_t n = design.modules.size();
+  ModuleDag dag;
+  dag.children.resize(n);
+  dag.parents.resize(n);
+  std::vector<bool> instantiated(n, false);
+  for (ModuleId m = 0; m < n; m++) {
+    // Only instance nodes carry a module id.
+    std::vector<ModuleId> ids;
+    for (const auto &attrs : design.modules[m].attrs) {
+      if (attrs.module_id < n) {
+        ids.push_back(attrs.module_id);
+      }
+    }
+    std::sort(ids.begin(), ids.end());
+    auto &children = dag.children[m];
+    for (const ModuleId id : ids) {
+      if (children.empty() || children.back().first != id) {
+        children.emplace_back(id, 0);
+      }
+      children.back().second++;
+      instantiated[id] = true;
+    }
+  }
+
+  // Depth-first post-order from every module; an edge into the current path
+  // would close a cycle and is dropped.
+  enum : uint8_t { kNew, kOnPath, kDone };
+  std::vector<uint8_t> state(n, kNew);
+  std::vector<std::vector<bool>> cyclic(n);
+  for (ModuleId m = 0; m < n; m++) {
+    cyclic[m].assign(dag.children[m].size(), false);
+  }
+  dag.bottom_up.reserve(n);
+  std::vector<std::pair<ModuleId, size_t>> stack;
+  for (ModuleId root = 0; root < n; root++) {
+    if (state[root] != kNew) {
+      continue;
+    }
+    state[root] = kOnPath;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      auto &[m, next] = stack.back();
+      if (next == dag.children[m].size()) {
+        state[m] = kDone;
+        dag.bottom_up.push_back(m);
+        stack.pop_back();
+        continue;
+      }
+      const size_t edge = next++;
+      const ModuleId child = dag.children[m][edge].first;
+      if (state[child] == kOnPath) {
+        cyclic[m][edge] = true;
+      } else if (state[child] == kNew) {
+        state[child] = kOnPath;
+        stack.emplace_back(child, 0);
+      }
+    }
+  }
+
+  for (ModuleId m = 0; m < n; m++) {
+    auto &children = dag.children[m];
+    size_t kept = 0;
+    for (size_t e = 0; e < children.size(); e++) {
+      if (cyclic[m][e]) {
+        dag.cyclic_edges++;
+      } else {
+        children[kept++] = children[e];
+      }
+    }
+    children.resize(kept);
+    for (const auto &[child, count] : children) {
+      dag.parents[child].push_back(m);
+    }
+    if (!instantiated[m]) {
+      dag.tops.push_back(m);
+    }
+  }
+  return dag;
+}
+
+PassRunResult PassManager::run(const Tig &design) const {
+  PassRunResult result;
+  const ModuleDag dag = ModuleDag::build(design);
+  const unsigned threads = util::resolve_num_threads(options_.num_threads);
+  for (const ModulePass &pass : passes_) {
+    PassTiming &timing = result.timings.emplace_back();
+    timing.name = pass.name;
+    timing.modules.assign(design.modules.size(), std::chrono::nanoseconds{0});
+    const auto start = Clock::now();
+    std::string error;
+    {
+      util::ScopedTimer timer("phase", pass.name);
+      const PassGraph graph = pass_graph(dag, pass.order);
+      Scheduler scheduler(design, pass, graph, timing);
+      error = scheduler.run(threads);
+    }
+    timing.wall = Clock::now() - start;
+    if (!error.empty()) {
+      result.message = std::move(error);
+      return result;
+    }
+  }
+  result.ok = true;
+  result.message = "ok";
+  return result;
+}
+
+} // namespace abys::ir
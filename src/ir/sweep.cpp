@@ -0,0 +1,683 @@
+#include "abys/ir/sweep.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "abys/ir/pass_manager.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+using ModuleId = Tig::ModuleId;
+using NodeId = Tig::NodeId;
+
+constexpr uint32_t kDropped = std::numeric_limits<uint32_t>::max();
+
+// Node and output marks of one module as bitsets as large as the module, for
+// sweeping a whole design.
+class DenseMarks {
+public:
+  void init(const Module &module) {
+    nodes_.assign(words(module.num_nodes()), 0);
+    outputs_.assign(words(module.outputs.size()), 0);
+  }
+
+  bool mark_node(NodeId n) { return set(nodes_, n); }
+  bool mark_output(uint32_t i) { return set(outputs_, i); }
+
+  // Prepares rank(); no marks may be added afterwards.
+  void finish() {
+    ranks_.resize(nodes_.size());
+    uint32_t count = 0;
+    for (size_t w = 0; w < nodes_.size(); w++) {
+      ranks_[w] = count;
+      count += static_cast<uint32_t>(std::popcount(nodes_[w]));
+    }
+    count_ = count;
+  }
+
+  size_t count() const { return count_; }
+
+  // The new id of node `n`: the number of marked nodes before it, or kDropped.
+  uint32_t rank(NodeId n) const {
+    const uint64_t word = nodes_[n / 64];
+    const uint64_t bit = uint64_t{1} << (n % 64);
+    if (!(word & bit)) {
+      return kDropped;
+    }
+    return ranks_[n / 64] + static_cast<uint32_t>(std::popcount(word & (bit - 1)));
+  }
+
+  // Calls `f` on every marked node in increasing order.
+  template <typename F> void for_each_node(F &&f) const {
+    for (size_t w = 0; w < nodes_.size(); w++) {
+      for (uint64_t word = nodes_[w]; word != 0; word &= word - 1) {
+        f(static_cast<NodeId>(w * 64 + std::countr_zero(word)));
+      }
+    }
+  }
+
+private:
+  static size_t words(size_t bits) { return (bits + 63) / 64; }
+
+  static bool set(std::vector<uint64_t> &bits, size_t i) {
+    uint64_t &word = bits[i / 64];
+    const uint64_t bit = uint64_t{1} << (i % 64);
+    if (word & bit) {
+      return false;
+    }
+    word |= bit;
+    return true;
+  }
+
+  std::vector<uint64_t> nodes_;
+  std::vector<uint64_t> outputs_;
+  std::vector<uint32_t> ranks_;
+  size_t count_ = 0;
+};
+
+// The same marks as hash sets holding only what was marked, for cones.
+class SparseMarks {
+public:
+  void init(const Module &) {}
+
+  bool mark_node(NodeId n) { return nodes_.insert(n).second; }
+  bool mark_output(uint32_t i) { return outputs_.insert(i).second; }
+
+  void finish() {
+    sorted_.assign(nodes_.begin(), nodes_.end());
+    std::sort(sorted_.begin(), sorted_.end());
+  }
+
+  size_t count() const { return sorted_.size(); }
+
+  uint32_t rank(NodeId n) const {
+    const auto it = std::lower_bound(sorted_.begin(), sorted_.end(), n);
+    return it != sorted_.end() && *it == n ? static_cast<uint32_t>(it - sorted_.begin())
+                                           : kDropped;
+  }
+
+  template <typename F> void for_each_node(F &&f) const {
+    for (const NodeId n : sorted_) {
+      f(n);
+    }
+  }
+
+private:
+  std::unordered_set<NodeId> nodes_;
+  std::unordered_set<uint32_t> outputs_;
+  std::vector<NodeId> sorted_;
+};
+
+// New index of each input and output port of a module whose unused ports are
+// dropped, or kDropped.
+struct PortMap {
+  std::vector<uint32_t> inputs;
+  std::vector<uint32_t> outputs;
+};
+
+template <typename Marks> struct ModuleState {
+  Marks marks;
+  // kPi and kPo nodes in node order, matched to instance ports.
+  std::vector<NodeId> pis;
+  std::vector<NodeId> pos;
+  // Input ports a kept node reads, and output ports a kept instance reads.
+  std::vector<bool> used_inputs;
+  std::vector<bool> used_outputs;
+  // Kept instances of the module, as {parent module, instance node}.
+  std::vector<std::pair<ModuleId, NodeId>> instances;
+  // The block each kRi and kRo node a block lists belongs to.
+  std::unordered_map<NodeId, uint32_t> block_of;
+  std::vector<bool> kept_blocks;
+  PortMap ports;
+};
+
+// Marks the cone of influence of the outputs and nodes it is asked to keep,
+// across instances, with a worklist of {module, node} pairs.
+//
+// A node is visited once, when first kept. Visiting reads its fanins, which
+// keeps the driving nodes and marks the outputs read; reading an instance
+// output keeps the child's kPo node for that port. An instance's input is read
+// only once the child's kPi node for that port is kept, whichever is visited
+// first. Keeping a node a block lists keeps the whole block.
+template <typename Marks> class ConeMarker {
+public:
+  // With `holds_state`, every module reached also keeps its blocks, its kRi
+  // nodes and its instances of the modules `holds_state` flags.
+  ConeMarker(const Tig &design, const std::vector<bool> *holds_state)
+      : design_(design), holds_state_(holds_state), states_(design.modules.size()) {}
+
+  void keep_output(ModuleId m, Tig::PortIndex port) {
+    auto &s = reach(m);
+    if (port >= s.pos.size() || s.used_outputs[port]) {
+      return;
+    }
+    s.used_outputs[port] = true;
+    keep_node(m, s.pos[port]);
+  }
+
+  void keep_all_outputs(ModuleId m) {
+    const size_t num_outputs = reach(m).pos.size();
+    for (size_t port = 0; port < num_outputs; port++) {
+      keep_output(m, static_cast<Tig::PortIndex>(port));
+    }
+  }
+
+  void run() {
+    while (!work_.empty()) {
+      const auto [m, n] = work_.back();
+      work_.pop_back();
+      visit(m, n);
+    }
+  }
+
+  bool reached(ModuleId m) const { return states_[m] != nullptr; }
+  ModuleState<Marks> &state(ModuleId m) { return *states_[m]; }
+  const ModuleState<Marks> &state(ModuleId m) const { return *states_[m]; }
+
+  // Reached modules, in the order they were reached.
+  const std::vector<ModuleId> &entered() const { return entered_; }
+
+  ModuleState<Marks> &reach(ModuleId m) {
+    if (states_[m]) {
+      return *states_[m];
+    }
+    states_[m] = std::make_unique<ModuleState<Marks>>();
+    entered_.push_back(m);
+    auto &s = *states_[m];
+    const Module &module = design_.modules[m];
+    s.marks.init(module);
+    for (NodeId n = 0; n < module.num_nodes(); n++) {
+      if (module.kind(n) == NodeKind::kPi) {
+        s.pis.push_back(n);
+      } else if (module.kind(n) == NodeKind::kPo) {
+        s.pos.push_back(n);
+      }
+    }
+    s.used_inputs.assign(s.pis.size(), false);
+    s.used_outputs.assign(s.pos.size(), false);
+    s.kept_blocks.assign(module.blocks.size(), false);
+    for (uint32_t b = 0; b < module.blocks.size(); b++) {
+      const auto &block = module.blocks[b];
+      for (const auto *nodes : {&block.inputs, &block.outputs}) {
+        for (const NodeId n : *nodes) {
+          s.block_of.emplace(n, b);
+        }
+      }
+    }
+    if (holds_state_) {
+      for (uint32_t b = 0; b < module.blocks.size(); b++) {
+        keep_block(m, b);
+      }
+      for (NodeId n = 0; n < module.num_nodes(); n++) {
+        const NodeKind kind = module.kind(n);
+        const ModuleId child = module.instance_module_id(n);
+        if (kind == NodeKind::kRi || (kind == NodeKind::kInstance && child < states_.size() &&
+                                      (*holds_state_)[child])) {
+          keep_node(m, n);
+        }
+      }
+    }
+    return s;
+  }
+
+private:
+  void keep_node(ModuleId m, NodeId n) {
+    if (n < design_.modules[m].num_nodes() && states_[m]->marks.mark_node(n)) {
+      work_.emplace_back(m, n);
+    }
+  }
+
+  void keep_block(ModuleId m, uint32_t b) {
+    auto &s = *states_[m];
+    if (s.kept_blocks[b]) {
+      return;
+    }
+    s.kept_blocks[b] = true;
+    const auto &block = design_.modules[m].blocks[b];
+    for (const auto *nodes : {&block.inputs, &block.outputs}) {
+      for (const NodeId n : *nodes) {
+        keep_node(m, n);
+      }
+    }
+  }
+
+  void read(ModuleId m, const EdgeRef &edge) {
+    const Module &module = design_.modules[m];
+    if (edge.node_id >= module.num_nodes()) {
+      return;
+    }
+    if (!states_[m]->marks.mark_output(module.output_offsets[edge.node_id] + edge.port_idx)) {
+      return;
+    }
+    const ModuleId child = module.instance_module_id(edge.node_id);
+    if (module.kind(edge.node_id) == NodeKind::kInstance && child < states_.size()) {
+      keep_output(child, edge.port_idx);
+    }
+    keep_node(m, edge.node_id);
+  }
+
+  void visit(ModuleId m, NodeId n) {
+    const Module &module = design_.modules[m];
+    auto &s = *states_[m];
+    const auto fanins = module.node_fanins(n);
+    const ModuleId child = module.instance_module_id(n);
+    if (module.kind(n) == NodeKind::kPi) {
+      const size_t port = std::lower_bound(s.pis.begin(), s.pis.end(), n) - s.pis.begin();
+      s.used_inputs[port] = true;
+      for (const auto &[parent, instance] : s.instances) {
+        read_instance_input(parent, instance, port);
+      }
+    } else if (module.kind(n) == NodeKind::kInstance && child < states_.size()) {
+      auto &c = reach(child);
+      c.instances.emplace_back(m, n);
+      for (size_t port = 0; port < c.used_inputs.size(); port++) {
+        if (c.used_inputs[port]) {
+          read_instance_input(m, n, port);
+        }
+      }
+    } else {
+      for (const EdgeRef &fanin : fanins) {
+        read(m, fanin);
+      }
+    }
+    if (!s.block_of.empty()) {
+      if (const auto it = s.block_of.find(n); it != s.block_of.end()) {
+        keep_block(m, it->second);
+      }
+    }
+  }
+
+  void read_instance_input(ModuleId m, NodeId instance, size_t port) {
+    const auto fanins = design_.modules[m].node_fanins(instance);
+    if (port < fanins.size()) {
+      read(m, fanins[port]);
+    }
+  }
+
+  const Tig &design_;
+  const std::vector<bool> *holds_state_;
+  std::vector<std::unique_ptr<ModuleState<Marks>>> states_;
+  std::vector<ModuleId> entered_;
+  std::vector<std::pair<ModuleId, NodeId>> work_;
+};
+
+// Copy the nodes `s` kept from `from`, in order, renumbered densely. `ctx`
+// translates module ids, names and parameter sets and, for modules whose
+// unused ports are dropped, gives their port maps. Fanins whose driver was
+// dropped, which nothing observes, are tied to an all-x constant of their
+// width appended after the kept nodes, and counted in `tied`.
+template <typename Marks, typename Context>
+Module compact_module(const Module &from, const ModuleState<Marks> &s, Context &ctx,
+                      size_t &tied) {
+  Module to;
+  to.name = ctx.name(from.name);
+  const PortMap *own = ctx.ports_of_self();
+  auto copy_ports = [&](const std::vector<Module::Port> &ports,
+                        const std::vector<uint32_t> *map, std::vector<Module::Port> &out) {
+    for (size_t i = 0; i < ports.size(); i++) {
+      if (!map || i >= map->size() || (*map)[i] != kDropped) {
+        out.push_back({ctx.name(ports[i].name), ports[i].width, ports[i].sign});
+      }
+    }
+  };
+  copy_ports(from.input_ports, own ? &own->inputs : nullptr, to.input_ports);
+  copy_ports(from.output_ports, own ? &own->outputs : nullptr, to.output_ports);
+
+  auto child_ports = [&](NodeId n) -> const PortMap * {
+    if (from.kind(n) != NodeKind::kInstance) {
+      return nullptr;
+    }
+    const ModuleId child = from.instance_module_id(n);
+    return child == Tig::kInvalidModuleId ? nullptr : ctx.ports(child);
+  };
+  auto kept_port = [](const std::vector<uint32_t> &map, size_t i) {
+    return i >= map.size() ? i : map[i];
+  };
+  auto edge = [&](const EdgeRef &e) -> EdgeRef {
+    if (e.node_id >= from.num_nodes()) {
+      return e;
+    }
+    const uint32_t node = s.marks.rank(e.node_id);
+    const PortMap *ports = child_ports(e.node_id);
+    const size_t port = ports ? kept_port(ports->outputs, e.port_idx) : e.port_idx;
+    if (node == kDropped || port == kDropped) {
+      return {};
+    }
+    return {node, static_cast<Tig::PortIndex>(port)};
+  };
+
+  const size_t num_nodes = s.marks.count();
+  std::vector<Tig::SignalWidth> tie_widths;
+  std::unordered_map<Tig::SignalWidth, NodeId> ties;
+  auto tie = [&](const EdgeRef &e) -> EdgeRef {
+    const auto outputs = from.node_outputs(e.node_id);
+    const Tig::SignalWidth width = e.port_idx < outputs.size() ? outputs[e.port_idx].width : 0;
+    auto [it, added] = ties.try_emplace(width, static_cast<NodeId>(num_nodes + ties.size()));
+    if (added) {
+      tie_widths.push_back(width);
+    }
+    tied++;
+    return {it->second, 0};
+  };
+  to.node_kinds.reserve(num_nodes);
+  to.node_attrs.reserve(num_nodes);
+  to.fanin_offsets.reserve(num_nodes + 1);
+  to.output_offsets.reserve(num_nodes + 1);
+  s.marks.for_each_node([&](NodeId n) {
+    const PortMap *ports = child_ports(n);
+    to.node_kinds.push_back(from.kind(n));
+    const auto fanins = from.node_fanins(n);
+    for (size_t i = 0; i < fanins.size(); i++) {
+      if (ports && kept_port(ports->inputs, i) == kDropped) {
+        continue;
+      }
+      const EdgeRef fanin = edge(fanins[i]);
+      const bool dropped =
+          fanin.node_id == Tig::kInvalidNodeId && fanins[i].node_id < from.num_nodes();
+      to.fanins.push_back(dropped ? tie(fanins[i]) : fanin);
+    }
+    to.fanin_offsets.push_back(static_cast<uint32_t>(to.fanins.size()));
+    const auto outputs = from.node_outputs(n);
+    for (size_t i = 0; i < outputs.size(); i++) {
+      if (!ports || kept_port(ports->outputs, i) != kDropped) {
+        to.outputs.push_back({ctx.name(outputs[i].name), outputs[i].width, outputs[i].sign});
+      }
+    }
+    to.output_offsets.push_back(static_cast<uint32_t>(to.outputs.size()));
+
+    const Module::NodeAttrs *a = from.find_attrs(n);
+    if (!a) {
+      to.node_attrs.push_back(Module::kNoAttrs);
+      return;
+    }
+    Module::NodeAttrs attrs = *a;
+    attrs.name = ctx.name(a->name);
+    attrs.op = ctx.name(a->op);
+    if (a->module_id != Tig::kInvalidModuleId) {
+      attrs.module_id = ctx.module(a->module_id);
+    }
+    const auto widths = from.node_segment_widths(n);
+    attrs.segments_begin = static_cast<uint32_t>(to.segment_widths.size());
+    to.segment_widths.insert(to.segment_widths.end(), widths.begin(), widths.end());
+    attrs.segments_end = static_cast<uint32_t>(to.segment_widths.size());
+    if (from.kind(n) == NodeKind::kConst) {
+      const ConstView value = from.node_const(n);
+      attrs.const_value = static_cast<uint32_t>(to.const_words.size());
+      to.const_words.insert(to.const_words.end(), value.value_words().begin(),
+                            value.value_words().end());
+      if (!value.unknown_words().empty()) {
+        to.const_words.insert(to.const_words.end(), value.unknown_words().begin(),
+                              value.unknown_words().end());
+        attrs.const_value |= Module::kConstUnknownPlane;
+      }
+    }
+    to.node_attrs.push_back(static_cast<uint32_t>(to.attrs.size()));
+    to.attrs.push_back(attrs);
+  });
+  for (const Tig::SignalWidth width : tie_widths) {
+    to.node_kinds.push_back(NodeKind::kConst);
+    to.fanin_offsets.push_back(static_cast<uint32_t>(to.fanins.size()));
+    to.outputs.push_back({kEmptyName, width, false});
+    to.output_offsets.push_back(static_cast<uint32_t>(to.outputs.size()));
+    Module::NodeAttrs attrs;
+    attrs.segments_begin = attrs.segments_end = static_cast<uint32_t>(to.segment_widths.size());
+    attrs.const_value = static_cast<uint32_t>(to.const_words.size()) | Module::kConstUnknownPlane;
+    const size_t words = ConstView::words_for(width);
+    to.const_words.resize(to.const_words.size() + words, 0);
+    for (size_t w = 0; w < words; w++) {
+      const uint64_t bits = width - w * 64;
+      to.const_words.push_back(bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1);
+    }
+    to.node_attrs.push_back(static_cast<uint32_t>(to.attrs.size()));
+    to.attrs.push_back(attrs);
+  }
+
+  for (size_t b = 0; b < from.blocks.size(); b++) {
+    if (!s.kept_blocks[b]) {
+      continue;
+    }
+    const Module::Block &block = from.blocks[b];
+    Module::Block &copy = to.blocks.emplace_back();
+    copy.kind = block.kind;
+    copy.name = ctx.name(block.name);
+    copy.impl_name = ctx.name(block.impl_name);
+    copy_ports(block.input_ports, nullptr, copy.input_ports);
+    copy_ports(block.output_ports, nullptr, copy.output_ports);
+    auto node = [&](NodeId n) { return n < from.num_nodes() ? s.marks.rank(n) : n; };
+    std::transform(block.inputs.begin(), block.inputs.end(), std::back_inserter(copy.inputs),
+                   node);
+    std::transform(block.outputs.begin(), block.outputs.end(),
+                   std::back_inserter(copy.outputs), node);
+    copy.params = ctx.params(block.params);
+    copy.attributes = ctx.params(block.attributes);
+  }
+
+  for (const auto &[name, e] : from.signal_map) {
+    const EdgeRef moved = edge(e);
+    if (moved.node_id != Tig::kInvalidNodeId) {
+      to.signal_map.emplace(ctx.name(name), moved);
+    }
+  }
+  return to;
+}
+
+// Sweeping keeps module ids dense and everything else as it is.
+struct SweepContext {
+  const std::vector<ModuleId> &remap;
+
+  ModuleId module(ModuleId m) const { return m < remap.size() ? remap[m] : m; }
+  const PortMap *ports(ModuleId) const { return nullptr; }
+  const PortMap *ports_of_self() const { return nullptr; }
+  NameId name(NameId name) const { return name; }
+  ParamSetId params(ParamSetId set) const { return set; }
+};
+
+// A cone drops unused ports and carries names and parameter sets over into a
+// design of its own.
+struct ConeContext {
+  const Tig &from;
+  Tig &to;
+  const ConeMarker<SparseMarks> &marker;
+  const std::unordered_map<ModuleId, ModuleId> &remap;
+  ModuleId self = Tig::kInvalidModuleId;
+  std::unordered_map<NameId, NameId> names;
+  std::unordered_map<ParamSetId, ParamSetId> sets;
+
+  ModuleId module(ModuleId m) const {
+    const auto it = remap.find(m);
+    return it == remap.end() ? Tig::kInvalidModuleId : it->second;
+  }
+  const PortMap *ports(ModuleId m) const {
+    return m < from.modules.size() && marker.reached(m) ? &marker.state(m).ports : nullptr;
+  }
+  const PortMap *ports_of_self() const { return ports(self); }
+  NameId name(NameId name) {
+    if (name == kEmptyName) {
+      return name;
+    }
+    auto [it, added] = names.try_emplace(name);
+    if (added) {
+      it->second = to.names.intern(from.names.view(name));
+    }
+    return it->second;
+  }
+  ParamSetId params(ParamSetId set) {
+    if (set == kEmptyParamSet) {
+      return set;
+    }
+    auto [it, added] = sets.try_emplace(set);
+    if (added) {
+      it->second = to.params.import(from.params, set, [this](NameId n) { return name(n); });
+    }
+    return it->second;
+  }
+};
+
+std::vector<uint32_t> port_map(const std::vector<bool> &used) {
+  std::vector<uint32_t> map;
+  map.reserve(used.size());
+  uint32_t next = 0;
+  for (const bool u : used) {
+    map.push_back(u ? next++ : kDropped);
+  }
+  return map;
+}
+
+} // namespace
+
+SweepReport sweep_dead_logic(Tig &design, const SweepOptions &options) {
+  // Modules are read through `source`, so that those left as they are stay
+  // shared with copies of the design.
+  const Tig &source = design;
+  SweepReport report;
+  const size_t n = design.modules.size();
+  report.modules_before = n;
+  for (const auto &module : design.modules) {
+    report.nodes_before += module.num_nodes();
+  }
+
+  const ModuleDag dag = ModuleDag::build(design);
+  std::vector<bool> holds_state(n, false);
+  for (const ModuleId m : dag.bottom_up) {
+    const Module &module = source.modules[m];
+    bool holds = !module.blocks.empty() ||
+                 std::find(module.node_kinds.begin(), module.node_kinds.end(), NodeKind::kRi) !=
+                     module.node_kinds.end();
+    for (const auto &[child, count] : dag.children[m]) {
+      holds = holds || holds_state[child];
+    }
+    holds_state[m] = holds;
+  }
+
+  ConeMarker<DenseMarks> marker(design, &holds_state);
+  if (options.roots.empty()) {
+    for (ModuleId m = 0; m < n; m++) {
+      if (dag.parents[m].empty()) {
+        marker.keep_all_outputs(m);
+      }
+    }
+  }
+  for (const ModuleId m : options.roots) {
+    if (m < n) {
+      marker.keep_all_outputs(m);
+    }
+  }
+  marker.run();
+
+  // Survivors keep their relative order.
+  report.remap.assign(n, Tig::kInvalidModuleId);
+  for (ModuleId m = 0; m < n; m++) {
+    if (marker.reached(m)) {
+      report.remap[m] = static_cast<ModuleId>(report.modules_after++);
+    }
+  }
+
+  // Compaction drops instance nodes. That is safe for the hierarchy the
+  // manager derived up front only because no pass follows. A module that keeps
+  // every node and whose instances keep their module ids is left in place.
+  std::vector<Module> compacted(n);
+  std::vector<bool> unchanged(n, false);
+  std::vector<size_t> tied(n, 0);
+  const SweepContext ctx{report.remap};
+  PassManager passes({options.num_threads});
+  passes.add({"sweep", PassOrder::kAny, [&](ModuleId m) {
+                if (!marker.reached(m)) {
+                  return;
+                }
+                // Ports stay, read or not.
+                auto &s = marker.state(m);
+                for (const auto *nodes : {&s.pis, &s.pos}) {
+                  for (const NodeId node : *nodes) {
+                    s.marks.mark_node(node);
+                  }
+                }
+                s.marks.finish();
+                const Module &module = source.modules[m];
+                unchanged[m] = s.marks.count() == module.num_nodes() &&
+                               std::all_of(module.attrs.begin(), module.attrs.end(),
+                                           [&](const Module::NodeAttrs &attrs) {
+                                             return attrs.module_id == Tig::kInvalidModuleId ||
+                                                    report.remap[attrs.module_id] ==
+                                                        attrs.module_id;
+                                           });
+                if (!unchanged[m]) {
+                  compacted[m] = compact_module(module, s, ctx, tied[m]);
+                }
+              }});
+  // Compaction fails only when it runs out of memory.
+  if (const auto run = passes.run(design); !run.ok) {
+    throw std::runtime_error(run.message);
+  }
+
+  for (ModuleId m = 0; m < n; m++) {
+    if (!marker.reached(m)) {
+      continue;
+    }
+    if (unchanged[m]) {
+      report.nodes_after += source.modules[m].num_nodes();
+      continue;
+    }
+    report.nodes_after += compacted[m].num_nodes();
+    report.tied_inputs += tied[m];
+    design.modules.replace(m, std::move(compacted[m]));
+  }
+  design.modules.retain([&](size_t m) { return marker.reached(static_cast<ModuleId>(m)); });
+  return report;
+}
+
+ConeResult extract_cone(const Tig &design, Tig::ModuleId module_id, Tig::PortIndex output_port) {
+  ConeResult result;
+  if (module_id >= design.modules.size()) {
+    result.message = "no module " + std::to_string(module_id);
+    return result;
+  }
+  ConeMarker<SparseMarks> marker(design, nullptr);
+  const size_t num_outputs = marker.reach(module_id).pos.size();
+  if (output_port >= num_outputs) {
+    result.message = "module " + std::string(design.names.view(design.modules[module_id].name)) +
+                     " has " + std::to_string(num_outputs) + " outputs, not " +
+                     std::to_string(output_port + 1);
+    return result;
+  }
+  marker.keep_output(module_id, output_port);
+  marker.run();
+
+  std::vector<ModuleId> entered = marker.entered();
+  std::sort(entered.begin(), entered.end());
+  std::unordered_map<ModuleId, ModuleId> remap;
+  for (const ModuleId m : entered) {
+    remap.emplace(m, static_cast<ModuleId>(remap.size()));
+    auto &s = marker.state(m);
+    s.marks.finish();
+    s.ports = {port_map(s.used_inputs), port_map(s.used_outputs)};
+  }
+
+  ConeContext ctx{design, result.design, marker, remap, Tig::kInvalidModuleId, {}, {}};
+  result.design.modules.reserve(entered.size());
+  // Every edge of a cone stays inside it.
+  size_t tied = 0;
+  for (const ModuleId m : entered) {
+    ctx.self = m;
+    result.design.modules.push_back(
+        compact_module(design.modules[m], marker.state(m), ctx, tied));
+  }
+  result.top = remap.at(module_id);
+  result.ok = true;
+  result.message = "ok";
+  return result;
+}
+
+} // namespace abys::ir
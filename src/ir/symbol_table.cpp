@@ -0,0 +1,75 @@
+#include "abys/ir/symbol_table.h"
+
+#include <cassert>
+
+namespace abys::ir {
+
+SymbolTable::SymbolTable() : offsets_{0, 0}, slots_(16, kInvalidName) {
+  slots_[hash({}) & (slots_.size() - 1)] = kEmptyName;
+}
+
+uint64_t SymbolTable::hash(std::string_view name) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (const char c : name) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+NameId SymbolTable::find(std::string_view chars, std::span<const uint32_t> offsets,
+                         std::span<const NameId> slots, std::string_view name) {
+  const size_t mask = slots.size() - 1;
+  for (size_t i = hash(name) & mask;; i = (i + 1) & mask) {
+    const NameId id = slots[i];
+    if (id == kInvalidName ||
+        chars.substr(offsets[id], offsets[id + 1] - offsets[id]) == name) {
+      return id;
+    }
+  }
+}
+
+NameId SymbolTable::find(std::string_view name) const {
+  return find(chars_, offsets_, slots_, name);
+}
+
+NameId SymbolTable::intern(std::string_view name) {
+  size_t mask = slots_.size() - 1;
+  size_t i = hash(name) & mask;
+  for (; slots_[i] != kInvalidName; i = (i + 1) & mask) {
+    if (view(slots_[i]) == name) {
+      return slots_[i];
+    }
+  }
+  const NameId id = size();
+  assert(id != kInvalidName);
+  chars_.append(name);
+  offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+  slots_[i] = id;
+  if (2 * static_cast<size_t>(size()) > slots_.size()) {
+    grow();
+  }
+  return id;
+}
+
+void SymbolTable::assign(std::string_view chars, std::span<const uint32_t> offsets,
+                         std::span<const NameId> slots) {
+  chars_.assign(chars);
+  offsets_.assign(offsets.begin(), offsets.end());
+  slots_.assign(slots.begin(), slots.end());
+}
+
+void SymbolTable::grow() {
+  std::vector<NameId> slots(2 * slots_.size(), kInvalidName);
+  const size_t mask = slots.size() - 1;
+  for (NameId id = 0; id < size(); id++) {
+    size_t i = hash(view(id)) & mask;
+    while (slots[i] != kInvalidName) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = id;
+  }
+  slots_ = std::move(slots);
+}
+
+} // namespace abys::ir
@@ -0,0 +1,225 @@
+#include "abys/ir/tig.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using NodeId = Tig::NodeId;
+using EdgeRef = Module::EdgeRef;
+using GraphIndex = Module::GraphIndex;
+
+// Drop an index that no longer describes the module's nodes and edges.
+GraphIndex &checked_index(const Module &module) {
+  GraphIndex &index = module.graph_index;
+  if (index.num_nodes != module.num_nodes() || index.num_edges != module.fanins.size()) {
+    index = {};
+    index.num_nodes = module.num_nodes();
+    index.num_edges = module.fanins.size();
+  }
+  return index;
+}
+
+uint32_t compute_level(const Module &module, const GraphIndex &index, NodeId node_id) {
+  uint32_t level = 0;
+  for (const EdgeRef &fanin : module.node_fanins(node_id)) {
+    if (fanin.node_id != Tig::kInvalidNodeId) {
+      level = std::max(level, index.levels[fanin.node_id] + 1);
+    }
+  }
+  return level;
+}
+
+void build_fanouts(const Module &module, GraphIndex &index) {
+  const NodeId num_nodes = module.num_nodes();
+  index.fanout_offsets.assign(num_nodes + 1, 0);
+  for (const EdgeRef &fanin : module.fanins) {
+    if (fanin.node_id != Tig::kInvalidNodeId) {
+      index.fanout_offsets[fanin.node_id + 1]++;
+    }
+  }
+  for (NodeId n = 0; n < num_nodes; n++) {
+    index.fanout_offsets[n + 1] += index.fanout_offsets[n];
+  }
+  index.fanouts.resize(index.fanout_offsets[num_nodes]);
+  std::vector<uint32_t> cursor(index.fanout_offsets.begin(), index.fanout_offsets.end() - 1);
+  for (NodeId n = 0; n < num_nodes; n++) {
+    const auto fanins = module.node_fanins(n);
+    for (size_t i = 0; i < fanins.size(); i++) {
+      if (fanins[i].node_id != Tig::kInvalidNodeId) {
+        index.fanouts[cursor[fanins[i].node_id]++] = {n, static_cast<Tig::PortIndex>(i)};
+      }
+    }
+  }
+  index.fanouts_valid = true;
+}
+
+void build_levels(const Module &module, GraphIndex &index) {
+  index.levels.assign(module.num_nodes(), Module::kNoLevel);
+  for (const NodeId n : index.order) {
+    index.levels[n] = compute_level(module, index, n);
+  }
+  index.levels_valid = true;
+}
+
+// Kahn's algorithm, seeded in node id order so the result is deterministic.
+void build_order(const Module &module, GraphIndex &index) {
+  if (!index.fanouts_valid) {
+    build_fanouts(module, index);
+  }
+  const NodeId num_nodes = module.num_nodes();
+  std::vector<uint32_t> pending(num_nodes, 0);
+  for (NodeId n = 0; n < num_nodes; n++) {
+    for (const EdgeRef &fanin : module.node_fanins(n)) {
+      pending[n] += fanin.node_id != Tig::kInvalidNodeId ? 1 : 0;
+    }
+  }
+  index.order.clear();
+  index.order.reserve(num_nodes);
+  for (NodeId n = 0; n < num_nodes; n++) {
+    if (pending[n] == 0) {
+      index.order.push_back(n);
+    }
+  }
+  for (size_t head = 0; head < index.order.size(); head++) {
+    const NodeId n = index.order[head];
+    for (uint32_t f = index.fanout_offsets[n]; f < index.fanout_offsets[n + 1]; f++) {
+      if (--pending[index.fanouts[f].node_id] == 0) {
+        index.order.push_back(index.fanouts[f].node_id);
+      }
+    }
+  }
+  index.order_pos.assign(num_nodes, Module::kNoLevel);
+  for (size_t pos = 0; pos < index.order.size(); pos++) {
+    index.order_pos[index.order[pos]] = static_cast<uint32_t>(pos);
+  }
+  index.order_valid = true;
+  build_levels(module, index);
+}
+
+} // namespace
+
+std::span<const EdgeRef> Module::node_fanouts(NodeId node_id) const {
+  GraphIndex &index = checked_index(*this);
+  if (!index.fanouts_valid) {
+    build_fanouts(*this, index);
+  }
+  return {index.fanouts.data() + index.fanout_offsets[node_id],
+          index.fanouts.data() + index.fanout_offsets[node_id + 1]};
+}
+
+std::span<const NodeId> Module::topological_order() const {
+  GraphIndex &index = checked_index(*this);
+  if (!index.order_valid) {
+    build_order(*this, index);
+  }
+  return index.order;
+}
+
+uint32_t Module::node_level(NodeId node_id) const {
+  GraphIndex &index = checked_index(*this);
+  if (!index.order_valid) {
+    build_order(*this, index);
+  } else if (!index.levels_valid) {
+    build_levels(*this, index);
+  }
+  return index.levels[node_id];
+}
+
+void Module::patch_graph_index_node_added(NodeId node_id) {
+  GraphIndex &index = graph_index;
+  const auto fanins = node_fanins(node_id);
+  if (index.num_nodes != node_id || index.num_edges != this->fanins.size() - fanins.size()) {
+    invalidate_graph_index();
+    return;
+  }
+  index.num_nodes = num_nodes();
+  index.num_edges = this->fanins.size();
+
+  const bool connected = std::any_of(fanins.begin(), fanins.end(), [](const EdgeRef &fanin) {
+    return fanin.node_id != Tig::kInvalidNodeId;
+  });
+  if (index.fanouts_valid) {
+    // A new node has no consumers, but its drivers gain one.
+    if (connected) {
+      index.fanouts_valid = false;
+    } else {
+      index.fanout_offsets.push_back(index.fanout_offsets.back());
+    }
+  }
+
+  // The node goes last unless a driver is left out of the order, in which
+  // case Kahn's algorithm would leave it out too.
+  if (index.order_valid) {
+    const bool ordered = std::all_of(fanins.begin(), fanins.end(), [&](const EdgeRef &fanin) {
+      return fanin.node_id == Tig::kInvalidNodeId || index.order_pos[fanin.node_id] != kNoLevel;
+    });
+    index.order_pos.push_back(ordered ? static_cast<uint32_t>(index.order.size()) : kNoLevel);
+    if (ordered) {
+      index.order.push_back(node_id);
+    }
+    if (index.levels_valid) {
+      index.levels.push_back(kNoLevel);
+      if (ordered) {
+        index.levels[node_id] = compute_level(*this, index, node_id);
+      }
+    }
+  }
+}
+
+void Module::patch_graph_index_input_changed(NodeId node_id, PortIndex port_idx,
+                                             EdgeRef old_input) {
+  GraphIndex &index = graph_index;
+  const EdgeRef input = node_fanins(node_id)[port_idx];
+  if (index.num_nodes != num_nodes() || index.num_edges != fanins.size() ||
+      input.node_id == old_input.node_id) {
+    return;
+  }
+
+  if (index.order_valid) {
+    // Adding or keeping an edge that points forward in a complete order keeps
+    // it valid. A partial order may gain nodes, so it is rebuilt.
+    const bool complete = index.order.size() == num_nodes();
+    const bool forward = input.node_id == Tig::kInvalidNodeId ||
+                         index.order_pos[input.node_id] < index.order_pos[node_id];
+    if (!complete || !forward) {
+      index.order_valid = false;
+      index.levels_valid = false;
+    }
+  }
+
+  // Only the node's own level and those downstream of it can change. The
+  // fanouts below the node are unaffected by the rewired edge, so they drive
+  // the propagation before being dropped.
+  if (index.levels_valid && index.fanouts_valid) {
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> queue;
+    queue.push(index.order_pos[node_id]);
+    uint32_t last = kNoLevel;
+    while (!queue.empty()) {
+      const uint32_t pos = queue.top();
+      queue.pop();
+      if (pos == last) {
+        continue;
+      }
+      last = pos;
+      const NodeId n = index.order[pos];
+      const uint32_t level = compute_level(*this, index, n);
+      if (level == index.levels[n]) {
+        continue;
+      }
+      index.levels[n] = level;
+      for (uint32_t f = index.fanout_offsets[n]; f < index.fanout_offsets[n + 1]; f++) {
+        queue.push(index.order_pos[index.fanouts[f].node_id]);
+      }
+    }
+  } else {
+    index.levels_valid = false;
+  }
+  index.fanouts_valid = false;
+}
+
+} // namespace abys::ir
@@ -1,80 +1,421 @@
 #include "abys/ir/tig_builder.h"
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
-#include <memory>
-#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "abys/util/hash.h"
 
 namespace abys::ir {
 
-TigBuilder::NodeId TigBuilder::create_node(Module &module, NodeKind kind) {
-  NodeId node_id = static_cast<NodeId>(module.nodes.size());
-  module.nodes.emplace_back();
-  module.nodes.back().kind = kind;
+namespace {
+
+// Apply `f` to every NameId field of `module` other than its own name and the
+// signal_map keys.
+template <typename F> void for_each_name(Tig::Module &module, F &&f) {
+  for (auto *ports : {&module.input_ports, &module.output_ports}) {
+    for (auto &port : *ports) {
+      f(port.name);
+    }
+  }
+  for (auto &output : module.outputs) {
+    f(output.name);
+  }
+  for (auto &attrs : module.attrs) {
+    f(attrs.name);
+    f(attrs.op);
+  }
+  for (auto &block : module.blocks) {
+    f(block.name);
+    f(block.impl_name);
+    for (auto *ports : {&block.input_ports, &block.output_ports}) {
+      for (auto &port : *ports) {
+        f(port.name);
+      }
+    }
+  }
+}
+
+constexpr Tig::NodeId kEmptySlot = Tig::kInvalidNodeId;
+constexpr Tig::NodeId kTombstone = Tig::kInvalidNodeId - 1;
+
+// The attribute that distinguishes otherwise equal nodes of a kind: the op, or
+// the hash of a constant's value.
+uint64_t hash_cons_key(const Tig::Module &module, Tig::NodeId node_id) {
+  if (module.kind(node_id) == Tig::Module::NodeKind::kConst) {
+    return module.node_const(node_id).hash();
+  }
+  const auto *attrs = module.find_attrs(node_id);
+  return attrs ? attrs->op : kEmptyName;
+}
+
+uint64_t hash_node(Tig::Module::NodeKind kind, uint64_t key, const Tig::Module::Output &output,
+                   std::span<const Tig::Module::EdgeRef> inputs) {
+  uint64_t h = util::hash_combine(static_cast<uint64_t>(kind), key);
+  h = util::hash_combine(h, output.width * 2 + (output.sign ? 1 : 0));
+  for (const Tig::Module::EdgeRef &input : inputs) {
+    h = util::hash_combine(h, (uint64_t{input.node_id} << 32) | input.port_idx);
+  }
+  return h;
+}
+
+} // namespace
+
+bool TigBuilder::hash_consable(const Module &module, NodeId node_id) const {
+  const NodeKind kind = module.kind(node_id);
+  if (kind != NodeKind::kConvert && kind != NodeKind::kOp && kind != NodeKind::kConst) {
+    return false;
+  }
+  const auto fanins = module.node_fanins(node_id);
+  return std::none_of(fanins.begin(), fanins.end(),
+                      [](const EdgeRef &fanin) { return fanin.node_id == kInvalidNodeId; });
+}
+
+TigBuilder::NodeId TigBuilder::hash_cons_find(ModuleId module_id, NodeKind kind, uint64_t key,
+                                              const SignalSpec &output,
+                                              std::span<const EdgeRef> inputs,
+                                              ConstView value) const {
+  if (module_id >= hash_cons_tables_.size() || hash_cons_tables_[module_id].slots.empty()) {
+    return kInvalidNodeId;
+  }
+  const Module &module = std::as_const(design_).modules[module_id];
+  const auto &slots = hash_cons_tables_[module_id].slots;
+  const size_t mask = slots.size() - 1;
+  for (size_t slot = hash_node(kind, key, output, inputs) & mask;
+       slots[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+    const NodeId node_id = slots[slot];
+    if (node_id == kTombstone || module.kind(node_id) != kind ||
+        hash_cons_key(module, node_id) != key ||
+        (kind == NodeKind::kConst && !(module.node_const(node_id) == value))) {
+      continue;
+    }
+    const auto &existing = module.node_outputs(node_id)[0];
+    const auto fanins = module.node_fanins(node_id);
+    if (existing.width == output.width && existing.sign == output.sign &&
+        std::equal(fanins.begin(), fanins.end(), inputs.begin(), inputs.end(),
+                   [](const EdgeRef &a, const EdgeRef &b) {
+                     return a.node_id == b.node_id && a.port_idx == b.port_idx;
+                   })) {
+      return node_id;
+    }
+  }
+  return kInvalidNodeId;
+}
+
+TigBuilder::NodeId TigBuilder::hash_cons_reuse(ModuleId module_id, NodeKind kind, uint64_t key,
+                                               const SignalSpec &output,
+                                               std::span<const EdgeRef> inputs,
+                                               ConstView value) {
+  if (!hash_consing_ ||
+      std::any_of(inputs.begin(), inputs.end(),
+                  [](const EdgeRef &input) { return input.node_id == kInvalidNodeId; })) {
+    return kInvalidNodeId;
+  }
+  hash_cons_stats_.lookups++;
+  const NodeId node_id = hash_cons_find(module_id, kind, key, output, inputs, value);
+  if (node_id != kInvalidNodeId) {
+    hash_cons_stats_.hits++;
+    add_signal(design_.modules[module_id], output.name, {node_id, 0});
+  }
+  return node_id;
+}
+
+void TigBuilder::hash_cons_insert(ModuleId module_id, NodeId node_id) {
+  if (module_id >= hash_cons_tables_.size()) {
+    hash_cons_tables_.resize(module_id + 1);
+  }
+  auto &table = hash_cons_tables_[module_id];
+  if ((table.used + 1) * 2 > table.slots.size()) {
+    // Rehash live entries into a table at most a quarter full.
+    std::vector<NodeId> live;
+    for (const NodeId n : table.slots) {
+      if (n != kEmptySlot && n != kTombstone) {
+        live.push_back(n);
+      }
+    }
+    table.slots.assign(std::max<size_t>(16, std::bit_ceil(4 * (live.size() + 1))), kEmptySlot);
+    table.used = 0;
+    live.push_back(node_id);
+    for (const NodeId n : live) {
+      hash_cons_place(module_id, n);
+    }
+    return;
+  }
+  hash_cons_place(module_id, node_id);
+}
+
+void TigBuilder::hash_cons_place(ModuleId module_id, NodeId node_id) {
+  const Module &module = std::as_const(design_).modules[module_id];
+  auto &table = hash_cons_tables_[module_id];
+  const size_t mask = table.slots.size() - 1;
+  size_t slot = hash_node(module.kind(node_id), hash_cons_key(module, node_id),
+                          module.node_outputs(node_id)[0], module.node_fanins(node_id)) &
+                mask;
+  while (table.slots[slot] != kEmptySlot && table.slots[slot] != kTombstone) {
+    slot = (slot + 1) & mask;
+  }
+  if (table.slots[slot] == kEmptySlot) {
+    table.used++;
+  }
+  table.slots[slot] = node_id;
+}
+
+void TigBuilder::hash_cons_erase(ModuleId module_id, NodeId node_id) {
+  if (module_id >= hash_cons_tables_.size() || hash_cons_tables_[module_id].slots.empty()) {
+    return;
+  }
+  const Module &module = std::as_const(design_).modules[module_id];
+  auto &slots = hash_cons_tables_[module_id].slots;
+  const size_t mask = slots.size() - 1;
+  for (size_t slot = hash_node(module.kind(node_id), hash_cons_key(module, node_id),
+                               module.node_outputs(node_id)[0], module.node_fanins(node_id)) &
+                     mask;
+       slots[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+    if (slots[slot] == node_id) {
+      slots[slot] = kTombstone;
+      return;
+    }
+  }
+}
+
+TigBuilder::NodeId TigBuilder::create_node(Module &module, NodeKind kind,
+                                           std::span<const EdgeRef> inputs,
+                                           std::span<const SignalSpec> outputs) {
+  NodeId node_id = module.num_nodes();
+  module.node_kinds.push_back(kind);
+  module.node_attrs.push_back(Module::kNoAttrs);
+  module.fanins.insert(module.fanins.end(), inputs.begin(), inputs.end());
+  module.fanin_offsets.push_back(static_cast<uint32_t>(module.fanins.size()));
+  module.outputs.insert(module.outputs.end(), outputs.begin(), outputs.end());
+  module.output_offsets.push_back(static_cast<uint32_t>(module.outputs.size()));
+  module.patch_graph_index_node_added(node_id);
   return node_id;
 }
 
-void TigBuilder::add_signal(Module &module, std::string_view name, EdgeRef edge) {
-  auto [it, inserted] = module.signal_map.emplace(std::string(name), edge);
+Tig::Module::NodeAttrs &TigBuilder::create_attrs(Module &module, NodeId node_id) {
+  assert(module.node_attrs[node_id] == Module::kNoAttrs);
+  module.node_attrs[node_id] = static_cast<uint32_t>(module.attrs.size());
+  return module.attrs.emplace_back();
+}
+
+void TigBuilder::add_signal(Module &module, NameId name, EdgeRef edge) {
+  if (name == kEmptyName) {
+    return;
+  }
+  auto [it, inserted] = module.signal_map.emplace(name, edge);
   assert(inserted);
   (void)it;
 }
 
-TigBuilder::ModuleId TigBuilder::create_module(std::string name) {
+ParamSetId TigBuilder::intern_params(
+    std::span<const std::pair<std::string_view, std::string_view>> params) {
+  std::vector<Param> set;
+  set.reserve(params.size());
+  for (const auto &[key, text] : params) {
+    set.push_back(design_.params.parse(design_.names, intern(key), text));
+  }
+  return design_.params.intern(set);
+}
+
+TigBuilder::ModuleId TigBuilder::create_module(std::string_view name) {
   ModuleId module_id = static_cast<ModuleId>(design_.modules.size());
   design_.modules.emplace_back();
-  design_.modules.back().name = std::move(name);
+  design_.modules.back().name = intern(name);
   return module_id;
 }
 
-TigBuilder::NodeId TigBuilder::create_module_input(ModuleId module_id, std::string name,
+void TigBuilder::adopt_module(ModuleId module_id, Tig &&local, ModuleId local_id) {
+  Module &module = design_.modules[module_id];
+  const NameId name = module.name;
+  if (module_id < hash_cons_tables_.size()) {
+    hash_cons_tables_[module_id] = {};
+  }
+  module = std::move(local.modules[local_id]);
+  module.name = name;
+
+  // Only names the module refers to are carried over, in local handle order.
+  std::vector<NameId> names(local.names.size(), kInvalidName);
+  for_each_name(module, [&](NameId &id) { names[id] = kEmptyName; });
+  for (const auto &entry : module.signal_map) {
+    names[entry.first] = kEmptyName;
+  }
+  for (const auto &block : module.blocks) {
+    for (const ParamSetId set : {block.params, block.attributes}) {
+      for (const Param &param : local.params.view(set)) {
+        names[param.key] = kEmptyName;
+        if (param.kind == ParamKind::kString || param.kind == ParamKind::kText) {
+          names[param.as_name()] = kEmptyName;
+        }
+      }
+    }
+  }
+  for (NameId id = 0; id < local.names.size(); id++) {
+    if (names[id] != kInvalidName) {
+      names[id] = intern(local.names.view(id));
+    }
+  }
+
+  for_each_name(module, [&](NameId &id) { id = names[id]; });
+  std::unordered_map<NameId, EdgeRef> signal_map;
+  signal_map.reserve(module.signal_map.size());
+  for (const auto &[signal, edge] : module.signal_map) {
+    signal_map.emplace(names[signal], edge);
+  }
+  module.signal_map = std::move(signal_map);
+
+  // Blocks share a handful of sets, so each is imported once.
+  std::vector<ParamSetId> sets(local.params.size(), kInvalidParamSet);
+  for (auto &block : module.blocks) {
+    for (ParamSetId *set : {&block.params, &block.attributes}) {
+      if (sets[*set] == kInvalidParamSet) {
+        sets[*set] = design_.params.import(local.params, *set, names);
+      }
+      *set = sets[*set];
+    }
+  }
+}
+
+TigBuilder::NodeId TigBuilder::create_module_input(ModuleId module_id, NameId name,
                                                    SignalWidth width, bool sign) {
   Module &module = design_.modules[module_id];
   module.input_ports.emplace_back(name, width, sign);
-  NodeId node_id = create_node(module, NodeKind::kPi);
-  auto &node = module.nodes[node_id];
-  node.outputs.emplace_back(name, width, sign);
+  const SignalSpec output{name, width, sign};
+  NodeId node_id = create_node(module, NodeKind::kPi, {}, {&output, 1});
   add_signal(module, name, {node_id, 0});
   return node_id;
 }
 
-TigBuilder::NodeId TigBuilder::create_module_output(ModuleId module_id, std::string name,
+TigBuilder::NodeId TigBuilder::create_module_output(ModuleId module_id, NameId name,
                                                     SignalWidth width, bool sign, NodeId input_id,
                                                     PortIndex port_idx) {
   Module &module = design_.modules[module_id];
   module.output_ports.emplace_back(Module::Port{name, width, sign});
-  NodeId node_id = create_node(module, NodeKind::kPo);
-  auto &node = module.nodes[node_id];
-  node.inputs.emplace_back(input_id, port_idx);
-  return node_id;
+  const EdgeRef input{input_id, port_idx};
+  return create_node(module, NodeKind::kPo, {&input, 1}, {});
 }
 
-TigBuilder::NodeId TigBuilder::create_conversion_node(ModuleId module_id, std::string name,
+TigBuilder::NodeId TigBuilder::create_conversion_node(ModuleId module_id, NameId name,
                                                       SignalWidth width, bool sign,
                                                       NodeId input_id, PortIndex port_idx) {
   Module &module = design_.modules[module_id];
-  NodeId node_id = create_node(module, NodeKind::kConvert);
-  auto &node = module.nodes[node_id];
-  node.inputs.emplace_back(input_id, port_idx);
-  node.outputs.emplace_back(name, width, sign);
+  const EdgeRef input{input_id, port_idx};
+  const SignalSpec output{name, width, sign};
+  if (NodeId existing = hash_cons_reuse(module_id, NodeKind::kConvert, kEmptyName, output,
+                                        {&input, 1});
+      existing != kInvalidNodeId) {
+    return existing;
+  }
+  NodeId node_id = create_node(module, NodeKind::kConvert, {&input, 1}, {&output, 1});
+  add_signal(module, name, {node_id, 0});
+  if (hash_consing_ && hash_consable(module, node_id)) {
+    hash_cons_insert(module_id, node_id);
+  }
+  return node_id;
+}
+
+TigBuilder::NodeId TigBuilder::create_op_node(ModuleId module_id, NameId name, NameId op,
+                                              SignalWidth width, bool sign,
+                                              std::span<const Signal> node_inputs) {
+  Module &module = design_.modules[module_id];
+  const SignalSpec output{name, width, sign};
+  if (NodeId existing = hash_cons_reuse(module_id, NodeKind::kOp, op, output, node_inputs);
+      existing != kInvalidNodeId) {
+    return existing;
+  }
+  NodeId node_id = create_node(module, NodeKind::kOp, node_inputs, {&output, 1});
+  create_attrs(module, node_id).op = op;
   add_signal(module, name, {node_id, 0});
+  if (hash_consing_ && hash_consable(module, node_id)) {
+    hash_cons_insert(module_id, node_id);
+  }
   return node_id;
 }
 
-TigBuilder::NodeId TigBuilder::create_instance(ModuleId module_id, std::string name,
+TigBuilder::NodeId TigBuilder::create_const_node(ModuleId module_id, NameId name,
+                                                 SignalWidth width, bool sign,
+                                                 std::string_view value) {
+  assert(value.size() == width);
+  const std::optional<ConstValue> parsed = ConstValue::parse(value);
+  assert(parsed);
+  return create_const_node(module_id, name, width, sign, parsed->view());
+}
+
+TigBuilder::NodeId TigBuilder::create_const_node(ModuleId module_id, NameId name,
+                                                 SignalWidth width, bool sign, ConstView value) {
+  assert(value.width() == width);
+  Module &module = design_.modules[module_id];
+  const SignalSpec output{name, width, sign};
+  if (NodeId existing =
+          hash_cons_reuse(module_id, NodeKind::kConst, value.hash(), output, {}, value);
+      existing != kInvalidNodeId) {
+    return existing;
+  }
+  NodeId node_id = create_node(module, NodeKind::kConst, {}, {&output, 1});
+  auto &attrs = create_attrs(module, node_id);
+  attrs.const_value = static_cast<uint32_t>(module.const_words.size());
+  assert(attrs.const_value < Module::kConstUnknownPlane);
+  const auto words = value.value_words();
+  module.const_words.insert(module.const_words.end(), words.begin(), words.end());
+  if (value.has_unknown()) {
+    const auto unknown = value.unknown_words();
+    module.const_words.insert(module.const_words.end(), unknown.begin(), unknown.end());
+    attrs.const_value |= Module::kConstUnknownPlane;
+  }
+  add_signal(module, name, {node_id, 0});
+  if (hash_consing_) {
+    hash_cons_insert(module_id, node_id);
+  }
+  return node_id;
+}
+
+TigBuilder::NodeId TigBuilder::create_split_node(ModuleId module_id, NodeId input_id,
+                                                 PortIndex port_idx,
+                                                 std::span<const SignalSpec> node_outputs) {
+  Module &module = design_.modules[module_id];
+  const EdgeRef input{input_id, port_idx};
+  NodeId node_id = create_node(module, NodeKind::kSplit, {&input, 1}, node_outputs);
+  auto &attrs = create_attrs(module, node_id);
+  attrs.segments_begin = static_cast<uint32_t>(module.segment_widths.size());
+  for (size_t i = 0; i < node_outputs.size(); i++) {
+    module.segment_widths.push_back(node_outputs[i].width);
+    add_signal(module, node_outputs[i].name, {node_id, static_cast<PortIndex>(i)});
+  }
+  attrs.segments_end = static_cast<uint32_t>(module.segment_widths.size());
+  return node_id;
+}
+
+TigBuilder::NodeId TigBuilder::create_merge_node(ModuleId module_id, NameId name,
+                                                 SignalWidth width, bool sign,
+                                                 std::span<const Signal> node_inputs,
+                                                 std::span<const SignalWidth> input_widths) {
+  assert(node_inputs.size() == input_widths.size());
+  Module &module = design_.modules[module_id];
+  const SignalSpec output{name, width, sign};
+  NodeId node_id = create_node(module, NodeKind::kMerge, node_inputs, {&output, 1});
+  auto &attrs = create_attrs(module, node_id);
+  attrs.segments_begin = static_cast<uint32_t>(module.segment_widths.size());
+  module.segment_widths.insert(module.segment_widths.end(), input_widths.begin(),
+                               input_widths.end());
+  attrs.segments_end = static_cast<uint32_t>(module.segment_widths.size());
+  add_signal(module, name, {node_id, 0});
+  return node_id;
+}
+
+TigBuilder::NodeId TigBuilder::create_instance(ModuleId module_id, NameId name,
                                                ModuleId instance_module_id,
-                                               std::vector<Signal> &node_inputs,
-                                               std::vector<SignalSpec> &node_outputs) {
+                                               std::span<const Signal> node_inputs,
+                                               std::span<const SignalSpec> node_outputs) {
   Module &module = design_.modules[module_id];
-  NodeId node_id = create_node(module, NodeKind::kInstance);
-  auto &node = module.nodes[node_id];
-  node.name = std::move(name);
-  node.module_id = instance_module_id;
-  node.inputs = node_inputs;
-  node.outputs = node_outputs;
-  for (size_t i = 0; i < node.outputs.size(); i++) {
+  NodeId node_id = create_node(module, NodeKind::kInstance, node_inputs, node_outputs);
+  auto &attrs = create_attrs(module, node_id);
+  attrs.name = name;
+  attrs.module_id = instance_module_id;
+  for (size_t i = 0; i < node_outputs.size(); i++) {
     const PortIndex port_idx = static_cast<PortIndex>(i);
-    add_signal(module, node.outputs[i].name, {node_id, port_idx});
+    add_signal(module, node_outputs[i].name, {node_id, port_idx});
   }
   return node_id;
 }
@@ -82,29 +423,107 @@ TigBuilder::NodeId TigBuilder::create_instance(ModuleId module_id, std::string n
 void TigBuilder::set_node_input(ModuleId module_id, NodeId node_id, PortIndex port_idx,
                                 Signal input) {
   Module &module = design_.modules[module_id];
-  auto &node = module.nodes[node_id];
-  node.inputs[port_idx] = input;
+  const bool was_hashed = hash_consing_ && hash_consable(module, node_id);
+  if (was_hashed) {
+    hash_cons_erase(module_id, node_id);
+  }
+  EdgeRef &fanin = module.node_fanins(node_id)[port_idx];
+  const EdgeRef old_input = fanin;
+  fanin = input;
+  module.patch_graph_index_input_changed(node_id, port_idx, old_input);
+  if (hash_consing_ && hash_consable(module, node_id) &&
+      hash_cons_find(module_id, module.kind(node_id), hash_cons_key(module, node_id),
+                     module.node_outputs(node_id)[0],
+                     module.node_fanins(node_id)) == kInvalidNodeId) {
+    hash_cons_insert(module_id, node_id);
+  }
+}
+
+size_t TigBuilder::merge_equivalent_nodes(ModuleId module_id) {
+  Module &module = design_.modules[module_id];
+  if (module_id >= hash_cons_tables_.size()) {
+    hash_cons_tables_.resize(module_id + 1);
+  }
+  hash_cons_tables_[module_id] = {};
+
+  // The node each merged node was merged into. Kept nodes are never merged
+  // later, so one lookup resolves any fanin.
+  std::vector<NodeId> kept(module.num_nodes(), kInvalidNodeId);
+  auto redirect = [&](NodeId node_id) {
+    const auto fanins = module.node_fanins(node_id);
+    for (size_t i = 0; i < fanins.size(); i++) {
+      const EdgeRef old_input = fanins[i];
+      if (old_input.node_id != kInvalidNodeId && kept[old_input.node_id] != kInvalidNodeId) {
+        fanins[i].node_id = kept[old_input.node_id];
+        module.patch_graph_index_input_changed(node_id, static_cast<PortIndex>(i), old_input);
+      }
+    }
+  };
+
+  const auto order = module.topological_order();
+  size_t merged = 0;
+  for (const NodeId node_id : std::vector<NodeId>(order.begin(), order.end())) {
+    redirect(node_id);
+    if (!hash_consable(module, node_id)) {
+      continue;
+    }
+    const NodeKind kind = module.kind(node_id);
+    hash_cons_stats_.lookups++;
+    const NodeId existing = hash_cons_find(
+        module_id, kind, hash_cons_key(module, node_id), module.node_outputs(node_id)[0],
+        module.node_fanins(node_id),
+        kind == NodeKind::kConst ? module.node_const(node_id) : ConstView{});
+    if (existing == kInvalidNodeId) {
+      hash_cons_insert(module_id, node_id);
+      continue;
+    }
+    kept[node_id] = existing;
+    hash_cons_stats_.hits++;
+    merged++;
+  }
+  if (merged == 0) {
+    return 0;
+  }
+  // Nodes on cycles are left out of the order but may still read merged ones.
+  for (NodeId node_id = 0; node_id < module.num_nodes(); node_id++) {
+    redirect(node_id);
+  }
+  for (auto &entry : module.signal_map) {
+    if (kept[entry.second.node_id] != kInvalidNodeId) {
+      entry.second.node_id = kept[entry.second.node_id];
+    }
+  }
+  return merged;
 }
 
 TigBuilder::Signal TigBuilder::get_node_input(ModuleId module_id, NodeId node_id,
                                               PortIndex port_idx) {
-  Module &module = design_.modules[module_id];
-  const auto &node = module.nodes[node_id];
-  return node.inputs[port_idx];
+  const Module &module = std::as_const(design_).modules[module_id];
+  return module.node_fanins(node_id)[port_idx];
 }
 
 TigBuilder::SignalSpec TigBuilder::get_signal_spec(ModuleId module_id, Signal signal) {
-  Module &module = design_.modules[module_id];
-  const auto &node = module.nodes[signal.node_id];
-  assert(signal.port_idx < node.outputs.size());
-  return node.outputs[signal.port_idx];
+  const Module &module = std::as_const(design_).modules[module_id];
+  const auto outputs = module.node_outputs(signal.node_id);
+  assert(signal.port_idx < outputs.size());
+  return outputs[signal.port_idx];
 }
 
-TigBuilder::Signal TigBuilder::find_signal(ModuleId module_id, std::string name) {
-  Module &module = design_.modules[module_id];
+TigBuilder::Signal TigBuilder::find_signal(ModuleId module_id, NameId name) {
+  const Module &module = std::as_const(design_).modules[module_id];
   auto it = module.signal_map.find(name);
-  assert(it != module.signal_map.end());
+  if (it == module.signal_map.end()) {
+    return {};
+  }
   return it->second;
 }
 
+TigBuilder::Signal TigBuilder::find_signal(ModuleId module_id, std::string_view name) {
+  const NameId id = design_.names.find(name);
+  if (id == kInvalidName) {
+    return {};
+  }
+  return find_signal(module_id, id);
+}
+
 } // namespace abys::ir
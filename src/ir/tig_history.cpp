@@ -0,0 +1,31 @@
+#include "abys/ir/tig_history.h"
+
+#include <utility>
+
+namespace abys::ir {
+
+void TigHistory::checkpoint() { checkpoints_.push_back(design_.modules); }
+
+bool TigHistory::undo() {
+  if (checkpoints_.empty()) {
+    return false;
+  }
+  design_.modules = std::move(checkpoints_.back());
+  checkpoints_.pop_back();
+  return true;
+}
+
+size_t TigHistory::changed_modules() const {
+  const size_t n = design_.modules.size();
+  if (checkpoints_.empty()) {
+    return n;
+  }
+  const Tig::ModuleList &last = checkpoints_.back();
+  size_t changed = 0;
+  for (size_t m = 0; m < n; m++) {
+    changed += m < last.size() && design_.modules.same(m, last, m) ? 0 : 1;
+  }
+  return changed;
+}
+
+} // namespace abys::ir
@@ -0,0 +1,264 @@
+#include "abys/ir/tig_memory.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "abys/ir/pass_manager.h"
+#include "abys/util/json.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using ModuleId = Tig::ModuleId;
+using C = MemoryCategory;
+
+constexpr std::string_view kCategoryNames[kNumMemoryCategories] = {
+    "nodes",      "edges",  "outputs",      "attrs",       "consts", "ports",
+    "signal_map", "blocks", "block_params", "graph_index", "names",  "modules",
+};
+
+template <typename T> uint64_t vector_bytes(const std::vector<T> &v) {
+  return v.capacity() * sizeof(T);
+}
+
+// A libstdc++ hash table node: the next pointer, the value and, unless the
+// hash is trivially cheap (as for integers), the cached hash code.
+template <typename Value, bool kCachesHash> struct HashNode {
+  void *next;
+  Value value;
+};
+template <typename Value> struct HashNode<Value, true> {
+  void *next;
+  Value value;
+  size_t hash;
+};
+
+template <typename Map> uint64_t hash_map_bytes(const Map &map) {
+  using Node = HashNode<typename Map::value_type, !std::is_integral_v<typename Map::key_type>>;
+  // A table with one bucket uses a bucket stored inside the map itself.
+  const uint64_t buckets = map.bucket_count() > 1 ? map.bucket_count() * sizeof(void *) : 0;
+  return map.size() * sizeof(Node) + buckets;
+}
+
+// What make_shared allocates for a module: a control block holding the
+// vtable pointer and the two counts, then the module itself.
+struct SharedModule {
+  void *vtable;
+  int32_t use_count;
+  int32_t weak_count;
+  Module module;
+};
+
+uint64_t saturating_mul(uint64_t a, uint64_t b) {
+  if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return a * b;
+}
+
+uint64_t saturating_add(uint64_t a, uint64_t b) {
+  return a > std::numeric_limits<uint64_t>::max() - b ? std::numeric_limits<uint64_t>::max()
+                                                      : a + b;
+}
+
+std::string_view module_name(const Tig &design, ModuleId m) {
+  return design.names.view(design.modules[m].name);
+}
+
+void write_usage_json(std::ostream &out, const MemoryUsage &usage) {
+  out << '{';
+  for (size_t c = 0; c < kNumMemoryCategories; c++) {
+    out << '"' << kCategoryNames[c] << "\":" << usage.bytes[c] << ',';
+  }
+  out << "\"total\":" << usage.total() << '}';
+}
+
+} // namespace
+
+std::string_view memory_category_name(MemoryCategory category) {
+  const auto index = static_cast<size_t>(category);
+  return index < kNumMemoryCategories ? kCategoryNames[index] : "unknown";
+}
+
+uint64_t MemoryUsage::total() const {
+  uint64_t sum = 0;
+  for (const uint64_t b : bytes) {
+    sum = saturating_add(sum, b);
+  }
+  return sum;
+}
+
+MemoryUsage &MemoryUsage::operator+=(const MemoryUsage &other) {
+  for (size_t c = 0; c < kNumMemoryCategories; c++) {
+    bytes[c] = saturating_add(bytes[c], other.bytes[c]);
+  }
+  return *this;
+}
+
+void MemoryUsage::add_scaled(const MemoryUsage &other, uint64_t times) {
+  for (size_t c = 0; c < kNumMemoryCategories; c++) {
+    bytes[c] = saturating_add(bytes[c], saturating_mul(other.bytes[c], times));
+  }
+}
+
+MemoryUsage module_memory(const Tig::Module &module) {
+  MemoryUsage usage;
+  usage[C::kNodes] = vector_bytes(module.node_kinds) + vector_bytes(module.node_attrs) +
+                     vector_bytes(module.fanin_offsets) + vector_bytes(module.output_offsets);
+  usage[C::kEdges] = vector_bytes(module.fanins);
+  usage[C::kOutputs] = vector_bytes(module.outputs);
+  usage[C::kAttrs] = vector_bytes(module.attrs) + vector_bytes(module.segment_widths);
+  usage[C::kConsts] = vector_bytes(module.const_words);
+  usage[C::kPorts] = vector_bytes(module.input_ports) + vector_bytes(module.output_ports);
+  usage[C::kSignalMap] = hash_map_bytes(module.signal_map);
+  usage[C::kBlocks] = vector_bytes(module.blocks);
+  for (const auto &block : module.blocks) {
+    usage[C::kBlocks] += vector_bytes(block.input_ports) + vector_bytes(block.output_ports) +
+                         vector_bytes(block.inputs) + vector_bytes(block.outputs);
+  }
+  const auto &index = module.graph_index;
+  usage[C::kGraphIndex] = vector_bytes(index.fanout_offsets) + vector_bytes(index.fanouts) +
+                          vector_bytes(index.order) + vector_bytes(index.order_pos) +
+                          vector_bytes(index.levels);
+  return usage;
+}
+
+DesignMemory design_memory(const Tig &design, unsigned num_threads) {
+  const size_t n = design.modules.size();
+  DesignMemory memory;
+  memory.modules.resize(n);
+  memory.design[C::kNames] = design.names.heap_bytes();
+  memory.design[C::kBlockParams] = design.params.heap_bytes();
+  memory.design[C::kModules] = design.modules.capacity() * sizeof(std::shared_ptr<Module>) +
+                               n * sizeof(SharedModule);
+
+  // Instance edges that close a cycle are left out of both aggregations.
+  const ModuleDag dag = ModuleDag::build(design);
+  memory.tops = dag.tops;
+  std::vector<bool> top(n, false);
+  for (const ModuleId m : dag.tops) {
+    top[m] = true;
+  }
+
+  PassManager passes({num_threads});
+  passes.add({"account memory", PassOrder::kBottomUp, [&](ModuleId m) {
+                auto &mod = memory.modules[m];
+                mod.self = module_memory(design.modules[m]);
+                mod.hierarchy = mod.self;
+                for (const auto &[child, count] : dag.children[m]) {
+                  mod.hierarchy.add_scaled(memory.modules[child].hierarchy, count);
+                }
+              }});
+  passes.add({"count instances", PassOrder::kTopDown, [&](ModuleId m) {
+                uint64_t instances = top[m] ? 1 : 0;
+                for (const ModuleId parent : dag.parents[m]) {
+                  const auto &edges = dag.children[parent];
+                  const auto edge = std::lower_bound(
+                      edges.begin(), edges.end(), m,
+                      [](const auto &e, ModuleId id) { return e.first < id; });
+                  instances = saturating_add(
+                      instances, saturating_mul(memory.modules[parent].instances, edge->second));
+                }
+                memory.modules[m].instances = instances;
+              }});
+  // Neither step fails short of running out of memory.
+  if (const auto run = passes.run(design); !run.ok) {
+    throw std::runtime_error(run.message);
+  }
+
+  memory.total = memory.design;
+  memory.flattened = memory.design;
+  for (const auto &mod : memory.modules) {
+    memory.total += mod.self;
+    memory.flattened.add_scaled(mod.self, mod.instances);
+  }
+  return memory;
+}
+
+void write_memory_report(std::ostream &out, const Tig &design, const DesignMemory &memory,
+                         size_t limit) {
+  out << "design: " << design.modules.size() << " modules, " << memory.tops.size() << " top";
+  for (size_t i = 0; i < memory.tops.size(); i++) {
+    out << (i == 0 ? " (" : ", ") << module_name(design, memory.tops[i]);
+  }
+  out << (memory.tops.empty() ? "\n" : ")\n");
+
+  char line[256];
+  std::snprintf(line, sizeof(line), "  %-16s %16s %20s\n", "category", "bytes", "flattened bytes");
+  out << line;
+  for (size_t c = 0; c < kNumMemoryCategories; c++) {
+    std::snprintf(line, sizeof(line), "  %-16s %16" PRIu64 " %20" PRIu64 "\n",
+                  std::string(kCategoryNames[c]).c_str(), memory.total.bytes[c],
+                  memory.flattened.bytes[c]);
+    out << line;
+  }
+  std::snprintf(line, sizeof(line), "  %-16s %16" PRIu64 " %20" PRIu64 "\n", "total",
+                memory.total.total(), memory.flattened.total());
+  out << line;
+
+  std::vector<ModuleId> order(design.modules.size());
+  for (ModuleId m = 0; m < order.size(); m++) {
+    order[m] = m;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](ModuleId a, ModuleId b) {
+    return memory.modules[a].self.total() > memory.modules[b].self.total();
+  });
+  const size_t shown = limit == 0 ? order.size() : std::min(limit, order.size());
+  if (shown == 0) {
+    return;
+  }
+  out << (shown == order.size() ? "modules" : "largest modules") << ":\n";
+  std::snprintf(line, sizeof(line), "  %-28s %10s %10s %10s %14s %18s\n", "module", "instances",
+                "nodes", "edges", "bytes", "hierarchy bytes");
+  out << line;
+  for (size_t i = 0; i < shown; i++) {
+    const ModuleId m = order[i];
+    const auto &mod = memory.modules[m];
+    std::snprintf(line, sizeof(line), "  %-28s %10" PRIu64 " %10zu %10zu %14" PRIu64
+                  " %18" PRIu64 "\n",
+                  std::string(module_name(design, m)).c_str(), mod.instances,
+                  static_cast<size_t>(design.modules[m].num_nodes()),
+                  design.modules[m].fanins.size(), mod.self.total(), mod.hierarchy.total());
+    out << line;
+  }
+}
+
+void write_memory_report_json(std::ostream &out, const Tig &design,
+                              const DesignMemory &memory) {
+  out << "{\"num_modules\":" << design.modules.size() << ",\"tops\":[";
+  for (size_t i = 0; i < memory.tops.size(); i++) {
+    out << (i == 0 ? "" : ",");
+    util::write_json_string(out, module_name(design, memory.tops[i]));
+  }
+  out << "],\"design\":";
+  write_usage_json(out, memory.design);
+  out << ",\"total\":";
+  write_usage_json(out, memory.total);
+  out << ",\"flattened\":";
+  write_usage_json(out, memory.flattened);
+  out << ",\"modules\":[";
+  for (ModuleId m = 0; m < design.modules.size(); m++) {
+    const auto &mod = memory.modules[m];
+    out << (m == 0 ? "\n" : ",\n") << "{\"id\":" << m << ",\"name\":";
+    util::write_json_string(out, module_name(design, m));
+    out << ",\"instances\":" << mod.instances
+        << ",\"nodes\":" << design.modules[m].num_nodes()
+        << ",\"edges\":" << design.modules[m].fanins.size() << ",\"self\":";
+    write_usage_json(out, mod.self);
+    out << ",\"hierarchy\":";
+    write_usage_json(out, mod.hierarchy);
+    out << '}';
+  }
+  out << "\n]}\n";
+}
+
+} // namespace abys::ir
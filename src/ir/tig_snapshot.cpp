@@ -0,0 +1,727 @@
+#include "abys/ir/tig_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "abys/util/hash.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+
+constexpr char kMagic[8] = {'A', 'B', 'Y', 'S', 'T', 'I', 'G', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kAlignment = 8;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t file_size;
+  uint64_t checksum; // over everything after the header
+  uint32_t num_modules;
+  uint32_t num_sections;
+};
+static_assert(std::has_unique_object_representations_v<Header>);
+
+struct SectionEntry {
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Sections shared by the whole design, followed by kModuleSections per module.
+enum GlobalSection : size_t {
+  kNameChars,
+  kNameOffsets,
+  kNameSlots,
+  kParams,
+  kParamOffsets,
+  kParamWords,
+  kParamBitsOffsets,
+  kModuleNames,
+  kGlobalSections,
+};
+
+enum ModuleSection : size_t {
+  kInputPorts,
+  kOutputPorts,
+  kNodeKinds,
+  kNodeAttrs,
+  kFaninOffsets,
+  kFanins,
+  kOutputOffsets,
+  kOutputs,
+  kAttrs,
+  kSegmentWidths,
+  kConstWords,
+  kSignals,
+  kBlocks,
+  kModuleSections,
+};
+
+// Element size of every module section but kBlocks, in ModuleSection order.
+constexpr size_t kElementSizes[kBlocks] = {
+    sizeof(Module::Port),     sizeof(Module::Port),    sizeof(Module::NodeKind),
+    sizeof(uint32_t),         sizeof(uint32_t),        sizeof(Module::EdgeRef),
+    sizeof(uint32_t),         sizeof(Module::Output),  sizeof(Module::NodeAttrs),
+    sizeof(Tig::SignalWidth), sizeof(uint64_t),        sizeof(TigSnapshot::SignalEntry),
+};
+
+size_t module_section(Tig::ModuleId module_id, ModuleSection section) {
+  return kGlobalSections + module_id * kModuleSections + section;
+}
+
+size_t align_up(size_t n) { return (n + kAlignment - 1) & ~(kAlignment - 1); }
+
+// Port and Output have padding. It is zeroed before writing so that a snapshot
+// is a pure function of the design.
+Module::Port zero_padded(const Module::Port &port) {
+  Module::Port out;
+  std::memset(static_cast<void *>(&out), 0, sizeof(out));
+  out.name = port.name;
+  out.width = port.width;
+  out.sign = port.sign;
+  return out;
+}
+
+Module::Output zero_padded(const Module::Output &output) {
+  Module::Output out;
+  std::memset(static_cast<void *>(&out), 0, sizeof(out));
+  out.name = output.name;
+  out.width = output.width;
+  out.sign = output.sign;
+  return out;
+}
+
+// Blocks hold port and node lists and are encoded as a flat byte stream.
+// Unlike every other section they are decoded on materialize rather than used
+// in place.
+class ByteWriter {
+public:
+  void u32(uint32_t v) { raw(&v, sizeof(v)); }
+  void u64(uint64_t v) { raw(&v, sizeof(v)); }
+  void raw(const void *data, size_t size) {
+    bytes.append(static_cast<const char *>(data), size);
+  }
+  std::string bytes;
+};
+
+// Reads past the end yield zeros and mark the reader failed; counts are checked
+// against the bytes left, so a corrupt stream cannot allocate more than it holds.
+class ByteReader {
+public:
+  explicit ByteReader(std::span<const char> bytes) : bytes_(bytes) {}
+  uint32_t u32() { return pod<uint32_t>(); }
+  uint64_t u64() { return pod<uint64_t>(); }
+  // A count of elements that take at least `min_bytes` each.
+  size_t count(size_t min_bytes) {
+    const uint64_t n = u64();
+    if (n > (bytes_.size() - pos_) / min_bytes) {
+      failed_ = true;
+      return 0;
+    }
+    return static_cast<size_t>(n);
+  }
+  bool ok() const { return !failed_ && pos_ == bytes_.size(); }
+
+private:
+  template <typename T> T pod() {
+    T v{};
+    if (failed_ || sizeof(T) > bytes_.size() - pos_) {
+      failed_ = true;
+      return v;
+    }
+    std::memcpy(&v, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return v;
+  }
+  std::span<const char> bytes_;
+  size_t pos_ = 0;
+  bool failed_ = false;
+};
+
+constexpr size_t kEncodedPort = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+constexpr size_t kEncodedBlock = 5 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+
+std::string encode_blocks(const std::vector<Module::Block> &blocks) {
+  ByteWriter w;
+  w.u64(blocks.size());
+  for (const auto &block : blocks) {
+    w.u32(static_cast<uint32_t>(block.kind));
+    w.u32(block.name);
+    w.u32(block.impl_name);
+    for (const auto *ports : {&block.input_ports, &block.output_ports}) {
+      w.u64(ports->size());
+      for (const auto &port : *ports) {
+        w.u32(port.name);
+        w.u64(port.width);
+        w.u32(port.sign);
+      }
+    }
+    for (const auto *ids : {&block.inputs, &block.outputs}) {
+      w.u64(ids->size());
+      w.raw(ids->data(), ids->size() * sizeof(Tig::NodeId));
+    }
+    w.u32(block.params);
+    w.u32(block.attributes);
+  }
+  return std::move(w.bytes);
+}
+
+// Returns false if `bytes` is not exactly one encoded block list.
+bool decode_blocks(std::span<const char> bytes, std::vector<Module::Block> &blocks) {
+  ByteReader r(bytes);
+  blocks.resize(r.count(kEncodedBlock));
+  for (auto &block : blocks) {
+    block.kind = static_cast<Module::BlockKind>(r.u32());
+    block.name = r.u32();
+    block.impl_name = r.u32();
+    for (auto *ports : {&block.input_ports, &block.output_ports}) {
+      ports->resize(r.count(kEncodedPort));
+      for (auto &port : *ports) {
+        port.name = r.u32();
+        port.width = r.u64();
+        port.sign = r.u32() != 0;
+      }
+    }
+    for (auto *ids : {&block.inputs, &block.outputs}) {
+      ids->resize(r.count(sizeof(Tig::NodeId)));
+      for (auto &id : *ids) {
+        id = r.u32();
+      }
+    }
+    block.params = r.u32();
+    block.attributes = r.u32();
+  }
+  return r.ok();
+}
+
+// Offsets into an array of `size` elements: starting at 0, never decreasing,
+// and ending at `size`.
+bool valid_offsets(std::span<const uint32_t> offsets, size_t size) {
+  return !offsets.empty() && offsets.front() == 0 && offsets.back() == size &&
+         std::is_sorted(offsets.begin(), offsets.end());
+}
+
+// One section's bytes, either borrowed from the design or owned when the
+// in-memory representation has to be rewritten first.
+struct SectionData {
+  const void *borrowed = nullptr;
+  size_t size = 0;
+  std::string owned;
+  bool is_owned = false;
+
+  const void *data() const { return is_owned ? owned.data() : borrowed; }
+
+  template <typename T> static SectionData of(std::span<const T> values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if constexpr (std::has_unique_object_representations_v<T>) {
+      SectionData s;
+      s.borrowed = values.data();
+      s.size = values.size_bytes();
+      return s;
+    } else {
+      std::string bytes(values.size_bytes(), '\0');
+      for (size_t i = 0; i < values.size(); i++) {
+        const T value = zero_padded(values[i]);
+        std::memcpy(bytes.data() + i * sizeof(T), &value, sizeof(T));
+      }
+      return of(std::move(bytes));
+    }
+  }
+
+  static SectionData of(std::string bytes) {
+    SectionData s;
+    s.size = bytes.size();
+    s.owned = std::move(bytes);
+    s.is_owned = true;
+    return s;
+  }
+};
+
+template <typename T> SectionData section_of(const std::vector<T> &values) {
+  return SectionData::of(std::span<const T>(values));
+}
+
+std::vector<TigSnapshot::SignalEntry> sorted_signals(const Module &module) {
+  std::vector<TigSnapshot::SignalEntry> signals;
+  signals.reserve(module.signal_map.size());
+  for (const auto &[name, edge] : module.signal_map) {
+    signals.push_back({name, edge});
+  }
+  std::sort(signals.begin(), signals.end(),
+            [](const auto &a, const auto &b) { return a.name < b.name; });
+  return signals;
+}
+
+uint64_t checksum_of(const std::byte *data, size_t size) {
+  return util::hash_bytes(data + sizeof(Header), size - sizeof(Header));
+}
+
+static_assert(std::has_unique_object_representations_v<TigSnapshot::SignalEntry>);
+static_assert(std::has_unique_object_representations_v<Param>);
+
+struct FileCloser {
+  void operator()(std::FILE *f) const { std::fclose(f); }
+};
+
+} // namespace
+
+TigSnapshotResult write_tig_snapshot(const Tig &design, const std::string &path) {
+  const auto num_modules = static_cast<Tig::ModuleId>(design.modules.size());
+  const size_t num_sections = kGlobalSections + num_modules * kModuleSections;
+
+  std::vector<Tig::NameId> module_names;
+  module_names.reserve(num_modules);
+  for (const auto &module : design.modules) {
+    module_names.push_back(module.name);
+  }
+
+  // Sections are produced one module at a time so that only one module's
+  // rewritten arrays are held at once.
+  auto global_section = [&](size_t index) {
+    switch (index) {
+    case kNameChars:
+      return SectionData::of(std::span<const char>(design.names.chars()));
+    case kNameOffsets:
+      return SectionData::of(design.names.offsets());
+    case kNameSlots:
+      return SectionData::of(design.names.slots());
+    case kParams:
+      return SectionData::of(design.params.params());
+    case kParamOffsets:
+      return SectionData::of(design.params.offsets());
+    case kParamWords:
+      return SectionData::of(design.params.words());
+    case kParamBitsOffsets:
+      return SectionData::of(design.params.bits_offsets());
+    default:
+      return section_of(module_names);
+    }
+  };
+  auto module_sections = [&](const Module &module) {
+    std::vector<SectionData> sections;
+    sections.reserve(kModuleSections);
+    sections.push_back(section_of(module.input_ports));
+    sections.push_back(section_of(module.output_ports));
+    sections.push_back(section_of(module.node_kinds));
+    sections.push_back(section_of(module.node_attrs));
+    sections.push_back(section_of(module.fanin_offsets));
+    sections.push_back(section_of(module.fanins));
+    sections.push_back(section_of(module.output_offsets));
+    sections.push_back(section_of(module.outputs));
+    sections.push_back(section_of(module.attrs));
+    sections.push_back(section_of(module.segment_widths));
+    sections.push_back(section_of(module.const_words));
+    const auto signals = sorted_signals(module);
+    sections.push_back(SectionData::of(
+        std::string(reinterpret_cast<const char *>(signals.data()),
+                    signals.size() * sizeof(TigSnapshot::SignalEntry))));
+    sections.push_back(SectionData::of(encode_blocks(module.blocks)));
+    return sections;
+  };
+
+  // Sizes are known up front, except for the blocks stream which is encoded
+  // once here and again while writing; blocks are few relative to nodes.
+  std::vector<SectionEntry> table(num_sections);
+  size_t offset = align_up(sizeof(Header) + num_sections * sizeof(SectionEntry));
+  auto place = [&](size_t index, size_t size) {
+    table[index] = {offset, size};
+    offset = align_up(offset + size);
+  };
+  for (size_t i = 0; i < kGlobalSections; i++) {
+    place(i, global_section(i).size);
+  }
+  for (Tig::ModuleId m = 0; m < num_modules; m++) {
+    const Module &module = design.modules[m];
+    place(module_section(m, kInputPorts), module.input_ports.size() * sizeof(Module::Port));
+    place(module_section(m, kOutputPorts), module.output_ports.size() * sizeof(Module::Port));
+    place(module_section(m, kNodeKinds), module.node_kinds.size() * sizeof(Module::NodeKind));
+    place(module_section(m, kNodeAttrs), module.node_attrs.size() * sizeof(uint32_t));
+    place(module_section(m, kFaninOffsets), module.fanin_offsets.size() * sizeof(uint32_t));
+    place(module_section(m, kFanins), module.fanins.size() * sizeof(Module::EdgeRef));
+    place(module_section(m, kOutputOffsets), module.output_offsets.size() * sizeof(uint32_t));
+    place(module_section(m, kOutputs), module.outputs.size() * sizeof(Module::Output));
+    place(module_section(m, kAttrs), module.attrs.size() * sizeof(Module::NodeAttrs));
+    place(module_section(m, kSegmentWidths), module.segment_widths.size() * sizeof(uint64_t));
+    place(module_section(m, kConstWords), module.const_words.size() * sizeof(uint64_t));
+    place(module_section(m, kSignals),
+          module.signal_map.size() * sizeof(TigSnapshot::SignalEntry));
+    place(module_section(m, kBlocks), encode_blocks(module.blocks).size());
+  }
+  const size_t file_size = offset;
+
+  std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "wb"));
+  if (!file) {
+    return {false, "failed to open " + path + " for writing"};
+  }
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kTigSnapshotVersion;
+  header.byte_order = kByteOrderMark;
+  header.file_size = file_size;
+  header.num_modules = num_modules;
+  header.num_sections = static_cast<uint32_t>(num_sections);
+
+  // Everything after the header is streamed through the checksum, which is
+  // patched into the header at the end.
+  util::Hasher checksum;
+  size_t written = sizeof(Header);
+  bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+  auto emit = [&](const void *data, size_t size) {
+    if (size == 0) {
+      return;
+    }
+    checksum.update(data, size);
+    ok = ok && std::fwrite(data, 1, size, file.get()) == size;
+    written += size;
+  };
+  auto pad_to = [&](size_t target) {
+    static const char zeros[kAlignment] = {};
+    emit(zeros, target - written);
+  };
+  auto next_offset = [&](size_t index) {
+    return index + 1 < num_sections ? table[index + 1].offset : file_size;
+  };
+
+  emit(table.data(), table.size() * sizeof(SectionEntry));
+  pad_to(table[0].offset);
+  for (size_t i = 0; i < kGlobalSections; i++) {
+    const SectionData s = global_section(i);
+    emit(s.data(), s.size);
+    pad_to(next_offset(i));
+  }
+  for (Tig::ModuleId m = 0; m < num_modules; m++) {
+    const auto sections = module_sections(design.modules[m]);
+    for (size_t k = 0; k < kModuleSections; k++) {
+      emit(sections[k].data(), sections[k].size);
+      pad_to(next_offset(module_section(m, static_cast<ModuleSection>(k))));
+    }
+  }
+
+  header.checksum = checksum.digest();
+  ok = ok && std::fseek(file.get(), 0, SEEK_SET) == 0 &&
+       std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+  if (!ok || std::fflush(file.get()) != 0) {
+    return {false, "failed to write " + path};
+  }
+  return {true, "ok"};
+}
+
+TigSnapshot::TigSnapshot(TigSnapshot &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      num_modules_(std::exchange(other.num_modules_, 0)) {}
+
+TigSnapshot &TigSnapshot::operator=(TigSnapshot &&other) noexcept {
+  if (this != &other) {
+    close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    num_modules_ = std::exchange(other.num_modules_, 0);
+  }
+  return *this;
+}
+
+TigSnapshot::~TigSnapshot() { close(); }
+
+void TigSnapshot::close() {
+  if (data_) {
+    munmap(const_cast<std::byte *>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  num_modules_ = 0;
+}
+
+TigSnapshotResult TigSnapshot::open(const std::string &path, bool verify_checksum) {
+  close();
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {false, "failed to open " + path};
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return {false, path + " is not a Tig snapshot"};
+  }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return {false, "failed to map " + path};
+  }
+  data_ = static_cast<const std::byte *>(data);
+  size_ = static_cast<size_t>(st.st_size);
+
+  auto result = validate(verify_checksum);
+  if (!result.ok) {
+    close();
+    result.message = path + ": " + result.message;
+    return result;
+  }
+  Header header;
+  std::memcpy(&header, data_, sizeof(header));
+  num_modules_ = header.num_modules;
+  return result;
+}
+
+TigSnapshotResult TigSnapshot::validate(bool verify_checksum) const {
+  Header header;
+  std::memcpy(&header, data_, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return {false, "not a Tig snapshot"};
+  }
+  if (header.byte_order != kByteOrderMark) {
+    return {false, "snapshot was written with a different byte order"};
+  }
+  if (header.version != kTigSnapshotVersion) {
+    return {false, "unsupported snapshot version " + std::to_string(header.version)};
+  }
+  if (header.file_size != size_) {
+    return {false, "snapshot is truncated"};
+  }
+  const size_t num_sections = kGlobalSections + size_t{header.num_modules} * kModuleSections;
+  if (header.num_sections != num_sections ||
+      sizeof(Header) + num_sections * sizeof(SectionEntry) > size_) {
+    return {false, "corrupt section table"};
+  }
+  const auto *table = reinterpret_cast<const SectionEntry *>(data_ + sizeof(Header));
+  for (size_t i = 0; i < num_sections; i++) {
+    if (table[i].offset % kAlignment != 0 || table[i].offset > size_ ||
+        table[i].size > size_ - table[i].offset) {
+      return {false, "corrupt section table"};
+    }
+  }
+  if (verify_checksum && checksum_of(data_, size_) != header.checksum) {
+    return {false, "checksum mismatch"};
+  }
+
+  // Structural checks, so that no file, whatever its checksum, sends the
+  // views, materialize() or the Tig it builds out of bounds: every section
+  // holds whole elements, every offset array is ordered and ends at the end of
+  // its array, and every name, node, port, attribute, segment, constant, module
+  // and parameter set a section refers to exists.
+  auto count = [&](size_t index, size_t elem) -> size_t {
+    return table[index].size % elem == 0 ? table[index].size / elem : SIZE_MAX;
+  };
+  const auto name_offsets = section<uint32_t>(kNameOffsets);
+  const auto name_slots = section<NameId>(kNameSlots);
+  if (count(kNameOffsets, sizeof(uint32_t)) == SIZE_MAX ||
+      count(kNameSlots, sizeof(NameId)) == SIZE_MAX ||
+      !valid_offsets(name_offsets, table[kNameChars].size) ||
+      !std::has_single_bit(name_slots.size()) ||
+      std::find(name_slots.begin(), name_slots.end(), kInvalidName) == name_slots.end() ||
+      count(kModuleNames, sizeof(NameId)) != header.num_modules) {
+    return {false, "corrupt name table"};
+  }
+  const size_t num_names = name_offsets.size() - 1;
+  auto valid_name = [&](NameId name) { return name < num_names; };
+  if (!std::all_of(name_slots.begin(), name_slots.end(),
+                   [&](NameId id) { return id == kInvalidName || valid_name(id); })) {
+    return {false, "corrupt name table"};
+  }
+  const auto module_names = section<NameId>(kModuleNames);
+  if (!std::all_of(module_names.begin(), module_names.end(), valid_name)) {
+    return {false, "corrupt name table"};
+  }
+
+  const auto params = section<Param>(kParams);
+  const auto param_offsets = section<uint32_t>(kParamOffsets);
+  const auto bits_offsets = section<uint64_t>(kParamBitsOffsets);
+  const auto words = section<uint64_t>(kParamWords);
+  if (count(kParams, sizeof(Param)) == SIZE_MAX ||
+      count(kParamOffsets, sizeof(uint32_t)) == SIZE_MAX || param_offsets.size() < 2 ||
+      !valid_offsets(param_offsets, params.size()) ||
+      count(kParamBitsOffsets, sizeof(uint64_t)) == SIZE_MAX ||
+      count(kParamWords, sizeof(uint64_t)) == SIZE_MAX) {
+    return {false, "corrupt parameter table"};
+  }
+  for (const uint64_t offset : bits_offsets) {
+    if (offset >= words.size() ||
+        ConstView::words_for(words[offset] >> 1) * ((words[offset] & 1) + 1) >
+            words.size() - offset - 1) {
+      return {false, "corrupt parameter table"};
+    }
+  }
+  for (const Param &param : params) {
+    const bool named = param.kind == ParamKind::kString || param.kind == ParamKind::kText;
+    if (!valid_name(param.key) || param.kind > ParamKind::kText ||
+        (named && !valid_name(param.as_name())) ||
+        (param.kind == ParamKind::kBits && param.payload >= bits_offsets.size())) {
+      return {false, "corrupt parameter table"};
+    }
+  }
+  const size_t num_param_sets = param_offsets.size() - 1;
+
+  for (ModuleId m = 0; m < header.num_modules; m++) {
+    const std::string corrupt = "corrupt module " + std::to_string(m);
+    for (size_t k = 0; k < kBlocks; k++) {
+      if (count(module_section(m, static_cast<ModuleSection>(k)), kElementSizes[k]) == SIZE_MAX) {
+        return {false, corrupt};
+      }
+    }
+    const ModuleView view = module(m);
+    const size_t nodes = view.node_kinds.size();
+    if (view.node_attrs.size() != nodes || view.fanin_offsets.size() != nodes + 1 ||
+        view.output_offsets.size() != nodes + 1 ||
+        !valid_offsets(view.fanin_offsets, view.fanins.size()) ||
+        !valid_offsets(view.output_offsets, view.outputs.size())) {
+      return {false, corrupt};
+    }
+    auto valid_edge = [&](const EdgeRef &edge) {
+      return edge.node_id < nodes && edge.port_idx < view.node_outputs(edge.node_id).size();
+    };
+    auto valid_port = [&](const Module::Port &port) { return valid_name(port.name); };
+    auto valid_output = [&](const Module::Output &output) { return valid_name(output.name); };
+    if (!std::all_of(view.input_ports.begin(), view.input_ports.end(), valid_port) ||
+        !std::all_of(view.output_ports.begin(), view.output_ports.end(), valid_port) ||
+        !std::all_of(view.outputs.begin(), view.outputs.end(), valid_output) ||
+        !std::all_of(view.fanins.begin(), view.fanins.end(), [&](const EdgeRef &edge) {
+          return edge.node_id == Tig::kInvalidNodeId || valid_edge(edge);
+        })) {
+      return {false, corrupt};
+    }
+    for (const auto &attrs : view.attrs) {
+      if (!valid_name(attrs.name) || !valid_name(attrs.op) ||
+          (attrs.module_id != Tig::kInvalidModuleId && attrs.module_id >= header.num_modules) ||
+          attrs.segments_begin > attrs.segments_end ||
+          attrs.segments_end > view.segment_widths.size()) {
+        return {false, corrupt};
+      }
+    }
+    for (NodeId n = 0; n < nodes; n++) {
+      if (view.node_kinds[n] > NodeKind::kUnknown ||
+          (view.node_attrs[n] != Module::kNoAttrs && view.node_attrs[n] >= view.attrs.size())) {
+        return {false, corrupt};
+      }
+      if (view.node_kinds[n] != NodeKind::kConst || view.node_attrs[n] == Module::kNoAttrs) {
+        continue;
+      }
+      // A constant's words follow from its output's width and its planes.
+      const auto outputs = view.node_outputs(n);
+      const uint32_t value = view.attrs[view.node_attrs[n]].const_value;
+      const uint64_t offset = value & ~Module::kConstUnknownPlane;
+      const uint64_t planes = (value & Module::kConstUnknownPlane) ? 2 : 1;
+      if (outputs.size() != 1 || offset > view.const_words.size() ||
+          ConstView::words_for(outputs[0].width) * planes > view.const_words.size() - offset) {
+        return {false, corrupt};
+      }
+    }
+    for (size_t i = 0; i < view.signals.size(); i++) {
+      if (!valid_name(view.signals[i].name) || !valid_edge(view.signals[i].edge) ||
+          (i > 0 && view.signals[i - 1].name >= view.signals[i].name)) {
+        return {false, corrupt};
+      }
+    }
+    std::vector<Module::Block> blocks;
+    if (!decode_blocks(section<char>(module_section(m, kBlocks)), blocks)) {
+      return {false, corrupt};
+    }
+    for (const auto &block : blocks) {
+      auto valid_node = [&](NodeId id) { return id < nodes; };
+      if (block.kind > Module::BlockKind::kUnknown || !valid_name(block.name) ||
+          !valid_name(block.impl_name) || block.params >= num_param_sets ||
+          block.attributes >= num_param_sets ||
+          !std::all_of(block.input_ports.begin(), block.input_ports.end(), valid_port) ||
+          !std::all_of(block.output_ports.begin(), block.output_ports.end(), valid_port) ||
+          !std::all_of(block.inputs.begin(), block.inputs.end(), valid_node) ||
+          !std::all_of(block.outputs.begin(), block.outputs.end(), valid_node)) {
+        return {false, corrupt};
+      }
+    }
+  }
+  return {true, "ok"};
+}
+
+template <typename T> std::span<const T> TigSnapshot::section(size_t index) const {
+  const auto *table = reinterpret_cast<const SectionEntry *>(data_ + sizeof(Header));
+  return {reinterpret_cast<const T *>(data_ + table[index].offset), table[index].size / sizeof(T)};
+}
+
+TigSnapshot::ModuleView TigSnapshot::module(ModuleId m) const {
+  ModuleView view;
+  view.name = section<NameId>(kModuleNames)[m];
+  view.input_ports = section<Module::Port>(module_section(m, kInputPorts));
+  view.output_ports = section<Module::Port>(module_section(m, kOutputPorts));
+  view.node_kinds = section<NodeKind>(module_section(m, kNodeKinds));
+  view.node_attrs = section<uint32_t>(module_section(m, kNodeAttrs));
+  view.fanin_offsets = section<uint32_t>(module_section(m, kFaninOffsets));
+  view.fanins = section<EdgeRef>(module_section(m, kFanins));
+  view.output_offsets = section<uint32_t>(module_section(m, kOutputOffsets));
+  view.outputs = section<Module::Output>(module_section(m, kOutputs));
+  view.attrs = section<Module::NodeAttrs>(module_section(m, kAttrs));
+  view.segment_widths = section<SignalWidth>(module_section(m, kSegmentWidths));
+  view.const_words = section<uint64_t>(module_section(m, kConstWords));
+  view.signals = section<SignalEntry>(module_section(m, kSignals));
+  return view;
+}
+
+TigSnapshot::EdgeRef TigSnapshot::ModuleView::find_signal(NameId name) const {
+  auto it = std::lower_bound(signals.begin(), signals.end(), name,
+                             [](const SignalEntry &e, NameId n) { return e.name < n; });
+  if (it == signals.end() || it->name != name) {
+    return {};
+  }
+  return it->edge;
+}
+
+std::string_view TigSnapshot::name(NameId name) const {
+  const auto chars = section<char>(kNameChars);
+  const auto offsets = section<uint32_t>(kNameOffsets);
+  return {chars.data() + offsets[name], offsets[name + 1] - offsets[name]};
+}
+
+TigSnapshot::NameId TigSnapshot::find_name(std::string_view name) const {
+  const auto chars = section<char>(kNameChars);
+  return SymbolTable::find({chars.data(), chars.size()}, section<uint32_t>(kNameOffsets),
+                           section<NameId>(kNameSlots), name);
+}
+
+Tig TigSnapshot::materialize() const {
+  Tig design;
+  const auto chars = section<char>(kNameChars);
+  design.names.assign({chars.data(), chars.size()}, section<uint32_t>(kNameOffsets),
+                      section<NameId>(kNameSlots));
+  design.params.assign(section<Param>(kParams), section<uint32_t>(kParamOffsets),
+                       section<uint64_t>(kParamWords), section<uint64_t>(kParamBitsOffsets));
+  design.modules.resize(num_modules_);
+  for (ModuleId m = 0; m < num_modules_; m++) {
+    const ModuleView view = module(m);
+    Module &module = design.modules[m];
+    module.name = view.name;
+    module.input_ports.assign(view.input_ports.begin(), view.input_ports.end());
+    module.output_ports.assign(view.output_ports.begin(), view.output_ports.end());
+    module.node_kinds.assign(view.node_kinds.begin(), view.node_kinds.end());
+    module.node_attrs.assign(view.node_attrs.begin(), view.node_attrs.end());
+    module.fanin_offsets.assign(view.fanin_offsets.begin(), view.fanin_offsets.end());
+    module.fanins.assign(view.fanins.begin(), view.fanins.end());
+    module.output_offsets.assign(view.output_offsets.begin(), view.output_offsets.end());
+    module.outputs.assign(view.outputs.begin(), view.outputs.end());
+    module.attrs.assign(view.attrs.begin(), view.attrs.end());
+    module.segment_widths.assign(view.segment_widths.begin(), view.segment_widths.end());
+    module.const_words.assign(view.const_words.begin(), view.const_words.end());
+    module.signal_map.reserve(view.signals.size());
+    for (const auto &entry : view.signals) {
+      module.signal_map.emplace(entry.name, entry.edge);
+    }
+    // Validated on open.
+    decode_blocks(section<char>(module_section(m, kBlocks)), module.blocks);
+  }
+  return design;
+}
+
+} // namespace abys::ir
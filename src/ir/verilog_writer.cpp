@@ -0,0 +1,785 @@
+#include "abys/ir/verilog_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "abys/util/parallel.h"
+#include "abys/util/profile.h"
+#include "abys/version.h"
+
+namespace abys::ir {
+
+namespace {
+
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+
+struct FileCloser {
+  void operator()(std::FILE *f) const { std::fclose(f); }
+};
+
+struct Chunk {
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+};
+
+// Buffers a module writer may fill ahead of its turn before it has to wait.
+constexpr size_t kMaxPendingChunks = 4;
+
+// Puts module output into the file in module order. The writer of the oldest
+// unwritten module, the head, writes straight through. Other writers queue
+// their full buffers, up to kMaxPendingChunks each, and then wait for their
+// turn; a writer that finishes early leaves its chunks here for the head to
+// drain, within the same overall budget. Only the head ever writes, so writes
+// need no lock of their own.
+class OrderedFile {
+public:
+  OrderedFile(std::FILE *file, size_t budget_bytes) : file_(file), budget_bytes_(budget_bytes) {}
+
+  bool is_head(size_t index) {
+    std::lock_guard lock(mutex_);
+    return head_ == index;
+  }
+
+  void wait_turn(size_t index) {
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [&] { return head_ == index; });
+  }
+
+  // Called by the head only.
+  void write(const char *data, size_t size) {
+    if (!failed_ && size > 0 && std::fwrite(data, 1, size, file_) != size) {
+      failed_ = true;
+    }
+    bytes_ += size;
+  }
+
+  // Hand over the rest of module `index`. The head writes it along with any
+  // finished successors; anyone else stashes it, waiting while the stash is
+  // over budget.
+  void finish(size_t index, std::vector<Chunk> chunks) {
+    size_t size = 0;
+    for (const Chunk &chunk : chunks) {
+      size += chunk.size;
+    }
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [&] { return head_ == index || stashed_bytes_ + size <= budget_bytes_; });
+    if (head_ != index) {
+      stashed_bytes_ += size;
+      stashed_.emplace(index, std::move(chunks));
+      return;
+    }
+    for (;;) {
+      for (const Chunk &chunk : chunks) {
+        write(chunk.data.get(), chunk.size);
+      }
+      head_++;
+      auto next = stashed_.find(head_);
+      if (next == stashed_.end()) {
+        break;
+      }
+      chunks = std::move(next->second);
+      stashed_.erase(next);
+      for (const Chunk &chunk : chunks) {
+        stashed_bytes_ -= chunk.size;
+      }
+    }
+    changed_.notify_all();
+  }
+
+  bool failed() const { return failed_; }
+  uint64_t bytes() const { return bytes_; }
+
+private:
+  std::FILE *file_;
+  size_t budget_bytes_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  size_t head_ = 0;
+  std::map<size_t, std::vector<Chunk>> stashed_;
+  size_t stashed_bytes_ = 0;
+  bool failed_ = false;
+  uint64_t bytes_ = 0;
+};
+
+// Output of one module: a fixed buffer that spills into the file when full.
+class ChunkWriter {
+public:
+  ChunkWriter(OrderedFile &file, size_t index, size_t capacity)
+      : file_(file), index_(index), capacity_(capacity), buffer_(take_buffer()) {}
+
+  void put(char c) {
+    if (size_ == capacity_) {
+      spill();
+    }
+    buffer_[size_++] = c;
+  }
+
+  void put(std::string_view text) {
+    while (!text.empty()) {
+      if (size_ == capacity_) {
+        spill();
+      }
+      const size_t n = std::min(text.size(), capacity_ - size_);
+      std::memcpy(buffer_.get() + size_, text.data(), n);
+      size_ += n;
+      text.remove_prefix(n);
+    }
+  }
+
+  void put_uint(uint64_t value) {
+    char digits[20];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    put(std::string_view(digits, static_cast<size_t>(end - digits)));
+  }
+
+  void finish() {
+    pending_.push_back({std::move(buffer_), size_});
+    file_.finish(index_, std::move(pending_));
+  }
+
+private:
+  std::unique_ptr<char[]> take_buffer() {
+    if (spare_.empty()) {
+      return std::make_unique_for_overwrite<char[]>(capacity_);
+    }
+    auto buffer = std::move(spare_.back());
+    spare_.pop_back();
+    return buffer;
+  }
+
+  void write_pending() {
+    for (Chunk &chunk : pending_) {
+      file_.write(chunk.data.get(), chunk.size);
+      spare_.push_back(std::move(chunk.data));
+    }
+    pending_.clear();
+  }
+
+  void spill() {
+    if (!head_ && (head_ = file_.is_head(index_))) {
+      write_pending();
+    }
+    if (!head_ && pending_.size() < kMaxPendingChunks) {
+      pending_.push_back({std::move(buffer_), size_});
+      buffer_ = take_buffer();
+      size_ = 0;
+      return;
+    }
+    if (!head_) {
+      file_.wait_turn(index_);
+      head_ = true;
+      write_pending();
+    }
+    file_.write(buffer_.get(), size_);
+    size_ = 0;
+  }
+
+  OrderedFile &file_;
+  size_t index_;
+  size_t capacity_;
+  std::vector<std::unique_ptr<char[]>> spare_;
+  std::unique_ptr<char[]> buffer_;
+  size_t size_ = 0;
+  std::vector<Chunk> pending_;
+  bool head_ = false;
+};
+
+bool is_simple_identifier(std::string_view name) {
+  if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+  });
+}
+
+const char *op_symbol(std::string_view op) {
+  static constexpr std::pair<std::string_view, const char *> kOps[] = {
+      {"and", "&"}, {"or", "|"},  {"xor", "^"},  {"xnor", "~^"}, {"add", "+"}, {"sub", "-"},
+      {"mul", "*"}, {"not", "~"}, {"neg", "-"},  {"eq", "=="},   {"ne", "!="}, {"lt", "<"},
+  };
+  for (const auto &[name, symbol] : kOps) {
+    if (name == op) {
+      return symbol;
+    }
+  }
+  return nullptr;
+}
+
+// The name every module is written under. Lowering gives each specialization
+// of a source module that module's name, so names after the first get the
+// module id added, as often as it takes to find one no other module uses.
+std::vector<std::string> module_names(const Tig &design) {
+  std::vector<std::string> names;
+  names.reserve(design.modules.size());
+  std::unordered_set<std::string> used;
+  for (Tig::ModuleId m = 0; m < design.modules.size(); m++) {
+    const NameId name = design.modules[m].name;
+    std::string unique =
+        name == kEmptyName ? "_m" + std::to_string(m) : std::string(design.names.view(name));
+    while (!used.insert(unique).second) {
+      unique += '_' + std::to_string(m);
+    }
+    names.push_back(std::move(unique));
+  }
+  return names;
+}
+
+// Renders one module. Everything goes straight into the ChunkWriter; the only
+// allocations are per-module tables and the rare sorted parameter list.
+class ModuleEmitter {
+public:
+  ModuleEmitter(const Tig &design, const std::vector<std::string> &module_names,
+                Tig::ModuleId module_id, ChunkWriter &out)
+      : design_(design), module_names_(module_names), module_id_(module_id),
+        module_(design.modules[module_id]), out_(out) {}
+
+  // Returns an error message, or an empty string.
+  std::string run() {
+    mark_port_aliases();
+    write_header();
+    write_wires();
+    uint32_t po = 0;
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      write_node(n, po);
+    }
+    for (const auto &block : module_.blocks) {
+      write_block(block);
+    }
+    out_.put("endmodule\n\n");
+    return std::move(error_);
+  }
+
+private:
+  std::string_view view(NameId name) const { return design_.names.view(name); }
+
+  size_t output_index(EdgeRef edge) const {
+    return module_.output_offsets[edge.node_id] + edge.port_idx;
+  }
+  const Module::Output &spec(EdgeRef edge) const { return module_.outputs[output_index(edge)]; }
+
+  void fail(std::string message) {
+    if (error_.empty()) {
+      error_ = "module " + std::string(view(module_.name)) + ": " + std::move(message);
+    }
+  }
+
+  void ident(std::string_view name) {
+    if (is_simple_identifier(name)) {
+      out_.put(name);
+    } else {
+      out_.put('\\');
+      out_.put(name);
+      out_.put(' ');
+    }
+  }
+
+  void module_name(Tig::ModuleId module_id) { ident(module_names_[module_id]); }
+
+  void signal(EdgeRef edge) {
+    const NameId name = spec(edge).name;
+    if (name != kEmptyName) {
+      ident(view(name));
+      return;
+    }
+    out_.put("_n");
+    out_.put_uint(edge.node_id);
+    if (edge.port_idx != 0) {
+      out_.put('_');
+      out_.put_uint(edge.port_idx);
+    }
+  }
+
+  void range(uint64_t width, bool sign) {
+    out_.put(sign ? " signed [" : " [");
+    out_.put_uint(width == 0 ? 0 : width - 1);
+    out_.put(":0] ");
+  }
+
+  void replicate(uint64_t count, std::string_view bit) {
+    out_.put('{');
+    out_.put_uint(count);
+    out_.put('{');
+    out_.put(bit);
+    out_.put("}}");
+  }
+
+  // Bits [lo, lo + count) of `edge`, extended past its width with its sign bit
+  // if `sign` is set and with zeros otherwise.
+  void bits(EdgeRef edge, uint64_t lo, uint64_t count, bool sign) {
+    if (edge.node_id == Tig::kInvalidNodeId) {
+      replicate(count, "1'bx");
+      return;
+    }
+    const uint64_t width = spec(edge).width;
+    const uint64_t inside = lo < width ? std::min(count, width - lo) : 0;
+    const uint64_t extension = count - inside;
+    if (extension > 0) {
+      out_.put('{');
+      out_.put('{');
+      out_.put_uint(extension);
+      out_.put('{');
+      if (sign && width > 0) {
+        signal(edge);
+        out_.put('[');
+        out_.put_uint(width - 1);
+        out_.put(']');
+      } else {
+        out_.put("1'b0");
+      }
+      out_.put("}}");
+      if (inside == 0) {
+        out_.put('}');
+        return;
+      }
+      out_.put(", ");
+    }
+    signal(edge);
+    if (lo != 0 || inside != width) {
+      out_.put('[');
+      out_.put_uint(lo + inside - 1);
+      out_.put(':');
+      out_.put_uint(lo);
+      out_.put(']');
+    }
+    if (extension > 0) {
+      out_.put('}');
+    }
+  }
+
+  void begin_assign(EdgeRef edge) {
+    out_.put("  assign ");
+    signal(edge);
+    out_.put(" = ");
+  }
+
+  // An output port driven by a signal of the same name is that signal, so it
+  // needs neither a wire nor an assignment.
+  void mark_port_aliases() {
+    port_alias_.assign(module_.outputs.size(), false);
+    uint32_t po = 0;
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) != NodeKind::kPo) {
+        continue;
+      }
+      const EdgeRef fanin = module_.node_fanins(n)[0];
+      const NameId port = po < module_.output_ports.size() ? module_.output_ports[po].name
+                                                           : kEmptyName;
+      po++;
+      if (fanin.node_id != Tig::kInvalidNodeId && port != kEmptyName &&
+          spec(fanin).name == port && module_.kind(fanin.node_id) != NodeKind::kPi) {
+        port_alias_[output_index(fanin)] = true;
+      }
+    }
+  }
+
+  void write_header() {
+    out_.put("module ");
+    module_name(module_id_);
+    out_.put('(');
+    bool first = true;
+    for (const auto *ports : {&module_.input_ports, &module_.output_ports}) {
+      for (const auto &port : *ports) {
+        out_.put(first ? "" : ", ");
+        ident(view(port.name));
+        first = false;
+      }
+    }
+    out_.put(");\n");
+    for (const auto &port : module_.input_ports) {
+      out_.put("  input");
+      range(port.width, port.sign);
+      ident(view(port.name));
+      out_.put(";\n");
+    }
+    for (const auto &port : module_.output_ports) {
+      out_.put("  output");
+      range(port.width, port.sign);
+      ident(view(port.name));
+      out_.put(";\n");
+    }
+  }
+
+  void write_wires() {
+    for (Tig::NodeId n = 0; n < module_.num_nodes(); n++) {
+      if (module_.kind(n) == NodeKind::kPi) {
+        continue;
+      }
+      const auto outputs = module_.node_outputs(n);
+      for (size_t port = 0; port < outputs.size(); port++) {
+        const EdgeRef edge{n, static_cast<Tig::PortIndex>(port)};
+        if (port_alias_[output_index(edge)] || outputs[port].width == 0) {
+          continue;
+        }
+        out_.put("  wire");
+        range(outputs[port].width, outputs[port].sign);
+        signal(edge);
+        out_.put(";\n");
+      }
+    }
+  }
+
+  void write_node(Tig::NodeId n, uint32_t &po) {
+    const auto fanins = module_.node_fanins(n);
+    const auto outputs = module_.node_outputs(n);
+    switch (module_.kind(n)) {
+    case NodeKind::kPi:
+    case NodeKind::kRo:
+    case NodeKind::kRi:
+      return;
+    case NodeKind::kPo: {
+      const EdgeRef fanin = fanins[0];
+      if (po >= module_.output_ports.size()) {
+        fail("more output nodes than output ports");
+        return;
+      }
+      const auto &port = module_.output_ports[po++];
+      if (fanin.node_id != Tig::kInvalidNodeId && port_alias_[output_index(fanin)]) {
+        return;
+      }
+      out_.put("  assign ");
+      ident(view(port.name));
+      out_.put(" = ");
+      bits(fanin, 0, port.width,
+           fanin.node_id != Tig::kInvalidNodeId && spec(fanin).sign);
+      out_.put(";\n");
+      return;
+    }
+    case NodeKind::kConst: {
+      const ConstView value = module_.node_const(n);
+      if (outputs[0].width == 0) {
+        return;
+      }
+      begin_assign({n, 0});
+      if (value.width() == outputs[0].width) {
+        static constexpr char kDigits[] = {'0', '1', 'x', 'z'};
+        out_.put_uint(outputs[0].width);
+        out_.put("'b");
+        for (uint64_t i = value.width(); i-- > 0;) {
+          out_.put(kDigits[static_cast<size_t>(value.bit(i))]);
+        }
+      } else {
+        replicate(outputs[0].width, "1'bx");
+      }
+      out_.put(";\n");
+      return;
+    }
+    case NodeKind::kConvert:
+      if (outputs[0].width != 0) {
+        begin_assign({n, 0});
+        bits(fanins[0], 0, outputs[0].width, operand_sign(fanins[0]));
+        out_.put(";\n");
+      }
+      return;
+    case NodeKind::kSplit: {
+      uint64_t offset = 0;
+      for (size_t port = 0; port < outputs.size(); port++) {
+        if (outputs[port].width != 0) {
+          begin_assign({n, static_cast<Tig::PortIndex>(port)});
+          bits(fanins[0], offset, outputs[port].width, operand_sign(fanins[0]));
+          out_.put(";\n");
+        }
+        offset += outputs[port].width;
+      }
+      return;
+    }
+    case NodeKind::kMerge:
+      return write_merge(n);
+    case NodeKind::kOp:
+      return write_op(n);
+    case NodeKind::kInstance:
+      return write_instance(n);
+    default:
+      fail("node " + std::to_string(n) + " has a kind the writer does not handle");
+      return;
+    }
+  }
+
+  bool operand_sign(EdgeRef edge) const {
+    return edge.node_id != Tig::kInvalidNodeId && spec(edge).sign;
+  }
+
+  void write_merge(Tig::NodeId n) {
+    const auto widths = module_.node_segment_widths(n);
+    const auto fanins = module_.node_fanins(n);
+    const uint64_t width = module_.node_outputs(n)[0].width;
+    if (width == 0) {
+      return;
+    }
+    // Segments, least significant first, clipped to the output width.
+    pieces_.clear();
+    uint64_t pos = 0;
+    for (size_t i = 0; i < fanins.size() && pos < width; i++) {
+      const uint64_t count = std::min<uint64_t>(widths[i], width - pos);
+      if (count > 0) {
+        pieces_.emplace_back(i, count);
+      }
+      pos += count;
+    }
+    begin_assign({n, 0});
+    out_.put('{');
+    bool first = true;
+    if (pos < width) {
+      replicate(width - pos, "1'b0");
+      first = false;
+    }
+    for (auto it = pieces_.rbegin(); it != pieces_.rend(); ++it) {
+      out_.put(first ? "" : ", ");
+      bits(fanins[it->first], 0, it->second, operand_sign(fanins[it->first]));
+      first = false;
+    }
+    out_.put("};\n");
+  }
+
+  void write_op(Tig::NodeId n) {
+    const auto *attrs = module_.find_attrs(n);
+    const std::string_view op = attrs ? view(attrs->op) : std::string_view();
+    const auto fanins = module_.node_fanins(n);
+    const uint64_t w = module_.node_outputs(n)[0].width;
+    const char *symbol = op_symbol(op);
+    const bool is_unary = op == "not" || op == "neg";
+    if (!symbol) {
+      fail("unsupported op '" + std::string(op) + "' on node " + std::to_string(n));
+      return;
+    }
+    if (fanins.size() != (is_unary ? 1u : 2u)) {
+      fail("op '" + std::string(op) + "' of node " + std::to_string(n) + " has " +
+           std::to_string(fanins.size()) + " inputs");
+      return;
+    }
+    if (w == 0) {
+      return;
+    }
+    begin_assign({n, 0});
+    if (is_unary) {
+      out_.put(symbol);
+      bits(fanins[0], 0, w, operand_sign(fanins[0]));
+    } else if (op == "eq" || op == "ne" || op == "lt") {
+      // Operands are compared at their common width, signed only if both are.
+      const uint64_t cw = std::max(spec(fanins[0]).width, spec(fanins[1]).width);
+      const bool sign = operand_sign(fanins[0]) && operand_sign(fanins[1]);
+      const bool cast = sign && op == "lt";
+      if (w > 1) {
+        out_.put('{');
+        replicate(w - 1, "1'b0");
+        out_.put(", ");
+      }
+      out_.put(cast ? "($signed(" : "(");
+      bits(fanins[0], 0, cw, sign);
+      out_.put(cast ? ") " : " ");
+      out_.put(symbol);
+      out_.put(cast ? " $signed(" : " ");
+      bits(fanins[1], 0, cw, sign);
+      out_.put(cast ? "))" : ")");
+      if (w > 1) {
+        out_.put('}');
+      }
+    } else {
+      bits(fanins[0], 0, w, operand_sign(fanins[0]));
+      out_.put(' ');
+      out_.put(symbol);
+      out_.put(' ');
+      bits(fanins[1], 0, w, operand_sign(fanins[1]));
+    }
+    out_.put(";\n");
+  }
+
+  void instance_name(NameId name, char prefix, Tig::NodeId n) {
+    if (name != kEmptyName) {
+      ident(view(name));
+    } else {
+      out_.put('_');
+      out_.put(prefix);
+      out_.put_uint(n);
+    }
+  }
+
+  void write_instance(Tig::NodeId n) {
+    const auto *attrs = module_.find_attrs(n);
+    const Tig::ModuleId child_id = attrs ? attrs->module_id : Tig::kInvalidModuleId;
+    if (child_id >= design_.modules.size()) {
+      fail("instance node " + std::to_string(n) + " has no module");
+      return;
+    }
+    const Module &child = design_.modules[child_id];
+    const auto fanins = module_.node_fanins(n);
+    const auto outputs = module_.node_outputs(n);
+    if (fanins.size() != child.input_ports.size() || outputs.size() != child.output_ports.size()) {
+      fail("instance node " + std::to_string(n) + " does not match the ports of " +
+           std::string(view(child.name)));
+      return;
+    }
+    out_.put("  ");
+    module_name(child_id);
+    out_.put(' ');
+    instance_name(attrs->name, 'u', n);
+    out_.put('(');
+    for (size_t i = 0; i < fanins.size(); i++) {
+      out_.put(i == 0 ? "\n    ." : ",\n    .");
+      ident(view(child.input_ports[i].name));
+      out_.put('(');
+      bits(fanins[i], 0, child.input_ports[i].width, operand_sign(fanins[i]));
+      out_.put(')');
+    }
+    for (size_t i = 0; i < outputs.size(); i++) {
+      out_.put(i + fanins.size() == 0 ? "\n    ." : ",\n    .");
+      ident(view(child.output_ports[i].name));
+      out_.put('(');
+      if (outputs[i].width != 0) {
+        signal({n, static_cast<Tig::PortIndex>(i)});
+      }
+      out_.put(')');
+    }
+    out_.put(");\n");
+  }
+
+  // Sets are sorted by name handle; order them by name so the output reads
+  // the same whatever order the names were interned in.
+  std::vector<const Param *> sorted(ParamSetId set) const {
+    std::vector<const Param *> entries;
+    for (const Param &param : design_.params.view(set)) {
+      entries.push_back(&param);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [&](const Param *a, const Param *b) { return view(a->key) < view(b->key); });
+    return entries;
+  }
+
+  void put_param_value(const Param &param) {
+    out_.put(design_.params.to_verilog(design_.names, param));
+  }
+
+  void write_block(const Module::Block &block) {
+    static constexpr const char *kDefaultCells[] = {"abys_memory", "abys_latch", "abys_ff",
+                                                    "abys_macro", "abys_block"};
+    out_.put("  ");
+    if (block.attributes != kEmptyParamSet) {
+      out_.put("(* ");
+      bool first = true;
+      for (const Param *param : sorted(block.attributes)) {
+        out_.put(first ? "" : ", ");
+        out_.put(view(param->key));
+        out_.put(" = ");
+        put_param_value(*param);
+        first = false;
+      }
+      out_.put(" *) ");
+    }
+    if (block.impl_name != kEmptyName) {
+      ident(view(block.impl_name));
+    } else {
+      out_.put(kDefaultCells[static_cast<size_t>(block.kind)]);
+    }
+    if (block.params != kEmptyParamSet) {
+      out_.put(" #(");
+      bool first = true;
+      for (const Param *param : sorted(block.params)) {
+        out_.put(first ? "." : ", .");
+        ident(view(param->key));
+        out_.put('(');
+        put_param_value(*param);
+        out_.put(')');
+        first = false;
+      }
+      out_.put(')');
+    }
+    out_.put(' ');
+    if (block.name != kEmptyName) {
+      ident(view(block.name));
+    } else {
+      out_.put("_b");
+      out_.put_uint(static_cast<uint64_t>(&block - module_.blocks.data()));
+    }
+    out_.put('(');
+    bool first = true;
+    // Block inputs are kRi nodes, connected to what drives them; outputs are
+    // kRo nodes, whose wires the block drives.
+    for (size_t i = 0; i < block.inputs.size() && i < block.input_ports.size(); i++) {
+      out_.put(first ? "\n    ." : ",\n    .");
+      first = false;
+      ident(view(block.input_ports[i].name));
+      out_.put('(');
+      const auto fanins = module_.node_fanins(block.inputs[i]);
+      if (!fanins.empty()) {
+        bits(fanins[0], 0, block.input_ports[i].width, operand_sign(fanins[0]));
+      }
+      out_.put(')');
+    }
+    for (size_t i = 0; i < block.outputs.size() && i < block.output_ports.size(); i++) {
+      out_.put(first ? "\n    ." : ",\n    .");
+      first = false;
+      ident(view(block.output_ports[i].name));
+      out_.put('(');
+      if (!module_.node_outputs(block.outputs[i]).empty()) {
+        signal({block.outputs[i], 0});
+      }
+      out_.put(')');
+    }
+    out_.put(");\n");
+  }
+
+  const Tig &design_;
+  const std::vector<std::string> &module_names_;
+  Tig::ModuleId module_id_;
+  const Module &module_;
+  ChunkWriter &out_;
+  std::vector<bool> port_alias_;
+  std::vector<std::pair<size_t, uint64_t>> pieces_;
+  std::string error_;
+};
+
+} // namespace
+
+VerilogWriteResult write_verilog(const Tig &design, const std::string &path,
+                                 const VerilogWriteOptions &options) {
+  std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "wb"));
+  if (!file) {
+    return {false, "failed to open " + path + " for writing"};
+  }
+  // Output is already buffered per module.
+  std::setvbuf(file.get(), nullptr, _IONBF, 0);
+
+  const size_t capacity = std::max<size_t>(options.buffer_bytes, 64);
+  const unsigned threads = util::resolve_num_threads(options.num_threads);
+  OrderedFile out(file.get(), size_t{threads} * kMaxPendingChunks * capacity);
+  const std::string banner = "// Generated by abys " + version() + "\n\n";
+  out.write(banner.data(), banner.size());
+
+  // Errors are collected rather than thrown: a writer waiting for its turn must
+  // never be left behind by one that gave up.
+  std::vector<std::string> errors(design.modules.size());
+  const std::vector<std::string> names = module_names(design);
+  util::parallel_for(design.modules.size(), threads, [&](size_t m) {
+    util::ScopedTimer timer("write verilog", design.names.view(design.modules[m].name));
+    ChunkWriter writer(out, m, capacity);
+    errors[m] = ModuleEmitter(design, names, static_cast<Tig::ModuleId>(m), writer).run();
+    writer.finish();
+  });
+
+  if (std::fflush(file.get()) != 0 || out.failed()) {
+    return {false, "failed to write " + path, out.bytes()};
+  }
+  for (std::string &error : errors) {
+    if (!error.empty()) {
+      return {false, std::move(error), out.bytes()};
+    }
+  }
+  return {true, "ok", out.bytes()};
+}
+
+} // namespace abys::ir
@@ -1,9 +1,26 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "abys/aig/aiger.h"
+#include "abys/design_cache.h"
 #include "abys/frontend.h"
+#include "abys/ir/const_prop.h"
+#include "abys/ir/module_dedup.h"
+#include "abys/ir/pass_manager.h"
+#include "abys/ir/sweep.h"
+#include "abys/ir/tig_memory.h"
+#include "abys/ir/tig_snapshot.h"
+#include "abys/ir/verilog_writer.h"
+#include "abys/server.h"
+#include "abys/util/profile.h"
 #include "abys/version.h"
 
 namespace {
@@ -20,7 +37,623 @@ void print_help() {
   std::cout << "abys: logic synthesis toolchain (scaffold)\n";
   std::cout << "Usage:\n";
   std::cout << "  abys --version\n";
-  std::cout << "  abys parse <files...> [--top <module>]\n";
+  std::cout << "  abys parse <files...> [--top <module>] [-j <threads>]\n";
+  std::cout << "  abys write-tig <files...> [--top <module>] [-j <threads>] [--cache <dir>]\n";
+  std::cout << "                 [--hash-cons] [--const-prop] [--sweep] [--dedup]\n";
+  std::cout << "                 [--cone <output>] -o <out.tig>\n";
+  std::cout << "  abys read-tig <file.tig>\n";
+  std::cout << "  abys stats <files...|file.tig> [--top <module>] [-j <threads>] [--hash-cons]\n";
+  std::cout << "             [--const-prop] [--sweep] [--dedup] [--cone <output>] [--json]\n";
+  std::cout << "             [--limit <modules>]\n";
+  std::cout << "  abys write-verilog <files...> [--top <module>] [-j <threads>] [--const-prop]\n";
+  std::cout << "                     [--sweep] [--dedup] [--cone <output>] -o <out.v>\n";
+  std::cout << "  abys write-aiger <files...> [--top <module>] [-j <threads>] [--const-prop]\n";
+  std::cout << "                   [--sweep] [--dedup] [--cone <output>] -o <dir>\n";
+  std::cout << "  abys serve [--socket <path>] [--max-designs <n>] [--poll-ms <ms>] [--stop]\n";
+  std::cout << "Every command also accepts --stats (print per-phase time and memory)\n";
+  std::cout << "and --trace <file> (write a Chrome trace-event JSON file), and --connect\n";
+  std::cout << "(run the command on the abys server at $ABYS_SOCKET or the default socket).\n";
+}
+
+// Parses a whole argument as a non-negative decimal count.
+std::optional<size_t> parse_count(const std::string &text) {
+  size_t value = 0;
+  const char *end = text.data() + text.size();
+  const auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (text.empty() || ec != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+struct ProfileArgs {
+  bool stats = false;
+  std::optional<std::string> trace;
+};
+
+// Removes --stats and --trace <file> from argv, as every command accepts them.
+ProfileArgs take_profile_args(int &argc, char **argv) {
+  ProfileArgs args;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--stats") {
+      args.stats = true;
+      continue;
+    }
+    if (arg == "--trace" && i + 1 < argc) {
+      args.trace = argv[++i];
+      continue;
+    }
+    argv[kept++] = argv[i];
+  }
+  argc = kept;
+  return args;
+}
+
+struct SourceArgs {
+  std::vector<std::string> files;
+  std::optional<std::string> top;
+  std::optional<std::string> output;
+  bool const_prop = false;
+  bool sweep = false;
+  bool dedup = false;
+  // Output of the top module whose cone replaces the design.
+  std::optional<std::string> cone;
+  bool json = false;
+  // Modules listed by `stats`; 0 lists every module.
+  size_t limit = 20;
+  abys::FrontendOptions options;
+  // Set when an option value is malformed; the command then prints it and
+  // exits with a usage error.
+  std::optional<std::string> error;
+};
+
+SourceArgs parse_source_args(int argc, char **argv) {
+  SourceArgs args;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--top" && i + 1 < argc) {
+      args.top = argv[++i];
+      continue;
+    }
+    if (arg == "-o" && i + 1 < argc) {
+      args.output = argv[++i];
+      continue;
+    }
+    if (arg == "-j" && i + 1 < argc) {
+      // One count for parsing and lowering; parsing defaults to every core.
+      const auto threads = parse_count(argv[++i]);
+      if (!threads || *threads > std::numeric_limits<unsigned>::max()) {
+        args.error = std::string("-j needs a thread count, got ") + argv[i];
+        continue;
+      }
+      args.options.parse_threads = static_cast<unsigned>(*threads);
+      args.options.lowering_threads = static_cast<unsigned>(*threads);
+      continue;
+    }
+    if (arg == "--hash-cons") {
+      args.options.hash_consing = true;
+      continue;
+    }
+    if (arg == "--const-prop") {
+      args.const_prop = true;
+      continue;
+    }
+    if (arg == "--sweep") {
+      args.sweep = true;
+      continue;
+    }
+    if (arg == "--dedup") {
+      args.dedup = true;
+      continue;
+    }
+    if (arg == "--cone" && i + 1 < argc) {
+      args.cone = argv[++i];
+      continue;
+    }
+    if (arg == "--json") {
+      args.json = true;
+      continue;
+    }
+    if (arg == "--limit" && i + 1 < argc) {
+      const auto limit = parse_count(argv[++i]);
+      if (!limit) {
+        args.error = std::string("--limit needs a module count, got ") + argv[i];
+        continue;
+      }
+      args.limit = *limit;
+      continue;
+    }
+    if (arg == "--cache" && i + 1 < argc) {
+      args.options.cache_dir = argv[++i];
+      continue;
+    }
+    args.files.push_back(arg);
+  }
+  return args;
+}
+
+// Elaborated sessions and designs kept across commands while serving.
+abys::DesignCache *resident = nullptr;
+
+// A lowered design, either owned by the command or shared with the resident
+// cache until a pass needs to change it. The command's copy still shares every
+// module its passes leave alone.
+struct Design {
+  abys::ir::Tig owned;
+  std::shared_ptr<const abys::ir::Tig> shared;
+  abys::FrontendSession::BuildStats stats;
+
+  const abys::ir::Tig &get() const { return shared ? *shared : owned; }
+  abys::ir::Tig &mutate() {
+    if (shared) {
+      owned = *shared;
+      shared.reset();
+    }
+    return owned;
+  }
+};
+
+// Elaborates and lowers the sources of `args`, or reuses the resident design
+// when serving. Reports failures as `<command> failed: ...`.
+std::optional<Design> build_design(const SourceArgs &args, const std::string &command) {
+  Design design;
+  if (resident) {
+    auto lookup = resident->build(args.files, args.top, args.options);
+    if (!lookup.ok) {
+      std::cerr << command << " failed: " << lookup.message << '\n';
+      return std::nullopt;
+    }
+    abys::util::count("resident designs reused", lookup.warm ? 1 : 0);
+    design.shared = std::move(lookup.design);
+    design.stats = lookup.build_stats;
+    return design;
+  }
+  abys::FrontendSession session(args.options);
+  auto loaded = session.load(args.files, args.top);
+  if (!loaded.ok) {
+    std::cerr << command << " failed: " << loaded.message << '\n';
+    return std::nullopt;
+  }
+  abys::ir::TigBuildResult result;
+  {
+    abys::util::ScopedTimer timer("phase", "build tig");
+    result = session.build_tig();
+  }
+  if (!result.ok) {
+    std::cerr << command << " failed: " << result.message << '\n';
+    return std::nullopt;
+  }
+  design.owned = std::move(result.design);
+  design.stats = session.last_build_stats();
+  return design;
+}
+
+struct PassReports {
+  std::optional<abys::ir::ConstPropReport> folded;
+  std::optional<abys::ir::SweepReport> swept;
+  std::optional<abys::ir::ModuleDedupReport> dedup;
+};
+
+// The module named by --top, or else the only module no instance refers to.
+std::optional<abys::ir::Tig::ModuleId> find_top(const abys::ir::Tig &design,
+                                                const SourceArgs &args) {
+  if (args.top) {
+    for (abys::ir::Tig::ModuleId m = 0; m < design.modules.size(); m++) {
+      if (design.names.view(design.modules[m].name) == *args.top) {
+        return m;
+      }
+    }
+    return std::nullopt;
+  }
+  const auto tops = abys::ir::ModuleDag::build(design).tops;
+  if (tops.size() != 1) {
+    return std::nullopt;
+  }
+  return tops[0];
+}
+
+// Runs the passes `args` asks for, in a fixed order. Reports failures as
+// `<command> failed: ...`.
+std::optional<PassReports> run_passes(Design &design, const SourceArgs &args,
+                                      const std::string &command) {
+  PassReports reports;
+  if (args.const_prop) {
+    abys::util::ScopedTimer timer("phase", "propagate constants");
+    reports.folded =
+        abys::ir::propagate_constants(design.mutate(), args.options.lowering_threads);
+  }
+  if (args.sweep) {
+    abys::util::ScopedTimer timer("phase", "sweep dead logic");
+    abys::ir::SweepOptions options;
+    options.num_threads = args.options.lowering_threads;
+    reports.swept = abys::ir::sweep_dead_logic(design.mutate(), options);
+  }
+  if (args.dedup) {
+    abys::util::ScopedTimer timer("phase", "dedup modules");
+    reports.dedup = abys::ir::dedup_modules(design.mutate());
+  }
+  if (args.cone) {
+    abys::util::ScopedTimer timer("phase", "extract cone");
+    const auto &tig = design.get();
+    const auto top = find_top(tig, args);
+    if (!top) {
+      std::cerr << command << " failed: --cone needs a single top module; pass --top\n";
+      return std::nullopt;
+    }
+    const auto &ports = tig.modules[*top].output_ports;
+    const auto port = std::find_if(ports.begin(), ports.end(), [&](const auto &p) {
+      return tig.names.view(p.name) == *args.cone;
+    });
+    if (port == ports.end()) {
+      std::cerr << command << " failed: top module "
+                << tig.names.view(tig.modules[*top].name) << " has no output " << *args.cone
+                << '\n';
+      return std::nullopt;
+    }
+    auto cone = abys::ir::extract_cone(
+        tig, *top, static_cast<abys::ir::Tig::PortIndex>(port - ports.begin()));
+    if (!cone.ok) {
+      std::cerr << command << " failed: " << cone.message << '\n';
+      return std::nullopt;
+    }
+    design.owned = std::move(cone.design);
+    design.shared.reset();
+  }
+  return reports;
+}
+
+int run_parse(int argc, char **argv) {
+  const SourceArgs args = parse_source_args(argc, argv);
+  if (args.error) {
+    std::cerr << argv[1] << ": " << *args.error << '\n';
+    return 1;
+  }
+  abys::ParseResult result;
+  if (resident) {
+    const auto lookup = resident->load(args.files, args.top, args.options);
+    result = {lookup.ok, lookup.message};
+  } else {
+    abys::FrontendSession session(args.options);
+    result = session.load(args.files, args.top);
+  }
+  if (!result.ok) {
+    std::cerr << "parse failed: " << result.message << '\n';
+    return 2;
+  }
+  std::cout << "parse ok\n";
+  return 0;
+}
+
+int run_write_tig(int argc, char **argv) {
+  const SourceArgs args = parse_source_args(argc, argv);
+  if (args.error) {
+    std::cerr << argv[1] << ": " << *args.error << '\n';
+    return 1;
+  }
+  if (!args.output) {
+    std::cerr << "write-tig: missing -o <out.tig>\n";
+    return 1;
+  }
+  auto design = build_design(args, "write-tig");
+  if (!design) {
+    return 2;
+  }
+  const auto reports = run_passes(*design, args, "write-tig");
+  if (!reports) {
+    return 2;
+  }
+  abys::ir::TigSnapshotResult written;
+  {
+    abys::util::ScopedTimer timer("phase", "write snapshot");
+    written = abys::ir::write_tig_snapshot(design->get(), *args.output);
+  }
+  if (!written.ok) {
+    std::cerr << "write-tig failed: " << written.message << '\n';
+    return 2;
+  }
+
+  if (!args.options.cache_dir.empty()) {
+    std::cout << "reused " << design->stats.cached_modules << " of " << design->stats.modules
+              << " modules from " << args.options.cache_dir << '\n';
+  }
+  if (reports->folded) {
+    std::cout << "folded " << reports->folded->folded_nodes << " nodes into "
+              << reports->folded->created_consts << " constants\n";
+  }
+  if (reports->swept) {
+    const auto &swept = *reports->swept;
+    std::cout << "swept " << swept.nodes_before - swept.nodes_after << " of "
+              << swept.nodes_before << " nodes and " << swept.modules_before - swept.modules_after
+              << " of " << swept.modules_before << " modules\n";
+  }
+  if (reports->dedup) {
+    const auto &dedup = *reports->dedup;
+    std::cout << "merged " << dedup.modules_before - dedup.modules_after << " of "
+              << dedup.modules_before << " modules, saving " << dedup.bytes_saved << " bytes\n";
+  }
+  std::cout << "wrote " << *args.output << '\n';
+  return 0;
+}
+
+int run_write_verilog(int argc, char **argv) {
+  const SourceArgs args = parse_source_args(argc, argv);
+  if (args.error) {
+    std::cerr << argv[1] << ": " << *args.error << '\n';
+    return 1;
+  }
+  if (!args.output) {
+    std::cerr << "write-verilog: missing -o <out.v>\n";
+    return 1;
+  }
+  auto design = build_design(args, "write-verilog");
+  if (!design) {
+    return 2;
+  }
+  if (!run_passes(*design, args, "write-verilog")) {
+    return 2;
+  }
+  abys::ir::VerilogWriteOptions options;
+  options.num_threads = args.options.lowering_threads;
+  abys::ir::VerilogWriteResult written;
+  {
+    abys::util::ScopedTimer timer("phase", "write verilog");
+    written = abys::ir::write_verilog(design->get(), *args.output, options);
+  }
+  if (!written.ok) {
+    std::cerr << "write-verilog failed: " << written.message << '\n';
+    return 2;
+  }
+  std::cout << "wrote " << written.bytes_written << " bytes to " << *args.output << '\n';
+  return 0;
+}
+
+int run_write_aiger(int argc, char **argv) {
+  const SourceArgs args = parse_source_args(argc, argv);
+  if (args.error) {
+    std::cerr << argv[1] << ": " << *args.error << '\n';
+    return 1;
+  }
+  if (!args.output) {
+    std::cerr << "write-aiger: missing -o <dir>\n";
+    return 1;
+  }
+  auto design = build_design(args, "write-aiger");
+  if (!design) {
+    return 2;
+  }
+  if (!run_passes(*design, args, "write-aiger")) {
+    return 2;
+  }
+  abys::aig::AigerWriteOptions options;
+  options.num_threads = args.options.lowering_threads;
+  abys::aig::AigerWriteResult written;
+  {
+    abys::util::ScopedTimer timer("phase", "write aiger");
+    written = abys::aig::write_aiger(design->get(), *args.output, options);
+  }
+  if (!written.ok) {
+    std::cerr << "write-aiger failed: " << written.message << '\n';
+    return 2;
+  }
+  std::cout << "wrote " << written.bytes_written << " bytes to " << written.paths.size()
+            << " files in " << *args.output << '\n';
+  return 0;
+}
+
+int run_read_tig(int argc, char **argv) {
+  if (argc != 3) {
+    print_help();
+    return 1;
+  }
+  abys::ir::TigSnapshot snapshot;
+  abys::ir::TigSnapshotResult result;
+  {
+    abys::util::ScopedTimer timer("phase", "open snapshot");
+    result = snapshot.open(argv[2]);
+  }
+  if (!result.ok) {
+    std::cerr << "read-tig failed: " << result.message << '\n';
+    return 2;
+  }
+
+  size_t total_nodes = 0;
+  size_t total_edges = 0;
+  for (abys::ir::Tig::ModuleId m = 0; m < snapshot.num_modules(); ++m) {
+    const auto module = snapshot.module(m);
+    std::cout << "module " << snapshot.name(module.name) << ": " << module.num_nodes()
+              << " nodes, " << module.fanins.size() << " edges, " << module.input_ports.size()
+              << " inputs, " << module.output_ports.size() << " outputs\n";
+    total_nodes += module.num_nodes();
+    total_edges += module.fanins.size();
+  }
+  std::cout << snapshot.num_modules() << " modules, " << total_nodes << " nodes, " << total_edges
+            << " edges\n";
+  return 0;
+}
+
+bool is_snapshot_path(const std::string &path) {
+  return path.size() > 4 && path.compare(path.size() - 4, 4, ".tig") == 0;
+}
+
+int run_stats(int argc, char **argv) {
+  const SourceArgs args = parse_source_args(argc, argv);
+  if (args.error) {
+    std::cerr << argv[1] << ": " << *args.error << '\n';
+    return 1;
+  }
+  std::optional<Design> design;
+  if (args.files.size() == 1 && is_snapshot_path(args.files[0])) {
+    abys::ir::TigSnapshot snapshot;
+    abys::util::ScopedTimer timer("phase", "open snapshot");
+    const auto opened = snapshot.open(args.files[0]);
+    if (!opened.ok) {
+      std::cerr << "stats failed: " << opened.message << '\n';
+      return 2;
+    }
+    design.emplace();
+    design->owned = snapshot.materialize();
+  } else {
+    design = build_design(args, "stats");
+    if (!design) {
+      return 2;
+    }
+  }
+  if (!run_passes(*design, args, "stats")) {
+    return 2;
+  }
+  abys::ir::DesignMemory memory;
+  {
+    abys::util::ScopedTimer timer("phase", "account memory");
+    memory = abys::ir::design_memory(design->get(), args.options.lowering_threads);
+  }
+  if (args.json) {
+    abys::ir::write_memory_report_json(std::cout, design->get(), memory);
+  } else {
+    abys::ir::write_memory_report(std::cout, design->get(), memory, args.limit);
+  }
+  return 0;
+}
+
+int run_invocation(int argc, char **argv);
+
+int run_serve(int argc, char **argv) {
+  abys::ServerOptions options;
+  options.socket_path = abys::default_socket_path();
+  size_t max_designs = 4;
+  bool stop = false;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--socket" && i + 1 < argc) {
+      options.socket_path = argv[++i];
+    } else if (arg == "--max-designs" && i + 1 < argc) {
+      const auto count = parse_count(argv[++i]);
+      if (!count || *count == 0) {
+        std::cerr << "serve: --max-designs needs a positive count, got " << argv[i] << '\n';
+        return 1;
+      }
+      max_designs = *count;
+    } else if (arg == "--poll-ms" && i + 1 < argc) {
+      const auto ms = parse_count(argv[++i]);
+      if (!ms || *ms > 24 * 60 * 60 * 1000) {
+        std::cerr << "serve: --poll-ms needs a count of milliseconds, got " << argv[i] << '\n';
+        return 1;
+      }
+      // Polling without a pause would keep a core busy.
+      options.poll_interval = std::chrono::milliseconds(std::max<size_t>(1, *ms));
+    } else if (arg == "--stop") {
+      stop = true;
+    } else {
+      std::cerr << "serve: unknown option " << arg << '\n';
+      return 1;
+    }
+  }
+  if (stop) {
+    const auto stopped = abys::stop_server(options.socket_path);
+    if (!stopped.ok) {
+      std::cerr << "serve --stop failed: " << stopped.message << '\n';
+      return 2;
+    }
+    std::cout << "stopped " << options.socket_path << '\n';
+    return 0;
+  }
+
+  abys::DesignCache cache(max_designs);
+  resident = &cache;
+  const auto run = [](const std::vector<std::string> &args) {
+    if (!args.empty() && args[0] == "serve") {
+      std::cerr << "serve: cannot be run on a server\n";
+      return 1;
+    }
+    std::vector<std::string> storage{"abys"};
+    storage.insert(storage.end(), args.begin(), args.end());
+    std::vector<char *> argv_copy;
+    for (auto &arg : storage) {
+      argv_copy.push_back(arg.data());
+    }
+    argv_copy.push_back(nullptr);
+    return run_invocation(static_cast<int>(storage.size()), argv_copy.data());
+  };
+  const auto idle = [&cache] {
+    if (const size_t reloaded = cache.refresh()) {
+      std::cerr << "reloaded " << reloaded << " changed design(s)\n";
+    }
+  };
+  std::cout << "listening on " << options.socket_path << std::endl;
+  const auto served = abys::serve(options, run, idle);
+  resident = nullptr;
+  if (!served.ok) {
+    std::cerr << "serve failed: " << served.message << '\n';
+    return 2;
+  }
+  return 0;
+}
+
+int run_command(int argc, char **argv) {
+  if (argc <= 1) {
+    print_help();
+    return 1;
+  }
+  std::string command = argv[1];
+  if (command == "parse") {
+    return run_parse(argc, argv);
+  }
+  if (command == "write-tig") {
+    return run_write_tig(argc, argv);
+  }
+  if (command == "read-tig") {
+    return run_read_tig(argc, argv);
+  }
+  if (command == "write-verilog") {
+    return run_write_verilog(argc, argv);
+  }
+  if (command == "write-aiger") {
+    return run_write_aiger(argc, argv);
+  }
+  if (command == "stats") {
+    return run_stats(argc, argv);
+  }
+  if (command == "serve") {
+    return run_serve(argc, argv);
+  }
+
+  print_help();
+  return 1;
+}
+
+// Runs one command with its profiling flags, as typed or as forwarded to a
+// server.
+int run_invocation(int argc, char **argv) {
+  const ProfileArgs profile = take_profile_args(argc, argv);
+  abys::util::Profiler::instance().clear();
+  abys::util::Profiler::set_enabled(profile.stats || profile.trace);
+  const int status = run_command(argc, argv);
+
+  if (profile.stats) {
+    std::cout << "stats:\n";
+    abys::util::Profiler::instance().write_summary(std::cout);
+  }
+  if (profile.trace && !abys::util::Profiler::instance().write_trace(*profile.trace)) {
+    std::cerr << "failed to write trace " << *profile.trace << '\n';
+    return status == 0 ? 2 : status;
+  }
+  return status;
+}
+
+// Removes --connect from argv and reports whether it was there.
+bool take_connect_flag(int &argc, char **argv) {
+  bool connect = false;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--connect") {
+      connect = true;
+      continue;
+    }
+    argv[kept++] = argv[i];
+  }
+  argc = kept;
+  return connect;
 }
 
 } // namespace
@@ -42,30 +675,15 @@ int main(int argc, char **argv) {
     }
   }
 
-  std::string command = argv[1];
-  if (command == "parse") {
-    std::vector<std::string> files;
-    std::optional<std::string> top;
-
-    for (int i = 2; i < argc; ++i) {
-      std::string arg = argv[i];
-      if (arg == "--top" && i + 1 < argc) {
-        top = argv[++i];
-        continue;
-      }
-      files.push_back(arg);
-    }
-
-    auto result = abys::parse_systemverilog(files, top);
-    if (!result.ok) {
-      std::cerr << "parse failed: " << result.message << '\n';
+  if (take_connect_flag(argc, argv)) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    int status = 0;
+    const auto forwarded = abys::forward_to_server(abys::default_socket_path(), args, status);
+    if (!forwarded.ok) {
+      std::cerr << "--connect failed: " << forwarded.message << '\n';
       return 2;
     }
-
-    std::cout << "parse ok\n";
-    return 0;
+    return status;
   }
-
-  print_help();
-  return 1;
+  return run_invocation(argc, argv);
 }
@@ -0,0 +1,402 @@
+#include "abys/server.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <span>
+#include <utility>
+
+namespace abys {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x53594241; // "ABYS"
+// Longer commands are refused rather than buffered.
+constexpr uint64_t kMaxPayload = uint64_t{16} << 20;
+
+enum class RequestKind : uint32_t { kRun = 1, kStop = 2 };
+
+// Sent with the client's standard output and error attached, for kRun. The
+// payload follows: the working directory, then each argument, each ended by a
+// NUL. The server answers with the exit status as an int32_t.
+struct RequestHeader {
+  uint32_t magic = kMagic;
+  RequestKind kind = RequestKind::kRun;
+  uint64_t payload_size = 0;
+};
+
+class Fd {
+public:
+  Fd() = default;
+  explicit Fd(int fd) : fd_(fd) {}
+  Fd(Fd &&other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+  Fd &operator=(Fd &&other) noexcept {
+    reset(std::exchange(other.fd_, -1));
+    return *this;
+  }
+  Fd(const Fd &) = delete;
+  Fd &operator=(const Fd &) = delete;
+  ~Fd() { reset(); }
+
+  int get() const { return fd_; }
+  explicit operator bool() const { return fd_ >= 0; }
+  void reset(int fd = -1) {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    fd_ = fd;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+bool write_all(int fd, const void *data, size_t size) {
+  const auto *p = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t n = ::write(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool read_all(int fd, void *data, size_t size) {
+  auto *p = static_cast<char *>(data);
+  while (size > 0) {
+    const ssize_t n = ::read(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads and writes on `fd` fail once they have waited `timeout`.
+bool set_timeouts(int fd, std::chrono::milliseconds timeout) {
+  timeval tv{};
+  tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000 * 1000);
+  return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0 &&
+         ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) == 0;
+}
+
+std::string errno_message(const std::string &what) {
+  return what + ": " + std::strerror(errno);
+}
+
+bool make_address(const std::string &path, sockaddr_un &addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    return false;
+  }
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return true;
+}
+
+Fd connect_to(const std::string &path, std::string &error) {
+  sockaddr_un addr;
+  if (!make_address(path, addr)) {
+    error = "socket path is empty or too long: " + path;
+    return {};
+  }
+  Fd fd(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+  if (!fd) {
+    error = errno_message("socket");
+    return {};
+  }
+  if (::connect(fd.get(), reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+    error = errno_message("no abys server at " + path);
+    return {};
+  }
+  return fd;
+}
+
+// Sends the header, with `fds` attached when there are any, then the payload.
+bool send_request(int fd, RequestKind kind, const std::string &payload,
+                  std::span<const int> fds) {
+  RequestHeader header;
+  header.kind = kind;
+  header.payload_size = payload.size();
+  iovec iov{&header, sizeof(header)};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  if (!fds.empty()) {
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(fds.size_bytes());
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(fds.size_bytes());
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), fds.size_bytes());
+  }
+  ssize_t n;
+  do {
+    n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  return n == static_cast<ssize_t>(sizeof(header)) &&
+         write_all(fd, payload.data(), payload.size());
+}
+
+struct Request {
+  RequestKind kind = RequestKind::kRun;
+  std::string cwd;
+  std::vector<std::string> args;
+  Fd out;
+  Fd err;
+};
+
+bool receive_request(int fd, Request &request) {
+  RequestHeader header;
+  iovec iov{&header, sizeof(header)};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  do {
+    n = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  // Descriptors are adopted first so that they are closed on every path.
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    int fds[2] = {-1, -1};
+    std::memcpy(fds, CMSG_DATA(cmsg), std::min<size_t>(count, 2) * sizeof(int));
+    request.out.reset(fds[0]);
+    request.err.reset(fds[1]);
+  }
+  if (n != static_cast<ssize_t>(sizeof(header)) || header.magic != kMagic ||
+      header.payload_size > kMaxPayload || (msg.msg_flags & MSG_CTRUNC)) {
+    return false;
+  }
+  request.kind = header.kind;
+  std::string payload(header.payload_size, '\0');
+  if (!read_all(fd, payload.data(), payload.size())) {
+    return false;
+  }
+  if (request.kind == RequestKind::kStop) {
+    return true;
+  }
+  if (request.kind != RequestKind::kRun || !request.out || !request.err) {
+    return false;
+  }
+  size_t begin = 0;
+  for (size_t end; (end = payload.find('\0', begin)) != std::string::npos; begin = end + 1) {
+    if (begin == 0) {
+      request.cwd = payload.substr(0, end);
+    } else {
+      request.args.push_back(payload.substr(begin, end - begin));
+    }
+  }
+  return !request.cwd.empty();
+}
+
+void flush_output() {
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+}
+
+// Runs `request` with the client's output descriptors in place of ours and in
+// the client's working directory, then puts both back.
+int run_forwarded(const ServerHandler &run, Request &request) {
+  flush_output();
+  Fd saved_out(::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0));
+  Fd saved_err(::fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 0));
+  ::dup2(request.out.get(), STDOUT_FILENO);
+  ::dup2(request.err.get(), STDERR_FILENO);
+  request.out.reset();
+  request.err.reset();
+
+  std::error_code ec;
+  const auto server_cwd = std::filesystem::current_path(ec);
+  int status = 2;
+  if (::chdir(request.cwd.c_str()) != 0) {
+    std::cerr << "abys serve: cannot change to " << request.cwd << ": " << std::strerror(errno)
+              << '\n';
+  } else {
+    try {
+      status = run(request.args);
+    } catch (const std::exception &e) {
+      std::cerr << "abys: " << e.what() << '\n';
+    }
+  }
+
+  flush_output();
+  // A client that went away leaves the streams failed; the next one must not
+  // inherit that.
+  std::cout.clear();
+  std::cerr.clear();
+  const std::pair<const Fd *, int> restore[] = {{&saved_out, STDOUT_FILENO},
+                                                 {&saved_err, STDERR_FILENO}};
+  for (const auto &[saved, target] : restore) {
+    if (*saved) {
+      ::dup2(saved->get(), target);
+    } else {
+      ::close(target);
+    }
+  }
+  if (!server_cwd.empty()) {
+    std::filesystem::current_path(server_cwd, ec);
+  }
+  return status;
+}
+
+} // namespace
+
+ServeResult serve(const ServerOptions &options, const ServerHandler &run,
+                  const std::function<void()> &idle) {
+  sockaddr_un addr;
+  if (!make_address(options.socket_path, addr)) {
+    return {false, "socket path is empty or too long: " + options.socket_path};
+  }
+  // Only a socket nobody answers on is taken over.
+  std::string ignored;
+  if (connect_to(options.socket_path, ignored)) {
+    return {false, "an abys server is already listening on " + options.socket_path};
+  }
+  ::unlink(options.socket_path.c_str());
+
+  Fd listener(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+  if (!listener) {
+    return {false, errno_message("socket")};
+  }
+  const mode_t mask = ::umask(0077);
+  const int bound =
+      ::bind(listener.get(), reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+  ::umask(mask);
+  if (bound != 0) {
+    return {false, errno_message("cannot bind " + options.socket_path)};
+  }
+  if (::listen(listener.get(), 16) != 0) {
+    ::unlink(options.socket_path.c_str());
+    return {false, errno_message("cannot listen on " + options.socket_path)};
+  }
+  // Writes to a client that went away must fail, not kill the server.
+  ::signal(SIGPIPE, SIG_IGN);
+
+  using Clock = std::chrono::steady_clock;
+  const auto poll_interval = std::max(options.poll_interval, std::chrono::milliseconds(1));
+  auto last_idle = Clock::now();
+  bool stopping = false;
+  while (!stopping) {
+    if (Clock::now() - last_idle >= poll_interval) {
+      idle();
+      last_idle = Clock::now();
+    }
+    pollfd p{listener.get(), POLLIN, 0};
+    const int ready = ::poll(&p, 1, static_cast<int>(poll_interval.count()));
+    if (ready <= 0) {
+      continue;
+    }
+    Fd client(::accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC));
+    // Commands are served one at a time, so a client that connects and then
+    // stalls must not block the loop.
+    if (!client || !set_timeouts(client.get(), options.client_timeout)) {
+      continue;
+    }
+    Request request;
+    if (!receive_request(client.get(), request)) {
+      continue;
+    }
+    int32_t status = 0;
+    if (request.kind == RequestKind::kStop) {
+      stopping = true;
+    } else {
+      status = run_forwarded(run, request);
+    }
+    write_all(client.get(), &status, sizeof(status));
+  }
+  ::unlink(options.socket_path.c_str());
+  return {true, "ok"};
+}
+
+ServeResult forward_to_server(const std::string &socket_path,
+                              const std::vector<std::string> &args, int &status) {
+  std::string error;
+  Fd fd = connect_to(socket_path, error);
+  if (!fd) {
+    return {false, error};
+  }
+  std::error_code ec;
+  std::string payload = std::filesystem::current_path(ec).string();
+  if (ec) {
+    return {false, "cannot read the working directory: " + ec.message()};
+  }
+  payload += '\0';
+  for (const auto &arg : args) {
+    payload += arg;
+    payload += '\0';
+  }
+  flush_output();
+  const int fds[] = {STDOUT_FILENO, STDERR_FILENO};
+  int32_t reply = 0;
+  if (!send_request(fd.get(), RequestKind::kRun, payload, fds) ||
+      !read_all(fd.get(), &reply, sizeof(reply))) {
+    return {false, "the abys server at " + socket_path + " closed the connection"};
+  }
+  status = reply;
+  return {true, "ok"};
+}
+
+ServeResult stop_server(const std::string &socket_path) {
+  std::string error;
+  Fd fd = connect_to(socket_path, error);
+  if (!fd) {
+    return {false, error};
+  }
+  int32_t reply = 0;
+  if (!send_request(fd.get(), RequestKind::kStop, {}, {}) ||
+      !read_all(fd.get(), &reply, sizeof(reply))) {
+    return {false, "the abys server at " + socket_path + " closed the connection"};
+  }
+  return {true, "ok"};
+}
+
+std::string default_socket_path() {
+  if (const char *path = std::getenv("ABYS_SOCKET"); path && *path) {
+    return path;
+  }
+  if (const char *dir = std::getenv("XDG_RUNTIME_DIR"); dir && *dir) {
+    return std::string(dir) + "/abys.sock";
+  }
+  return "/tmp/abys-" + std::to_string(::getuid()) + ".sock";
+}
+
+} // namespace abys
@@ -0,0 +1,42 @@
+#include "abys/sim/sim_kernels.h"
+
+#include "sim_kernels_impl.h"
+
+namespace abys::sim {
+
+#if defined(ABYS_HAVE_AVX2)
+// Defined in sim_kernels_avx2.cpp, the only unit built with -mavx2.
+const Kernels &avx2_kernel_table();
+#endif
+
+namespace {
+
+struct ScalarLane {
+  using Vector = Word;
+  static constexpr size_t kWords = 1;
+  static Vector load(const Word *p) { return *p; }
+  static void store(Word *p, Vector v) { *p = v; }
+  static Vector broadcast(Word w) { return w; }
+};
+
+constexpr Kernels kScalarKernels = make_kernels<ScalarLane>("scalar");
+
+} // namespace
+
+const Kernels &scalar_kernels() { return kScalarKernels; }
+
+const Kernels *avx2_kernels() {
+#if defined(ABYS_HAVE_AVX2)
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported ? &avx2_kernel_table() : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+const Kernels &best_kernels() {
+  const Kernels *avx2 = avx2_kernels();
+  return avx2 ? *avx2 : scalar_kernels();
+}
+
+} // namespace abys::sim
@@ -0,0 +1,28 @@
+// Built with -mavx2 and only called after a runtime CPU check; see
+// sim_kernels_impl.h for why it must not include library headers.
+
+#include <immintrin.h>
+
+#include "sim_kernels_impl.h"
+
+namespace abys::sim {
+
+namespace {
+
+struct Avx2Lane {
+  using Vector = __m256i;
+  static constexpr size_t kWords = 4;
+  static Vector load(const Word *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(Word *p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+  static Vector broadcast(Word w) { return _mm256_set1_epi64x(static_cast<long long>(w)); }
+};
+
+constexpr Kernels kAvx2Kernels = make_kernels<Avx2Lane>("avx2");
+
+} // namespace
+
+const Kernels &avx2_kernel_table() { return kAvx2Kernels; }
+
+} // namespace abys::sim
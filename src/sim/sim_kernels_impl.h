@@ -0,0 +1,134 @@
+#pragma once
+
+// Kernel bodies shared by the scalar and the AVX2 translation unit. A `Lane`
+// loads, stores and broadcasts one vector of `Lane::kWords` words; the bit
+// operators work on both that vector and a plain Word, so every kernel is one
+// vector loop followed by a scalar tail (none for a one-word lane). Everything
+// here has internal linkage and uses no library code, so the AVX2 unit cannot
+// leak AVX2 instructions into inline functions that other units share.
+
+#include <cstddef>
+
+#include "abys/sim/sim_kernels.h"
+
+namespace abys::sim {
+namespace {
+
+template <typename T> T majority(T a, T b, T c) { return (a & b) | (c & (a ^ b)); }
+
+template <typename Lane> struct KernelImpl {
+  using V = typename Lane::Vector;
+  static constexpr size_t kStep = Lane::kWords;
+
+  template <typename F> static void map1(Word *dst, const Word *a, size_t n, F f) {
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      Lane::store(dst + i, f(Lane::load(a + i)));
+    }
+    for (; kStep > 1 && i < n; i++) {
+      dst[i] = f(a[i]);
+    }
+  }
+
+  template <typename F> static void map2(Word *dst, const Word *a, const Word *b, size_t n, F f) {
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      Lane::store(dst + i, f(Lane::load(a + i), Lane::load(b + i)));
+    }
+    for (; kStep > 1 && i < n; i++) {
+      dst[i] = f(a[i], b[i]);
+    }
+  }
+
+  // sum = a ^ y ^ carry, carry = maj(a, y, carry) with y = addend(b).
+  template <typename F>
+  static void add(Word *sum, Word *carry, const Word *a, const Word *b, size_t n, F addend) {
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      const V x = Lane::load(a + i);
+      const V y = addend(Lane::load(b + i));
+      const V c = Lane::load(carry + i);
+      Lane::store(sum + i, x ^ y ^ c);
+      Lane::store(carry + i, majority(x, y, c));
+    }
+    for (; kStep > 1 && i < n; i++) {
+      const Word x = a[i];
+      const Word y = addend(b[i]);
+      const Word c = carry[i];
+      sum[i] = x ^ y ^ c;
+      carry[i] = majority(x, y, c);
+    }
+  }
+
+  static void fill(Word *dst, Word value, size_t n) {
+    const V v = Lane::broadcast(value);
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      Lane::store(dst + i, v);
+    }
+    for (; kStep > 1 && i < n; i++) {
+      dst[i] = value;
+    }
+  }
+
+  static void copy(Word *dst, const Word *a, size_t n) {
+    map1(dst, a, n, [](auto x) { return x; });
+  }
+  static void bit_not(Word *dst, const Word *a, size_t n) {
+    map1(dst, a, n, [](auto x) { return ~x; });
+  }
+  static void bit_and(Word *dst, const Word *a, const Word *b, size_t n) {
+    map2(dst, a, b, n, [](auto x, auto y) { return x & y; });
+  }
+  static void bit_or(Word *dst, const Word *a, const Word *b, size_t n) {
+    map2(dst, a, b, n, [](auto x, auto y) { return x | y; });
+  }
+  static void bit_xor(Word *dst, const Word *a, const Word *b, size_t n) {
+    map2(dst, a, b, n, [](auto x, auto y) { return x ^ y; });
+  }
+  static void bit_xnor(Word *dst, const Word *a, const Word *b, size_t n) {
+    map2(dst, a, b, n, [](auto x, auto y) { return ~(x ^ y); });
+  }
+  static void full_add(Word *sum, Word *carry, const Word *a, const Word *b, size_t n) {
+    add(sum, carry, a, b, n, [](auto y) { return y; });
+  }
+  static void full_sub(Word *sum, Word *carry, const Word *a, const Word *b, size_t n) {
+    add(sum, carry, a, b, n, [](auto y) { return ~y; });
+  }
+  static void accumulate_and(Word *acc, Word *carry, const Word *a, const Word *b, size_t n) {
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      const V x = Lane::load(acc + i);
+      const V y = Lane::load(a + i) & Lane::load(b + i);
+      const V c = Lane::load(carry + i);
+      Lane::store(acc + i, x ^ y ^ c);
+      Lane::store(carry + i, majority(x, y, c));
+    }
+    for (; kStep > 1 && i < n; i++) {
+      const Word x = acc[i];
+      const Word y = a[i] & b[i];
+      const Word c = carry[i];
+      acc[i] = x ^ y ^ c;
+      carry[i] = majority(x, y, c);
+    }
+  }
+  static void and_xnor(Word *acc, const Word *a, const Word *b, size_t n) {
+    size_t i = 0;
+    for (; i + kStep <= n; i += kStep) {
+      Lane::store(acc + i, Lane::load(acc + i) & ~(Lane::load(a + i) ^ Lane::load(b + i)));
+    }
+    for (; kStep > 1 && i < n; i++) {
+      acc[i] &= ~(a[i] ^ b[i]);
+    }
+  }
+};
+
+template <typename Lane> constexpr Kernels make_kernels(const char *name) {
+  using K = KernelImpl<Lane>;
+  return {name,         &K::fill,    &K::copy,     &K::bit_not,  &K::bit_and,
+          &K::bit_or,   &K::bit_xor, &K::bit_xnor, &K::full_add, &K::full_sub,
+          &K::accumulate_and, &K::and_xnor};
+}
+
+} // namespace
+} // namespace abys::sim
@@ -0,0 +1,468 @@
+#include "abys/sim/simulator.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string_view>
+
+#include "abys/util/hash.h"
+
+namespace abys::sim {
+
+namespace {
+
+using ir::ConstView;
+using ir::Logic;
+using ir::Tig;
+using Module = Tig::Module;
+using NodeKind = Module::NodeKind;
+using EdgeRef = Module::EdgeRef;
+
+constexpr Word kOnes = ~Word{0};
+
+// Thrown for designs the simulator cannot handle; turned into a SimResult.
+struct SimError : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+uint64_t splitmix64(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+} // namespace
+
+struct Simulator::Frame {
+  const Module *module = nullptr;
+  // Values of the output with index `i` in Module::outputs start at word
+  // `offsets[i]`.
+  std::vector<size_t> offsets;
+  std::vector<Word> values;
+  // kPi nodes and kPo fanins in node order, matched to instance ports.
+  std::vector<Tig::NodeId> pis;
+  std::vector<EdgeRef> pos;
+  std::span<const Tig::NodeId> order;
+  bool checked = false;
+
+  Word *planes(EdgeRef edge) {
+    return values.data() + offsets[module->output_offsets[edge.node_id] + edge.port_idx];
+  }
+  const Module::Output &spec(EdgeRef edge) const {
+    return module->node_outputs(edge.node_id)[edge.port_idx];
+  }
+};
+
+Simulator::Simulator(const Tig &design, Tig::ModuleId top, SimOptions options)
+    : design_(design), top_(top), num_words_(std::max<size_t>(1, options.num_words)),
+      kernels_(options.allow_simd ? &best_kernels() : &scalar_kernels()),
+      frames_(design.modules.size()), zeros_(num_words_, 0), scratch_(4 * num_words_) {
+  const Module &module = design.modules[top];
+  for (const NodeKind kind : {NodeKind::kPi, NodeKind::kRo}) {
+    for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+      if (module.kind(n) != kind) {
+        continue;
+      }
+      for (size_t port = 0; port < module.node_outputs(n).size(); port++) {
+        inputs_.push_back({n, static_cast<Tig::PortIndex>(port)});
+      }
+    }
+  }
+  for (const NodeKind kind : {NodeKind::kPo, NodeKind::kRi}) {
+    for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+      if (module.kind(n) == kind) {
+        const auto fanins = module.node_fanins(n);
+        outputs_.insert(outputs_.end(), fanins.begin(), fanins.end());
+      }
+    }
+  }
+  frame(top);
+}
+
+Simulator::~Simulator() = default;
+Simulator::Simulator(Simulator &&) noexcept = default;
+
+Simulator::Frame &Simulator::frame(Tig::ModuleId module_id) {
+  auto &slot = frames_[module_id];
+  if (slot) {
+    return *slot;
+  }
+  slot = std::make_unique<Frame>();
+  Frame &f = *slot;
+  const Module &module = design_.modules[module_id];
+  f.module = &module;
+  f.offsets.resize(module.outputs.size() + 1);
+  size_t words = 0;
+  for (size_t i = 0; i < module.outputs.size(); i++) {
+    f.offsets[i] = words;
+    words += module.outputs[i].width * num_words_;
+  }
+  f.offsets.back() = words;
+  f.values.assign(words, 0);
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.kind(n) == NodeKind::kPi) {
+      f.pis.push_back(n);
+    } else if (module.kind(n) == NodeKind::kPo) {
+      f.pos.push_back(module.node_fanins(n)[0]);
+    }
+  }
+  return f;
+}
+
+std::span<Word> Simulator::input_values(size_t i) {
+  Frame &f = frame(top_);
+  return {f.planes(inputs_[i]), f.spec(inputs_[i]).width * num_words_};
+}
+
+void Simulator::randomize_inputs(uint64_t seed) {
+  for (size_t i = 0; i < inputs_.size(); i++) {
+    uint64_t state = util::hash_combine(seed, i);
+    for (Word &word : input_values(i)) {
+      word = splitmix64(state);
+    }
+  }
+}
+
+std::span<const Word> Simulator::values(EdgeRef signal) const {
+  Frame &f = *frames_[top_];
+  return {f.planes(signal), f.spec(signal).width * num_words_};
+}
+
+uint64_t Simulator::signature(EdgeRef signal) const {
+  const auto words = values(signal);
+  return util::hash_bytes(words.data(), words.size_bytes(), words.size());
+}
+
+std::vector<uint64_t> Simulator::signatures() const {
+  const Module &module = design_.modules[top_];
+  std::vector<uint64_t> result;
+  result.reserve(module.outputs.size());
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    for (size_t port = 0; port < module.node_outputs(n).size(); port++) {
+      result.push_back(signature({n, static_cast<Tig::PortIndex>(port)}));
+    }
+  }
+  return result;
+}
+
+SimResult Simulator::run() {
+  nodes_evaluated_ = 0;
+  try {
+    evaluate(top_, 0);
+  } catch (const SimError &e) {
+    return {false, e.what()};
+  }
+  return {true, "ok"};
+}
+
+void Simulator::evaluate(Tig::ModuleId module_id, size_t depth) {
+  if (depth > design_.modules.size()) {
+    throw SimError("instance cycle through module " +
+                   std::string(design_.names.view(design_.modules[module_id].name)));
+  }
+  Frame &f = frame(module_id);
+  const Module &module = *f.module;
+  if (!f.checked) {
+    for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+      for (const EdgeRef &fanin : module.node_fanins(n)) {
+        if (fanin.node_id == Tig::kInvalidNodeId) {
+          throw SimError("node " + std::to_string(n) + " has an unconnected input");
+        }
+      }
+    }
+    f.order = module.topological_order();
+    if (f.order.size() != module.num_nodes()) {
+      throw SimError("combinational cycle in module " +
+                     std::string(design_.names.view(module.name)));
+    }
+    f.checked = true;
+  }
+  for (const Tig::NodeId n : f.order) {
+    evaluate_node(f, n, depth);
+  }
+  nodes_evaluated_ += f.order.size();
+}
+
+namespace {
+
+// Bit `bit` of `edge` extended to any width: past the signal's own bits it is
+// the sign bit for signed extension and zero otherwise.
+struct Operand {
+  const Word *base;
+  uint64_t width;
+  bool sign;
+  const Word *zeros;
+  size_t num_words;
+
+  const Word *plane(uint64_t bit) const {
+    if (bit >= width) {
+      if (!sign || width == 0) {
+        return zeros;
+      }
+      bit = width - 1;
+    }
+    return base + bit * num_words;
+  }
+};
+
+} // namespace
+
+void Simulator::evaluate_node(Frame &f, Tig::NodeId n, size_t depth) {
+  const Module &module = *f.module;
+  const Kernels &k = *kernels_;
+  const size_t nw = num_words_;
+  auto operand = [&](EdgeRef edge, bool sign) {
+    return Operand{f.planes(edge), f.spec(edge).width, sign, zeros_.data(), nw};
+  };
+
+  switch (module.kind(n)) {
+  case NodeKind::kPi:
+  case NodeKind::kRo:
+  case NodeKind::kPo:
+  case NodeKind::kRi:
+    return;
+  case NodeKind::kConst: {
+    const ConstView value = module.node_const(n);
+    Word *dst = f.planes({n, 0});
+    const uint64_t width = module.node_outputs(n)[0].width;
+    for (uint64_t b = 0; b < width; b++) {
+      const bool one = b < value.width() && value.bit(b) == Logic::k1;
+      k.fill(dst + b * nw, one ? kOnes : 0, nw);
+    }
+    return;
+  }
+  case NodeKind::kConvert: {
+    const EdgeRef input = module.node_fanins(n)[0];
+    const Operand a = operand(input, f.spec(input).sign);
+    Word *dst = f.planes({n, 0});
+    for (uint64_t b = 0; b < module.node_outputs(n)[0].width; b++) {
+      k.copy(dst + b * nw, a.plane(b), nw);
+    }
+    return;
+  }
+  case NodeKind::kSplit: {
+    const EdgeRef input = module.node_fanins(n)[0];
+    const Operand a = operand(input, f.spec(input).sign);
+    const auto outputs = module.node_outputs(n);
+    uint64_t offset = 0;
+    for (size_t port = 0; port < outputs.size(); port++) {
+      Word *dst = f.planes({n, static_cast<Tig::PortIndex>(port)});
+      for (uint64_t b = 0; b < outputs[port].width; b++) {
+        k.copy(dst + b * nw, a.plane(offset + b), nw);
+      }
+      offset += outputs[port].width;
+    }
+    return;
+  }
+  case NodeKind::kMerge: {
+    const auto widths = module.node_segment_widths(n);
+    const auto fanins = module.node_fanins(n);
+    const uint64_t width = module.node_outputs(n)[0].width;
+    Word *dst = f.planes({n, 0});
+    uint64_t pos = 0;
+    for (size_t i = 0; i < fanins.size() && pos < width; i++) {
+      const Operand a = operand(fanins[i], f.spec(fanins[i]).sign);
+      for (uint64_t b = 0; b < widths[i] && pos < width; b++, pos++) {
+        k.copy(dst + pos * nw, a.plane(b), nw);
+      }
+    }
+    for (; pos < width; pos++) {
+      k.fill(dst + pos * nw, 0, nw);
+    }
+    return;
+  }
+  case NodeKind::kOp:
+    return evaluate_op(f, n);
+  case NodeKind::kInstance:
+    return evaluate_instance(f, n, depth);
+  default:
+    throw SimError("node " + std::to_string(n) + " has a kind the simulator does not handle");
+  }
+}
+
+void Simulator::evaluate_op(Frame &f, Tig::NodeId n) {
+  const Module &module = *f.module;
+  const Kernels &k = *kernels_;
+  const size_t nw = num_words_;
+  const auto *attrs = module.find_attrs(n);
+  const std::string_view op = attrs ? design_.names.view(attrs->op) : std::string_view();
+  const auto fanins = module.node_fanins(n);
+  const uint64_t w = module.node_outputs(n)[0].width;
+  Word *dst = f.planes({n, 0});
+  Word *carry = scratch_.data();
+  Word *tmp_a = carry + nw;
+  Word *tmp_b = tmp_a + nw;
+  Word *sum = tmp_b + nw;
+
+  const bool is_unary = op == "not" || op == "neg";
+  if (fanins.size() != (is_unary ? 1u : 2u)) {
+    throw SimError("op '" + std::string(op) + "' of node " + std::to_string(n) + " has " +
+                   std::to_string(fanins.size()) + " inputs");
+  }
+  auto operand = [&](size_t i, bool sign) {
+    return Operand{f.planes(fanins[i]), f.spec(fanins[i]).width, sign, zeros_.data(), nw};
+  };
+  const Operand a = operand(0, f.spec(fanins[0]).sign);
+  const Operand b = is_unary ? a : operand(1, f.spec(fanins[1]).sign);
+  auto bitwise = [&](auto kernel) {
+    for (uint64_t i = 0; i < w; i++) {
+      kernel(dst + i * nw, a.plane(i), b.plane(i), nw);
+    }
+  };
+
+  if (op == "and") {
+    bitwise(k.bit_and);
+  } else if (op == "or") {
+    bitwise(k.bit_or);
+  } else if (op == "xor") {
+    bitwise(k.bit_xor);
+  } else if (op == "xnor") {
+    bitwise(k.bit_xnor);
+  } else if (op == "not") {
+    for (uint64_t i = 0; i < w; i++) {
+      k.bit_not(dst + i * nw, a.plane(i), nw);
+    }
+  } else if (op == "add") {
+    k.fill(carry, 0, nw);
+    for (uint64_t i = 0; i < w; i++) {
+      k.full_add(dst + i * nw, carry, a.plane(i), b.plane(i), nw);
+    }
+  } else if (op == "sub" || op == "neg") {
+    k.fill(carry, kOnes, nw);
+    for (uint64_t i = 0; i < w; i++) {
+      const Word *minuend = op == "neg" ? zeros_.data() : a.plane(i);
+      k.full_sub(dst + i * nw, carry, minuend, b.plane(i), nw);
+    }
+  } else if (op == "mul") {
+    // Shift-and-add, truncated to the result width.
+    k.fill(dst, 0, w * nw);
+    for (uint64_t i = 0; i < w; i++) {
+      k.fill(carry, 0, nw);
+      for (uint64_t j = 0; i + j < w; j++) {
+        k.accumulate_and(dst + (i + j) * nw, carry, a.plane(j), b.plane(i), nw);
+      }
+    }
+  } else if (op == "eq" || op == "ne" || op == "lt") {
+    // Operands are compared at their common width, signed only if both are.
+    const auto &sa = f.spec(fanins[0]);
+    const auto &sb = f.spec(fanins[1]);
+    const bool sign = sa.sign && sb.sign;
+    const uint64_t cw = std::max(sa.width, sb.width);
+    const Operand ca = operand(0, sign);
+    const Operand cb = operand(1, sign);
+    if (op == "lt") {
+      // a < b iff a + ~b + 1 has no carry out; signed operands compare as
+      // unsigned with their sign bits flipped.
+      k.fill(carry, kOnes, nw);
+      for (uint64_t i = 0; i < cw; i++) {
+        const Word *pa = ca.plane(i);
+        const Word *pb = cb.plane(i);
+        if (sign && i + 1 == cw) {
+          k.bit_not(tmp_a, pa, nw);
+          k.bit_not(tmp_b, pb, nw);
+          pa = tmp_a;
+          pb = tmp_b;
+        }
+        k.full_sub(sum, carry, pa, pb, nw);
+      }
+      k.bit_not(carry, carry, nw);
+    } else {
+      k.fill(carry, kOnes, nw);
+      for (uint64_t i = 0; i < cw; i++) {
+        k.and_xnor(carry, ca.plane(i), cb.plane(i), nw);
+      }
+      if (op == "ne") {
+        k.bit_not(carry, carry, nw);
+      }
+    }
+    if (w > 0) {
+      k.copy(dst, carry, nw);
+      k.fill(dst + nw, 0, (w - 1) * nw);
+    }
+  } else {
+    throw SimError("unsupported op '" + std::string(op) + "' on node " + std::to_string(n));
+  }
+}
+
+void Simulator::evaluate_instance(Frame &f, Tig::NodeId n, size_t depth) {
+  const Module &module = *f.module;
+  const Kernels &k = *kernels_;
+  const size_t nw = num_words_;
+  const Tig::ModuleId child_id = module.instance_module_id(n);
+  if (child_id >= design_.modules.size()) {
+    throw SimError("instance node " + std::to_string(n) + " has no module");
+  }
+  Frame &child = frame(child_id);
+  const auto fanins = module.node_fanins(n);
+  const auto outputs = module.node_outputs(n);
+  if (fanins.size() != child.pis.size() || outputs.size() != child.pos.size()) {
+    throw SimError("instance node " + std::to_string(n) + " does not match the ports of " +
+                   std::string(design_.names.view(design_.modules[child_id].name)));
+  }
+
+  for (size_t i = 0; i < fanins.size(); i++) {
+    const Operand a{f.planes(fanins[i]), f.spec(fanins[i]).width, f.spec(fanins[i]).sign,
+                    zeros_.data(), nw};
+    const EdgeRef port{child.pis[i], 0};
+    Word *dst = child.planes(port);
+    for (uint64_t b = 0; b < child.spec(port).width; b++) {
+      k.copy(dst + b * nw, a.plane(b), nw);
+    }
+  }
+  evaluate(child_id, depth + 1);
+  for (size_t i = 0; i < outputs.size(); i++) {
+    const EdgeRef port = child.pos[i];
+    const Operand a{child.planes(port), child.spec(port).width, child.spec(port).sign,
+                    zeros_.data(), nw};
+    Word *dst = f.planes({n, static_cast<Tig::PortIndex>(i)});
+    for (uint64_t b = 0; b < outputs[i].width; b++) {
+      k.copy(dst + b * nw, a.plane(b), nw);
+    }
+  }
+}
+
+ScreenResult screen_equivalence(const Tig &design, Tig::ModuleId a, Tig::ModuleId b,
+                                size_t rounds, SimOptions options, uint64_t seed) {
+  Simulator sim_a(design, a, options);
+  Simulator sim_b(design, b, options);
+  auto widths_match = [&](std::span<const EdgeRef> x, const Module &mx,
+                          std::span<const EdgeRef> y, const Module &my) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
+                      [&](const EdgeRef &ex, const EdgeRef &ey) {
+                        return mx.node_outputs(ex.node_id)[ex.port_idx].width ==
+                               my.node_outputs(ey.node_id)[ey.port_idx].width;
+                      });
+  };
+  const Module &ma = design.modules[a];
+  const Module &mb = design.modules[b];
+  if (!widths_match(sim_a.inputs(), ma, sim_b.inputs(), mb) ||
+      !widths_match(sim_a.outputs(), ma, sim_b.outputs(), mb)) {
+    return {false, "modules have different inputs or outputs"};
+  }
+
+  for (size_t round = 0; round < rounds; round++) {
+    sim_a.randomize_inputs(seed + round);
+    sim_b.randomize_inputs(seed + round);
+    for (Simulator *sim : {&sim_a, &sim_b}) {
+      if (const SimResult run = sim->run(); !run.ok) {
+        return {false, run.message};
+      }
+    }
+    for (size_t o = 0; o < sim_a.outputs().size(); o++) {
+      const auto va = sim_a.output_values(o);
+      const auto vb = sim_b.output_values(o);
+      for (size_t i = 0; i < va.size(); i++) {
+        if (const Word diff = va[i] ^ vb[i]; diff != 0) {
+          const size_t word = i % sim_a.num_words();
+          const size_t pattern = round * sim_a.num_patterns() + 64 * word +
+                                 static_cast<size_t>(std::countr_zero(diff));
+          return {true, "ok", true, o, pattern};
+        }
+      }
+    }
+  }
+  return {true, "ok"};
+}
+
+} // namespace abys::sim
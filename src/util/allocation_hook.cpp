@@ -0,0 +1,30 @@
+// Replaces the global allocation functions so that util::thread_allocations()
+// counts every allocation of the calling thread. Linked into executables that
+// report allocations (see --stats), not into abys_core, so that library users
+// keep their own allocator.
+
+#include <cstdlib>
+#include <new>
+
+#include "abys/util/profile.h"
+
+namespace {
+
+void *allocate(std::size_t size) {
+  auto &counters = abys::util::thread_allocations();
+  counters.count++;
+  counters.bytes += size;
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,232 @@
+#include "abys/util/profile.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+#include "abys/util/json.h"
+
+namespace abys::util {
+
+namespace {
+
+double to_ms(Profiler::Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+double to_us(Profiler::Clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+double to_mib(uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+struct Totals {
+  size_t scopes = 0;
+  Profiler::Clock::duration time{};
+  uint64_t allocations = 0;
+  uint64_t allocated_bytes = 0;
+  size_t rss_bytes = 0;
+
+  void add(const Profiler::Event &event) {
+    scopes++;
+    time += event.duration;
+    allocations += event.allocations;
+    allocated_bytes += event.allocated_bytes;
+    rss_bytes = std::max(rss_bytes, event.rss_bytes);
+  }
+};
+
+constexpr size_t kSlowestModules = 10;
+
+} // namespace
+
+AllocationCounters &thread_allocations() {
+  thread_local AllocationCounters counters;
+  return counters;
+}
+
+uint32_t thread_ordinal() {
+  static std::atomic<uint32_t> next{0};
+  thread_local const uint32_t ordinal = next.fetch_add(1, std::memory_order_relaxed);
+  return ordinal;
+}
+
+size_t current_rss_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t resident = 0;
+  if (!(statm >> pages >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+Profiler &Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::record(Event event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back(std::move(event));
+}
+
+void Profiler::count(std::string_view name, int64_t delta) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = counters_.find(name);
+  if (it == counters_.end()) {
+    it = counters_.emplace(std::string(name), 0).first;
+  }
+  it->second += delta;
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  counters_.clear();
+  origin_ = Clock::now();
+}
+
+std::vector<Profiler::Event> Profiler::events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_;
+}
+
+std::map<std::string, int64_t, std::less<>> Profiler::counters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counters_;
+}
+
+void Profiler::write_summary(std::ostream &out) const {
+  auto events = this->events();
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event &a, const Event &b) { return a.start < b.start; });
+
+  // Phases keep their first-start order; module scopes fold into categories.
+  std::vector<std::pair<std::string, Totals>> phases;
+  std::map<std::string, Totals> categories;
+  std::map<std::string, Profiler::Clock::duration> modules;
+  for (const auto &event : events) {
+    if (event.category == "phase") {
+      auto it = std::find_if(phases.begin(), phases.end(),
+                             [&](const auto &phase) { return phase.first == event.name; });
+      if (it == phases.end()) {
+        it = phases.emplace(phases.end(), event.name, Totals{});
+      }
+      it->second.add(event);
+    } else {
+      categories[event.category].add(event);
+      modules[event.name] += event.duration;
+    }
+  }
+
+  char line[256];
+  auto print_row = [&](const std::string &name, const Totals &totals) {
+    std::snprintf(line, sizeof(line), "  %-28s %8zu %12.3f %12" PRIu64 " %12.2f %10.1f\n",
+                  name.c_str(), totals.scopes, to_ms(totals.time), totals.allocations,
+                  to_mib(totals.allocated_bytes), to_mib(totals.rss_bytes));
+    out << line;
+  };
+  std::snprintf(line, sizeof(line), "  %-28s %8s %12s %12s %12s %10s\n", "phase", "count",
+                "time (ms)", "allocs", "alloc (MiB)", "rss (MiB)");
+  out << line;
+  for (const auto &[name, totals] : phases) {
+    print_row(name, totals);
+  }
+  for (const auto &[category, totals] : categories) {
+    print_row(category + " (per module)", totals);
+  }
+
+  if (!modules.empty()) {
+    std::vector<std::pair<std::string, Profiler::Clock::duration>> slowest(modules.begin(),
+                                                                           modules.end());
+    const size_t shown = std::min(kSlowestModules, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + static_cast<std::ptrdiff_t>(shown),
+                      slowest.end(),
+                      [](const auto &a, const auto &b) { return a.second > b.second; });
+    out << "  slowest modules:\n";
+    for (size_t i = 0; i < shown; i++) {
+      std::snprintf(line, sizeof(line), "    %-26s %12.3f ms\n", slowest[i].first.c_str(),
+                    to_ms(slowest[i].second));
+      out << line;
+    }
+  }
+
+  for (const auto &[name, value] : counters()) {
+    out << "  " << name << ": " << value << '\n';
+  }
+}
+
+bool Profiler::write_trace(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+  // Timestamps in microseconds to the nanosecond; the default six significant
+  // digits would round events of a run past one second into each other.
+  out << std::fixed << std::setprecision(3);
+  const auto pid = static_cast<long>(::getpid());
+  const auto events = this->events();
+  Clock::duration end{};
+
+  out << "{\"traceEvents\":[\n";
+  bool first = true;
+  for (const auto &event : events) {
+    out << (first ? "" : ",\n") << "{\"name\":";
+    write_json_string(out, event.name);
+    out << ",\"cat\":";
+    write_json_string(out, event.category);
+    out << ",\"ph\":\"X\",\"ts\":" << to_us(event.start) << ",\"dur\":" << to_us(event.duration)
+        << ",\"pid\":" << pid << ",\"tid\":" << event.thread
+        << ",\"args\":{\"allocs\":" << event.allocations
+        << ",\"alloc_bytes\":" << event.allocated_bytes;
+    if (event.rss_bytes != 0) {
+      out << ",\"rss_bytes\":" << event.rss_bytes;
+    }
+    out << "}}";
+    first = false;
+    end = std::max(end, event.start + event.duration);
+  }
+  // Counters are totals for the run, so they are shown once at its end.
+  for (const auto &[name, value] : counters()) {
+    out << (first ? "" : ",\n") << "{\"name\":";
+    write_json_string(out, name);
+    out << ",\"ph\":\"C\",\"ts\":" << to_us(end) << ",\"pid\":" << pid
+        << ",\"tid\":0,\"args\":{\"value\":" << value << "}}";
+    first = false;
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return static_cast<bool>(out);
+}
+
+void ScopedTimer::begin(std::string_view category, std::string_view name) {
+  active_ = true;
+  event_.category = category;
+  event_.name = name;
+  event_.thread = thread_ordinal();
+  allocations_ = thread_allocations();
+  // The profiler's origin is taken on first use, which must not come after the
+  // start of the first event.
+  Profiler::instance();
+  start_ = Profiler::Clock::now();
+}
+
+void ScopedTimer::end() {
+  const auto stop = Profiler::Clock::now();
+  auto &profiler = Profiler::instance();
+  const AllocationCounters &now = thread_allocations();
+  event_.start = start_ - profiler.origin();
+  event_.duration = stop - start_;
+  event_.allocations = now.count - allocations_.count;
+  event_.allocated_bytes = now.bytes - allocations_.bytes;
+  if (event_.category == "phase") {
+    event_.rss_bytes = current_rss_bytes();
+  }
+  profiler.record(std::move(event_));
+}
+
+} // namespace abys::util
@@ -0,0 +1,171 @@
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/aig/aiger.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/sim/simulator.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::aig::Aig;
+using abys::aig::Literal;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+// Output values of `aig` with input `i` set to bit `i` of `pattern`.
+std::vector<bool> evaluate(const Aig &aig, uint64_t pattern) {
+  std::vector<bool> values(aig.num_vars(), false);
+  for (size_t i = 0; i < aig.num_inputs(); i++) {
+    values[aig.inputs()[i]] = (pattern >> i) & 1;
+  }
+  auto value = [&](Literal lit) {
+    return values[abys::aig::literal_var(lit)] != abys::aig::is_complemented(lit);
+  };
+  for (abys::aig::Var var = 1; var < aig.num_vars(); var++) {
+    if (aig.is_and(var)) {
+      values[var] = value(aig.fanin0(var)) && value(aig.fanin1(var));
+    }
+  }
+  std::vector<bool> outputs;
+  for (const Literal lit : aig.outputs()) {
+    outputs.push_back(value(lit));
+  }
+  return outputs;
+}
+
+} // namespace
+
+int main() {
+  // The AND of two inputs, as in the AIGER format description.
+  Aig small;
+  const Literal a = small.create_input();
+  const Literal b = small.create_input();
+  small.add_output(small.create_and(a, b));
+  std::vector<char> buffer;
+  const size_t small_size = abys::aig::encode_aiger(small, {}, buffer);
+  const std::string expected = "aig 3 2 0 1 1\n6\n\x02\x02";
+  expect(std::string(buffer.data(), small_size).substr(0, expected.size()) == expected,
+         "an AND of two inputs encodes as two deltas");
+
+  // Inputs created between ANDs are renumbered ahead of them.
+  Aig mixed;
+  const Literal x = mixed.create_input();
+  const Literal y = mixed.create_input();
+  const Literal g = mixed.create_and(x, y);
+  const Literal z = mixed.create_input();
+  const Literal h = mixed.create_and(g, abys::aig::negate(z));
+  mixed.add_output(h);
+  mixed.add_output(abys::aig::negate(x));
+  mixed.add_output(abys::aig::kTrue);
+  mixed.add_output(mixed.create_xor(h, y));
+  const abys::aig::AigerSymbols names{{"x", "y", "z"}, {"h", "", "one"}};
+  const size_t mixed_size = abys::aig::encode_aiger(mixed, names, buffer);
+  const char *const before = buffer.data();
+  const auto decoded = abys::aig::decode_aiger({buffer.data(), mixed_size});
+  expect(decoded.ok, "decode: " + decoded.message);
+  expect(decoded.aig.num_inputs() == 3 && decoded.aig.outputs().size() == 4,
+         "inputs and outputs survive");
+  bool same = true;
+  for (uint64_t pattern = 0; pattern < 8; pattern++) {
+    same = same && evaluate(decoded.aig, pattern) == evaluate(mixed, pattern);
+  }
+  expect(same, "the decoded AIG computes the same outputs");
+  expect(decoded.symbols.inputs == names.inputs &&
+             decoded.symbols.outputs == std::vector<std::string>{"h", "", "one", ""},
+         "symbols survive");
+
+  const size_t again = abys::aig::encode_aiger(small, {}, buffer);
+  expect(again == small_size && buffer.data() == before, "the buffer is reused as it is");
+
+  expect(!abys::aig::decode_aiger("aag 0 0 0 0 0\n").ok, "ASCII AIGER is refused");
+  expect(!abys::aig::decode_aiger("aig 1 0 1 0 0\n2\n").ok, "latches are refused");
+  expect(!abys::aig::decode_aiger("aig 3 2 0 1 1\n6\n\x02").ok, "truncated ANDs are refused");
+  expect(!abys::aig::decode_aiger("aig 3 2 0 1 1\n6\n\x07\x02").ok,
+         "ANDs reading later variables are refused");
+  expect(!abys::aig::decode_aiger("aig 2147483646 2147483646 0 0 0\n").ok,
+         "a short header cannot ask for billions of inputs");
+
+  // A design: a leaf with word-level logic and a top that instantiates it.
+  Tig design;
+  TigBuilder builder(design);
+  auto name = [&](const char *s) { return builder.intern(s); };
+  const auto leaf = builder.create_module("leaf");
+  const auto la = builder.create_module_input(leaf, name("a"), 8, false);
+  const auto lb = builder.create_module_input(leaf, name("b"), 8, false);
+  const auto lc = builder.create_module_input(leaf, name("c"), 1, false);
+  const std::vector<TigBuilder::Signal> ab{{la, 0}, {lb, 0}};
+  const auto sum = builder.create_op_node(leaf, name("sum"), name("add"), 8, false, ab);
+  const auto eq = builder.create_op_node(leaf, name("eq"), name("eq"), 1, false, ab);
+  const std::vector<TigBuilder::Signal> sum_c{{sum, 0}, {lc, 0}};
+  const auto mixed_sum = builder.create_op_node(leaf, name("t"), name("xor"), 8, false, sum_c);
+  builder.create_module_output(leaf, name("s"), 8, false, mixed_sum);
+  builder.create_module_output(leaf, name("e"), 1, false, eq);
+
+  const auto top = builder.create_module("top/level");
+  const auto x8 = builder.create_module_input(top, name("x"), 8, false);
+  const auto c1 = builder.create_module_input(top, name("c"), 1, false);
+  const std::vector<TigBuilder::Signal> u_inputs{{x8, 0}, {x8, 0}, {c1, 0}};
+  const std::vector<TigBuilder::SignalSpec> u_outputs{{name("u_s"), 8, false},
+                                                      {name("u_e"), 1, false}};
+  const auto u = builder.create_instance(top, name("u"), leaf, u_inputs, u_outputs);
+  builder.create_module_output(top, name("y"), 8, false, u);
+
+  const auto dir = std::filesystem::temp_directory_path() / "abys_aiger";
+  std::filesystem::remove_all(dir);
+  abys::aig::AigerWriteOptions options;
+  options.num_threads = 2;
+  const auto written = abys::aig::write_aiger(design, dir.string(), options);
+  expect(written.ok, "write the design: " + written.message);
+  expect(written.paths.size() == 2 && written.paths[1] == (dir / "top_level.aig").string(),
+         "one file per module, named after it");
+  uint64_t on_disk = 0;
+  for (const auto &path : written.paths) {
+    on_disk += std::filesystem::exists(path) ? std::filesystem::file_size(path) : 0;
+  }
+  expect(on_disk == written.bytes_written, "every byte is counted");
+
+  const auto read_leaf = abys::aig::read_aiger(written.paths[leaf]);
+  expect(read_leaf.ok, "read the leaf: " + read_leaf.message);
+  const auto mapped = abys::aig::build_aiger_module(builder, "leaf_mapped", read_leaf.aig,
+                                                    read_leaf.symbols);
+  const auto &ports = design.modules[mapped].input_ports;
+  expect(ports.size() == 3 && design.names.view(ports[0].name) == "a" && ports[0].width == 8 &&
+             ports[2].width == 1 && design.modules[mapped].output_ports.size() == 2,
+         "bits regroup into the leaf's ports");
+  const auto screen = abys::sim::screen_equivalence(design, leaf, mapped);
+  expect(screen.ok && !screen.distinguished, "the leaf reads back with the same behaviour");
+
+  const auto read_top = abys::aig::read_aiger(written.paths[top]);
+  expect(read_top.ok, "read the top: " + read_top.message);
+  expect(read_top.symbols.inputs.size() == 18 && read_top.symbols.inputs[9] == "u_s[0]" &&
+             read_top.symbols.inputs[17] == "u_e",
+         "instance outputs are inputs named after their signals");
+  expect(read_top.symbols.outputs.size() == 25 && read_top.symbols.outputs[8] == "u.a[0]" &&
+             read_top.symbols.outputs[24] == "u.c",
+         "instance inputs are outputs named after the child's ports");
+  const auto unnamed = abys::aig::build_aiger_module(builder, "bare", mixed);
+  expect(design.modules[unnamed].input_ports.size() == 3 &&
+             design.names.view(design.modules[unnamed].output_ports[3].name) == "o3",
+         "unnamed bits become 1-bit ports");
+
+  // A module named like another's renamed file is renamed again.
+  Tig clash;
+  TigBuilder clash_builder(clash);
+  for (const char *module_name : {"a", "a_2", "A"}) {
+    const auto m = clash_builder.create_module(module_name);
+    const auto i = clash_builder.create_module_input(m, clash_builder.intern("i"), 1, false);
+    clash_builder.create_module_output(m, clash_builder.intern("o"), 1, false, i);
+  }
+  const auto clash_written = abys::aig::write_aiger(clash, (dir / "clash").string());
+  expect(clash_written.ok && clash_written.paths[1] != clash_written.paths[2] &&
+             std::filesystem::path(clash_written.paths[2]).filename() == "A_2_2.aig",
+         "every module gets a file of its own");
+  std::filesystem::remove_all(dir);
+
+  return abys::test::report("aiger");
+}
@@ -0,0 +1,165 @@
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/aig/aig.h"
+#include "abys/aig/bit_blast.h"
+#include "abys/ir/tig_builder.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::aig::Literal;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+constexpr uint64_t kWidth = 4;
+
+// Value of every AIG output for the given input bits; AND variables are
+// numbered after their fanins, so one pass in variable order suffices.
+std::vector<bool> simulate(const abys::aig::Aig &aig, const std::vector<bool> &inputs) {
+  std::vector<bool> values(aig.num_vars(), false);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    values[aig.inputs()[i]] = inputs[i];
+  }
+  auto value = [&](Literal lit) {
+    return values[abys::aig::literal_var(lit)] != abys::aig::is_complemented(lit);
+  };
+  for (abys::aig::Var v = 1; v < aig.num_vars(); v++) {
+    if (aig.is_and(v)) {
+      values[v] = value(aig.fanin0(v)) && value(aig.fanin1(v));
+    }
+  }
+  std::vector<bool> outputs;
+  for (const Literal lit : aig.outputs()) {
+    outputs.push_back(value(lit));
+  }
+  return outputs;
+}
+
+int64_t to_signed(uint64_t v, uint64_t width) {
+  return v & (1ULL << (width - 1)) ? static_cast<int64_t>(v) - (1LL << width)
+                                   : static_cast<int64_t>(v);
+}
+
+struct Case {
+  std::string op;
+  uint64_t width;
+  bool sign;
+  std::function<uint64_t(uint64_t, uint64_t)> expected;
+};
+
+} // namespace
+
+int main() {
+  const uint64_t mask = (1ULL << kWidth) - 1;
+  const std::vector<Case> cases = {
+      {"and", kWidth, false, [](uint64_t a, uint64_t b) { return a & b; }},
+      {"or", kWidth, false, [](uint64_t a, uint64_t b) { return a | b; }},
+      {"xor", kWidth, false, [](uint64_t a, uint64_t b) { return a ^ b; }},
+      {"xnor", kWidth, false, [=](uint64_t a, uint64_t b) { return ~(a ^ b) & mask; }},
+      {"not", kWidth, false, [=](uint64_t a, uint64_t) { return ~a & mask; }},
+      {"neg", kWidth, false, [=](uint64_t a, uint64_t) { return (0 - a) & mask; }},
+      {"add", kWidth, false, [=](uint64_t a, uint64_t b) { return (a + b) & mask; }},
+      {"sub", kWidth, false, [=](uint64_t a, uint64_t b) { return (a - b) & mask; }},
+      {"mul", kWidth, false, [=](uint64_t a, uint64_t b) { return (a * b) & mask; }},
+      {"eq", 1, false, [](uint64_t a, uint64_t b) { return a == b ? 1 : 0; }},
+      {"ne", 1, false, [](uint64_t a, uint64_t b) { return a != b ? 1 : 0; }},
+      {"lt", 1, false, [](uint64_t a, uint64_t b) { return a < b ? 1 : 0; }},
+      {"lt", 1, true,
+       [](uint64_t a, uint64_t b) { return to_signed(a, kWidth) < to_signed(b, kWidth) ? 1 : 0; }},
+  };
+
+  for (const auto &c : cases) {
+    Tig design;
+    TigBuilder builder(design);
+    const auto m = builder.create_module("m");
+    const auto a = builder.create_module_input(m, builder.intern("a"), kWidth, c.sign);
+    const auto b = builder.create_module_input(m, builder.intern("b"), kWidth, c.sign);
+    const bool unary = c.op == "not" || c.op == "neg";
+    std::vector<TigBuilder::Signal> inputs{{a, 0}};
+    if (!unary) {
+      inputs.push_back({b, 0});
+    }
+    const auto y = builder.create_op_node(m, builder.intern("y"), builder.intern(c.op), c.width,
+                                          false, inputs);
+    builder.create_module_output(m, builder.intern("y"), c.width, false, y);
+
+    abys::aig::BlastedModule blasted;
+    const auto result = abys::aig::bit_blast_module(design, m, blasted);
+    expect(result.ok, c.op + ": " + result.message);
+    if (!result.ok) {
+      continue;
+    }
+    for (uint64_t va = 0; va <= mask; va++) {
+      for (uint64_t vb = 0; vb <= mask; vb++) {
+        std::vector<bool> bits;
+        for (uint64_t i = 0; i < 2 * kWidth; i++) {
+          bits.push_back((((i < kWidth ? va : vb) >> (i % kWidth)) & 1) != 0);
+        }
+        const auto out = simulate(blasted.aig, bits);
+        uint64_t got = 0;
+        for (size_t i = 0; i < out.size(); i++) {
+          got |= static_cast<uint64_t>(out[i]) << i;
+        }
+        if (got != c.expected(va, vb)) {
+          expect(false, c.op + (c.sign ? " (signed)" : "") + " of " + std::to_string(va) + ", " +
+                            std::to_string(vb) + " gave " + std::to_string(got));
+          break;
+        }
+      }
+    }
+  }
+
+  // Structural hashing: the same AND built twice is one node.
+  abys::aig::Aig aig;
+  const Literal x = aig.create_input();
+  const Literal z = aig.create_input();
+  expect(aig.create_and(x, z) == aig.create_and(z, x) && aig.num_ands() == 1 &&
+             aig.create_and(x, abys::aig::negate(x)) == abys::aig::kFalse,
+         "structural hashing");
+
+  // Split, sign-extending conversion, constant and merge: y = {4'b1010, sext(a[1:0])}.
+  {
+    Tig design;
+    TigBuilder builder(design);
+    const auto m = builder.create_module("m");
+    const auto a = builder.create_module_input(m, builder.intern("a"), kWidth, false);
+    const std::vector<TigBuilder::SignalSpec> halves{{builder.intern("lo"), 2, true},
+                                                     {builder.intern("hi"), 2, false}};
+    const auto split = builder.create_split_node(m, a, 0, halves);
+    const auto ext = builder.create_conversion_node(m, builder.intern("ext"), 4, true, split, 0);
+    const auto k = builder.create_const_node(m, builder.intern("k"), 4, false, "1010");
+    const std::vector<TigBuilder::Signal> parts{{ext, 0}, {k, 0}};
+    const std::vector<Tig::SignalWidth> widths{4, 4};
+    const auto y = builder.create_merge_node(m, builder.intern("y"), 8, false, parts, widths);
+    builder.create_module_output(m, builder.intern("y"), 8, false, y);
+
+    abys::aig::BlastedModule blasted;
+    const bool blasted_ok = abys::aig::bit_blast_module(design, m, blasted).ok;
+    expect(blasted_ok, "split/merge blasts");
+    if (blasted_ok) {
+      for (uint64_t va = 0; va <= mask; va++) {
+        std::vector<bool> bits;
+        for (uint64_t i = 0; i < kWidth; i++) {
+          bits.push_back(((va >> i) & 1) != 0);
+        }
+        const auto out = simulate(blasted.aig, bits);
+        uint64_t got = 0;
+        for (size_t i = 0; i < out.size(); i++) {
+          got |= static_cast<uint64_t>(out[i]) << i;
+        }
+        const uint64_t lo = static_cast<uint64_t>(to_signed(va & 3, 2)) & mask;
+        if (got != (0xa0 | lo)) {
+          expect(false, "split/merge of " + std::to_string(va) + " gave " + std::to_string(got));
+          break;
+        }
+      }
+    }
+  }
+
+  return abys::test::report("bit blast");
+}
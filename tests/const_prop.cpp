@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/const_prop.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/sim/simulator.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using NodeKind = Tig::Module::NodeKind;
+using abys::test::expect;
+
+// Signatures of the module outputs under random inputs.
+std::vector<uint64_t> signatures(const Tig &design, Tig::ModuleId top) {
+  abys::sim::Simulator sim(design, top);
+  sim.randomize_inputs(11);
+  if (!sim.run().ok) {
+    return {};
+  }
+  std::vector<uint64_t> out;
+  for (const auto &output : sim.outputs()) {
+    out.push_back(sim.signature(output));
+  }
+  return out;
+}
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  builder.set_hash_consing(true);
+  auto name = [&](const char *s) { return builder.intern(s); };
+  const auto m = builder.create_module("m");
+  const auto a = builder.create_module_input(m, name("a"), 8, false);
+  const auto k3 = builder.create_const_node(m, name("k3"), 8, false, "00000011");
+  const auto k5 = builder.create_const_node(m, name("k5"), 4, true, "1011");
+  // k3 + sext(k5) = 3 - 5, then its inverse, then a mix with the input.
+  const std::vector<TigBuilder::Signal> sum_inputs{{k3, 0}, {k5, 0}};
+  const auto sum = builder.create_op_node(m, name("sum"), name("add"), 8, false, sum_inputs);
+  const auto alias = builder.create_op_node(m, name("alias"), name("add"), 8, false, sum_inputs);
+  expect(alias == sum, "hash-consing shares the sum");
+  const std::vector<TigBuilder::Signal> inv_inputs{{sum, 0}};
+  const auto inv = builder.create_op_node(m, name("inv"), name("not"), 8, false, inv_inputs);
+  const std::vector<TigBuilder::Signal> mix_inputs{{a, 0}, {inv, 0}};
+  const auto mix = builder.create_op_node(m, name("mix"), name("xor"), 8, false, mix_inputs);
+  const std::vector<TigBuilder::SignalSpec> halves{{name("lo"), 4, false}, {name("hi"), 4, false}};
+  const auto split = builder.create_split_node(m, sum, 0, halves);
+  const std::vector<TigBuilder::Signal> merge_inputs{{split, 1}, {split, 0}, {k5, 0}};
+  const std::vector<TigBuilder::SignalWidth> merge_widths{4, 4, 6};
+  const auto merged = builder.create_merge_node(m, name("merged"), 14, false, merge_inputs,
+                                                merge_widths);
+  const auto wide = builder.create_conversion_node(m, name("wide"), 100, false, merged);
+  builder.create_module_output(m, name("y0"), 8, false, mix);
+  builder.create_module_output(m, name("y1"), 100, false, wide);
+  builder.create_module_output(m, name("y2"), 4, false, split, 0);
+
+  Tig before = design;
+  const auto expected = signatures(before, m);
+  const auto report = abys::ir::propagate_constants(design);
+  const Tig::Module &module = design.modules[m];
+
+  expect(report.folded_nodes == 5, "sum, inv, split, merge and wide fold; mix does not");
+  expect(report.created_consts == 6, "one constant per folded output");
+  auto value = [&](const char *signal) {
+    const auto edge = builder.find_signal(m, signal);
+    if (edge.node_id == Tig::kInvalidNodeId || module.kind(edge.node_id) != NodeKind::kConst) {
+      return std::string("not a constant");
+    }
+    return module.node_const(edge.node_id).to_string();
+  };
+  expect(value("sum") == "11111110", "sum folds to -2");
+  expect(value("alias") == "11111110", "hash-consed names move with the output");
+  expect(value("inv") == "00000001", "folds cascade");
+  expect(value("lo") == "1110" && value("hi") == "1111", "split folds per output");
+  expect(value("merged") == "11101111101111", "merge concatenates, sign-extending segments");
+  expect(value("wide") == std::string(86, '0') + "11101111101111", "conversion zero-extends");
+  expect(value("mix") == "not a constant", "nodes with a live input stay");
+  expect(module.node_fanins(mix)[1].node_id == builder.find_signal(m, "inv").node_id,
+         "consumers read the constant");
+  expect(module.node_outputs(sum)[0].name == abys::ir::kEmptyName &&
+             module.node_fanouts(sum).empty(),
+         "folded nodes are left nameless and unread");
+  expect(!expected.empty() && signatures(design, m) == expected,
+         "folding preserves simulated behavior");
+
+  const auto again = abys::ir::propagate_constants(design);
+  expect(again.folded_nodes == 0, "a second pass finds nothing left to fold");
+
+  return abys::test::report("const prop");
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+
+#include "abys/ir/const_value.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::ConstValue;
+using abys::ir::ConstView;
+using abys::ir::Logic;
+using abys::test::expect;
+
+ConstValue parse(const std::string &digits) { return *ConstValue::parse(digits); }
+
+std::string eval(const char *op, uint64_t width, const std::string &a, bool a_sign,
+                 const std::string &b = {}, bool b_sign = false) {
+  const ConstValue x = parse(a);
+  const ConstValue y = parse(b);
+  const ConstView yv = y.view();
+  const auto out = abys::ir::evaluate_const_op(op, width, x, a_sign, b.empty() ? nullptr : &yv,
+                                               b_sign);
+  return out ? out->view().to_string() : "none";
+}
+
+} // namespace
+
+int main() {
+  const ConstValue small = parse("10xz");
+  expect(small.view().to_string() == "10xz", "small round trip");
+  expect(small.bit(0) == Logic::kZ && small.bit(1) == Logic::kX && small.bit(3) == Logic::k1,
+         "bit order is least significant first");
+  expect(small.view().has_unknown(), "unknown bits are seen");
+  expect(!ConstValue::parse("012"), "bad digits are rejected");
+
+  // 130 bits: three words per plane, on the heap.
+  std::string wide(130, '0');
+  wide[0] = '1';
+  wide[129] = '1';
+  wide[60] = 'x';
+  const ConstValue big = parse(wide);
+  expect(big.view().to_string() == wide, "wide round trip");
+  expect(big.num_words() == 3, "wide word count");
+  ConstValue copy = big;
+  expect(copy.view() == big.view() && copy.view().hash() == big.view().hash(), "copies compare");
+  ConstValue moved = std::move(copy);
+  expect(moved.view() == big.view(), "moves keep the value");
+
+  const ConstValue two_state = ConstValue::from_uint64(70, 5);
+  const ConstView no_plane(70, two_state.view().value_words().data(), nullptr);
+  expect(no_plane == two_state.view() && no_plane.hash() == two_state.view().hash(),
+         "a missing unknown plane equals an all-zero one");
+
+  expect(abys::ir::const_bits(parse("1010"), 1, 6, true).view().to_string() == "111101",
+         "slices sign-extend past the top");
+  expect(abys::ir::const_bits(parse("1010"), 0, 6, false).view().to_string() == "001010",
+         "unsigned resize zero-extends");
+  expect(abys::ir::const_bits(parse("x1"), 0, 4, true).view().to_string() == "xxx1",
+         "an unknown top bit extends as unknown");
+
+  expect(eval("add", 4, "0111", false, "0011", false) == "1010", "add");
+  expect(eval("sub", 4, "0001", false, "0011", false) == "1110", "sub wraps");
+  expect(eval("neg", 4, "0001", false) == "1111", "neg");
+  expect(eval("mul", 8, "1111", true, "0011", false) == "11111101", "signed operand of mul");
+  std::string ones(100, '1');
+  std::string expected(100, '0');
+  expected[99] = '1';
+  expect(eval("mul", 100, ones, false, ones, false) == expected, "wide mul truncates");
+  const std::string one = std::string(99, '0') + "1";
+  expect(eval("add", 100, ones, false, one, false) == std::string(100, '0'),
+         "wide add carries across words");
+  expect(eval("and", 4, "01xx", false, "0x01", false) == "0x0x", "four-state and");
+  expect(eval("or", 4, "01xx", false, "0x01", false) == "01x1", "four-state or");
+  expect(eval("xor", 4, "011z", false, "0101", false) == "001x", "four-state xor");
+  expect(eval("not", 4, "01xz", false) == "10xx", "four-state not");
+  expect(eval("add", 4, "000x", false, "0001", false) == "xxxx", "unknown arithmetic is x");
+  expect(eval("lt", 1, "1111", true, "0001", true) == "1", "signed lt");
+  expect(eval("lt", 1, "1111", true, "0001", false) == "0", "mixed signs compare unsigned");
+  expect(eval("eq", 2, "0011", false, "11", false) == "01", "eq at the common width");
+  expect(eval("ne", 1, "0x", false, "00", false) == "x", "unknown compare is x");
+  expect(eval("shl", 4, "0001", false, "0001", false) == "none", "unknown ops are not folded");
+  expect(eval("not", 4, "0001", false, "0001", false) == "none", "arity is checked");
+
+  return abys::test::report("const value");
+}
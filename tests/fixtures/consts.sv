@@ -0,0 +1,10 @@
+module consts(
+  input  logic [7:0]  a,
+  output logic [7:0]  y,
+  output logic [69:0] w,
+  output logic [3:0]  z
+);
+  assign y = a & 8'hf0;
+  assign w = 70'h20_0000_0000_0000_0001 + 70'd2;
+  assign z = 4'b10xz;
+endmodule
@@ -0,0 +1,36 @@
+module half_adder(
+  input  logic a,
+  input  logic b,
+  output logic s,
+  output logic c
+);
+  assign s = a ^ b;
+  assign c = a & b;
+endmodule
+
+module full_adder(
+  input  logic a,
+  input  logic b,
+  input  logic ci,
+  output logic s,
+  output logic co
+);
+  logic s0, c0, c1;
+  half_adder ha0(.a(a), .b(b), .s(s0), .c(c0));
+  half_adder ha1(.a(s0), .b(ci), .s(s), .c(c1));
+  assign co = c0 | c1;
+endmodule
+
+module top(
+  input  logic a0,
+  input  logic a1,
+  input  logic b0,
+  input  logic b1,
+  output logic s0,
+  output logic s1,
+  output logic co
+);
+  logic c0;
+  half_adder ha(.a(a0), .b(b0), .s(s0), .c(c0));
+  full_adder fa(.a(a1), .b(b1), .ci(c0), .s(s1), .co(co));
+endmodule
@@ -0,0 +1,15 @@
+module shared(
+  input  logic [7:0] a,
+  input  logic [7:0] b,
+  output logic [7:0] x,
+  output logic [7:0] y,
+  output logic [7:0] z,
+  output logic [7:0] w
+);
+  logic [7:0] t;
+  assign x = a & b;
+  assign y = a & b;
+  assign z = t | a;
+  assign w = t | a;
+  assign t = a ^ b;
+endmodule
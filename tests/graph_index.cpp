@@ -0,0 +1,88 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig.h"
+#include "abys/ir/tig_builder.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+// The patched indices of `module` must match ones built from scratch, and the
+// order must put every driver before its consumers.
+bool matches_rebuilt(const Tig::Module &module) {
+  Tig::Module fresh = module;
+  fresh.invalidate_graph_index();
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.node_fanouts(n).size() != fresh.node_fanouts(n).size() ||
+        module.node_level(n) != fresh.node_level(n)) {
+      return false;
+    }
+  }
+  const auto order = module.topological_order();
+  if (order.size() != fresh.topological_order().size()) {
+    return false;
+  }
+  std::vector<size_t> pos(module.num_nodes(), order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    pos[order[i]] = i;
+  }
+  for (const Tig::NodeId n : order) {
+    for (const auto &fanin : module.node_fanins(n)) {
+      if (fanin.node_id != Tig::kInvalidNodeId && pos[fanin.node_id] >= pos[n]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main() {
+  // Interleave node creation, rewiring (including cycles and disconnects) and
+  // queries, so every patch path runs against a warm index.
+  std::mt19937 rng(1);
+  for (int round = 0; round < 100; round++) {
+    Tig design;
+    TigBuilder builder(design);
+    const auto m = builder.create_module("m");
+    const auto op = builder.intern("and");
+    std::vector<Tig::NodeId> nodes;
+    for (int i = 0; i < 4; i++) {
+      nodes.push_back(builder.create_module_input(m, builder.intern("i" + std::to_string(i)), 1,
+                                                  false));
+    }
+    auto pick = [&]() -> TigBuilder::Signal {
+      if (rng() % 5 == 0) {
+        return {};
+      }
+      return {nodes[rng() % nodes.size()], 0};
+    };
+    for (int step = 0; step < 60; step++) {
+      const auto action = rng() % 4;
+      if (action < 2) {
+        const std::vector<TigBuilder::Signal> inputs{pick(), pick()};
+        nodes.push_back(builder.create_op_node(m, abys::ir::kEmptyName, op, 1, false, inputs));
+      } else if (action == 2) {
+        const auto node = nodes[rng() % nodes.size()];
+        const auto num_fanins = design.modules[m].node_fanins(node).size();
+        if (num_fanins > 0) {
+          builder.set_node_input(m, node, rng() % num_fanins, pick());
+        }
+      } else {
+        const bool fresh = matches_rebuilt(design.modules[m]);
+        expect(fresh, "stale graph index in round " + std::to_string(round));
+        if (!fresh) {
+          break;
+        }
+      }
+    }
+  }
+  return abys::test::report("graph index");
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  builder.set_hash_consing(true);
+  const auto m = builder.create_module("m");
+  const auto a = builder.create_module_input(m, builder.intern("a"), 8, false);
+  const auto b = builder.create_module_input(m, builder.intern("b"), 8, false);
+  const auto add = builder.intern("add");
+  const std::vector<TigBuilder::Signal> ab{{a, 0}, {b, 0}};
+  const std::vector<TigBuilder::Signal> ba{{b, 0}, {a, 0}};
+
+  const auto x = builder.create_op_node(m, builder.intern("x"), add, 8, false, ab);
+  const auto y = builder.create_op_node(m, builder.intern("y"), add, 8, false, ab);
+  expect(x == y, "identical ops are shared");
+  expect(builder.find_signal(m, "y").node_id == x, "the shared node is found under both names");
+  expect(builder.create_op_node(m, builder.intern("z"), add, 8, false, ba) != x,
+         "operand order distinguishes ops");
+  expect(builder.create_op_node(m, builder.intern("w"), add, 9, false, ab) != x,
+         "width distinguishes ops");
+  expect(builder.create_conversion_node(m, builder.intern("c0"), 16, false, x) ==
+             builder.create_conversion_node(m, builder.intern("c1"), 16, false, y),
+         "identical conversions are shared");
+  expect(builder.create_const_node(m, builder.intern("k0"), 4, false, "1010") ==
+             builder.create_const_node(m, builder.intern("k1"), 4, false, "1010"),
+         "identical constants are shared");
+
+  // A node with a pending input is never shared, but joins once connected.
+  const std::vector<TigBuilder::Signal> pending{{a, 0}, {}};
+  const auto p = builder.create_op_node(m, builder.intern("p"), add, 8, false, pending);
+  expect(builder.create_op_node(m, builder.intern("q"), add, 8, false, pending) != p,
+         "nodes with pending inputs are not shared");
+  builder.set_node_input(m, p, 1, {a, 0});
+  const std::vector<TigBuilder::Signal> aa{{a, 0}, {a, 0}};
+  expect(builder.create_op_node(m, builder.intern("r"), add, 8, false, aa) == p,
+         "a node joins the table once its inputs are connected");
+
+  const auto &stats = builder.hash_cons_stats();
+  expect(stats.hits == 4 && stats.lookups == 9, "hit counters");
+
+  // Nodes connected after their creation are shared by merging afterwards,
+  // consumers and names included.
+  const auto n = builder.create_module("n");
+  const auto c = builder.create_module_input(n, builder.intern("c"), 8, false);
+  const std::vector<TigBuilder::Signal> open{{c, 0}, {}};
+  const auto u = builder.create_op_node(n, builder.intern("u"), add, 8, false, open);
+  const auto v = builder.create_op_node(n, builder.intern("v"), add, 8, false, open);
+  const std::vector<TigBuilder::Signal> from_v{{v, 0}};
+  const auto nv = builder.create_op_node(n, builder.intern("nv"), builder.intern("not"), 8,
+                                         false, from_v);
+  builder.create_module_output(n, builder.intern("o"), 8, false, nv);
+  const auto d = builder.create_module_input(n, builder.intern("d"), 8, false);
+  builder.set_node_input(n, u, 1, {d, 0});
+  builder.set_node_input(n, v, 1, {d, 0});
+  expect(builder.merge_equivalent_nodes(n) == 1, "one node merged");
+  expect(builder.get_node_input(n, nv, 0).node_id == u, "consumers move to the node kept");
+  expect(builder.find_signal(n, "v").node_id == u, "names move to the node kept");
+  expect(stats.hits == 5, "merges count as hits");
+  return abys::test::report("hash consing");
+}
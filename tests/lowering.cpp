@@ -0,0 +1,77 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abys/frontend.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::test::expect;
+
+abys::ir::TigBuildResult lower(const std::string &fixture, bool hash_consing) {
+  abys::FrontendOptions options;
+  options.hash_consing = hash_consing;
+  const auto path = std::filesystem::path(ABYS_FIXTURES_DIR) / fixture;
+  return abys::build_tig_from_systemverilog({path.string()}, std::nullopt, options);
+}
+
+// The driver of every output port, in port order.
+std::vector<Tig::NodeId> output_drivers(const Tig::Module &module) {
+  std::vector<Tig::NodeId> drivers;
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    if (module.kind(n) == Tig::Module::NodeKind::kPo) {
+      drivers.push_back(module.node_fanins(n)[0].node_id);
+    }
+  }
+  return drivers;
+}
+
+} // namespace
+
+int main() {
+  // x and y read ports only; z and w read t, which is assigned after them.
+  for (const bool hash_consing : {false, true}) {
+    const auto built = lower("shared.sv", hash_consing);
+    expect(built.ok, "lower shared.sv: " + built.message);
+    if (!built.ok) {
+      continue;
+    }
+    const auto drivers = output_drivers(built.design.modules[0]);
+    const std::string mode = hash_consing ? "hash-consed" : "plain";
+    expect(drivers.size() == 4, mode + ": four outputs");
+    if (drivers.size() != 4) {
+      continue;
+    }
+    expect((drivers[0] == drivers[1]) == hash_consing,
+           mode + ": assignments from ports share a node only when hash-consing");
+    expect((drivers[2] == drivers[3]) == hash_consing,
+           mode + ": assignments from later signals share a node only when hash-consing");
+  }
+
+  // Valid SystemVerilog the lowering does not support must fail the build with
+  // a message, not crash or leave a signal undriven.
+  const auto dir = std::filesystem::temp_directory_path() / "abys_lowering";
+  std::filesystem::create_directories(dir);
+  const std::pair<const char *, const char *> unsupported[] = {
+      {"concat_target", "assign {y, z} = {a, b};"},
+      {"slice_target", "assign y[1:0] = a[1:0];\n  assign y[3:2] = b[3:2];\n  assign z = a;"},
+      {"variable_init", "logic [3:0] v = 4'd3;\n  assign y = v;\n  assign z = a;"},
+  };
+  for (const auto &[name, body] : unsupported) {
+    const auto path = dir / (std::string(name) + ".sv");
+    std::ofstream(path) << "module " << name << "(input logic [3:0] a, input logic [3:0] b,\n"
+                        << "  output logic [3:0] y, output logic [3:0] z);\n  " << body
+                        << "\nendmodule\n";
+    const auto built = abys::build_tig_from_systemverilog({path.string()}, std::nullopt);
+    expect(!built.ok && built.message.find("failed to lower") != std::string::npos,
+           std::string(name) + " is refused: " + built.message);
+  }
+  std::filesystem::remove_all(dir);
+
+  return abys::test::report("lowering");
+}
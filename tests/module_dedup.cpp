@@ -0,0 +1,75 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/module_dedup.h"
+#include "abys/ir/tig_builder.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+Tig::ModuleId make_inverter(TigBuilder &builder, const std::string &internal,
+                            TigBuilder::SignalWidth width) {
+  const auto m = builder.create_module("inv");
+  const auto a = builder.create_module_input(m, builder.intern("a"), width, false);
+  const std::vector<TigBuilder::Signal> inputs{{a, 0}};
+  const auto y = builder.create_op_node(m, builder.intern(internal), builder.intern("not"),
+                                        width, false, inputs);
+  builder.create_module_output(m, builder.intern("y"), width, false, y);
+  return m;
+}
+
+Tig::ModuleId make_wrapper(TigBuilder &builder, const std::string &instance,
+                           Tig::ModuleId child) {
+  const auto m = builder.create_module("wrap");
+  const auto a = builder.create_module_input(m, builder.intern("a"), 8, false);
+  const std::vector<TigBuilder::Signal> inputs{{a, 0}};
+  const std::vector<TigBuilder::SignalSpec> outputs{{builder.intern(instance + ".y"), 8, false}};
+  const auto u = builder.create_instance(m, builder.intern(instance), child, inputs, outputs);
+  builder.create_module_output(m, builder.intern("y"), 8, false, u);
+  return m;
+}
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  const auto inv0 = make_inverter(builder, "n0", 8);
+  const auto inv1 = make_inverter(builder, "n1", 8);
+  const auto inv2 = make_inverter(builder, "n2", 4);
+  const auto wrap0 = make_wrapper(builder, "u0", inv0);
+  const auto wrap1 = make_wrapper(builder, "u1", inv1);
+  const auto top = builder.create_module("top");
+  const auto a = builder.create_module_input(top, builder.intern("a"), 8, false);
+  const std::vector<TigBuilder::Signal> inputs{{a, 0}};
+  const std::vector<TigBuilder::SignalSpec> o0{{builder.intern("w0.y"), 8, false}};
+  const std::vector<TigBuilder::SignalSpec> o1{{builder.intern("w1.y"), 8, false}};
+  const auto w0 = builder.create_instance(top, builder.intern("w0"), wrap1, inputs, o0);
+  const auto w1 = builder.create_instance(top, builder.intern("w1"), wrap0, inputs, o1);
+
+  const auto report = abys::ir::dedup_modules(design);
+  expect(report.modules_before == 6 && report.modules_after == 4, "module counts");
+  expect(design.modules.size() == 4, "merged modules are dropped");
+  expect(report.bytes_saved > 0, "bytes saved");
+  expect(report.remap[inv0] == 0 && report.remap[inv1] == 0, "identical leaves merge");
+  expect(report.remap[inv2] == 1, "a different width keeps its own module");
+  expect(report.remap[wrap0] == 2 && report.remap[wrap1] == 2,
+         "parents of merged children merge in turn");
+  expect(report.remap[top] == 3, "survivors keep their order");
+  const auto &t = design.modules[3];
+  expect(t.find_attrs(w0)->module_id == 2 && t.find_attrs(w1)->module_id == 2,
+         "instances are retargeted");
+  const auto &w = design.modules[2];
+  expect(w.find_attrs(1)->module_id == 0, "nested instances are retargeted");
+  expect(builder.find_signal(0, "n0").node_id != Tig::kInvalidNodeId,
+         "the surviving module keeps its internal names");
+
+  const auto again = abys::ir::dedup_modules(design);
+  expect(again.modules_after == 4 && again.bytes_saved == 0, "deduplication is idempotent");
+  return abys::test::report("module dedup");
+}
@@ -0,0 +1,106 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "abys/frontend.h"
+#include "abys/ir/tig_snapshot.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::test::expect;
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+} // namespace
+
+int main() {
+  const std::filesystem::path fixture = std::filesystem::path(ABYS_FIXTURES_DIR) / "hier.sv";
+  const auto dir = std::filesystem::temp_directory_path() / "abys_parallel_lowering";
+  std::filesystem::create_directories(dir);
+
+  // Lowering on any number of threads must produce the serial design bit for bit.
+  std::string serial;
+  for (unsigned threads : {1u, 2u, 4u, 0u}) {
+    abys::FrontendOptions options;
+    options.lowering_threads = threads;
+    auto built = abys::build_tig_from_systemverilog({fixture.string()}, std::nullopt, options);
+    const bool ok = built.ok && built.design.modules.size() == 3;
+    expect(ok, "build with " + std::to_string(threads) + " threads: " + built.message);
+    if (!ok) {
+      continue;
+    }
+    const auto path = dir / ("hier." + std::to_string(threads) + ".tig");
+    abys::ir::write_tig_snapshot(built.design, path.string());
+    const std::string bytes = read_file(path);
+    if (serial.empty()) {
+      serial = bytes;
+    } else {
+      expect(bytes == serial, std::to_string(threads) + " threads match the serial design");
+    }
+  }
+
+  // A cold and a warm cached build must match too; the warm one lowers nothing.
+  for (size_t expected_cached : {size_t{0}, size_t{3}}) {
+    abys::FrontendOptions options;
+    options.cache_dir = (dir / "cache").string();
+    abys::FrontendSession session(options);
+    auto built = session.load({fixture.string()}, std::nullopt).ok
+                     ? session.build_tig()
+                     : abys::ir::TigBuildResult{false, "load failed", {}};
+    const bool ok = built.ok && session.last_build_stats().cached_modules == expected_cached;
+    expect(ok, "cached build expected " + std::to_string(expected_cached) +
+                   " cached modules: " + built.message);
+    if (!ok) {
+      continue;
+    }
+    const auto path = dir / ("hier.cached." + std::to_string(expected_cached) + ".tig");
+    abys::ir::write_tig_snapshot(built.design, path.string());
+    expect(read_file(path) == serial, "cached build with " + std::to_string(expected_cached) +
+                                          " cached modules matches the serial design");
+  }
+
+  // Parsing many files on several threads must give the same design as on one.
+  // Every module of the fixture goes in a file of its own, next to enough
+  // unused ones for slang to parse in parallel.
+  std::vector<std::string> files;
+  const std::string text = read_file(fixture);
+  for (size_t begin = 0, end; (end = text.find("endmodule", begin)) != std::string::npos;
+       begin = end + 9) {
+    files.push_back((dir / ("part" + std::to_string(files.size()) + ".sv")).string());
+    std::ofstream(files.back()) << text.substr(begin, end + 9 - begin) << '\n';
+  }
+  for (int i = 0; i < 64; i++) {
+    files.push_back((dir / ("unused" + std::to_string(i) + ".sv")).string());
+    std::ofstream(files.back()) << "module unused" << i << "; endmodule\n";
+  }
+  std::string one_thread;
+  for (unsigned threads : {1u, 4u, 0u}) {
+    abys::FrontendOptions options;
+    options.parse_threads = threads;
+    auto built = abys::build_tig_from_systemverilog(files, "top", options);
+    const bool ok = built.ok && built.design.modules.size() == 3;
+    expect(ok, "parse with " + std::to_string(threads) + " threads: " + built.message);
+    if (!ok) {
+      continue;
+    }
+    const auto path = dir / ("files." + std::to_string(threads) + ".tig");
+    abys::ir::write_tig_snapshot(built.design, path.string());
+    const std::string bytes = read_file(path);
+    if (one_thread.empty()) {
+      one_thread = bytes;
+    } else {
+      expect(bytes == one_thread,
+             "parsing on " + std::to_string(threads) + " threads leaves the design alone");
+    }
+  }
+
+  std::filesystem::remove_all(dir);
+  return abys::test::report("parallel lowering");
+}
@@ -0,0 +1,127 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "abys/ir/param_store.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_snapshot.h"
+#include "abys/ir/verilog_writer.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Param;
+using abys::ir::ParamKind;
+using abys::ir::ParamStore;
+using abys::ir::SymbolTable;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using Text = std::pair<std::string_view, std::string_view>;
+using abys::test::expect;
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// A module holding one flop block with the given parameters.
+Tig::ModuleId make_flop_module(Tig &design, TigBuilder &builder, const std::string &name,
+                               std::span<const Text> params) {
+  const auto m = builder.create_module(name);
+  auto &block = design.modules[m].blocks.emplace_back();
+  block.kind = Tig::Module::BlockKind::kFf;
+  block.name = builder.intern("q_reg");
+  block.params = builder.intern_params(params);
+  const Text attributes[] = {{"keep", "1"}};
+  block.attributes = builder.intern_params(attributes);
+  return m;
+}
+
+} // namespace
+
+int main() {
+  SymbolTable names;
+  ParamStore store;
+  const auto key = [&](std::string_view s) { return names.intern(s); };
+  expect(store.view(abys::ir::kEmptyParamSet).empty(), "handle 0 is the empty set");
+  expect(store.intern({}) == abys::ir::kEmptyParamSet, "the empty set interns to 0");
+
+  // Order does not matter and the last value of a key wins.
+  const Param ab[] = {Param::integer(key("A"), 1), Param::integer(key("B"), 2)};
+  const Param ba[] = {Param::integer(key("B"), 3), Param::integer(key("A"), 1),
+                      Param::integer(key("B"), 2)};
+  const auto set = store.intern(ab);
+  expect(set != abys::ir::kEmptyParamSet && store.intern(ba) == set, "equal sets share a handle");
+  expect(store.size() == 2, "nothing new is stored for an equal set");
+  const Param *b = store.find(set, key("B"));
+  expect(b && b->kind == ParamKind::kInt && b->as_int() == 2, "find by key");
+  expect(!store.find(set, key("C")), "missing keys are not found");
+  expect(sizeof(Param) == 16, "params are 16 bytes");
+
+  auto parsed = [&](std::string_view text) { return store.parse(names, key("P"), text); };
+  expect(parsed("-12").kind == ParamKind::kInt && parsed("-12").as_int() == -12, "integers");
+  expect(parsed("2.5").kind == ParamKind::kReal && parsed("2.5").as_real() == 2.5, "reals");
+  expect(parsed("\"RISING\"").kind == ParamKind::kString &&
+             names.view(parsed("\"RISING\"").as_name()) == "RISING",
+         "string literals");
+  const Param init = parsed("8'hx5");
+  expect(init.kind == ParamKind::kBits && store.bits_value(init).to_string() == "xxxx0101",
+         "sized literals extend a leading x");
+  expect(parsed("4'b0101") == store.bits(key("P"), *abys::ir::ConstValue::parse("0101")) &&
+             parsed("4'h5") == parsed("4'b0101"),
+         "bit vectors are interned by value");
+  expect(parsed("WIDTH - 1").kind == ParamKind::kText, "other expressions stay text");
+  expect(parsed("4'sb0101").kind == ParamKind::kText, "signed literals stay text");
+  for (const char *text : {"-12", "2.5", "1.0", "\"RISING\"", "4'bx101", "WIDTH - 1"}) {
+    expect(store.to_verilog(names, parsed(text)) == text,
+           std::string("round trip of ") + text);
+  }
+  expect(store.to_verilog(names, Param::real(key("R"), 3)) == "3.0", "reals print as reals");
+
+  // Lowering workers build modules in their own designs; adoption imports the
+  // sets into the design's store, with their names and vectors.
+  Tig design;
+  TigBuilder builder(design);
+  const auto top = builder.create_module("top");
+  Tig local;
+  TigBuilder local_builder(local);
+  const Text flop_params[] = {{"INIT", "1'b0"}, {"CLK_EDGE", "\"RISING\""}};
+  make_flop_module(local, local_builder, "flop", flop_params);
+  builder.adopt_module(top, std::move(local));
+  const auto &block = design.modules[top].blocks[0];
+  const Param *imported = design.params.find(block.params, design.names.find("CLK_EDGE"));
+  expect(imported && imported->kind == ParamKind::kString &&
+             design.names.view(imported->as_name()) == "RISING",
+         "adopted sets keep their names");
+  const auto other = make_flop_module(design, builder, "other", flop_params);
+  expect(design.modules[other].blocks[0].params == block.params &&
+             design.modules[other].blocks[0].attributes == block.attributes,
+         "equal blocks compare by handle");
+
+  const auto dir = std::filesystem::temp_directory_path() / "abys_param_store";
+  std::filesystem::create_directories(dir);
+  const auto path = (dir / "flops.tig").string();
+  expect(abys::ir::write_tig_snapshot(design, path).ok, "write snapshot");
+  abys::ir::TigSnapshot snapshot;
+  expect(snapshot.open(path).ok, "open snapshot");
+  const Tig loaded = snapshot.materialize();
+  const auto &loaded_block = loaded.modules[top].blocks[0];
+  const Param *loaded_init = loaded.params.find(loaded_block.params, loaded.names.find("INIT"));
+  expect(loaded.params.size() == design.params.size() && loaded_init &&
+             loaded.params.bits_value(*loaded_init).to_string() == "0",
+         "parameter sets survive a snapshot");
+
+  const auto verilog = (dir / "flops.v").string();
+  expect(abys::ir::write_verilog(design, verilog).ok, "write verilog");
+  expect(read_file(verilog).find("(* keep = 1 *) abys_ff #(.CLK_EDGE(\"RISING\"), .INIT(1'b0)) "
+                                 "q_reg(") != std::string::npos,
+         "blocks are written with sorted parameters");
+  std::filesystem::remove_all(dir);
+
+  return abys::test::report("param store");
+}
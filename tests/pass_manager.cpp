@@ -0,0 +1,112 @@
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "abys/ir/pass_manager.h"
+#include "abys/ir/tig_builder.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::ModuleDag;
+using abys::ir::PassManager;
+using abys::ir::PassOrder;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+Tig::ModuleId make_module(TigBuilder &builder, const std::string &name) {
+  const auto m = builder.create_module(name);
+  const auto a = builder.create_module_input(m, builder.intern("a"), 8, false);
+  builder.create_module_output(m, builder.intern("y"), 8, false, a);
+  return m;
+}
+
+void instantiate(TigBuilder &builder, Tig::ModuleId parent, Tig::ModuleId child,
+                 const std::string &name) {
+  const std::vector<TigBuilder::Signal> inputs{builder.find_signal(parent, "a")};
+  const TigBuilder::SignalSpec out{builder.intern(name + ".y"), 8, false};
+  builder.create_instance(parent, builder.intern(name), child, inputs, {&out, 1});
+}
+
+// Runs one pass in `order` on four threads and returns the position at which
+// each module finished.
+std::vector<size_t> completion_order(const Tig &design, PassOrder order) {
+  std::mutex mutex;
+  std::vector<size_t> position(design.modules.size(), 0);
+  size_t next = 0;
+  PassManager passes({4});
+  passes.add({"record", order, [&](Tig::ModuleId m) {
+                std::lock_guard lock(mutex);
+                position[m] = next++;
+              }});
+  expect(passes.run(design).ok, "recording pass runs");
+  return position;
+}
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  // top -> {mid_a -> leaf, mid_b -> 2 x leaf}, and c1 <-> c2 off to the side.
+  const auto leaf = make_module(builder, "leaf");
+  const auto mid_a = make_module(builder, "mid_a");
+  const auto mid_b = make_module(builder, "mid_b");
+  const auto top = make_module(builder, "top");
+  const auto c1 = make_module(builder, "c1");
+  const auto c2 = make_module(builder, "c2");
+  instantiate(builder, mid_a, leaf, "u0");
+  instantiate(builder, mid_b, leaf, "u0");
+  instantiate(builder, mid_b, leaf, "u1");
+  instantiate(builder, top, mid_a, "a0");
+  instantiate(builder, top, mid_b, "b0");
+  instantiate(builder, c2, c1, "c");
+  instantiate(builder, c1, c2, "c");
+
+  const ModuleDag dag = ModuleDag::build(design);
+  expect(dag.cyclic_edges == 1, "one edge closes the cycle");
+  expect(dag.tops == std::vector<Tig::ModuleId>{top}, "top is the only uninstantiated module");
+  expect(dag.children[mid_b].size() == 1 && dag.children[mid_b][0].first == leaf &&
+             dag.children[mid_b][0].second == 2,
+         "repeated instances are counted");
+  expect(dag.parents[leaf] == std::vector<Tig::ModuleId>({mid_a, mid_b}), "parents by id");
+  expect(dag.bottom_up.size() == design.modules.size(), "every module is ordered");
+
+  const auto up = completion_order(design, PassOrder::kBottomUp);
+  const auto down = completion_order(design, PassOrder::kTopDown);
+  for (Tig::ModuleId m = 0; m < design.modules.size(); m++) {
+    for (const auto &[child, count] : dag.children[m]) {
+      expect(up[child] < up[m], "bottom-up runs children first");
+      expect(down[m] < down[child], "top-down runs parents first");
+    }
+  }
+
+  std::atomic<size_t> runs{0};
+  PassManager any({0});
+  any.add({"count", PassOrder::kAny, [&](Tig::ModuleId) { runs++; }});
+  const auto result = any.run(design);
+  expect(result.ok && runs == design.modules.size(), "kAny runs every module once");
+  expect(result.timings.size() == 1 && result.timings[0].name == "count" &&
+             result.timings[0].modules.size() == design.modules.size(),
+         "timings per pass and module");
+
+  PassManager failing({2});
+  failing.add({"boom", PassOrder::kBottomUp, [&](Tig::ModuleId m) {
+                 if (m == mid_a) {
+                   throw std::runtime_error("no");
+                 }
+               }});
+  failing.add({"never", PassOrder::kAny, [&](Tig::ModuleId) {
+                 expect(false, "passes after a failure do not run");
+               }});
+  const auto failed = failing.run(design);
+  expect(!failed.ok && failed.message == "pass boom failed on module mid_a: no",
+         "a throwing pass stops the run");
+  expect(failed.timings.size() == 1, "only the failed pass is timed");
+
+  return abys::test::report("pass manager");
+}
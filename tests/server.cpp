@@ -0,0 +1,117 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "abys/server.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::test::expect;
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// Forwards `args` with standard output sent to `out`.
+abys::ServeResult forward_into(const std::string &socket, const std::vector<std::string> &args,
+                               const std::filesystem::path &out, int &status) {
+  std::cout.flush();
+  const int saved = ::dup(STDOUT_FILENO);
+  const int file = ::open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  ::dup2(file, STDOUT_FILENO);
+  ::close(file);
+  const auto result = abys::forward_to_server(socket, args, status);
+  ::dup2(saved, STDOUT_FILENO);
+  ::close(saved);
+  return result;
+}
+
+} // namespace
+
+int main() {
+  const auto dir = std::filesystem::temp_directory_path() / "abys_server";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  const std::string socket = (dir / "abys.sock").string();
+
+  std::atomic<int> idle_calls{0};
+  std::vector<std::string> seen_cwds;
+  const abys::ServerHandler run = [&](const std::vector<std::string> &args) {
+    seen_cwds.push_back(std::filesystem::current_path().string());
+    for (const auto &arg : args) {
+      std::cout << arg << ' ';
+    }
+    std::cout << '\n';
+    return static_cast<int>(args.size());
+  };
+  abys::ServerOptions options;
+  options.socket_path = socket;
+  options.poll_interval = std::chrono::milliseconds(10);
+  options.client_timeout = std::chrono::milliseconds(100);
+  abys::ServeResult served;
+  std::thread server([&] { served = abys::serve(options, run, [&] { idle_calls++; }); });
+
+  int status = -1;
+  expect(!abys::forward_to_server((dir / "missing.sock").string(), {"parse"}, status).ok,
+         "no server, no forwarding");
+  abys::ServeResult forwarded;
+  for (int attempt = 0; attempt < 500 && !forwarded.ok; ++attempt) {
+    forwarded = forward_into(socket, {"write-tig", "a.sv", "-o", "a.tig"}, dir / "out.txt",
+                             status);
+    if (!forwarded.ok) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  expect(forwarded.ok, "forward to the server: " + forwarded.message);
+  expect(status == 4, "the handler's status comes back");
+  expect(read_file(dir / "out.txt") == "write-tig a.sv -o a.tig \n",
+         "output goes to the client's stdout");
+
+  // A client that connects and sends nothing is dropped after the timeout
+  // instead of holding up the next one.
+  const int stalled = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  socket.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+  expect(::connect(stalled, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == 0,
+         "connect a client that stalls");
+  const auto waited_from = std::chrono::steady_clock::now();
+  forwarded = forward_into(socket, {"parse"}, dir / "after.txt", status);
+  expect(forwarded.ok && status == 1, "a stalled client does not block the next one");
+  expect(std::chrono::steady_clock::now() - waited_from < std::chrono::seconds(5),
+         "the stalled client is dropped after the timeout");
+  ::close(stalled);
+
+  abys::ServerOptions second = options;
+  const auto refused = abys::serve(second, run, [] {});
+  expect(!refused.ok && refused.message.find("already listening") != std::string::npos,
+         "a second server does not take over a live socket");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  expect(idle_calls > 0, "idle work runs between commands");
+
+  expect(abys::stop_server(socket).ok, "stop the server");
+  server.join();
+  expect(served.ok, "serve returns cleanly: " + served.message);
+  expect(!std::filesystem::exists(socket), "the socket is removed");
+  expect(seen_cwds.size() == 2 && seen_cwds[0] == std::filesystem::current_path().string(),
+         "commands run in the client's directory");
+  expect(!abys::forward_to_server(socket, {"parse"}, status).ok, "a stopped server is gone");
+  std::filesystem::remove_all(dir);
+
+  return abys::test::report("server");
+}
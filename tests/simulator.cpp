@@ -0,0 +1,198 @@
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "abys/sim/simulator.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::sim::Simulator;
+using abys::sim::Word;
+using abys::test::expect;
+
+constexpr uint64_t kWidth = 4;
+// Every pair of 4-bit operands, one per pattern.
+constexpr size_t kWords = (1u << (2 * kWidth)) / 64;
+
+int64_t to_signed(uint64_t v, uint64_t width) {
+  return v & (1ULL << (width - 1)) ? static_cast<int64_t>(v) - (1LL << width)
+                                   : static_cast<int64_t>(v);
+}
+
+void set_pattern(std::span<Word> planes, size_t pattern, uint64_t value, uint64_t width,
+                 size_t num_words) {
+  for (uint64_t b = 0; b < width; b++) {
+    Word &word = planes[b * num_words + pattern / 64];
+    const Word bit = Word{1} << (pattern % 64);
+    word = (value >> b) & 1 ? word | bit : word & ~bit;
+  }
+}
+
+uint64_t get_pattern(std::span<const Word> planes, size_t pattern, uint64_t width,
+                     size_t num_words) {
+  uint64_t value = 0;
+  for (uint64_t b = 0; b < width; b++) {
+    value |= ((planes[b * num_words + pattern / 64] >> (pattern % 64)) & 1) << b;
+  }
+  return value;
+}
+
+struct Case {
+  std::string op;
+  uint64_t width;
+  bool sign;
+  std::function<uint64_t(uint64_t, uint64_t)> expected;
+};
+
+// y = op(a, b) in a module of its own.
+Tig::ModuleId build_op(TigBuilder &builder, const std::string &name, const std::string &op,
+                       uint64_t width, bool sign) {
+  const auto m = builder.create_module(name);
+  const auto a = builder.create_module_input(m, builder.intern("a"), kWidth, sign);
+  const auto b = builder.create_module_input(m, builder.intern("b"), kWidth, sign);
+  std::vector<TigBuilder::Signal> inputs{{a, 0}};
+  if (op != "not" && op != "neg") {
+    inputs.push_back({b, 0});
+  }
+  const auto y =
+      builder.create_op_node(m, builder.intern("y"), builder.intern(op), width, false, inputs);
+  builder.create_module_output(m, builder.intern("y"), width, false, y);
+  return m;
+}
+
+} // namespace
+
+int main() {
+  const uint64_t mask = (1ULL << kWidth) - 1;
+  const std::vector<Case> cases = {
+      {"and", kWidth, false, [](uint64_t a, uint64_t b) { return a & b; }},
+      {"or", kWidth, false, [](uint64_t a, uint64_t b) { return a | b; }},
+      {"xor", kWidth, false, [](uint64_t a, uint64_t b) { return a ^ b; }},
+      {"xnor", kWidth, false, [=](uint64_t a, uint64_t b) { return ~(a ^ b) & mask; }},
+      {"not", kWidth, false, [=](uint64_t a, uint64_t) { return ~a & mask; }},
+      {"neg", kWidth, false, [=](uint64_t a, uint64_t) { return (0 - a) & mask; }},
+      {"add", kWidth, false, [=](uint64_t a, uint64_t b) { return (a + b) & mask; }},
+      {"sub", kWidth, false, [=](uint64_t a, uint64_t b) { return (a - b) & mask; }},
+      {"mul", kWidth, false, [=](uint64_t a, uint64_t b) { return (a * b) & mask; }},
+      {"eq", 1, false, [](uint64_t a, uint64_t b) { return a == b ? 1 : 0; }},
+      {"ne", 1, false, [](uint64_t a, uint64_t b) { return a != b ? 1 : 0; }},
+      {"lt", 1, false, [](uint64_t a, uint64_t b) { return a < b ? 1 : 0; }},
+      {"lt", 1, true,
+       [](uint64_t a, uint64_t b) { return to_signed(a, kWidth) < to_signed(b, kWidth) ? 1 : 0; }},
+      // Wider than the operands: unsigned inputs are zero-extended.
+      {"add", kWidth + 2, false, [](uint64_t a, uint64_t b) { return a + b; }},
+  };
+
+  for (const bool simd : {false, true}) {
+    for (const auto &c : cases) {
+      Tig design;
+      TigBuilder builder(design);
+      const auto m = build_op(builder, "m", c.op, c.width, c.sign);
+      Simulator sim(design, m, {kWords, simd});
+      for (uint64_t p = 0; p < sim.num_patterns(); p++) {
+        set_pattern(sim.input_values(0), p, p & mask, kWidth, kWords);
+        set_pattern(sim.input_values(1), p, p >> kWidth, kWidth, kWords);
+      }
+      const auto run = sim.run();
+      expect(run.ok, c.op + ": " + run.message);
+      if (!run.ok) {
+        continue;
+      }
+      for (uint64_t p = 0; p < sim.num_patterns(); p++) {
+        const uint64_t a = p & mask;
+        const uint64_t b = p >> kWidth;
+        const uint64_t got = get_pattern(sim.output_values(0), p, c.width, kWords);
+        if (got != c.expected(a, b)) {
+          expect(false, std::string(sim.kernels().name) + ' ' + c.op +
+                            (c.sign ? " (signed)" : "") + " of " + std::to_string(a) + ", " +
+                            std::to_string(b) + " gave " + std::to_string(got));
+          break;
+        }
+      }
+    }
+  }
+
+  // Hierarchy: top instantiates the adder twice, y = (a + b) + b, with a
+  // constant, a split and a merge around it.
+  {
+    Tig design;
+    TigBuilder builder(design);
+    const auto adder = build_op(builder, "adder", "add", kWidth, false);
+    const auto top = builder.create_module("top");
+    const auto a = builder.create_module_input(top, builder.intern("a"), kWidth, false);
+    const auto b = builder.create_module_input(top, builder.intern("b"), kWidth, false);
+    const TigBuilder::SignalSpec spec{builder.intern("s"), kWidth, false};
+    const std::vector<TigBuilder::Signal> first_in{{a, 0}, {b, 0}};
+    const auto first = builder.create_instance(top, builder.intern("u0"), adder, first_in,
+                                               {&spec, 1});
+    const std::vector<TigBuilder::Signal> second_in{{first, 0}, {b, 0}};
+    const TigBuilder::SignalSpec spec2{builder.intern("t"), kWidth, false};
+    const auto second = builder.create_instance(top, builder.intern("u1"), adder, second_in,
+                                                {&spec2, 1});
+    const std::vector<TigBuilder::SignalSpec> halves{{builder.intern("lo"), 2, false},
+                                                     {builder.intern("hi"), 2, false}};
+    const auto split = builder.create_split_node(top, second, 0, halves);
+    const auto one = builder.create_const_node(top, builder.intern("one"), 2, false, "01");
+    // y = {01, t[3:2]}.
+    const std::vector<TigBuilder::Signal> parts{{split, 1}, {one, 0}};
+    const std::vector<Tig::SignalWidth> widths{2, 2};
+    const auto merged =
+        builder.create_merge_node(top, builder.intern("y"), kWidth, false, parts, widths);
+    builder.create_module_output(top, builder.intern("y"), kWidth, false, merged);
+
+    Simulator sim(design, top, {kWords, true});
+    for (uint64_t p = 0; p < sim.num_patterns(); p++) {
+      set_pattern(sim.input_values(0), p, p & mask, kWidth, kWords);
+      set_pattern(sim.input_values(1), p, p >> kWidth, kWidth, kWords);
+    }
+    const auto run = sim.run();
+    expect(run.ok, "hierarchy: " + run.message);
+    if (run.ok) {
+      for (uint64_t p = 0; p < sim.num_patterns(); p++) {
+        const uint64_t t = ((p & mask) + 2 * (p >> kWidth)) & mask;
+        const uint64_t expected = (t >> 2) | (1u << 2);
+        const uint64_t got = get_pattern(sim.output_values(0), p, kWidth, kWords);
+        if (got != expected) {
+          expect(false, "hierarchy pattern " + std::to_string(p) + " gave " +
+                            std::to_string(got) + ", expected " + std::to_string(expected));
+          break;
+        }
+      }
+      // The top's own nodes plus two evaluations of the four-node adder.
+      expect(sim.nodes_evaluated() == design.modules[top].num_nodes() + 2 * 4,
+             "evaluated " + std::to_string(sim.nodes_evaluated()) + " nodes");
+    }
+  }
+
+  // Screening and signatures: a + b equals b + a, but not a - b.
+  {
+    Tig design;
+    TigBuilder builder(design);
+    const auto add = build_op(builder, "add", "add", kWidth, false);
+    const auto xor_ = build_op(builder, "xor", "xor", kWidth, false);
+    const auto sub = build_op(builder, "sub", "sub", kWidth, false);
+    const auto same = abys::sim::screen_equivalence(design, add, add, 2, {3, true});
+    const auto differs = abys::sim::screen_equivalence(design, add, sub, 2, {3, true});
+    const auto close = abys::sim::screen_equivalence(design, add, xor_, 2, {3, true});
+    expect(same.ok && !same.distinguished && differs.ok && differs.distinguished && close.ok &&
+               close.distinguished,
+           "equivalence screening");
+
+    Simulator scalar(design, add, {5, false});
+    Simulator simd(design, add, {5, true});
+    scalar.randomize_inputs(7);
+    simd.randomize_inputs(7);
+    expect(scalar.run().ok && simd.run().ok && scalar.signatures() == simd.signatures(),
+           "scalar and SIMD signatures match");
+    expect(scalar.signature(scalar.inputs()[0]) != scalar.signature(scalar.inputs()[1]),
+           "independent inputs have signatures of their own");
+  }
+
+  return abys::test::report("simulator");
+}
@@ -0,0 +1,157 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/const_prop.h"
+#include "abys/ir/sweep.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/sim/simulator.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using NodeKind = Tig::Module::NodeKind;
+using abys::test::expect;
+
+// Signatures of the module outputs under random inputs.
+std::vector<uint64_t> signatures(const Tig &design, Tig::ModuleId top) {
+  abys::sim::Simulator sim(design, top);
+  sim.randomize_inputs(5);
+  if (!sim.run().ok) {
+    return {};
+  }
+  std::vector<uint64_t> out;
+  for (const auto &output : sim.outputs()) {
+    out.push_back(sim.signature(output));
+  }
+  return out;
+}
+
+size_t count_kind(const Tig::Module &module, NodeKind kind) {
+  size_t count = 0;
+  for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+    count += module.kind(n) == kind ? 1 : 0;
+  }
+  return count;
+}
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  auto name = [&](const char *s) { return builder.intern(s); };
+
+  // child: y0 = ~a and y1 = b + 1.
+  const auto child = builder.create_module("child");
+  const auto a = builder.create_module_input(child, name("a"), 8, false);
+  const auto b = builder.create_module_input(child, name("b"), 8, false);
+  const std::vector<TigBuilder::Signal> not_a{{a, 0}};
+  const auto inv = builder.create_op_node(child, name("inv"), name("not"), 8, false, not_a);
+  const auto one = builder.create_const_node(child, name("one"), 8, false, "00000001");
+  const std::vector<TigBuilder::Signal> b_plus_one{{b, 0}, {one, 0}};
+  const auto inc = builder.create_op_node(child, name("inc"), name("add"), 8, false, b_plus_one);
+  builder.create_module_output(child, name("y0"), 8, false, inv);
+  builder.create_module_output(child, name("y1"), 8, false, inc);
+
+  // Instantiated only for an output nobody reads.
+  const auto unused = builder.create_module("unused");
+  const auto u_in = builder.create_module_input(unused, name("i"), 8, false);
+  builder.create_module_output(unused, name("o"), 8, false, u_in);
+
+  // Holds a flop, so its instance stays though nothing reads it.
+  const auto stateful = builder.create_module("stateful");
+  auto &flop = design.modules[stateful].blocks.emplace_back();
+  flop.kind = Tig::Module::BlockKind::kFf;
+  flop.name = name("q_reg");
+
+  const auto top = builder.create_module("top");
+  const auto x = builder.create_module_input(top, name("x"), 8, false);
+  const auto z = builder.create_module_input(top, name("z"), 8, false);
+  const std::vector<TigBuilder::Signal> not_z{{z, 0}};
+  const auto z_inv = builder.create_op_node(top, name("z_inv"), name("not"), 8, false, not_z);
+  const std::vector<TigBuilder::Signal> u_inputs{{x, 0}, {z_inv, 0}};
+  const std::vector<TigBuilder::SignalSpec> u_outputs{{name("u_y0"), 8, false},
+                                                      {name("u_y1"), 8, false}};
+  const auto u = builder.create_instance(top, name("u"), child, u_inputs, u_outputs);
+  const std::vector<TigBuilder::Signal> dead_inputs{{x, 0}};
+  const std::vector<TigBuilder::SignalSpec> dead_outputs{{name("dead_o"), 8, false}};
+  builder.create_instance(top, name("dead"), unused, dead_inputs, dead_outputs);
+  builder.create_instance(top, name("state"), stateful, {}, {});
+  builder.create_conversion_node(top, name("wide_x"), 16, false, x);
+  const std::vector<TigBuilder::Signal> y_inputs{{u, 0}, {x, 0}};
+  const auto y = builder.create_op_node(top, name("y_drv"), name("xor"), 8, false, y_inputs);
+  builder.create_module_output(top, name("y"), 8, false, y);
+
+  const Tig original = design;
+  const auto expected = signatures(original, top);
+  const auto report = abys::ir::sweep_dead_logic(design);
+  expect(report.modules_before == 4 && report.modules_after == 3, "the unused module goes");
+  expect(report.remap[unused] == Tig::kInvalidModuleId && report.remap[child] == 0 &&
+             report.remap[stateful] == 1 && report.remap[top] == 2,
+         "survivors keep their order");
+  const Tig::ModuleId new_top = report.remap[top];
+  const auto &swept_top = design.modules[new_top];
+  const auto &swept_child = design.modules[report.remap[child]];
+  expect(swept_top.num_nodes() == 7, "x, z, u, state, y_drv, the output and a tie are left");
+  expect(count_kind(swept_top, NodeKind::kInstance) == 2, "the stateful instance stays");
+  expect(builder.find_signal(new_top, "wide_x").node_id == Tig::kInvalidNodeId &&
+             builder.find_signal(new_top, "z_inv").node_id == Tig::kInvalidNodeId,
+         "dead signals leave the signal map");
+  expect(builder.find_signal(new_top, "y_drv").node_id != Tig::kInvalidNodeId,
+         "live signals are remapped");
+  expect(swept_child.num_nodes() == 6 && swept_child.output_ports.size() == 2 &&
+             swept_child.input_ports.size() == 2,
+         "the child keeps its ports but not the logic behind y1");
+  expect(report.tied_inputs == 2, "y1 and the instance input behind b are tied off");
+  expect(signatures(design, new_top) == expected, "the sweep keeps behaviour");
+  expect(abys::ir::sweep_dead_logic(design).nodes_after == report.nodes_after,
+         "a second sweep finds nothing");
+
+  // The child as a root keeps both outputs.
+  Tig rooted = original;
+  abys::ir::SweepOptions options;
+  options.roots = {child};
+  const auto rooted_report = abys::ir::sweep_dead_logic(rooted, options);
+  expect(rooted_report.modules_after == 1 && rooted.modules[0].num_nodes() == 7,
+         "explicit roots keep every output");
+
+  // Constant propagation leaves its folded nodes for the sweep.
+  Tig folded;
+  TigBuilder folder(folded);
+  const auto f = folder.create_module("f");
+  const auto k = folder.create_const_node(f, folder.intern("k"), 8, false, "00000101");
+  const std::vector<TigBuilder::Signal> not_k{{k, 0}};
+  const auto nk = folder.create_op_node(f, folder.intern("nk"), folder.intern("not"), 8, false,
+                                        not_k);
+  folder.create_module_output(f, folder.intern("o"), 8, false, nk);
+  abys::ir::propagate_constants(folded);
+  expect(folded.modules[f].num_nodes() == 4, "folding adds a constant");
+  abys::ir::sweep_dead_logic(folded);
+  expect(folded.modules[f].num_nodes() == 2 && folded.modules[f].kind(1) == NodeKind::kConst,
+         "the folded op and its input go");
+
+  // The cone of y holds x and the child logic behind y0.
+  const auto cone = abys::ir::extract_cone(original, top, 0);
+  expect(cone.ok, "extract a cone: " + cone.message);
+  expect(cone.design.modules.size() == 2, "only modules the cone enters are copied");
+  const auto &cone_top = cone.design.modules[cone.top];
+  expect(cone_top.input_ports.size() == 1 && cone_top.output_ports.size() == 1 &&
+             cone.design.names.view(cone_top.input_ports[0].name) == "x",
+         "the top keeps the ports of the cone");
+  const auto &cone_child = cone.design.modules[cone_top.instance_module_id(1)];
+  expect(cone.design.names.view(cone_child.name) == "child" &&
+             cone_child.input_ports.size() == 1 && cone_child.output_ports.size() == 1 &&
+             cone_child.num_nodes() == 3,
+         "the child keeps a, inv and y0");
+  expect(cone_top.node_fanins(1).size() == 1 && cone_top.node_outputs(1).size() == 1,
+         "the instance loses the ports the child dropped");
+  expect(signatures(cone.design, cone.top) == std::vector<uint64_t>{expected[0]},
+         "the cone computes the same output");
+  expect(!abys::ir::extract_cone(original, top, 1).ok, "output ports are checked");
+
+  return abys::test::report("sweep");
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Checks shared by the test programs: a failed `expect` is printed and
+// counted, and `report` turns the count into the exit status of main.
+namespace abys::test {
+
+inline int failures = 0;
+
+inline void expect(bool cond, const std::string &what) {
+  if (!cond) {
+    std::cerr << "FAIL: " << what << '\n';
+    ++failures;
+  }
+}
+
+// Prints "<name> ok" when every expectation held.
+inline int report(const char *name) {
+  if (failures == 0) {
+    std::cout << name << " ok\n";
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+} // namespace abys::test
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abys/ir/const_prop.h"
+#include "abys/ir/module_dedup.h"
+#include "abys/ir/sweep.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_history.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  auto name = [&](const char *s) { return builder.intern(s); };
+
+  // pass: o = i, with nothing to fold or sweep.
+  const auto pass = builder.create_module("pass");
+  const auto i = builder.create_module_input(pass, name("i"), 8, false);
+  builder.create_module_output(pass, name("o"), 8, false, i);
+
+  // folds: o = ~5, which constant propagation folds.
+  const auto folds = builder.create_module("folds");
+  const auto k = builder.create_const_node(folds, name("k"), 8, false, "00000101");
+  const std::vector<TigBuilder::Signal> not_k{{k, 0}};
+  const auto nk = builder.create_op_node(folds, name("nk"), name("not"), 8, false, not_k);
+  builder.create_module_output(folds, name("o"), 8, false, nk);
+
+  const auto top = builder.create_module("top");
+  const auto x = builder.create_module_input(top, name("x"), 8, false);
+  const std::vector<TigBuilder::Signal> p_inputs{{x, 0}};
+  const std::vector<TigBuilder::SignalSpec> p_outputs{{name("p_o"), 8, false}};
+  const auto p = builder.create_instance(top, name("p"), pass, p_inputs, p_outputs);
+  const std::vector<TigBuilder::SignalSpec> f_outputs{{name("f_o"), 8, false}};
+  const auto f = builder.create_instance(top, name("f"), folds, {}, f_outputs);
+  const std::vector<TigBuilder::Signal> y_inputs{{p, 0}, {f, 0}};
+  const auto y = builder.create_op_node(top, name("y_drv"), name("and"), 8, false, y_inputs);
+  builder.create_module_output(top, name("y"), 8, false, y);
+
+  abys::ir::TigHistory history(design);
+  expect(!history.undo(), "nothing to undo yet");
+  history.checkpoint();
+  expect(history.changed_modules() == 0, "a checkpoint shares every module");
+  for (Tig::ModuleId m = 0; m < design.modules.size(); m++) {
+    expect(design.modules.shared(m), "module " + std::to_string(m) + " is shared");
+  }
+
+  abys::ir::propagate_constants(design);
+  expect(history.changed_modules() == 1, "folding copies only the module it folds");
+  expect(!design.modules.shared(folds) && design.modules.shared(pass) &&
+             design.modules.shared(top),
+         "modules nothing folds stay shared");
+  expect(design.modules[folds].num_nodes() == 4, "folding adds a constant");
+
+  history.checkpoint();
+  const auto swept = abys::ir::sweep_dead_logic(design);
+  expect(swept.nodes_after < swept.nodes_before, "the sweep drops the folded op");
+  expect(history.changed_modules() == 1, "the sweep copies only the module it compacts");
+
+  // A fork is a what-if run: it edits its own copies and leaves the design.
+  Tig fork = history.fork();
+  expect(fork.modules.same(pass, design.modules, pass), "a fork shares modules");
+  TigBuilder fork_builder(fork);
+  fork_builder.create_module("extra");
+  abys::ir::dedup_modules(fork);
+  fork_builder.create_const_node(top, fork_builder.intern("spare"), 1, false, "1");
+  expect(fork.modules.size() == 4 && design.modules.size() == 3, "forks grow on their own");
+  expect(!fork.modules.same(top, design.modules, top) &&
+             fork.modules.same(pass, design.modules, pass),
+         "a fork copies only the modules it writes");
+  expect(design.modules[top].num_nodes() == 5, "the fork's edits stay in the fork");
+
+  expect(history.undo() && history.num_checkpoints() == 1, "undo the sweep");
+  expect(design.modules[folds].num_nodes() == 4, "the sweep is undone");
+  expect(history.undo() && history.num_checkpoints() == 0, "undo the folding");
+  expect(design.modules[folds].num_nodes() == 3 &&
+             design.modules[folds].kind(1) == Tig::Module::NodeKind::kOp,
+         "the folding is undone");
+  expect(!history.undo(), "every checkpoint is used up");
+  expect(history.changed_modules() == design.modules.size(), "no checkpoint, all changed");
+
+  // Copies of a design share modules the same way.
+  const Tig copy = design;
+  design.modules[pass].name = name("renamed");
+  expect(copy.names.view(copy.modules[pass].name) == "pass", "a write leaves the copy alone");
+  expect(copy.modules.same(top, design.modules, top), "unwritten modules stay shared");
+
+  return abys::test::report("tig history");
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "abys/ir/module_dedup.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_memory.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::MemoryCategory;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+Tig::ModuleId make_parent(TigBuilder &builder, const std::string &name, Tig::ModuleId child,
+                          int instances) {
+  const auto m = builder.create_module(name);
+  Tig::NodeId a = builder.create_module_input(m, builder.intern("a"), 8, false);
+  for (int i = 0; i < instances; i++) {
+    const std::vector<TigBuilder::Signal> inputs{{a, 0}};
+    const std::vector<TigBuilder::SignalSpec> outputs{
+        {builder.intern(name + ".w" + std::to_string(i)), 8, false}};
+    a = builder.create_instance(m, builder.intern("u" + std::to_string(i)), child, inputs,
+                                outputs);
+  }
+  builder.create_module_output(m, builder.intern("y"), 8, false, a);
+  return m;
+}
+
+} // namespace
+
+int main() {
+  Tig design;
+  TigBuilder builder(design);
+  const auto leaf = builder.create_module("leaf");
+  const auto a = builder.create_module_input(leaf, builder.intern("a"), 8, false);
+  const std::vector<TigBuilder::Signal> inputs{{a, 0}};
+  const auto y = builder.create_op_node(leaf, builder.intern("n"), builder.intern("not"), 8,
+                                        false, inputs);
+  builder.create_module_output(leaf, builder.intern("y"), 8, false, y);
+  // top -> 2 x mid -> 3 x leaf, and top -> 1 x leaf directly: 7 leaves in all.
+  const auto mid = make_parent(builder, "mid", leaf, 3);
+  const auto top = builder.create_module("top");
+  const auto ta = builder.create_module_input(top, builder.intern("a"), 8, false);
+  const std::vector<TigBuilder::Signal> top_inputs{{ta, 0}};
+  for (const char *name : {"m0", "m1", "l0"}) {
+    const TigBuilder::SignalSpec out{builder.intern(std::string(name) + ".y"), 8, false};
+    builder.create_instance(top, builder.intern(name), name[0] == 'm' ? mid : leaf, top_inputs,
+                            {&out, 1});
+  }
+
+  auto &block = design.modules[leaf].blocks.emplace_back();
+  const std::pair<std::string_view, std::string_view> params[] = {{"WIDTH", "8"}};
+  const std::pair<std::string_view, std::string_view> attributes[] = {
+      {"a_long_attribute_name_past_any_small_string", "1"}};
+  block.params = builder.intern_params(params);
+  block.attributes = builder.intern_params(attributes);
+  design.modules[leaf].node_fanouts(0); // builds the graph index
+
+  const Tig::Module &leaf_module = design.modules[leaf];
+  const auto usage = abys::ir::module_memory(leaf_module);
+  expect(usage[MemoryCategory::kEdges] ==
+             leaf_module.fanins.capacity() * sizeof(Tig::Module::EdgeRef),
+         "edges are the fanin array");
+  expect(usage[MemoryCategory::kOutputs] ==
+             leaf_module.outputs.capacity() * sizeof(Tig::Module::Output),
+         "outputs are the output array");
+  expect(usage[MemoryCategory::kSignalMap] > 0, "signal map is counted");
+  expect(usage[MemoryCategory::kBlocks] > 0, "blocks are counted");
+  expect(usage[MemoryCategory::kBlockParams] == 0, "block params belong to the design");
+  expect(usage[MemoryCategory::kGraphIndex] > 0, "graph index is counted");
+  expect(usage[MemoryCategory::kNames] == 0, "names belong to the design");
+  expect(usage.total() == abys::ir::module_heap_bytes(leaf_module),
+         "module_heap_bytes is the module total");
+
+  const auto memory = abys::ir::design_memory(design);
+  expect(memory.tops.size() == 1 && memory.tops[0] == top, "top module");
+  expect(memory.modules[top].instances == 1, "top occurs once");
+  expect(memory.modules[mid].instances == 2, "mid occurs twice");
+  expect(memory.modules[leaf].instances == 7, "leaf occurs seven times");
+
+  abys::ir::MemoryUsage hierarchy = memory.modules[top].self;
+  hierarchy.add_scaled(memory.modules[leaf].self, 7);
+  hierarchy.add_scaled(memory.modules[mid].self, 2);
+  expect(memory.modules[top].hierarchy.bytes == hierarchy.bytes,
+         "hierarchy bytes weight children by instance count");
+
+  abys::ir::MemoryUsage flattened = memory.design;
+  flattened += hierarchy;
+  expect(memory.flattened.bytes == flattened.bytes, "flattened is the top's hierarchy");
+  expect(memory.design[MemoryCategory::kNames] > 0, "names are counted");
+  expect(memory.design[MemoryCategory::kBlockParams] == design.params.heap_bytes(),
+         "the parameter store is counted once");
+  expect(memory.total.total() == memory.design.total() + memory.modules[leaf].self.total() +
+                                     memory.modules[mid].self.total() +
+                                     memory.modules[top].self.total(),
+         "total sums the modules once");
+
+  std::ostringstream text;
+  abys::ir::write_memory_report(text, design, memory, 2);
+  expect(text.str().find("design: 3 modules, 1 top (top)") != std::string::npos,
+         "text header");
+  expect(text.str().find("block_params") != std::string::npos, "text categories");
+  expect(text.str().find("largest modules:") != std::string::npos, "text limit");
+
+  std::ostringstream json;
+  abys::ir::write_memory_report_json(json, design, memory);
+  const std::string leaf_json = "{\"id\":0,\"name\":\"leaf\",\"instances\":7,";
+  expect(json.str().find(leaf_json) != std::string::npos, "json module entry");
+  expect(json.str().find("\"tops\":[\"top\"]") != std::string::npos, "json tops");
+
+  return abys::test::report("tig memory");
+}
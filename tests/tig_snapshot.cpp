@@ -0,0 +1,200 @@
+#include <filesystem>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "abys/frontend.h"
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/tig_snapshot.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::ir::TigSnapshot;
+using abys::test::expect;
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+template <typename A, typename B> bool same(const A &a, const B &b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+}
+
+void check_view_matches(const Tig &design, const TigSnapshot &snapshot, const std::string &ctx) {
+  expect(snapshot.num_modules() == design.modules.size(), ctx + ": module count");
+  for (Tig::ModuleId m = 0; m < snapshot.num_modules(); ++m) {
+    const auto &module = design.modules[m];
+    const auto view = snapshot.module(m);
+    expect(snapshot.name(view.name) == design.names.view(module.name), ctx + ": module name");
+    expect(same(view.node_kinds, std::span(module.node_kinds)), ctx + ": node kinds");
+    expect(same(view.fanin_offsets, std::span(module.fanin_offsets)), ctx + ": fanin offsets");
+    expect(same(view.fanins, std::span(module.fanins)), ctx + ": fanins");
+    expect(view.outputs.size() == module.outputs.size(), ctx + ": outputs");
+    expect(same(view.const_words, std::span(module.const_words)), ctx + ": const words");
+    for (const auto &[name, edge] : module.signal_map) {
+      const auto found = view.find_signal(snapshot.find_name(design.names.view(name)));
+      expect(found.node_id == edge.node_id && found.port_idx == edge.port_idx,
+             ctx + ": signal " + std::string(design.names.view(name)));
+    }
+  }
+}
+
+void round_trip(const std::filesystem::path &fixture, const std::filesystem::path &dir) {
+  const std::string ctx = fixture.filename().string();
+  auto built = abys::build_tig_from_systemverilog({fixture.string()}, std::nullopt);
+  expect(built.ok, ctx + ": build: " + built.message);
+  if (!built.ok) {
+    return;
+  }
+
+  const auto first = dir / (ctx + ".tig");
+  expect(abys::ir::write_tig_snapshot(built.design, first.string()).ok, ctx + ": write");
+
+  TigSnapshot snapshot;
+  const auto opened = snapshot.open(first.string());
+  expect(opened.ok, ctx + ": open: " + opened.message);
+  if (!opened.ok) {
+    return;
+  }
+  check_view_matches(built.design, snapshot, ctx);
+
+  // Materializing and writing again must reproduce the file exactly.
+  const auto second = dir / (ctx + ".again.tig");
+  expect(abys::ir::write_tig_snapshot(snapshot.materialize(), second.string()).ok,
+         ctx + ": rewrite");
+  expect(read_file(first) == read_file(second), ctx + ": rewrite is not identical");
+
+  // A single flipped payload bit must be caught by the checksum.
+  std::string bytes = read_file(first);
+  bytes[bytes.size() - 1] ^= 1;
+  const auto corrupt = dir / (ctx + ".corrupt.tig");
+  std::ofstream(corrupt, std::ios::binary) << bytes;
+  TigSnapshot bad;
+  expect(!bad.open(corrupt.string()).ok, ctx + ": corruption not detected");
+}
+
+// Reads everything a snapshot and its materialized design let a caller reach.
+size_t touch(const TigSnapshot &snapshot) {
+  size_t sum = 0;
+  for (Tig::ModuleId m = 0; m < snapshot.num_modules(); ++m) {
+    const auto view = snapshot.module(m);
+    sum += snapshot.name(view.name).size();
+    for (Tig::NodeId n = 0; n < view.num_nodes(); n++) {
+      for (const auto &fanin : view.node_fanins(n)) {
+        if (fanin.node_id != Tig::kInvalidNodeId) {
+          sum += view.node_outputs(fanin.node_id)[fanin.port_idx].width;
+        }
+      }
+      for (const auto &output : view.node_outputs(n)) {
+        sum += snapshot.name(output.name).size();
+      }
+    }
+    for (const auto &entry : view.signals) {
+      const auto edge = view.find_signal(entry.name);
+      sum += view.node_outputs(edge.node_id)[edge.port_idx].width;
+      sum += snapshot.name(entry.name).size();
+    }
+  }
+  const Tig design = snapshot.materialize();
+  for (const auto &module : design.modules) {
+    for (Tig::NodeId n = 0; n < module.num_nodes(); n++) {
+      const auto *attrs = module.find_attrs(n);
+      if (module.kind(n) == Tig::Module::NodeKind::kConst) {
+        sum += module.node_const(n).to_string().size();
+      }
+      sum += attrs ? design.names.view(attrs->op).size() + module.node_segment_widths(n).size()
+                   : 0;
+    }
+    for (const auto &block : module.blocks) {
+      sum += design.names.view(block.name).size();
+      for (const auto set : {block.params, block.attributes}) {
+        for (const auto &param : design.params.view(set)) {
+          sum += design.names.view(param.key).size();
+        }
+      }
+    }
+  }
+  return sum;
+}
+
+// Structural checks alone, with the checksum skipped, must refuse a damaged
+// file or open one that stays in bounds, wherever the damage is.
+void corrupt_anywhere(const std::filesystem::path &dir) {
+  Tig design;
+  TigBuilder builder(design);
+  auto name = [&](const char *s) { return builder.intern(s); };
+  const auto leaf = builder.create_module("leaf");
+  const auto a = builder.create_module_input(leaf, name("a"), 8, false);
+  const auto k = builder.create_const_node(leaf, name("k"), 8, false, "01xz0101");
+  const std::vector<TigBuilder::Signal> ak{{a, 0}, {k, 0}};
+  const auto y = builder.create_op_node(leaf, name("y"), name("and"), 8, false, ak);
+  const std::vector<TigBuilder::SignalSpec> halves{{name("lo"), 4, false},
+                                                   {name("hi"), 4, false}};
+  const auto split = builder.create_split_node(leaf, y, 0, halves);
+  const std::vector<TigBuilder::Signal> parts{{split, 1}, {split, 0}};
+  const std::vector<Tig::SignalWidth> widths{4, 4};
+  const auto swapped = builder.create_merge_node(leaf, name("s"), 8, false, parts, widths);
+  builder.create_module_output(leaf, name("o"), 8, false, swapped);
+  auto &flop = design.modules[leaf].blocks.emplace_back();
+  flop.kind = Tig::Module::BlockKind::kFf;
+  flop.name = name("q_reg");
+  flop.input_ports.push_back({name("d"), 8, false});
+  flop.inputs.push_back(swapped);
+  const std::pair<std::string_view, std::string_view> params[] = {{"INIT", "4'b10x1"},
+                                                                  {"MODE", "\"fast\""}};
+  flop.params = builder.intern_params(params);
+  const auto top = builder.create_module("top");
+  const auto x = builder.create_module_input(top, name("x"), 8, false);
+  const std::vector<TigBuilder::Signal> u_inputs{{x, 0}};
+  const TigBuilder::SignalSpec u_output{name("u_o"), 8, false};
+  const auto u = builder.create_instance(top, name("u"), leaf, u_inputs, {&u_output, 1});
+  builder.create_module_output(top, name("z"), 8, false, u);
+
+  const auto path = dir / "corrupt.tig";
+  expect(abys::ir::write_tig_snapshot(design, path.string()).ok, "corrupt: write");
+  const std::string bytes = read_file(path);
+  size_t refused = 0;
+  size_t opened = 0;
+  for (size_t i = 0; i < bytes.size(); i++) {
+    for (const unsigned char value : {0x00, 0x01, 0x7f, 0xff}) {
+      if (static_cast<unsigned char>(bytes[i]) == value) {
+        continue;
+      }
+      std::string damaged = bytes;
+      damaged[i] = static_cast<char>(value);
+      std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+      TigSnapshot snapshot;
+      if (snapshot.open(path.string(), false).ok) {
+        opened += touch(snapshot) != 0;
+      } else {
+        refused++;
+      }
+    }
+  }
+  expect(refused > 0 && opened > 0, "corrupt: some damage is refused, some is harmless");
+}
+
+} // namespace
+
+int main() {
+  const std::filesystem::path fixtures = ABYS_FIXTURES_DIR;
+  const auto dir = std::filesystem::temp_directory_path() / "abys_tig_snapshot";
+  std::filesystem::create_directories(dir);
+
+  for (const char *name : {"and_gate.sv", "adder.sv", "consts.sv"}) {
+    round_trip(fixtures / name, dir);
+  }
+  corrupt_anywhere(dir);
+
+  std::filesystem::remove_all(dir);
+  return abys::test::report("tig snapshot");
+}
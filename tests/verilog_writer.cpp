@@ -0,0 +1,155 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "abys/ir/tig_builder.h"
+#include "abys/ir/verilog_writer.h"
+#include "test_util.h"
+
+namespace {
+
+using abys::ir::kEmptyName;
+using abys::ir::Tig;
+using abys::ir::TigBuilder;
+using abys::test::expect;
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// A 4-bit adder cell and a top module exercising every node kind the writer
+// renders: ports, an instance, a split, a constant, a merge, a comparison and
+// a widening signed conversion.
+Tig build_design(size_t num_cells) {
+  Tig design;
+  TigBuilder builder(design);
+  auto name = [&](const std::string &s) { return builder.intern(s); };
+  for (size_t c = 0; c < num_cells; c++) {
+    const auto cell = builder.create_module("cell" + std::to_string(c));
+    const auto a = builder.create_module_input(cell, name("a"), 4, false);
+    const auto b = builder.create_module_input(cell, name("b"), 4, false);
+    const std::vector<TigBuilder::Signal> ab{{a, 0}, {b, 0}};
+    const auto y = builder.create_op_node(cell, name("y"), name("add"), 4, false, ab);
+    builder.create_module_output(cell, name("y"), 4, false, y);
+  }
+
+  const auto top = builder.create_module("top");
+  const auto a = builder.create_module_input(top, name("a"), 4, false);
+  const auto b = builder.create_module_input(top, name("b.in"), 4, true);
+  const TigBuilder::SignalSpec sum{name("sum"), 4, false};
+  const std::vector<TigBuilder::Signal> ab{{a, 0}, {b, 0}};
+  const auto u = builder.create_instance(top, name("u0"), 0, ab, {&sum, 1});
+  const std::vector<TigBuilder::SignalSpec> halves{{name("lo"), 2, false}, {kEmptyName, 2, false}};
+  const auto split = builder.create_split_node(top, u, 0, halves);
+  const auto one = builder.create_const_node(top, name("one"), 2, false, "0x");
+  const std::vector<TigBuilder::Signal> parts{{split, 1}, {one, 0}};
+  const std::vector<Tig::SignalWidth> widths{2, 2};
+  const auto y = builder.create_merge_node(top, name("y"), 5, false, parts, widths);
+  builder.create_module_output(top, name("y"), 5, false, y);
+  const std::vector<TigBuilder::Signal> cmp{{b, 0}, {split, 0}};
+  const auto lt = builder.create_op_node(top, name("lt"), name("lt"), 1, false, cmp);
+  builder.create_module_output(top, name("z"), 1, false, lt);
+  const std::vector<TigBuilder::Signal> scmp{{b, 0}, {b, 0}};
+  const auto slt = builder.create_op_node(top, name("slt"), name("lt"), 1, false, scmp);
+  builder.create_module_output(top, name("s"), 1, false, slt);
+  const auto wide = builder.create_conversion_node(top, name("wide"), 6, true, b);
+  builder.create_module_output(top, name("w"), 6, true, wide);
+  return design;
+}
+
+} // namespace
+
+int main() {
+  const auto dir = std::filesystem::temp_directory_path() / "abys_verilog_writer";
+  std::filesystem::create_directories(dir);
+
+  const Tig design = build_design(1);
+  const auto path = dir / "small.v";
+  const auto result = abys::ir::write_verilog(design, path.string());
+  const std::string text = read_file(path);
+  expect(result.ok && result.bytes_written == text.size(), "write: " + result.message);
+  const std::vector<std::string> expected = {
+      "module cell0(a, b, y);\n  input [3:0] a;\n  input [3:0] b;\n  output [3:0] y;\n"
+      "  assign y = a + b;\nendmodule\n",
+      "  input signed [3:0] \\b.in ;\n",
+      "  cell0 u0(\n    .a(a),\n    .b(\\b.in ),\n    .y(sum));\n",
+      "  assign lo = sum[1:0];\n",
+      "  assign _n3_1 = sum[3:2];\n",
+      "  assign one = 2'b0x;\n",
+      "  assign y = {{1{1'b0}}, one, _n3_1};\n",
+      "  assign lt = (\\b.in  < {{2{1'b0}}, lo});\n",
+      "  assign slt = ($signed(\\b.in ) < $signed(\\b.in ));\n",
+      "  assign wide = {{2{\\b.in [3]}}, \\b.in };\n",
+      "  assign w = wide;\n",
+      "  assign z = lt;\n",
+  };
+  for (const auto &snippet : expected) {
+    expect(text.find(snippet) != std::string::npos, "missing\n" + snippet + "in\n" + text);
+  }
+  expect(text.find("wire [4:0] y;") == std::string::npos,
+         "an output port driven by its own name gets no wire");
+
+  // Two specializations of one source module share its name; a third module
+  // already has the name the second would get.
+  Tig clash;
+  {
+    TigBuilder builder(clash);
+    auto name = [&](const char *s) { return builder.intern(s); };
+    std::vector<Tig::ModuleId> invs;
+    for (const Tig::SignalWidth width : {8, 4, 1}) {
+      const auto inv = builder.create_module(invs.size() == 2 ? "inv_1" : "inv");
+      const auto a = builder.create_module_input(inv, name("a"), width, false);
+      const std::vector<TigBuilder::Signal> not_a{{a, 0}};
+      const auto y = builder.create_op_node(inv, name("y"), name("not"), width, false, not_a);
+      builder.create_module_output(inv, name("y"), width, false, y);
+      invs.push_back(inv);
+    }
+    const auto top = builder.create_module("top");
+    const auto x = builder.create_module_input(top, name("x"), 8, false);
+    const TigBuilder::SignalSpec y8{name("y8"), 8, false};
+    const TigBuilder::SignalSpec y4{name("y4"), 4, false};
+    const std::vector<TigBuilder::Signal> x_in{{x, 0}};
+    builder.create_instance(top, name("u8"), invs[0], x_in, {&y8, 1});
+    builder.create_instance(top, name("u4"), invs[1], x_in, {&y4, 1});
+  }
+  const auto clash_path = dir / "clash.v";
+  const auto clash_result = abys::ir::write_verilog(clash, clash_path.string());
+  const std::string clash_text = read_file(clash_path);
+  const std::vector<std::string> renamed = {
+      "module inv(a, y);", "module inv_1(a, y);", "module inv_1_2(a, y);",
+      "  inv u8(\n",      "  inv_1 u4(\n",
+  };
+  for (const auto &snippet : renamed) {
+    expect(clash_result.ok && clash_text.find(snippet) != std::string::npos,
+           "clashing module names: missing " + snippet + " in\n" + clash_text);
+  }
+
+  // Tiny buffers force every module through the spill and stash paths; the
+  // file must not depend on the thread count.
+  const Tig big = build_design(200);
+  std::string serial;
+  for (unsigned threads : {1u, 2u, 8u}) {
+    abys::ir::VerilogWriteOptions options;
+    options.buffer_bytes = 64;
+    options.num_threads = threads;
+    const auto out = dir / ("big." + std::to_string(threads) + ".v");
+    const bool written = abys::ir::write_verilog(big, out.string(), options).ok;
+    expect(written, "write with " + std::to_string(threads) + " threads");
+    if (!written) {
+      continue;
+    }
+    const std::string bytes = read_file(out);
+    if (serial.empty()) {
+      serial = bytes;
+    } else {
+      expect(bytes == serial, std::to_string(threads) + " threads leave the output alone");
+    }
+  }
+
+  std::filesystem::remove_all(dir);
+  return abys::test::report("verilog writer");
+}